@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures the cost of routing stanzas to client sessions, with 50k
+ * sessions (two resources for each of 25k users). Half of the stanzas are
+ * addressed to a full JID, the other half to a bare JID.
+ *
+ * The linear router replicates the scans that ServerStanzaRouter used to do
+ * before it indexed the sessions. It only routes a fraction of the stanzas,
+ * as it would take too long otherwise.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Swiften/Elements/Message.h>
+
+#include <Limber/Server/ServerSession.h>
+#include <Limber/Server/ServerStanzaRouter.h>
+
+using namespace Swift;
+
+static const int NUMBER_OF_USERS = 25000;
+static const int RESOURCES_PER_USER = 2;
+static const int NUMBER_OF_STANZAS = 1000000;
+static const int NUMBER_OF_LINEAR_STANZAS = 1000;
+
+class BenchmarkSession : public ServerSession {
+    public:
+        BenchmarkSession(const JID& jid, int priority) : jid_(jid), priority_(priority), stanzas(0) {}
+
+        virtual const JID& getJID() const {
+            return jid_;
+        }
+
+        virtual int getPriority() const {
+            return priority_;
+        }
+
+        virtual void sendStanza(std::shared_ptr<Stanza>) {
+            stanzas++;
+        }
+
+    private:
+        JID jid_;
+        int priority_;
+
+    public:
+        size_t stanzas;
+};
+
+class LinearRouter {
+    public:
+        bool routeStanza(std::shared_ptr<Stanza> stanza) {
+            JID to = stanza->getTo();
+            if (!to.isBare()) {
+                auto i = std::find_if(sessions.begin(), sessions.end(), [&](ServerSession* session) { return session->getJID().equals(to, JID::WithResource); });
+                if (i != sessions.end()) {
+                    (*i)->sendStanza(stanza);
+                    return true;
+                }
+            }
+            to = to.toBare();
+            std::vector<ServerSession*> candidateSessions;
+            for (auto session : sessions) {
+                if (session->getJID().equals(to, JID::WithoutResource) && session->getPriority() >= 0) {
+                    candidateSessions.push_back(session);
+                }
+            }
+            if (candidateSessions.empty()) {
+                return false;
+            }
+            auto i = std::max_element(candidateSessions.begin(), candidateSessions.end(), [](ServerSession* s1, ServerSession* s2) { return s1->getPriority() < s2->getPriority(); });
+            (*i)->sendStanza(stanza);
+            return true;
+        }
+
+        std::vector<ServerSession*> sessions;
+};
+
+template<typename Router>
+static double measure(Router& router, const std::vector<std::shared_ptr<Message> >& stanzas, size_t count) {
+    size_t routed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        routed += router.routeStanza(stanzas[i]);
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    if (routed != count) {
+        std::cerr << "Only routed " << routed << " of " << count << " stanzas" << std::endl;
+    }
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / count;
+}
+
+int main(int, char**) {
+    std::vector<std::unique_ptr<BenchmarkSession> > sessions;
+    for (int user = 0; user < NUMBER_OF_USERS; ++user) {
+        for (int resource = 0; resource < RESOURCES_PER_USER; ++resource) {
+            JID jid("user" + std::to_string(user), "example.com", "resource" + std::to_string(resource));
+            sessions.push_back(std::unique_ptr<BenchmarkSession>(new BenchmarkSession(jid, resource)));
+        }
+    }
+
+    std::mt19937 random(0);
+    std::uniform_int_distribution<size_t> sessionDistribution(0, sessions.size() - 1);
+    std::vector<std::shared_ptr<Message> > stanzas;
+    for (int i = 0; i < NUMBER_OF_STANZAS; ++i) {
+        const JID& jid = sessions[sessionDistribution(random)]->getJID();
+        std::shared_ptr<Message> message = std::make_shared<Message>();
+        message->setTo(i % 2 == 0 ? jid : jid.toBare());
+        stanzas.push_back(message);
+    }
+
+    ServerStanzaRouter indexedRouter;
+    LinearRouter linearRouter;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& session : sessions) {
+        indexedRouter.addClientSession(session.get());
+    }
+    auto addTime = std::chrono::steady_clock::now() - start;
+    for (const auto& session : sessions) {
+        linearRouter.sessions.push_back(session.get());
+    }
+
+    double linear = measure(linearRouter, stanzas, NUMBER_OF_LINEAR_STANZAS);
+    double indexed = measure(indexedRouter, stanzas, NUMBER_OF_STANZAS);
+
+    start = std::chrono::steady_clock::now();
+    for (const auto& session : sessions) {
+        indexedRouter.removeClientSession(session.get());
+    }
+    auto removeTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Routing " << NUMBER_OF_STANZAS << " stanzas across " << sessions.size() << " sessions" << std::endl;
+    std::cout << "  Linear:  " << linear << " ns/stanza (over " << NUMBER_OF_LINEAR_STANZAS << " stanzas)" << std::endl;
+    std::cout << "  Indexed: " << indexed << " ns/stanza" << std::endl;
+    std::cout << "  Indexed add:    " << static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(addTime).count()) / sessions.size() << " ns/session" << std::endl;
+    std::cout << "  Indexed remove: " << static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(removeTime).count()) / sessions.size() << " ns/session" << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2010-2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Limber/Server/Server.h>
+
+#include <boost/bind.hpp>
+
+#include <Swiften/Elements/IQ.h>
+#include <Swiften/Elements/Presence.h>
+#include <Swiften/Elements/RosterPayload.h>
+#include <Swiften/Elements/SoftwareVersion.h>
+#include <Swiften/Elements/Stanza.h>
+#include <Swiften/Elements/VCard.h>
+#include <Swiften/Network/BoostConnectionServer.h>
+
+#include <Limber/Server/ServerFromClientSession.h>
+
+namespace Swift {
+
+Server::Server(UserRegistry* userRegistry, EventLoop* eventLoop, int port, const HostAddress& address) : userRegistry_(userRegistry), tlsContextFactory_(nullptr) {
+    serverFromClientConnectionServer_ = BoostConnectionServer::create(address, port, &ioServicePool_, eventLoop);
+    serverFromClientConnectionServer_->onNewConnection.connect(boost::bind(&Server::handleNewConnection, this, _1));
+}
+
+Server::~Server() {
+    serverFromClientConnectionServer_->onNewConnection.disconnect(boost::bind(&Server::handleNewConnection, this, _1));
+    serverFromClientConnectionServer_->stop();
+    for (const auto& session : serverFromClientSessions_) {
+        session->onSessionStarted.disconnect_all_slots();
+        session->onElementReceived.disconnect_all_slots();
+        session->onSessionFinished.disconnect_all_slots();
+    }
+}
+
+boost::optional<ConnectionServer::Error> Server::start() {
+    return serverFromClientConnectionServer_->tryStart();
+}
+
+void Server::stop() {
+    serverFromClientConnectionServer_->stop();
+    // Finishing a session removes it from the list
+    std::vector< std::shared_ptr<ServerFromClientSession> > sessions(serverFromClientSessions_.begin(), serverFromClientSessions_.end());
+    for (const auto& session : sessions) {
+        session->finishSession();
+    }
+}
+
+HostAddressPort Server::getAddressPort() const {
+    return serverFromClientConnectionServer_->getAddressPort();
+}
+
+void Server::handleNewConnection(std::shared_ptr<Connection> connection) {
+    std::shared_ptr<ServerFromClientSession> session(new ServerFromClientSession(idGenerator_.generateID(), connection, &payloadParserFactories_, &payloadSerializers_, &xmlParserFactory_, userRegistry_));
+    if (tlsContextFactory_) {
+        session->setTLSContextFactory(tlsContextFactory_);
+    }
+    serverFromClientSessions_.insert(session);
+    session->onSessionStarted.connect(boost::bind(&Server::handleSessionStarted, this, session));
+    session->onElementReceived.connect(boost::bind(&Server::handleElementReceived, this, _1, session));
+    session->onSessionFinished.connect(boost::bind(&Server::handleSessionFinished, this, session));
+    session->startSession();
+}
+
+void Server::handleSessionStarted(std::shared_ptr<ServerFromClientSession> session) {
+    stanzaRouter_.addClientSession(session.get());
+}
+
+void Server::handleSessionFinished(std::shared_ptr<ServerFromClientSession> session) {
+    stanzaRouter_.removeClientSession(session.get());
+    serverFromClientSessions_.erase(session);
+}
+
+void Server::handleElementReceived(std::shared_ptr<ToplevelElement> element, std::shared_ptr<ServerFromClientSession> session) {
+    std::shared_ptr<Stanza> stanza(std::dynamic_pointer_cast<Stanza>(element));
+    if (!stanza) {
+        return;
+    }
+    stanza->setFrom(session->getRemoteJID());
+    // Replies come from the address the client used
+    JID replyFrom = stanza->getTo();
+    if (!stanza->getTo().isValid()) {
+        stanza->setTo(JID(session->getLocalJID()));
+    }
+    if (!stanza->getTo().isValid() || stanza->getTo() == session->getLocalJID() || stanza->getTo() == session->getRemoteJID().toBare()) {
+        if (std::shared_ptr<IQ> iq = std::dynamic_pointer_cast<IQ>(stanza)) {
+            if (iq->getType() != IQ::Get && iq->getType() != IQ::Set) {
+                return;
+            }
+            if (iq->getPayload<RosterPayload>()) {
+                session->sendElement(IQ::createResult(iq->getFrom(), replyFrom, iq->getID(), std::make_shared<RosterPayload>()));
+            }
+            else if (iq->getPayload<VCard>()) {
+                if (iq->getType() == IQ::Get) {
+                    std::shared_ptr<VCard> vcard(new VCard());
+                    vcard->setNickname(iq->getFrom().getNode());
+                    session->sendElement(IQ::createResult(iq->getFrom(), replyFrom, iq->getID(), vcard));
+                }
+                else {
+                    session->sendElement(IQ::createError(iq->getFrom(), replyFrom, iq->getID(), ErrorPayload::Forbidden, ErrorPayload::Cancel));
+                }
+            }
+            else if (iq->getPayload<SoftwareVersion>() && iq->getType() == IQ::Get) {
+                session->sendElement(IQ::createResult(iq->getFrom(), replyFrom, iq->getID(), std::make_shared<SoftwareVersion>("Limber")));
+            }
+            else {
+                session->sendElement(IQ::createError(iq->getFrom(), replyFrom, iq->getID(), ErrorPayload::FeatureNotImplemented, ErrorPayload::Cancel));
+            }
+        }
+        else if (std::shared_ptr<Presence> presence = std::dynamic_pointer_cast<Presence>(stanza)) {
+            session->setPriority(presence->getType() == Presence::Available ? presence->getPriority() : -1);
+            stanzaRouter_.handlePriorityChanged(session.get());
+        }
+    }
+    else if (!stanzaRouter_.routeStanza(stanza)) {
+        std::shared_ptr<IQ> iq = std::dynamic_pointer_cast<IQ>(stanza);
+        if (iq && (iq->getType() == IQ::Get || iq->getType() == IQ::Set)) {
+            session->sendElement(IQ::createError(iq->getFrom(), iq->getTo(), iq->getID(), ErrorPayload::ServiceUnavailable, ErrorPayload::Cancel));
+        }
+    }
+}
+
+}
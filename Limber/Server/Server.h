@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2010-2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <Swiften/Base/IDGenerator.h>
+#include <Swiften/Network/BoostIOServicePool.h>
+#include <Swiften/Network/ConnectionServer.h>
+#include <Swiften/Network/HostAddress.h>
+#include <Swiften/Network/HostAddressPort.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+
+#include <Limber/Server/ServerStanzaRouter.h>
+
+namespace Swift {
+    class BoostConnectionServer;
+    class Connection;
+    class EventLoop;
+    class ServerFromClientSession;
+    class TLSContextFactory;
+    class ToplevelElement;
+    class UserRegistry;
+
+    /**
+     * Accepts client connections, and routes stanzas between the connected
+     * clients.
+     *
+     * Stanzas to the server itself or to the bare JID of the sender are
+     * answered for rosters (always empty), vCards and software versions.
+     */
+    class Server {
+        public:
+            /**
+             * @param port The port to listen on, or 0 to pick a free one.
+             */
+            Server(UserRegistry* userRegistry, EventLoop* eventLoop, int port = 5222, const HostAddress& address = HostAddress());
+            ~Server();
+
+            /**
+             * Offers STARTTLS to clients, using server mode contexts of the
+             * given factory. The factory needs a server certificate.
+             */
+            void setTLSContextFactory(TLSContextFactory* tlsContextFactory) {
+                tlsContextFactory_ = tlsContextFactory;
+            }
+
+            boost::optional<ConnectionServer::Error> start();
+            void stop();
+
+            HostAddressPort getAddressPort() const;
+
+            size_t getSessionCount() const {
+                return serverFromClientSessions_.size();
+            }
+
+        private:
+            void handleNewConnection(std::shared_ptr<Connection> connection);
+            void handleSessionStarted(std::shared_ptr<ServerFromClientSession> session);
+            void handleSessionFinished(std::shared_ptr<ServerFromClientSession> session);
+            void handleElementReceived(std::shared_ptr<ToplevelElement> element, std::shared_ptr<ServerFromClientSession> session);
+
+        private:
+            IDGenerator idGenerator_;
+            PlatformXMLParserFactory xmlParserFactory_;
+            UserRegistry* userRegistry_;
+            TLSContextFactory* tlsContextFactory_;
+            BoostIOServicePool ioServicePool_;
+            std::shared_ptr<BoostConnectionServer> serverFromClientConnectionServer_;
+            std::unordered_set< std::shared_ptr<ServerFromClientSession> > serverFromClientSessions_;
+            ServerStanzaRouter stanzaRouter_;
+            FullPayloadParserFactoryCollection payloadParserFactories_;
+            FullPayloadSerializerCollection payloadSerializers_;
+    };
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -17,10 +17,16 @@
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Elements/ResourceBind.h>
 #include <Swiften/Elements/StartSession.h>
+#include <Swiften/Elements/StartTLSFailure.h>
+#include <Swiften/Elements/StartTLSRequest.h>
 #include <Swiften/Elements/StreamFeatures.h>
+#include <Swiften/Elements/TLSProceed.h>
 #include <Swiften/Network/Connection.h>
 #include <Swiften/SASL/PLAINMessage.h>
+#include <Swiften/StreamStack/StreamStack.h>
+#include <Swiften/StreamStack/TLSLayer.h>
 #include <Swiften/StreamStack/XMPPLayer.h>
+#include <Swiften/TLS/TLSContextFactory.h>
 
 #include <Limber/Server/UserRegistry.h>
 
@@ -38,16 +44,42 @@ ServerFromClientSession::ServerFromClientSession(
             userRegistry_(userRegistry),
             authenticated_(false),
             initialized(false),
-            allowSASLEXTERNAL(false) {
+            allowSASLEXTERNAL(false),
+            priority_(0),
+            tlsContextFactory_(nullptr) {
 }
 
+ServerFromClientSession::~ServerFromClientSession() {
+    if (tlsLayer_) {
+        tlsLayer_->onError.disconnect(boost::bind(&ServerFromClientSession::handleTLSError, this));
+    }
+}
 
 void ServerFromClientSession::handleElement(std::shared_ptr<ToplevelElement> element) {
     if (isInitialized()) {
         onElementReceived(element);
     }
     else {
-        if (AuthRequest* authRequest = dynamic_cast<AuthRequest*>(element.get())) {
+        if (dynamic_cast<StartTLSRequest*>(element.get())) {
+            std::unique_ptr<TLSContext> tlsContext;
+            if (tlsContextFactory_ && !tlsLayer_ && !authenticated_) {
+                tlsContext = std::unique_ptr<TLSContext>(tlsContextFactory_->createTLSContext(TLSOptions(), TLSContext::Mode::Server));
+            }
+            if (tlsContext) {
+                // The proceed still goes out unencrypted
+                getXMPPLayer()->writeElement(std::make_shared<TLSProceed>());
+                tlsLayer_ = std::unique_ptr<TLSLayer>(new TLSLayer(std::move(tlsContext)));
+                tlsLayer_->onError.connect(boost::bind(&ServerFromClientSession::handleTLSError, this));
+                getStreamStack()->addLayer(tlsLayer_.get());
+                getXMPPLayer()->resetParser();
+                tlsLayer_->accept();
+            }
+            else {
+                getXMPPLayer()->writeElement(std::make_shared<StartTLSFailure>());
+                finishSession(TLSError);
+            }
+        }
+        else if (AuthRequest* authRequest = dynamic_cast<AuthRequest*>(element.get())) {
             if (authRequest->getMechanism() == "PLAIN" || (allowSASLEXTERNAL && authRequest->getMechanism() == "EXTERNAL")) {
                 if (authRequest->getMechanism() == "EXTERNAL") {
                         getXMPPLayer()->writeElement(std::make_shared<AuthSuccess>());
@@ -75,7 +107,8 @@ void ServerFromClientSession::handleElement(std::shared_ptr<ToplevelElement> ele
         }
         else if (IQ* iq = dynamic_cast<IQ*>(element.get())) {
             if (std::shared_ptr<ResourceBind> resourceBind = iq->getPayload<ResourceBind>()) {
-                setRemoteJID(JID(user_, getLocalJID().getDomain(), resourceBind->getResource()));
+                // Let the server pick a resource, so clients sharing an account still get distinct JIDs
+                setRemoteJID(JID(user_, getLocalJID().getDomain(), resourceBind->getResource().empty() ? id_ : resourceBind->getResource()));
                 std::shared_ptr<ResourceBind> resultResourceBind(new ResourceBind());
                 resultResourceBind->setJID(getRemoteJID());
                 getXMPPLayer()->writeElement(IQ::createResult(JID(), iq->getID(), resultResourceBind));
@@ -96,6 +129,9 @@ void ServerFromClientSession::handleStreamStart(const ProtocolHeader& incomingHe
     getXMPPLayer()->writeHeader(header);
 
     std::shared_ptr<StreamFeatures> features(new StreamFeatures());
+    if (tlsContextFactory_ && !tlsLayer_ && !authenticated_) {
+        features->setHasStartTLS();
+    }
     if (!authenticated_) {
         features->addAuthenticationMechanism("PLAIN");
         if (allowSASLEXTERNAL) {
@@ -118,4 +154,12 @@ void ServerFromClientSession::setAllowSASLEXTERNAL() {
     allowSASLEXTERNAL = true;
 }
 
+void ServerFromClientSession::setTLSContextFactory(TLSContextFactory* tlsContextFactory) {
+    tlsContextFactory_ = tlsContextFactory;
+}
+
+void ServerFromClientSession::handleTLSError() {
+    finishSession(TLSError);
+}
+
 }
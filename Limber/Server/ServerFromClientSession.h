@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,8 @@
 #include <Swiften/Network/Connection.h>
 #include <Swiften/Session/Session.h>
 
+#include <Limber/Server/ServerSession.h>
+
 namespace Swift {
     class ProtocolHeader;
     class ToplevelElement;
@@ -28,8 +30,10 @@ namespace Swift {
     class ConnectionLayer;
     class Connection;
     class XMLParserFactory;
+    class TLSContextFactory;
+    class TLSLayer;
 
-    class ServerFromClientSession : public Session {
+    class ServerFromClientSession : public Session, public ServerSession {
         public:
             ServerFromClientSession(
                     const std::string& id,
@@ -38,13 +42,41 @@ namespace Swift {
                     PayloadSerializerCollection* payloadSerializers,
                     XMLParserFactory* xmlParserFactory,
                     UserRegistry* userRegistry);
+            virtual ~ServerFromClientSession();
 
             boost::signals2::signal<void ()> onSessionStarted;
             void setAllowSASLEXTERNAL();
 
+            /**
+             * Offers STARTTLS to the client, using server mode contexts of
+             * the given factory. The factory needs a server certificate.
+             */
+            void setTLSContextFactory(TLSContextFactory* tlsContextFactory);
+
+            virtual const JID& getJID() const override {
+                return getRemoteJID();
+            }
+
+            virtual int getPriority() const override {
+                return priority_;
+            }
+
+            /**
+             * Sets the priority of the client's current presence, or a
+             * negative value when it is unavailable.
+             */
+            void setPriority(int priority) {
+                priority_ = priority;
+            }
+
+            virtual void sendStanza(std::shared_ptr<Stanza> stanza) override {
+                sendElement(stanza);
+            }
+
         private:
             void handleElement(std::shared_ptr<ToplevelElement>);
             void handleStreamStart(const ProtocolHeader& header);
+            void handleTLSError();
 
             void setInitialized();
             bool isInitialized() const {
@@ -58,5 +90,8 @@ namespace Swift {
             bool initialized;
             bool allowSASLEXTERNAL;
             std::string user_;
+            int priority_;
+            TLSContextFactory* tlsContextFactory_;
+            std::unique_ptr<TLSLayer> tlsLayer_;
     };
 }
@@ -1,12 +1,11 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Limber/Server/ServerStanzaRouter.h>
 
-#include <algorithm>
 #include <cassert>
 
 #include <Swiften/Base/Algorithm.h>
@@ -15,62 +14,78 @@
 
 namespace Swift {
 
-namespace {
-    struct PriorityLessThan {
-        bool operator()(const ServerSession* s1, const ServerSession* s2) const {
-            return s1->getPriority() < s2->getPriority();
+void ServerStanzaRouter::BareJIDSessions::updateTopSession() {
+    // On equal priorities, the session that was added first wins
+    topSession = nullptr;
+    for (auto session : sessions) {
+        if (session->getPriority() >= 0 && (!topSession || session->getPriority() > topSession->getPriority())) {
+            topSession = session;
         }
-    };
-
-    struct HasJID {
-        HasJID(const JID& jid) : jid(jid) {}
-        bool operator()(const ServerSession* session) const {
-            return session->getJID().equals(jid, JID::WithResource);
-        }
-        JID jid;
-    };
+    }
 }
 
 ServerStanzaRouter::ServerStanzaRouter() {
 }
 
 bool ServerStanzaRouter::routeStanza(std::shared_ptr<Stanza> stanza) {
-    JID to = stanza->getTo();
+    const JID& to = stanza->getTo();
     assert(to.isValid());
 
     // For a full JID, first try to route to a session with the full JID
     if (!to.isBare()) {
-        std::vector<ServerSession*>::const_iterator i = std::find_if(clientSessions_.begin(), clientSessions_.end(), HasJID(to));
-        if (i != clientSessions_.end()) {
-            (*i)->sendStanza(stanza);
+        auto i = fullJIDSessions_.find(to);
+        if (i != fullJIDSessions_.end()) {
+            i->second->sendStanza(stanza);
             return true;
         }
     }
 
-    // Look for candidate sessions
-    to = to.toBare();
-    std::vector<ServerSession*> candidateSessions;
-    for (std::vector<ServerSession*>::const_iterator i = clientSessions_.begin(); i != clientSessions_.end(); ++i) {
-        if ((*i)->getJID().equals(to, JID::WithoutResource) && (*i)->getPriority() >= 0) {
-            candidateSessions.push_back(*i);
-        }
-    }
-    if (candidateSessions.empty()) {
+    // Otherwise, route to the session with the highest priority
+    auto i = bareJIDSessions_.find(to.toBare());
+    if (i == bareJIDSessions_.end() || !i->second.topSession) {
         return false;
     }
-
-    // Find the session with the highest priority
-    std::vector<ServerSession*>::const_iterator i = std::max_element(clientSessions_.begin(), clientSessions_.end(), PriorityLessThan());
-    (*i)->sendStanza(stanza);
+    i->second.topSession->sendStanza(stanza);
     return true;
 }
 
 void ServerStanzaRouter::addClientSession(ServerSession* clientSession) {
-    clientSessions_.push_back(clientSession);
+    const JID& jid = clientSession->getJID();
+    fullJIDSessions_[jid] = clientSession;
+
+    BareJIDSessions& bareJIDSessions = bareJIDSessions_[jid.toBare()];
+    bareJIDSessions.sessions.push_back(clientSession);
+    if (clientSession->getPriority() >= 0 && (!bareJIDSessions.topSession || clientSession->getPriority() > bareJIDSessions.topSession->getPriority())) {
+        bareJIDSessions.topSession = clientSession;
+    }
 }
 
 void ServerStanzaRouter::removeClientSession(ServerSession* clientSession) {
-    erase(clientSessions_, clientSession);
+    const JID& jid = clientSession->getJID();
+    auto i = fullJIDSessions_.find(jid);
+    // A newer session may have taken over the full JID
+    if (i != fullJIDSessions_.end() && i->second == clientSession) {
+        fullJIDSessions_.erase(i);
+    }
+
+    auto j = bareJIDSessions_.find(jid.toBare());
+    if (j == bareJIDSessions_.end()) {
+        return;
+    }
+    erase(j->second.sessions, clientSession);
+    if (j->second.sessions.empty()) {
+        bareJIDSessions_.erase(j);
+    }
+    else if (j->second.topSession == clientSession) {
+        j->second.updateTopSession();
+    }
+}
+
+void ServerStanzaRouter::handlePriorityChanged(ServerSession* clientSession) {
+    auto i = bareJIDSessions_.find(clientSession->getJID().toBare());
+    if (i != bareJIDSessions_.end()) {
+        i->second.updateTopSession();
+    }
 }
 
 }
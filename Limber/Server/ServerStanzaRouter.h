@@ -1,13 +1,14 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <Swiften/Elements/Stanza.h>
 #include <Swiften/JID/JID.h>
@@ -15,6 +16,13 @@
 namespace Swift {
     class ServerSession;
 
+    /**
+     * Routes stanzas to the client sessions of the server.
+     *
+     * Sessions are indexed by full and by bare JID, and the session with the
+     * highest priority of every bare JID is kept up to date, so routing does
+     * not depend on the number of connected sessions.
+     */
     class ServerStanzaRouter {
         public:
             ServerStanzaRouter();
@@ -24,7 +32,26 @@ namespace Swift {
             void addClientSession(ServerSession*);
             void removeClientSession(ServerSession*);
 
+            /**
+             * Needs to be called whenever the priority of an added session
+             * changes.
+             */
+            void handlePriorityChanged(ServerSession*);
+
         private:
-            std::vector<ServerSession*> clientSessions_;
+            struct BareJIDSessions {
+                BareJIDSessions() : topSession(nullptr) {}
+
+                void updateTopSession();
+
+                /// All sessions of the bare JID, in the order they were added
+                std::vector<ServerSession*> sessions;
+
+                /// The session with the highest non-negative priority, if any
+                ServerSession* topSession;
+            };
+
+            std::unordered_map<JID, ServerSession*> fullJIDSessions_;
+            std::unordered_map<JID, BareJIDSessions> bareJIDSessions_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -23,6 +23,9 @@ class ServerStanzaRouterTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testRouteStanza_BareJIDWithMultipleSessions);
         CPPUNIT_TEST(testRouteStanza_BareJIDWithOnlyNegativePriorities);
         CPPUNIT_TEST(testRouteStanza_BareJIDWithChangingPresence);
+        CPPUNIT_TEST(testRouteStanza_BareJIDWithSessionsOfOtherUsers);
+        CPPUNIT_TEST(testRemoveClientSession_TopSession);
+        CPPUNIT_TEST(testRemoveClientSession_LastSession);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -116,7 +119,9 @@ class ServerStanzaRouterTest : public CppUnit::TestFixture {
             testling.addClientSession(&session2);
 
             session1.priority = 3;
+            testling.handlePriorityChanged(&session1);
             session2.priority = 4;
+            testling.handlePriorityChanged(&session2);
             bool result = testling.routeStanza(createMessageTo("foo@bar.com"));
 
             CPPUNIT_ASSERT(result);
@@ -124,6 +129,50 @@ class ServerStanzaRouterTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session2.sentStanzas.size()));
         }
 
+        void testRouteStanza_BareJIDWithSessionsOfOtherUsers() {
+            ServerStanzaRouter testling;
+            MockServerSession session1(JID("foo@bar.com/Bla"), 1);
+            testling.addClientSession(&session1);
+            MockServerSession session2(JID("baz@bar.com/Bla"), 8);
+            testling.addClientSession(&session2);
+
+            bool result = testling.routeStanza(createMessageTo("foo@bar.com"));
+
+            CPPUNIT_ASSERT(result);
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session1.sentStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session2.sentStanzas.size()));
+        }
+
+        void testRemoveClientSession_TopSession() {
+            ServerStanzaRouter testling;
+            MockServerSession session1(JID("foo@bar.com/Bla"), 1);
+            testling.addClientSession(&session1);
+            MockServerSession session2(JID("foo@bar.com/Baz"), 8);
+            testling.addClientSession(&session2);
+            MockServerSession session3(JID("foo@bar.com/Bar"), 5);
+            testling.addClientSession(&session3);
+
+            testling.removeClientSession(&session2);
+            bool result = testling.routeStanza(createMessageTo("foo@bar.com"));
+
+            CPPUNIT_ASSERT(result);
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session1.sentStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session2.sentStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session3.sentStanzas.size()));
+        }
+
+        void testRemoveClientSession_LastSession() {
+            ServerStanzaRouter testling;
+            MockServerSession session(JID("foo@bar.com/Bla"), 0);
+            testling.addClientSession(&session);
+
+            testling.removeClientSession(&session);
+
+            CPPUNIT_ASSERT(!testling.routeStanza(createMessageTo("foo@bar.com/Bla")));
+            CPPUNIT_ASSERT(!testling.routeStanza(createMessageTo("foo@bar.com")));
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session.sentStanzas.size()));
+        }
+
     private:
         std::shared_ptr<Message> createMessageTo(const std::string& recipient) {
             std::shared_ptr<Message> message(new Message());
@@ -1,104 +1,107 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <SwifTools/Linkify.h>
 
-#include <iostream>
+#include <cstring>
 #include <sstream>
 
-#include <boost/regex.hpp>
-
 namespace Swift {
 
-static boost::regex linkifyRegexp("^(https?://|xmpp:).*");
-
-std::string Linkify::linkify(const std::string& input) {
-    std::ostringstream result;
-    std::vector<char> currentURL;
-    bool inURL = false;
-    for (size_t i = 0; i < input.size(); ++i) {
-        char c = input[i];
-        if (inURL) {
-            if (c != ' ' && c != '\t' && c != '\n' && !(c == '*' && i == input.size() - 1 && input[0] == '*')) {
-                currentURL.push_back(c);
-            }
-            else {
-                std::string url(&currentURL[0], currentURL.size());
-                result << "<a href=\"" << url << "\">" <<  url << "</a>";
-                currentURL.clear();
-                inURL = false;
-                result << c;
-            }
+/**
+ * Returns the position of the first URI prefix ("http://", "https://" or
+ * "xmpp:") at or after the given position, or std::string::npos.
+ *
+ * All prefixes have a colon at index 4 or 5, and colons are rare, so this
+ * looks for colons (using memchr) and then checks the characters around them.
+ */
+static size_t findLinkStart(const std::string& text, size_t start) {
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t position = start + 4;
+    while (position < size) {
+        const char* colon = static_cast<const char*>(std::memchr(data + position, ':', size - position));
+        if (!colon) {
+            return std::string::npos;
+        }
+        size_t colonPosition = static_cast<size_t>(colon - data);
+        size_t remaining = size - colonPosition;
+        if (colonPosition >= start + 5 && remaining >= 3 && std::memcmp(data + colonPosition - 5, "https://", 8) == 0) {
+            return colonPosition - 5;
         }
-        else {
-            if (boost::regex_match(input.substr(i, 8), linkifyRegexp)) {
-                currentURL.push_back(c);
-                inURL = true;
-            }
-            else {
-                result << c;
-            }
+        if (std::memcmp(data + colonPosition - 4, "xmpp:", 5) == 0) {
+            return colonPosition - 4;
         }
+        if (remaining >= 3 && std::memcmp(data + colonPosition - 4, "http://", 7) == 0) {
+            return colonPosition - 4;
+        }
+        position = colonPosition + 1;
     }
-    if (!currentURL.empty()) {
-        std::string url(&currentURL[0], currentURL.size());
+    return std::string::npos;
+}
+
+/**
+ * Returns the end of the URI starting at the given position. URIs end at
+ * whitespace, or at a '*' at the end of the text if the text starts with
+ * one (e.g. "*http://swift.im*").
+ */
+static size_t findLinkEnd(const std::string& text, size_t linkStart, bool trailingStarEndsLink) {
+    size_t end = text.find_first_of(" \t\n", linkStart);
+    if (end == std::string::npos) {
+        end = text.size();
+        if (trailingStarEndsLink && text[end - 1] == '*') {
+            --end;
+        }
+    }
+    return end;
+}
+
+boost::optional<std::pair<size_t, size_t> > Linkify::findLink(const std::string& text, size_t start) {
+    size_t linkStart = findLinkStart(text, start);
+    if (linkStart == std::string::npos) {
+        return boost::optional<std::pair<size_t, size_t> >();
+    }
+    size_t linkEnd = findLinkEnd(text, linkStart, text[start] == '*');
+    return std::make_pair(linkStart, linkEnd - linkStart);
+}
+
+std::string Linkify::linkify(const std::string& input) {
+    std::ostringstream result;
+    bool trailingStarEndsLink = !input.empty() && input[0] == '*';
+    size_t position = 0;
+    size_t linkStart;
+    while ((linkStart = findLinkStart(input, position)) != std::string::npos) {
+        size_t linkEnd = findLinkEnd(input, linkStart, trailingStarEndsLink);
+        result.write(input.data() + position, static_cast<std::streamsize>(linkStart - position));
+        std::string url(input, linkStart, linkEnd - linkStart);
         result << "<a href=\"" << url << "\">" <<  url << "</a>";
+        position = linkEnd;
     }
-    return std::string(result.str());
+    result.write(input.data() + position, static_cast<std::streamsize>(input.size() - position));
+    return result.str();
 }
 
 std::pair<std::vector<std::string>, size_t> Linkify::splitLink(const std::string& input) {
-    std::vector<std::string> result;
-    std::pair<std::vector<std::string>, size_t> pair;
-    std::vector<char> currentURL;
-    bool inURL = false;
-    size_t urlStartsAt = 0;
-    for (size_t i = 0; i < input.size(); ++i) {
-        char c = input[i];
-        if (inURL) {
-            if (c != ' ' && c != '\t' && c != '\n' && !(c == '*' && i == input.size() - 1 && input[0] == '*')) {
-                // Keep parsing
-            }
-            else {
-                std::string url(input.substr(urlStartsAt, i - urlStartsAt));
-                result.push_back(url);
-                inURL = false;
-                size_t remaining = input.size() - i;
-                if (remaining > 0) {
-                    result.push_back(input.substr(i, remaining));
-                }
-                pair.first = result;
-                pair.second = urlStartsAt == 0 ? 0 : 1;
-                return pair;
-            }
-        }
-        else {
-            if (boost::regex_match(input.substr(i, 8), linkifyRegexp)) {
-                urlStartsAt = i;
-                inURL = true;
-                if (i > 0) {
-                    result.push_back(input.substr(0, i));
-                }
-            }
-            else {
-                // Just keep swimming
-            }
-        }
+    std::pair<std::vector<std::string>, size_t> result;
+    boost::optional<std::pair<size_t, size_t> > link = findLink(input);
+    if (!link) {
+        result.first.push_back(input);
+        result.second = 1;
+        return result;
     }
-    if (urlStartsAt > 0 || inURL) {
-        std::string url(input.substr(urlStartsAt, input.size() - urlStartsAt));
-        result.push_back(url);
-        pair.first = result;
-        pair.second = urlStartsAt == 0 ? 0 : 1;
+    size_t linkEnd = link->first + link->second;
+    if (link->first > 0) {
+        result.first.push_back(input.substr(0, link->first));
     }
-    else {
-        pair.first.push_back(input);
-        pair.second = 1;
+    result.first.push_back(input.substr(link->first, link->second));
+    if (linkEnd < input.size()) {
+        result.first.push_back(input.substr(linkEnd));
     }
-    return pair;
+    result.second = link->first == 0 ? 0 : 1;
+    return result;
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,11 +7,25 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <boost/optional.hpp>
+
 namespace Swift {
     namespace Linkify {
         std::string linkify(const std::string&);
+
+        /**
+         * Finds the first URI in the part of the string starting at the given
+         * position, without copying the string. Returns the position and
+         * length of the URI in the string, if there is one.
+         *
+         * The URI is split the same way as by splitLink() on the part of the
+         * string starting at the given position.
+         */
+        boost::optional<std::pair<size_t, size_t> > findLink(const std::string& text, size_t start = 0);
+
         /**
          * Parse the string for a URI. The string will be split by the URI, and the segments plus index of the URI returned.
          * If no URI is found the index will be result.size() (i.e. an invalid index)
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <SwifTools/MultiStringMatcher.h>
+
+#include <algorithm>
+#include <deque>
+
+namespace Swift {
+
+static unsigned char foldCase(char c) {
+    unsigned char result = static_cast<unsigned char>(c);
+    if (result >= 'A' && result <= 'Z') {
+        result = static_cast<unsigned char>(result - 'A' + 'a');
+    }
+    return result;
+}
+
+MultiStringMatcher::MultiStringMatcher() : compiled_(false) {
+    nodes_.push_back(Node());
+}
+
+size_t MultiStringMatcher::addPattern(const std::string& pattern, bool caseSensitive) {
+    size_t index = patterns_.size();
+    patterns_.push_back(Pattern(pattern, caseSensitive));
+    if (pattern.empty()) {
+        return index;
+    }
+
+    int node = 0;
+    for (char c : pattern) {
+        unsigned char folded = foldCase(c);
+        int next = findTransition(node, folded);
+        if (next < 0) {
+            next = static_cast<int>(nodes_.size());
+            nodes_.push_back(Node());
+            std::vector<std::pair<unsigned char, int> >& transitions = nodes_[node].transitions;
+            std::pair<unsigned char, int> transition(folded, next);
+            transitions.insert(std::upper_bound(transitions.begin(), transitions.end(), transition), transition);
+        }
+        node = next;
+    }
+    nodes_[node].patterns.push_back(index);
+    compiled_ = false;
+    return index;
+}
+
+void MultiStringMatcher::clear() {
+    nodes_.clear();
+    nodes_.push_back(Node());
+    patterns_.clear();
+    compiled_ = false;
+}
+
+int MultiStringMatcher::findTransition(int node, unsigned char c) const {
+    const std::vector<std::pair<unsigned char, int> >& transitions = nodes_[node].transitions;
+    auto i = std::lower_bound(transitions.begin(), transitions.end(), c, [](const std::pair<unsigned char, int>& transition, unsigned char c) {
+        return transition.first < c;
+    });
+    return (i != transitions.end() && i->first == c) ? i->second : -1;
+}
+
+/**
+ * Computes the failure links breadth first, so that the links of all
+ * shorter prefixes are known when a node is handled.
+ */
+void MultiStringMatcher::compile() {
+    std::deque<int> queue;
+    for (const auto& transition : nodes_[0].transitions) {
+        nodes_[transition.second].failure = 0;
+        queue.push_back(transition.second);
+    }
+    while (!queue.empty()) {
+        int node = queue.front();
+        queue.pop_front();
+        Node& current = nodes_[node];
+        current.output = !current.patterns.empty() ? node : nodes_[current.failure].output;
+        for (const auto& transition : current.transitions) {
+            int failure = current.failure;
+            int next = findTransition(failure, transition.first);
+            while (next < 0 && failure != 0) {
+                failure = nodes_[failure].failure;
+                next = findTransition(failure, transition.first);
+            }
+            nodes_[transition.second].failure = next < 0 ? 0 : next;
+            queue.push_back(transition.second);
+        }
+    }
+    compiled_ = true;
+}
+
+std::vector<MultiStringMatcher::Match> MultiStringMatcher::findAll(const std::string& text) {
+    if (!compiled_) {
+        compile();
+    }
+
+    std::vector<Match> result;
+    int state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = foldCase(text[i]);
+        int next = findTransition(state, c);
+        while (next < 0 && state != 0) {
+            state = nodes_[state].failure;
+            next = findTransition(state, c);
+        }
+        state = next < 0 ? 0 : next;
+
+        for (int output = nodes_[state].output; output >= 0; output = nodes_[nodes_[output].failure].output) {
+            for (size_t pattern : nodes_[output].patterns) {
+                const Pattern& candidate = patterns_[pattern];
+                size_t position = i + 1 - candidate.text.size();
+                if (!candidate.caseSensitive || text.compare(position, candidate.text.size(), candidate.text) == 0) {
+                    result.push_back(Match(pattern, position, candidate.text.size()));
+                }
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const Match& left, const Match& right) {
+        if (left.position != right.position) {
+            return left.position < right.position;
+        }
+        if (left.length != right.length) {
+            return left.length > right.length;
+        }
+        return left.pattern < right.pattern;
+    });
+    return result;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Swift {
+    /**
+     * Finds all occurrences of a set of strings in a text in a single pass
+     * over the text (using the Aho-Corasick algorithm).
+     *
+     * Patterns can be matched case insensitively; this only folds ASCII
+     * letters.
+     */
+    class MultiStringMatcher {
+        public:
+            struct Match {
+                Match(size_t pattern, size_t position, size_t length) : pattern(pattern), position(position), length(length) {}
+
+                /** The index of the pattern, in the order they were added. */
+                size_t pattern;
+                size_t position;
+                size_t length;
+            };
+
+        public:
+            MultiStringMatcher();
+
+            /**
+             * Adds a pattern, and returns its index. Empty patterns never
+             * match.
+             */
+            size_t addPattern(const std::string& pattern, bool caseSensitive = true);
+            void clear();
+
+            size_t getPatternCount() const {
+                return patterns_.size();
+            }
+
+            /**
+             * Returns all (possibly overlapping) occurrences of the patterns,
+             * ordered by position, and longest first for the same position.
+             */
+            std::vector<Match> findAll(const std::string& text);
+
+        private:
+            struct Node {
+                Node() : failure(0), output(-1) {}
+
+                /** Sorted by character */
+                std::vector<std::pair<unsigned char, int> > transitions;
+                int failure;
+                /** The closest node (this one or one reached through failure links) that ends patterns, or -1 */
+                int output;
+                std::vector<size_t> patterns;
+            };
+
+            struct Pattern {
+                Pattern(const std::string& text, bool caseSensitive) : text(text), caseSensitive(caseSensitive) {}
+
+                std::string text;
+                bool caseSensitive;
+            };
+
+            int findTransition(int node, unsigned char c) const;
+            void compile();
+
+        private:
+            std::vector<Node> nodes_;
+            std::vector<Pattern> patterns_;
+            bool compiled_;
+    };
+}
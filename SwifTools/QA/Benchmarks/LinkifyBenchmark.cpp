@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures the throughput of splitting long messages into text and links,
+ * the way ChatMessageParser does it, for a pasted log with a few links and
+ * for plain text without any.
+ *
+ * The regex scanner replicates what Linkify did before it had a dedicated
+ * scanner: matching a regular expression at every position.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/regex.hpp>
+
+#include <SwifTools/Linkify.h>
+
+using namespace Swift;
+
+static const size_t MESSAGE_SIZE = 8192;
+
+static std::pair<std::vector<std::string>, size_t> regexSplitLink(const std::string& input) {
+    static const boost::regex linkifyRegexp("^(https?://|xmpp:).*");
+    std::pair<std::vector<std::string>, size_t> result;
+    size_t urlStartsAt = 0;
+    bool inURL = false;
+    for (size_t i = 0; i < input.size(); ++i) {
+        char c = input[i];
+        if (inURL) {
+            if (c == ' ' || c == '\t' || c == '\n' || (c == '*' && i == input.size() - 1 && input[0] == '*')) {
+                result.first.push_back(input.substr(urlStartsAt, i - urlStartsAt));
+                result.first.push_back(input.substr(i));
+                result.second = urlStartsAt == 0 ? 0 : 1;
+                return result;
+            }
+        }
+        else if (boost::regex_match(input.substr(i, 8), linkifyRegexp)) {
+            urlStartsAt = i;
+            inURL = true;
+            if (i > 0) {
+                result.first.push_back(input.substr(0, i));
+            }
+        }
+    }
+    if (inURL) {
+        result.first.push_back(input.substr(urlStartsAt));
+        result.second = urlStartsAt == 0 ? 0 : 1;
+    }
+    else {
+        result.first.push_back(input);
+        result.second = 1;
+    }
+    return result;
+}
+
+/**
+ * Splits the whole message, calling the split function on what is left after
+ * each link. Returns the number of links.
+ */
+template<typename SplitFunction>
+static size_t splitAll(const std::string& message, SplitFunction split) {
+    size_t links = 0;
+    std::string remaining = message;
+    while (!remaining.empty()) {
+        std::pair<std::vector<std::string>, size_t> parts = split(remaining);
+        if (parts.second >= parts.first.size()) {
+            break;
+        }
+        links++;
+        remaining = parts.second + 1 < parts.first.size() ? parts.first.back() : "";
+    }
+    return links;
+}
+
+static size_t findAll(const std::string& message) {
+    size_t links = 0;
+    size_t position = 0;
+    while (boost::optional<std::pair<size_t, size_t> > link = Linkify::findLink(message, position)) {
+        links++;
+        position = link->first + link->second;
+    }
+    return links;
+}
+
+template<typename Function>
+static void measure(const std::string& name, const std::string& message, Function function) {
+    size_t links = 0;
+    int iterations = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration duration;
+    do {
+        links = function(message);
+        iterations++;
+        duration = std::chrono::steady_clock::now() - start;
+    } while (duration < std::chrono::milliseconds(500));
+    double seconds = std::chrono::duration<double>(duration).count();
+    double megabytes = static_cast<double>(message.size()) * iterations / (1024 * 1024);
+    std::cout << "  " << name << ": " << megabytes / seconds << " MB/s (" << links << " links)" << std::endl;
+}
+
+static std::string repeat(const std::string& text) {
+    std::string result;
+    while (result.size() < MESSAGE_SIZE) {
+        result += text;
+    }
+    return result;
+}
+
+int main(int, char**) {
+    std::vector<std::pair<std::string, std::string> > messages = {
+        {"Pasted log", repeat("[12:01:33] <alice> see http://swift.im/download/ for builds, or join xmpp:swift@rooms.swift.im?join\n[12:01:40] <bob> thanks: that works now, the build from yesterday crashed on startup\n")},
+        {"Plain text", repeat("Lorem ipsum dolor sit amet, consectetur adipiscing elit: sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. ")}
+    };
+    for (const auto& message : messages) {
+        std::cout << message.first << " (" << message.second.size() << " bytes)" << std::endl;
+        measure("Regex scanner", message.second, [](const std::string& text) { return splitAll(text, regexSplitLink); });
+        measure("Linkify::splitLink", message.second, [](const std::string& text) { return splitAll(text, Linkify::splitLink); });
+        measure("Linkify::findLink", message.second, findAll);
+    }
+    return 0;
+}
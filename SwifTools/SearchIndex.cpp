@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <SwifTools/SearchIndex.h>
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace Swift {
+
+static bool isWordCharacter(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || static_cast<unsigned char>(c) >= 0x80;
+}
+
+static bool isSubsequence(const std::string& query, const std::string& text) {
+    size_t position = 0;
+    for (char c : query) {
+        position = text.find(c, position);
+        if (position == std::string::npos) {
+            return false;
+        }
+        position++;
+    }
+    return true;
+}
+
+static bool hasWordStartingWith(const std::string& text, const std::string& prefix) {
+    for (size_t position = text.find(prefix, 1); position != std::string::npos; position = text.find(prefix, position + 1)) {
+        if (!isWordCharacter(text[position - 1])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SearchIndex::SearchIndex() {
+}
+
+std::string SearchIndex::foldCase(const std::string& text) {
+    std::string result(text);
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+void SearchIndex::addEntry(const std::string& key, const std::vector<std::string>& texts) {
+    removeEntry(key);
+
+    size_t id;
+    if (freeIDs_.empty()) {
+        id = entries_.size();
+        entries_.push_back(Entry());
+    }
+    else {
+        id = freeIDs_.back();
+        freeIDs_.pop_back();
+    }
+    Entry& entry = entries_[id];
+    entry.key = key;
+    std::array<bool, 256> characters = {};
+    for (const auto& text : texts) {
+        std::string folded = foldCase(text);
+        for (char c : folded) {
+            characters[static_cast<unsigned char>(c)] = true;
+        }
+        sortedTexts_.insert(std::make_pair(folded, id));
+        entry.foldedTexts.push_back(folded);
+    }
+    for (size_t c = 0; c < characters.size(); ++c) {
+        if (characters[c]) {
+            std::vector<size_t>& ids = entriesByCharacter_[c];
+            ids.insert(std::upper_bound(ids.begin(), ids.end(), id), id);
+        }
+    }
+    entryIDs_[key] = id;
+}
+
+void SearchIndex::removeEntry(const std::string& key) {
+    auto i = entryIDs_.find(key);
+    if (i != entryIDs_.end()) {
+        size_t id = i->second;
+        entryIDs_.erase(i);
+        removeEntry(id);
+    }
+}
+
+void SearchIndex::removeEntry(size_t id) {
+    Entry& entry = entries_[id];
+    std::array<bool, 256> characters = {};
+    for (const auto& text : entry.foldedTexts) {
+        for (char c : text) {
+            characters[static_cast<unsigned char>(c)] = true;
+        }
+        sortedTexts_.erase(std::make_pair(text, id));
+    }
+    for (size_t c = 0; c < characters.size(); ++c) {
+        if (characters[c]) {
+            std::vector<size_t>& ids = entriesByCharacter_[c];
+            ids.erase(std::lower_bound(ids.begin(), ids.end(), id));
+        }
+    }
+    entry = Entry();
+    freeIDs_.push_back(id);
+}
+
+void SearchIndex::clear() {
+    entries_.clear();
+    freeIDs_.clear();
+    entryIDs_.clear();
+    sortedTexts_.clear();
+    for (auto& ids : entriesByCharacter_) {
+        ids.clear();
+    }
+}
+
+std::vector<std::string> SearchIndex::findPrefix(const std::string& prefix) const {
+    std::string foldedPrefix = foldCase(prefix);
+    std::vector<std::string> result;
+    std::unordered_set<size_t> found;
+    for (auto i = sortedTexts_.lower_bound(std::make_pair(foldedPrefix, size_t(0))); i != sortedTexts_.end() && i->first.compare(0, foldedPrefix.size(), foldedPrefix) == 0; ++i) {
+        if (found.insert(i->second).second) {
+            result.push_back(entries_[i->second].key);
+        }
+    }
+    return result;
+}
+
+std::vector<SearchIndex::Match> SearchIndex::find(const std::string& query) const {
+    std::string foldedQuery = foldCase(query);
+    std::vector<Match> result;
+    if (foldedQuery.empty()) {
+        for (const auto& entry : entryIDs_) {
+            result.push_back(Match(entry.first, PrefixMatch));
+        }
+    }
+    else {
+        // Only entries containing all characters of the query can match, so
+        // only look at those containing the least common one.
+        const std::vector<size_t>* candidates = nullptr;
+        for (char c : foldedQuery) {
+            const std::vector<size_t>& ids = entriesByCharacter_[static_cast<unsigned char>(c)];
+            if (!candidates || ids.size() < candidates->size()) {
+                candidates = &ids;
+            }
+        }
+        for (size_t id : *candidates) {
+            const Entry& entry = entries_[id];
+            bool matched = false;
+            MatchType bestType = SubsequenceMatch;
+            for (const auto& text : entry.foldedTexts) {
+                if (text.compare(0, foldedQuery.size(), foldedQuery) == 0) {
+                    matched = true;
+                    bestType = PrefixMatch;
+                    break;
+                }
+                else if (hasWordStartingWith(text, foldedQuery)) {
+                    matched = true;
+                    bestType = WordPrefixMatch;
+                }
+                else if (!matched) {
+                    matched = isSubsequence(foldedQuery, text);
+                }
+            }
+            if (matched) {
+                result.push_back(Match(entry.key, bestType));
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Match& left, const Match& right) {
+        if (left.type != right.type) {
+            return left.type < right.type;
+        }
+        return left.key < right.key;
+    });
+    return result;
+}
+
+}
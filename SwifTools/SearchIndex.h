@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Swift {
+    /**
+     * Indexes a set of entries, each with one or more texts (e.g. a contact
+     * with a name and a JID), for case insensitive searches while the user
+     * types.
+     *
+     * Entries can be added and removed at any time. Prefix queries use the
+     * sorted texts. Subsequence queries only check the entries containing
+     * the least common character of the query, which can still be most of
+     * the entries for queries made of common characters; the empty query
+     * returns all entries.
+     *
+     * Case folding only folds ASCII letters.
+     */
+    class SearchIndex {
+        public:
+            enum MatchType {
+                /** A text starts with the query */
+                PrefixMatch,
+                /** A word (other than the first) of a text starts with the query */
+                WordPrefixMatch,
+                /** The characters of the query appear in order in a text */
+                SubsequenceMatch
+            };
+
+            struct Match {
+                Match(const std::string& key, MatchType type) : key(key), type(type) {}
+
+                std::string key;
+                MatchType type;
+            };
+
+        public:
+            SearchIndex();
+
+            /**
+             * Adds an entry, replacing the texts of any entry with the same
+             * key.
+             */
+            void addEntry(const std::string& key, const std::vector<std::string>& texts);
+            void removeEntry(const std::string& key);
+            void clear();
+
+            bool hasEntry(const std::string& key) const {
+                return entryIDs_.find(key) != entryIDs_.end();
+            }
+
+            size_t getEntryCount() const {
+                return entryIDs_.size();
+            }
+
+            /**
+             * Returns the keys of the entries with a text starting with the
+             * prefix, in the order of their texts.
+             */
+            std::vector<std::string> findPrefix(const std::string& prefix) const;
+
+            /**
+             * Returns the entries with a text containing the characters of
+             * the query in order, best matches first (and ordered by key
+             * for matches of the same type). An empty query matches all
+             * entries.
+             */
+            std::vector<Match> find(const std::string& query) const;
+
+            /**
+             * Returns the folded version of a string, as used for matching.
+             */
+            static std::string foldCase(const std::string& text);
+
+        private:
+            struct Entry {
+                std::string key;
+                std::vector<std::string> foldedTexts;
+            };
+
+            void removeEntry(size_t id);
+
+        private:
+            std::vector<Entry> entries_;
+            std::vector<size_t> freeIDs_;
+            std::unordered_map<std::string, size_t> entryIDs_;
+            /** The folded texts, with the ID of their entry */
+            std::set<std::pair<std::string, size_t> > sortedTexts_;
+            /** The sorted IDs of the entries containing each (folded) character */
+            std::array<std::vector<size_t>, 256> entriesByCharacter_;
+    };
+}
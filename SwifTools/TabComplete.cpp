@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,20 +8,24 @@
 
 #include <algorithm>
 
-#include <boost/algorithm/string.hpp>
-
 namespace Swift {
 
+TabComplete::TabComplete() : nextWordAge_(0) {
+}
+
 void TabComplete::addWord(const std::string& word) {
-    words_.erase(std::remove(words_.begin(), words_.end(), word), words_.end());
-    words_.insert(words_.begin(), word);
-    if (boost::starts_with(boost::to_lower_copy(word), lastShort_)) {
+    if (!words_.hasEntry(word)) {
+        words_.addEntry(word, std::vector<std::string>(1, word));
+    }
+    wordAges_[word] = nextWordAge_++;
+    if (SearchIndex::foldCase(word).compare(0, lastShort_.size(), lastShort_) == 0) {
         lastCompletionCandidates_.insert(lastCompletionCandidates_.begin(), word);
     }
 }
 
 void TabComplete::removeWord(const std::string& word) {
-    words_.erase(std::remove(words_.begin(), words_.end(), word), words_.end());
+    words_.removeEntry(word);
+    wordAges_.erase(word);
     lastCompletionCandidates_.erase(std::remove(lastCompletionCandidates_.begin(), lastCompletionCandidates_.end(), word), lastCompletionCandidates_.end());
 }
 
@@ -39,13 +43,11 @@ std::string TabComplete::completeWord(const std::string& word) {
             lastCompletion_ = lastCompletionCandidates_[nextIndex];
         }
     } else {
-        lastShort_ = boost::to_lower_copy(word);
-        lastCompletionCandidates_.clear();
-        for (auto&& candidate : words_) {
-            if (boost::starts_with(boost::to_lower_copy(candidate), boost::to_lower_copy(word))) {
-                lastCompletionCandidates_.push_back(candidate);
-            }
-        }
+        lastShort_ = SearchIndex::foldCase(word);
+        lastCompletionCandidates_ = words_.findPrefix(word);
+        std::sort(lastCompletionCandidates_.begin(), lastCompletionCandidates_.end(), [this](const std::string& left, const std::string& right) {
+            return wordAges_.at(left) > wordAges_.at(right);
+        });
         lastCompletion_ = !lastCompletionCandidates_.empty() ? lastCompletionCandidates_[0] : word;
     }
     return lastCompletion_;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,16 +7,24 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <SwifTools/SearchIndex.h>
+
 namespace Swift {
     class TabComplete {
         public:
+            TabComplete();
+
             void addWord(const std::string& word);
             void removeWord(const std::string& word);
             std::string completeWord(const std::string& word);
         private:
-            std::vector<std::string> words_;
+            SearchIndex words_;
+            /** When each word was last added, as completions start with the most recent word */
+            std::unordered_map<std::string, size_t> wordAges_;
+            size_t nextWordAge_;
             std::string lastCompletion_;
             std::string lastShort_;
             std::vector<std::string> lastCompletionCandidates_;
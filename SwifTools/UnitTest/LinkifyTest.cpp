@@ -1,9 +1,14 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
+#include <algorithm>
+#include <random>
+
+#include <boost/regex.hpp>
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
@@ -38,6 +43,14 @@ class LinkifyTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testLinkify_SplitFirst);
         CPPUNIT_TEST(testLinkify_SplitSecond);
         CPPUNIT_TEST(testLinkify_SplitMiddle);
+        CPPUNIT_TEST(testLinkify_SplitXMPPURI);
+        CPPUNIT_TEST(testLinkify_SplitStarredURL);
+        CPPUNIT_TEST(testLinkify_SplitIncompletePrefix);
+
+        CPPUNIT_TEST(testLinkify_FindLink);
+        CPPUNIT_TEST(testLinkify_FindLinkFromPosition);
+        CPPUNIT_TEST(testLinkify_FindLinkNone);
+        CPPUNIT_TEST(testLinkify_SameAsRegexScanner);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -194,9 +207,11 @@ class LinkifyTest : public CppUnit::TestFixture {
                     result);
         }
 
-        void checkResult(const std::string& testling, size_t expectedIndex, std::string expectedSplit[]) {
+        template<size_t N>
+        void checkResult(const std::string& testling, size_t expectedIndex, std::string (&expectedSplit)[N]) {
             std::pair<std::vector<std::string>, size_t> result = Linkify::splitLink(testling);
             CPPUNIT_ASSERT_EQUAL(expectedIndex, result.second);
+            CPPUNIT_ASSERT_EQUAL(N, result.first.size());
             for (size_t i = 0; i < result.first.size(); i++) {
                 CPPUNIT_ASSERT_EQUAL(expectedSplit[i], result.first[i]);
             }
@@ -237,6 +252,111 @@ class LinkifyTest : public CppUnit::TestFixture {
             checkResult(testling, expectedIndex, expectedSplit);
         }
 
+        void testLinkify_SplitXMPPURI() {
+            std::string testling = "Join xmpp:swift@rooms.swift.im?join now";
+            size_t expectedIndex = 1;
+            std::string expectedSplit[] = {"Join ", "xmpp:swift@rooms.swift.im?join", " now"};
+            checkResult(testling, expectedIndex, expectedSplit);
+        }
+
+        void testLinkify_SplitStarredURL() {
+            std::string testling = "*https://swift.im*";
+            size_t expectedIndex = 1;
+            std::string expectedSplit[] = {"*", "https://swift.im", "*"};
+            checkResult(testling, expectedIndex, expectedSplit);
+        }
+
+        void testLinkify_SplitIncompletePrefix() {
+            std::string testling = "ends with http:/";
+            size_t expectedIndex = 1;
+            std::string expectedSplit[] = {"ends with http:/"};
+            checkResult(testling, expectedIndex, expectedSplit);
+        }
+
+        void testLinkify_FindLink() {
+            boost::optional<std::pair<size_t, size_t> > result = Linkify::findLink("a:b https://swift.im\tc");
+
+            CPPUNIT_ASSERT(result);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), result->first);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(16), result->second);
+        }
+
+        void testLinkify_FindLinkFromPosition() {
+            std::string text = "http://swift.im and xmpp:swift.im";
+
+            boost::optional<std::pair<size_t, size_t> > result = Linkify::findLink(text, 1);
+
+            CPPUNIT_ASSERT(result);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(20), result->first);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(13), result->second);
+        }
+
+        void testLinkify_FindLinkNone() {
+            CPPUNIT_ASSERT(!Linkify::findLink(""));
+            CPPUNIT_ASSERT(!Linkify::findLink("no links: here, or ftp://swift.im"));
+        }
+
+        /**
+         * Compares with the scanner that matched a regular expression at each
+         * position, on random strings made of the characters that matter.
+         */
+        void testLinkify_SameAsRegexScanner() {
+            const std::string alphabet = "htpsxm:/ *\n\ta";
+            std::mt19937 random(0);
+            std::uniform_int_distribution<size_t> character(0, alphabet.size() - 1);
+            std::uniform_int_distribution<size_t> length(0, 40);
+            for (int i = 0; i < 20000; ++i) {
+                std::string text;
+                for (size_t j = length(random); j > 0; --j) {
+                    text += alphabet[character(random)];
+                }
+                if (i % 2 == 0) {
+                    text = "http://" + text;
+                    std::shuffle(text.begin(), text.end(), random);
+                }
+
+                std::pair<std::vector<std::string>, size_t> expected = regexSplitLink(text);
+                std::pair<std::vector<std::string>, size_t> result = Linkify::splitLink(text);
+                CPPUNIT_ASSERT_EQUAL_MESSAGE(text, expected.second, result.second);
+                CPPUNIT_ASSERT_MESSAGE(text, expected.first == result.first);
+            }
+        }
+
+    private:
+        static std::pair<std::vector<std::string>, size_t> regexSplitLink(const std::string& input) {
+            static const boost::regex linkifyRegexp("^(https?://|xmpp:).*");
+            std::pair<std::vector<std::string>, size_t> result;
+            size_t urlStartsAt = 0;
+            bool inURL = false;
+            for (size_t i = 0; i < input.size(); ++i) {
+                char c = input[i];
+                if (inURL) {
+                    if (c == ' ' || c == '\t' || c == '\n' || (c == '*' && i == input.size() - 1 && input[0] == '*')) {
+                        result.first.push_back(input.substr(urlStartsAt, i - urlStartsAt));
+                        result.first.push_back(input.substr(i));
+                        result.second = urlStartsAt == 0 ? 0 : 1;
+                        return result;
+                    }
+                }
+                else if (boost::regex_match(input.substr(i, 8), linkifyRegexp)) {
+                    urlStartsAt = i;
+                    inURL = true;
+                    if (i > 0) {
+                        result.first.push_back(input.substr(0, i));
+                    }
+                }
+            }
+            if (inURL) {
+                result.first.push_back(input.substr(urlStartsAt));
+                result.second = urlStartsAt == 0 ? 0 : 1;
+            }
+            else {
+                result.first.push_back(input);
+                result.second = 1;
+            }
+            return result;
+        }
+
 
 };
 
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <SwifTools/MultiStringMatcher.h>
+
+using namespace Swift;
+
+class MultiStringMatcherTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(MultiStringMatcherTest);
+    CPPUNIT_TEST(testNoPatterns);
+    CPPUNIT_TEST(testSinglePattern);
+    CPPUNIT_TEST(testOverlappingPatterns);
+    CPPUNIT_TEST(testSuffixPatterns);
+    CPPUNIT_TEST(testCaseInsensitive);
+    CPPUNIT_TEST(testEmptyPattern);
+    CPPUNIT_TEST(testClear);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testNoPatterns() {
+        MultiStringMatcher testling;
+        CPPUNIT_ASSERT(testling.findAll("some text").empty());
+    }
+
+    void testSinglePattern() {
+        MultiStringMatcher testling;
+        testling.addPattern("ab");
+
+        std::vector<MultiStringMatcher::Match> matches = testling.findAll("xabyab");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), matches.size());
+        assertMatch(matches[0], 0, 1, 2);
+        assertMatch(matches[1], 0, 4, 2);
+    }
+
+    void testOverlappingPatterns() {
+        MultiStringMatcher testling;
+        testling.addPattern("she");
+        testling.addPattern("he");
+        testling.addPattern("hers");
+        testling.addPattern("his");
+
+        std::vector<MultiStringMatcher::Match> matches = testling.findAll("ushers");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), matches.size());
+        assertMatch(matches[0], 0, 1, 3);
+        assertMatch(matches[1], 2, 2, 4);
+        assertMatch(matches[2], 1, 2, 2);
+    }
+
+    void testSuffixPatterns() {
+        MultiStringMatcher testling;
+        testling.addPattern(":)");
+        testling.addPattern(")");
+        testling.addPattern(":-)");
+
+        std::vector<MultiStringMatcher::Match> matches = testling.findAll(":-):)");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), matches.size());
+        assertMatch(matches[0], 2, 0, 3);
+        assertMatch(matches[1], 1, 2, 1);
+        assertMatch(matches[2], 0, 3, 2);
+        assertMatch(matches[3], 1, 4, 1);
+    }
+
+    void testCaseInsensitive() {
+        MultiStringMatcher testling;
+        testling.addPattern("Alice", false);
+        testling.addPattern(":P");
+
+        std::vector<MultiStringMatcher::Match> matches = testling.findAll("aLiCe :p ALICE :P");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), matches.size());
+        assertMatch(matches[0], 0, 0, 5);
+        assertMatch(matches[1], 0, 9, 5);
+        assertMatch(matches[2], 1, 15, 2);
+    }
+
+    void testEmptyPattern() {
+        MultiStringMatcher testling;
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.addPattern(""));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.addPattern("a"));
+
+        std::vector<MultiStringMatcher::Match> matches = testling.findAll("ba");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), matches.size());
+        assertMatch(matches[0], 1, 1, 1);
+    }
+
+    void testClear() {
+        MultiStringMatcher testling;
+        testling.addPattern("a");
+        testling.findAll("a");
+        testling.clear();
+        testling.addPattern("b");
+
+        std::vector<MultiStringMatcher::Match> matches = testling.findAll("ab");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), matches.size());
+        assertMatch(matches[0], 0, 1, 1);
+    }
+
+private:
+    void assertMatch(const MultiStringMatcher::Match& match, size_t pattern, size_t position, size_t length) {
+        CPPUNIT_ASSERT_EQUAL(pattern, match.pattern);
+        CPPUNIT_ASSERT_EQUAL(position, match.position);
+        CPPUNIT_ASSERT_EQUAL(length, match.length);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MultiStringMatcherTest);
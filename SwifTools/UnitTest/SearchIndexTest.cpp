@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <SwifTools/SearchIndex.h>
+
+using namespace Swift;
+
+class SearchIndexTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(SearchIndexTest);
+    CPPUNIT_TEST(testFindPrefix);
+    CPPUNIT_TEST(testFindPrefix_CaseInsensitive);
+    CPPUNIT_TEST(testFindPrefix_MultipleTexts);
+    CPPUNIT_TEST(testFind_Subsequence);
+    CPPUNIT_TEST(testFind_RanksMatches);
+    CPPUNIT_TEST(testFind_EmptyQuery);
+    CPPUNIT_TEST(testFind_NoMatch);
+    CPPUNIT_TEST(testAddEntry_ReplacesTexts);
+    CPPUNIT_TEST(testRemoveEntry);
+    CPPUNIT_TEST(testRemoveEntry_ReusesID);
+    CPPUNIT_TEST(testClear);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testFindPrefix() {
+        SearchIndex testling;
+        addEntry(testling, "kev", "Kevin");
+        addEntry(testling, "remko", "Remko");
+        addEntry(testling, "kevlar", "Kevlar");
+
+        std::vector<std::string> keys = testling.findPrefix("Kev");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), keys.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("kev"), keys[0]);
+        CPPUNIT_ASSERT_EQUAL(std::string("kevlar"), keys[1]);
+    }
+
+    void testFindPrefix_CaseInsensitive() {
+        SearchIndex testling;
+        addEntry(testling, "a", "ALICE");
+
+        std::vector<std::string> keys = testling.findPrefix("aLi");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), keys.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("a"), keys[0]);
+    }
+
+    void testFindPrefix_MultipleTexts() {
+        SearchIndex testling;
+        testling.addEntry("alice@wonderland.lit", {"Alice", "alice@wonderland.lit"});
+
+        std::vector<std::string> keys = testling.findPrefix("ali");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), keys.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("alice@wonderland.lit"), keys[0]);
+    }
+
+    void testFind_Subsequence() {
+        SearchIndex testling;
+        testling.addEntry("alice@wonderland.lit", {"Alice", "alice@wonderland.lit"});
+        addEntry(testling, "bob", "Bob");
+
+        std::vector<SearchIndex::Match> matches = testling.find("awl");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), matches.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("alice@wonderland.lit"), matches[0].key);
+        CPPUNIT_ASSERT_EQUAL(SearchIndex::SubsequenceMatch, matches[0].type);
+    }
+
+    void testFind_RanksMatches() {
+        SearchIndex testling;
+        addEntry(testling, "1", "Sam Kerr");
+        addEntry(testling, "2", "Kim");
+        addEntry(testling, "3", "Skip");
+        addEntry(testling, "4", "Kate");
+
+        std::vector<SearchIndex::Match> matches = testling.find("k");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), matches.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("2"), matches[0].key);
+        CPPUNIT_ASSERT_EQUAL(SearchIndex::PrefixMatch, matches[0].type);
+        CPPUNIT_ASSERT_EQUAL(std::string("4"), matches[1].key);
+        CPPUNIT_ASSERT_EQUAL(SearchIndex::PrefixMatch, matches[1].type);
+        CPPUNIT_ASSERT_EQUAL(std::string("1"), matches[2].key);
+        CPPUNIT_ASSERT_EQUAL(SearchIndex::WordPrefixMatch, matches[2].type);
+        CPPUNIT_ASSERT_EQUAL(std::string("3"), matches[3].key);
+        CPPUNIT_ASSERT_EQUAL(SearchIndex::SubsequenceMatch, matches[3].type);
+    }
+
+    void testFind_EmptyQuery() {
+        SearchIndex testling;
+        addEntry(testling, "b", "Bob");
+        addEntry(testling, "a", "Alice");
+
+        std::vector<SearchIndex::Match> matches = testling.find("");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), matches.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("a"), matches[0].key);
+        CPPUNIT_ASSERT_EQUAL(std::string("b"), matches[1].key);
+    }
+
+    void testFind_NoMatch() {
+        SearchIndex testling;
+        addEntry(testling, "a", "Alice");
+
+        CPPUNIT_ASSERT(testling.find("ea").empty());
+        CPPUNIT_ASSERT(testling.find("z").empty());
+        CPPUNIT_ASSERT(testling.findPrefix("lice").empty());
+    }
+
+    void testAddEntry_ReplacesTexts() {
+        SearchIndex testling;
+        addEntry(testling, "a", "Alice");
+        addEntry(testling, "a", "Carol");
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getEntryCount());
+        CPPUNIT_ASSERT(testling.find("ali").empty());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.find("car").size());
+    }
+
+    void testRemoveEntry() {
+        SearchIndex testling;
+        addEntry(testling, "a", "Alice");
+        addEntry(testling, "b", "Bob");
+
+        testling.removeEntry("a");
+        testling.removeEntry("c");
+
+        CPPUNIT_ASSERT(!testling.hasEntry("a"));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getEntryCount());
+        CPPUNIT_ASSERT(testling.find("a").empty());
+        CPPUNIT_ASSERT(testling.findPrefix("a").empty());
+    }
+
+    void testRemoveEntry_ReusesID() {
+        SearchIndex testling;
+        addEntry(testling, "a", "Alice");
+        addEntry(testling, "b", "Bob");
+        testling.removeEntry("a");
+
+        addEntry(testling, "c", "Carol");
+
+        std::vector<SearchIndex::Match> matches = testling.find("o");
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), matches.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("b"), matches[0].key);
+        CPPUNIT_ASSERT_EQUAL(std::string("c"), matches[1].key);
+        CPPUNIT_ASSERT(testling.find("i").empty());
+    }
+
+    void testClear() {
+        SearchIndex testling;
+        addEntry(testling, "a", "Alice");
+
+        testling.clear();
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getEntryCount());
+        CPPUNIT_ASSERT(testling.find("").empty());
+        CPPUNIT_ASSERT(testling.findPrefix("").empty());
+    }
+
+private:
+    void addEntry(SearchIndex& index, const std::string& key, const std::string& text) {
+        index.addEntry(key, std::vector<std::string>(1, text));
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SearchIndexTest);
@@ -7,14 +7,15 @@
 #include <Swift/Controllers/Chat/ChatMessageParser.h>
 
 #include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
-#include <boost/regex.hpp>
 
-#include <Swiften/Base/Regex.h>
 #include <Swiften/Base/String.h>
 
 #include <SwifTools/Linkify.h>
@@ -36,35 +37,25 @@ namespace Swift {
         }
 
         /* Parse one, URLs */
-        while (!remaining.empty()) {
-            bool found = false;
-            std::pair<std::vector<std::string>, size_t> links = Linkify::splitLink(remaining);
-            remaining = "";
-            for (size_t i = 0; i < links.first.size(); i++) {
-                const std::string& part = links.first[i];
-                if (found) {
-                    // Must be on the last part, then
-                    remaining = part;
-                }
-                else {
-                    if (i == links.second) {
-                        found = true;
-                        parsedMessage.append(std::make_shared<ChatWindow::ChatURIMessagePart>(part));
-                    }
-                    else {
-                        parsedMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(part));
-                    }
-                }
+        size_t position = 0;
+        while (position < remaining.size()) {
+            boost::optional<std::pair<size_t, size_t> > link = Linkify::findLink(remaining, position);
+            size_t textEnd = link ? link->first : remaining.size();
+            if (textEnd != position) {
+                parsedMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(remaining.substr(position, textEnd - position)));
+            }
+            if (!link) {
+                break;
             }
+            parsedMessage.append(std::make_shared<ChatWindow::ChatURIMessagePart>(remaining.substr(link->first, link->second)));
+            position = link->first + link->second;
         }
 
-        /* do emoticon substitution */
-        parsedMessage = emoticonHighlight(parsedMessage);
-
-        if (!senderIsSelf) { /* do not highlight our own messsages */
-            // Highlight keywords and own mentions.
-            parsedMessage = splitHighlight(parsedMessage);
+        /* do emoticon substitution, and highlight keywords and own mentions,
+         * but do not highlight our own messsages */
+        parsedMessage = emoticonAndKeywordHighlight(parsedMessage, !senderIsSelf);
 
+        if (!senderIsSelf) {
             // Highlight full message events like, specific sender, general
             // incoming group message, or general incoming direct message.
             parsedMessage = fullMessageHighlight(parsedMessage, senderNickname);
@@ -73,160 +64,172 @@ namespace Swift {
         return parsedMessage;
     }
 
-    ChatWindow::ChatMessage ChatMessageParser::emoticonHighlight(const ChatWindow::ChatMessage& message) {
-        ChatWindow::ChatMessage parsedMessage = message;
+    /**
+     * Rebuilds the matcher if the own nickname or the keywords changed since
+     * it was built. The emoticons can't change.
+     */
+    void ChatMessageParser::updateMatcher() {
+        std::string nick = highlightConfiguration_->ownMentionAction.isEmpty() ? "" : nick_;
+        std::vector<MatcherKeyword> keywords;
+        const std::vector<HighlightConfiguration::KeywordHightlight>& keywordHighlights = highlightConfiguration_->keywordHighlights;
+        for (size_t i = 0; i < keywordHighlights.size(); ++i) {
+            if (!keywordHighlights[i].keyword.empty() && !keywordHighlights[i].action.isEmpty()) {
+                keywords.push_back(MatcherKeyword(keywordHighlights[i].keyword, keywordHighlights[i].matchCaseSensitive, i));
+            }
+        }
+        if (matcherCompiled_ && nick == matcherNick_ && keywords == matcherKeywords_) {
+            return;
+        }
 
-        std::string regexString;
-        /* Parse two, emoticons */
-        for (StringPair emoticon : emoticons_) {
-            /* Construct a regexp that finds an instance of any of the emoticons inside a group
-             * at the start or end of the line, or beside whitespace.
-             */
-            regexString += regexString.empty() ? "" : "|";
-            std::string escaped = "(" + Regex::escape(emoticon.first) + ")";
-            regexString += "^" + escaped + "|";
-            regexString += escaped + "$|";
-            regexString += "\\s" + escaped + "|";
-            regexString += escaped + "\\s";
+        matcher_.clear();
+        matcherPatterns_.clear();
+        for (const auto& emoticon : emoticons_) {
+            matcher_.addPattern(emoticon.first);
+            matcherPatterns_.push_back(MatcherPattern(MatcherPattern::Type::Emoticon));
+        }
+        if (!nick.empty()) {
+            matcher_.addPattern(nick, false);
+            matcherPatterns_.push_back(MatcherPattern(MatcherPattern::Type::OwnMention));
+        }
+        for (const auto& keyword : keywords) {
+            matcher_.addPattern(keyword.keyword, keyword.matchCaseSensitive);
+            matcherPatterns_.push_back(MatcherPattern(MatcherPattern::Type::Keyword, keyword.index));
+        }
+        matcherNick_ = nick;
+        matcherKeywords_ = keywords;
+        matcherCompiled_ = true;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    static bool isWordCharacter(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    /**
+     * Whether there is a word boundary at the given position, looking only
+     * at the text between start and end.
+     */
+    static bool isWordBoundary(const std::string& text, size_t position, size_t start, size_t end) {
+        bool wordBefore = position > start && isWordCharacter(text[position - 1]);
+        bool wordAfter = position < end && isWordCharacter(text[position]);
+        return wordBefore != wordAfter;
+    }
 
+    ChatWindow::ChatMessage ChatMessageParser::emoticonAndKeywordHighlight(const ChatWindow::ChatMessage& message, bool highlightKeywords) {
+        updateMatcher();
+        ChatWindow::ChatMessage parsedMessage = message;
+        if (matcher_.getPatternCount() == 0) {
+            return parsedMessage;
         }
-        if (!regexString.empty()) {
-            regexString += "";
-            boost::regex emoticonRegex(regexString);
-
-            ChatWindow::ChatMessage newMessage;
-            for (const auto& part : parsedMessage.getParts()) {
-                std::shared_ptr<ChatWindow::ChatTextMessagePart> textPart;
-                if ((textPart = std::dynamic_pointer_cast<ChatWindow::ChatTextMessagePart>(part))) {
-                    try {
-                        boost::match_results<std::string::const_iterator> match;
-                        const std::string& text = textPart->text;
-                        std::string::const_iterator start = text.begin();
-                        while (regex_search(start, text.end(), match, emoticonRegex)) {
-                            int matchIndex = 0;
-                            for (matchIndex = 1; matchIndex < static_cast<int>(match.size()); matchIndex++) {
-                                if (match[matchIndex].length() > 0) {
-                                    //This is the matching subgroup
-                                    break;
-                                }
-                            }
-                            std::string::const_iterator matchStart = match[matchIndex].first;
-                            std::string::const_iterator matchEnd = match[matchIndex].second;
-                            if (start != matchStart) {
-                                /* If we're skipping over plain text since the previous emoticon, record it as plain text */
-                                newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, matchStart)));
-                            }
-                            std::shared_ptr<ChatWindow::ChatEmoticonMessagePart> emoticonPart = std::make_shared<ChatWindow::ChatEmoticonMessagePart>();
-                            std::string matchString = match[matchIndex].str();
-                            std::map<std::string, std::string>::const_iterator emoticonIterator = emoticons_.find(matchString);
-                            assert (emoticonIterator != emoticons_.end());
-                            const StringPair& emoticon = *emoticonIterator;
-                            emoticonPart->imagePath = emoticon.second;
-                            emoticonPart->alternativeText = emoticon.first;
-                            newMessage.append(emoticonPart);
-                            start = matchEnd;
-                        }
-                        if (start != text.end()) {
-                            /* If there's plain text after the last emoticon, record it */
-                            newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, text.end())));
-                        }
 
-                    }
-                    catch (const std::runtime_error&) {
-                        /* Basically too expensive to compute the regex results and it gave up, so pass through as text */
-                        newMessage.append(part);
-                    }
-                }
-                else {
-                    newMessage.append(part);
-                }
+        HighlightAction ownMentionKeywordAction = highlightConfiguration_->ownMentionAction;
+        ownMentionKeywordAction.setSoundFilePath(boost::optional<std::string>());
+        ownMentionKeywordAction.setSystemNotificationEnabled(false);
+        bool ownMention = false;
+
+        ChatWindow::ChatMessage newMessage;
+        for (const auto& part : parsedMessage.getParts()) {
+            std::shared_ptr<ChatWindow::ChatTextMessagePart> textPart = std::dynamic_pointer_cast<ChatWindow::ChatTextMessagePart>(part);
+            if (!textPart) {
+                newMessage.append(part);
+                continue;
             }
-            parsedMessage.setParts(newMessage.getParts());
-        }
+            const std::string& text = textPart->text;
+            std::vector<MultiStringMatcher::Match> matches = matcher_.findAll(text);
 
-        return parsedMessage;
-    }
+            // The parts of the text that are replaced, by position. Maps to the end position and pattern.
+            std::map<size_t, std::pair<size_t, size_t> > replacements;
 
-    ChatWindow::ChatMessage ChatMessageParser::splitHighlight(const ChatWindow::ChatMessage& message) {
-        auto keywordToRegEx = [](const std::string& keyword, bool matchCaseSensitive) {
-            std::string escaped = Regex::escape(keyword);
-            boost::regex::flag_type flags = boost::regex::normal;
-            if (!matchCaseSensitive) {
-                flags |= boost::regex::icase;
+            /* Parse two, emoticons. An emoticon needs whitespace or the start or end of the line
+             * (or of the previous emoticon) on at least one side.
+             */
+            size_t searchStart = 0;
+            for (const auto& match : matches) {
+                size_t matchEnd = match.position + match.length;
+                if (matcherPatterns_[match.pattern].type != MatcherPattern::Type::Emoticon || match.position < searchStart) {
+                    continue;
+                }
+                if (match.position == searchStart || isSpace(text[match.position - 1]) || matchEnd == text.size() || isSpace(text[matchEnd])) {
+                    replacements[match.position] = std::make_pair(matchEnd, match.pattern);
+                    searchStart = matchEnd;
+                }
             }
-            return boost::regex("\\b" + escaped + "\\b", flags);
-        };
-
-        auto highlightKeywordInChatMessage = [&](const ChatWindow::ChatMessage& message, const std::string& keyword, bool matchCaseSensitive, const HighlightAction& action) {
-            ChatWindow::ChatMessage resultMessage;
-
-            for (const auto& part : message.getParts()) {
-                std::shared_ptr<ChatWindow::ChatTextMessagePart> textPart;
-                if ((textPart = std::dynamic_pointer_cast<ChatWindow::ChatTextMessagePart>(part))) {
-                    try {
-                        boost::match_results<std::string::const_iterator> match;
-                        const std::string& text = textPart->text;
-                        std::string::const_iterator start = text.begin();
-                        while (regex_search(start, text.end(), match, keywordToRegEx(keyword, matchCaseSensitive))) {
-                            std::string::const_iterator matchStart = match[0].first;
-                            std::string::const_iterator matchEnd = match[0].second;
-                            if (start != matchStart) {
-                                /* If we're skipping over plain text since the previous emoticon, record it as plain text */
-                                resultMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, matchStart)));
-                            }
-                            std::shared_ptr<ChatWindow::ChatHighlightingMessagePart> highlightPart = std::make_shared<ChatWindow::ChatHighlightingMessagePart>();
-                            highlightPart->text = match.str();
-                            highlightPart->action = action;
-                            resultMessage.append(highlightPart);
-                            start = matchEnd;
-                        }
-                        if (start != text.end()) {
-                            /* If there's plain text after the last emoticon, record it */
-                            resultMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(std::string(start, text.end())));
+
+            if (highlightKeywords) {
+                // Mentions of the own nickname go first, then the keywords in the configured order
+                auto priority = [&](const MultiStringMatcher::Match& match) {
+                    const MatcherPattern& pattern = matcherPatterns_[match.pattern];
+                    return pattern.type == MatcherPattern::Type::OwnMention ? 0 : pattern.keyword + 1;
+                };
+                std::stable_sort(matches.begin(), matches.end(), [&](const MultiStringMatcher::Match& left, const MultiStringMatcher::Match& right) {
+                    return priority(left) < priority(right);
+                });
+                for (const auto& match : matches) {
+                    size_t matchEnd = match.position + match.length;
+                    if (matcherPatterns_[match.pattern].type == MatcherPattern::Type::Emoticon) {
+                        continue;
+                    }
+                    // Keywords are matched as whole words, within the text that is not replaced yet
+                    auto next = replacements.lower_bound(match.position);
+                    if (next != replacements.end() && next->first < matchEnd) {
+                        continue;
+                    }
+                    size_t gapStart = 0;
+                    if (next != replacements.begin()) {
+                        auto previous = std::prev(next);
+                        if (previous->second.first > match.position) {
+                            continue;
                         }
+                        gapStart = previous->second.first;
                     }
-                    catch (const std::runtime_error&) {
-                        /* Basically too expensive to compute the regex results and it gave up, so pass through as text */
-                        resultMessage.append(part);
+                    size_t gapEnd = next != replacements.end() ? next->first : text.size();
+                    if (isWordBoundary(text, match.position, gapStart, gapEnd) && isWordBoundary(text, matchEnd, gapStart, gapEnd)) {
+                        replacements[match.position] = std::make_pair(matchEnd, match.pattern);
                     }
-                } else {
-                    resultMessage.append(part);
                 }
             }
-            return resultMessage;
-        };
 
-        ChatWindow::ChatMessage parsedMessage = message;
-
-        // detect mentions of own nickname
-        HighlightAction ownMentionKeywordAction = highlightConfiguration_->ownMentionAction;
-        ownMentionKeywordAction.setSoundFilePath(boost::optional<std::string>());
-        ownMentionKeywordAction.setSystemNotificationEnabled(false);
-        if (!getNick().empty() && !highlightConfiguration_->ownMentionAction.isEmpty()) {
-            auto nicknameHighlightedMessage = highlightKeywordInChatMessage(parsedMessage, nick_, false, ownMentionKeywordAction);
-            auto highlightedParts = nicknameHighlightedMessage.getParts();
-            auto ownNicknamePart = std::find_if(highlightedParts.begin(), highlightedParts.end(), [&](std::shared_ptr<ChatWindow::ChatMessagePart>& part){
-                auto highlightPart = std::dynamic_pointer_cast<ChatWindow::ChatHighlightingMessagePart>(part);
-                if (highlightPart && highlightPart->text == nick_) {
-                    return true;
+            size_t position = 0;
+            for (const auto& replacement : replacements) {
+                if (position != replacement.first) {
+                    newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(text.substr(position, replacement.first - position)));
+                }
+                std::string matchString = text.substr(replacement.first, replacement.second.first - replacement.first);
+                const MatcherPattern& pattern = matcherPatterns_[replacement.second.second];
+                if (pattern.type == MatcherPattern::Type::Emoticon) {
+                    std::map<std::string, std::string>::const_iterator emoticonIterator = emoticons_.find(matchString);
+                    assert(emoticonIterator != emoticons_.end());
+                    std::shared_ptr<ChatWindow::ChatEmoticonMessagePart> emoticonPart = std::make_shared<ChatWindow::ChatEmoticonMessagePart>();
+                    emoticonPart->imagePath = emoticonIterator->second;
+                    emoticonPart->alternativeText = emoticonIterator->first;
+                    newMessage.append(emoticonPart);
                 }
-                return false;
-            });
-            if (ownNicknamePart != highlightedParts.end()) {
-                parsedMessage.setHighlightActionOwnMention(highlightConfiguration_->ownMentionAction);
+                else {
+                    std::shared_ptr<ChatWindow::ChatHighlightingMessagePart> highlightPart = std::make_shared<ChatWindow::ChatHighlightingMessagePart>();
+                    if (pattern.type == MatcherPattern::Type::OwnMention) {
+                        highlightPart->action = ownMentionKeywordAction;
+                        ownMention |= (matchString == nick_);
+                    }
+                    else {
+                        highlightPart->action = highlightConfiguration_->keywordHighlights[pattern.keyword].action;
+                    }
+                    highlightPart->text = matchString;
+                    newMessage.append(highlightPart);
+                }
+                position = replacement.second.first;
             }
-            parsedMessage.setParts(nicknameHighlightedMessage.getParts());
-        }
-
-        // detect keywords
-        for (const auto& keywordHighlight : highlightConfiguration_->keywordHighlights) {
-            if (keywordHighlight.keyword.empty() || keywordHighlight.action.isEmpty()) {
-                continue;
+            if (position != text.size()) {
+                newMessage.append(std::make_shared<ChatWindow::ChatTextMessagePart>(text.substr(position)));
             }
-            auto newMessage = highlightKeywordInChatMessage(parsedMessage, keywordHighlight.keyword, keywordHighlight.matchCaseSensitive, keywordHighlight.action);
-            parsedMessage.setParts(newMessage.getParts());
         }
 
+        if (ownMention) {
+            parsedMessage.setHighlightActionOwnMention(highlightConfiguration_->ownMentionAction);
+        }
+        parsedMessage.setParts(newMessage.getParts());
         return parsedMessage;
     }
 
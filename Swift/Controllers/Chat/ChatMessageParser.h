@@ -6,8 +6,12 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include <SwifTools/MultiStringMatcher.h>
 
 #include <Swift/Controllers/Highlighting/HighlightConfiguration.h>
 #include <Swift/Controllers/UIInterfaces/ChatWindow.h>
@@ -31,8 +35,34 @@ namespace Swift {
             ChatWindow::ChatMessage parseMessageBody(const std::string& body, const std::string& sender = "", bool senderIsSelf = false);
 
         private:
-            ChatWindow::ChatMessage emoticonHighlight(const ChatWindow::ChatMessage& parsedMessage);
-            ChatWindow::ChatMessage splitHighlight(const ChatWindow::ChatMessage& parsedMessage);
+            /**
+             * What a pattern of the matcher stands for. The keyword is an
+             * index in the keyword highlights of the configuration.
+             */
+            struct MatcherPattern {
+                enum class Type { Emoticon, OwnMention, Keyword };
+
+                MatcherPattern(Type type, size_t keyword = 0) : type(type), keyword(keyword) {}
+
+                Type type;
+                size_t keyword;
+            };
+
+            struct MatcherKeyword {
+                MatcherKeyword(const std::string& keyword, bool matchCaseSensitive, size_t index) : keyword(keyword), matchCaseSensitive(matchCaseSensitive), index(index) {}
+
+                bool operator==(const MatcherKeyword& other) const {
+                    return keyword == other.keyword && matchCaseSensitive == other.matchCaseSensitive && index == other.index;
+                }
+
+                std::string keyword;
+                bool matchCaseSensitive;
+                size_t index;
+            };
+
+        private:
+            void updateMatcher();
+            ChatWindow::ChatMessage emoticonAndKeywordHighlight(const ChatWindow::ChatMessage& parsedMessage, bool highlightKeywords);
             ChatWindow::ChatMessage fullMessageHighlight(const ChatWindow::ChatMessage& parsedMessage, const std::string& sender);
 
         private:
@@ -40,5 +70,15 @@ namespace Swift {
             std::shared_ptr<HighlightConfiguration> highlightConfiguration_;
             Mode mode_;
             std::string nick_;
+
+            /**
+             * Finds emoticons, mentions of the own nickname and keywords in
+             * a single pass. Rebuilt when the nickname or keywords change.
+             */
+            MultiStringMatcher matcher_;
+            std::vector<MatcherPattern> matcherPatterns_;
+            std::string matcherNick_;
+            std::vector<MatcherKeyword> matcherKeywords_;
+            bool matcherCompiled_ = false;
     };
 }
@@ -47,6 +47,7 @@
 #include <Swift/Controllers/Chat/MUCController.h>
 #include <Swift/Controllers/Chat/MUCSearchController.h>
 #include <Swift/Controllers/Chat/UserSearchController.h>
+#include <Swift/Controllers/ContactSuggester.h>
 #include <Swift/Controllers/FileTransfer/FileTransferController.h>
 #include <Swift/Controllers/FileTransfer/FileTransferOverview.h>
 #include <Swift/Controllers/ProfileSettingsProvider.h>
@@ -920,7 +921,7 @@ void ChatsManager::handleUserNicknameChanged(MUCController* mucController, const
 
 bool ChatsManager::messageCausesSessionBinding(std::shared_ptr<Message> message) {
     bool causesRebind = false;
-    ChatState::ref chatState = message->getPayload<ChatState>();
+    const ChatState* chatState = message->getPayloadPtr<ChatState>();
     if (!message->getBody().get_value_or("").empty() || (chatState && chatState->getChatState() == ChatState::Composing)) {
         causesRebind = true;
     }
@@ -957,12 +958,13 @@ void ChatsManager::handleIncomingMessage(std::shared_ptr<Message> incomingMessag
     JID fromJID = message->getFrom();
 
     std::shared_ptr<MessageEvent> event(new MessageEvent(message));
-    bool isInvite = !!message->getPayload<MUCInvitationPayload>();
-    bool isMediatedInvite = (message->getPayload<MUCUserPayload>() && message->getPayload<MUCUserPayload>()->getInvite());
+    bool isInvite = message->getPayloadPtr<MUCInvitationPayload>() != nullptr;
+    const MUCUserPayload* mucUserPayload = message->getPayloadPtr<MUCUserPayload>();
+    bool isMediatedInvite = (mucUserPayload && mucUserPayload->getInvite());
     if (isMediatedInvite) {
-        fromJID = (*message->getPayload<MUCUserPayload>()->getInvite()).from;
+        fromJID = (*mucUserPayload->getInvite()).from;
     }
-    if (!event->isReadable() && !message->getPayload<ChatState>() && !message->getPayload<DeliveryReceipt>() && !message->getPayload<DeliveryReceiptRequest>() && !isInvite && !isMediatedInvite && !message->hasSubject()) {
+    if (!event->isReadable() && !message->getPayloadPtr<ChatState>() && !message->getPayloadPtr<DeliveryReceipt>() && !message->getPayloadPtr<DeliveryReceiptRequest>() && !isInvite && !isMediatedInvite && !message->hasSubject()) {
         return;
     }
 
@@ -1112,10 +1114,15 @@ std::vector<ChatListWindow::Chat> ChatsManager::getRecentChats() const {
 }
 
 std::vector<Contact::ref> Swift::ChatsManager::getContacts(bool withMUCNicks) {
+    return getMatchingContacts("", withMUCNicks);
+}
+
+std::vector<Contact::ref> Swift::ChatsManager::getMatchingContacts(const std::string& search, bool withMUCNicks) {
     std::vector<Contact::ref> result;
-    for (ChatListWindow::Chat chat : recentChats_) {
-        if (!chat.isMUC) {
-            result.push_back(std::make_shared<Contact>(chat.chatName.empty() ? chat.jid.toString() : chat.chatName, chat.jid, chat.statusType, chat.avatarPath));
+    for (const ChatListWindow::Chat& chat : recentChats_) {
+        std::string name = chat.chatName.empty() ? chat.jid.toString() : chat.chatName;
+        if (!chat.isMUC && (ContactSuggester::fuzzyMatch(name, search) || (chat.jid.isValid() && ContactSuggester::fuzzyMatch(chat.jid.toString(), search)))) {
+            result.push_back(std::make_shared<Contact>(name, chat.jid, chat.statusType, chat.avatarPath));
         }
     }
     if (withMUCNicks) {
@@ -1123,13 +1130,11 @@ std::vector<Contact::ref> Swift::ChatsManager::getContacts(bool withMUCNicks) {
         typedef std::map<JID, MUCController*>::value_type Item;
         for (const Item& item : mucControllers_) {
             JID mucJID = item.second->getToJID();
-            std::map<std::string, JID> participants = item.second->getParticipantJIDs();
-            typedef std::map<std::string, JID>::value_type ParticipantType;
-            for (const ParticipantType& participant : participants) {
-                const JID nickJID = JID(mucJID.getNode(), mucJID.getDomain(), participant.first);
+            for (const auto& nick : item.second->getMatchingParticipantNicks(search)) {
+                const JID nickJID = JID(mucJID.getNode(), mucJID.getDomain(), nick);
                 Presence::ref presence = presenceOracle_->getLastPresence(nickJID);
                 const boost::filesystem::path avatar = avatarManager_->getAvatarPath(nickJID);
-                result.push_back(std::make_shared<Contact>(participant.first, JID(), presence->getShow(), avatar));
+                result.push_back(std::make_shared<Contact>(nick, JID(), presence->getShow(), avatar));
             }
         }
     }
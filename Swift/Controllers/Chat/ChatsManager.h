@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -71,6 +71,7 @@ namespace Swift {
             void handleIncomingMessage(std::shared_ptr<Message> incomingMessage);
             std::vector<ChatListWindow::Chat> getRecentChats() const;
             virtual std::vector<Contact::ref> getContacts(bool withMUCNicks);
+            virtual std::vector<Contact::ref> getMatchingContacts(const std::string& search, bool withMUCNicks);
 
             boost::signals2::signal<void (bool supportsImpromptu)> onImpromptuMUCServiceDiscovered;
 
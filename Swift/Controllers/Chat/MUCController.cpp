@@ -264,6 +264,7 @@ void MUCController::rejoin() {
     if (parting_) {
         joined_ = false;
         parting_ = false;
+        clearCurrentOccupants();
         if (password_) {
             muc_->setPassword(*password_);
         }
@@ -309,6 +310,16 @@ std::map<std::string, JID> MUCController::getParticipantJIDs() const {
     return participants;
 }
 
+std::vector<std::string> MUCController::getMatchingParticipantNicks(const std::string& search) const {
+    std::vector<std::string> nicks;
+    for (const auto& match : currentOccupantsIndex_.find(search)) {
+        if (match.key != nick_) {
+            nicks.push_back(match.key);
+        }
+    }
+    return nicks;
+}
+
 void MUCController::sendInvites(const std::vector<JID>& jids, const std::string& reason) const {
     for (const auto& jid : jids) {
         muc_->invitePerson(jid, reason, isImpromptu_);
@@ -367,6 +378,7 @@ void MUCController::handleJoinFailed(std::shared_ptr<ErrorPayload> error) {
         default: break;
         }
     }
+    endOccupantBatch();
     errorMessage = str(format(QT_TRANSLATE_NOOP("", "Couldn't enter room: %1%.")) % errorMessage);
     chatWindow_->addErrorMessage(chatMessageParser_->parseMessageBody(errorMessage));
     parting_ = true;
@@ -383,6 +395,7 @@ void MUCController::handleJoinComplete(const std::string& nick) {
     receivedActivity();
     renameCounter_ = 0;
     joined_ = true;
+    endOccupantBatch();
     if (isImpromptu_) {
         lastStartMessage_ = str(format(QT_TRANSLATE_NOOP("", "You have joined the chat as %1%.")) % nick);
     }
@@ -409,6 +422,12 @@ void MUCController::handleJoinComplete(const std::string& nick) {
     onUserJoined();
 }
 
+void MUCController::endOccupantBatch() {
+    if (roster_->isBatching()) {
+        roster_->endBatch();
+    }
+}
+
 void MUCController::handleAvatarChanged(const JID& jid) {
     if (parting_ || !jid.equals(toJID_, JID::WithoutResource)) {
         return;
@@ -433,7 +452,12 @@ void MUCController::handleOccupantJoined(const MUCOccupant& occupant) {
     if (occupant.getRealJID()) {
         realJID = occupant.getRealJID().get();
     }
+    // The occupants already in the room arrive before the join completes; show them all at once then
+    if (!joined_ && !roster_->isBatching()) {
+        roster_->beginBatch();
+    }
     currentOccupants_.insert(occupant.getNick());
+    currentOccupantsIndex_.addEntry(occupant.getNick(), {occupant.getNick()});
     NickJoinPart event(occupant.getNick(), Join);
     appendToJoinParts(joinParts_, event);
     MUCOccupant::Role role = MUCOccupant::Participant;
@@ -689,7 +713,10 @@ void MUCController::setOnline(bool online) {
 }
 
 void MUCController::processUserPart() {
+    endOccupantBatch();
     roster_->removeAll();
+    // MUC forgets the other occupants without signalling each of them
+    clearCurrentOccupants();
     /* handleUserLeft won't throw a part back up unless this is called
        when it doesn't yet know we've left - which only happens on
        disconnect, so call with disconnect here so if the signal does
@@ -698,6 +725,11 @@ void MUCController::processUserPart() {
     setEnabled(false);
 }
 
+void MUCController::clearCurrentOccupants() {
+    currentOccupants_.clear();
+    currentOccupantsIndex_.clear();
+}
+
 bool MUCController::shouldUpdateJoinParts() {
     return lastWasPresence_;
 }
@@ -706,6 +738,7 @@ void MUCController::handleOccupantLeft(const MUCOccupant& occupant, MUC::Leaving
     NickJoinPart event(occupant.getNick(), Part);
     appendToJoinParts(joinParts_, event);
     currentOccupants_.erase(occupant.getNick());
+    currentOccupantsIndex_.removeEntry(occupant.getNick());
     completer_->removeWord(occupant.getNick());
     std::string partMessage;
     bool clearAfter = false;
@@ -775,6 +808,8 @@ void MUCController::handleOccupantNicknameChanged(const std::string& oldNickname
     // adjust occupants
     currentOccupants_.erase(oldNickname);
     currentOccupants_.insert(newNickname);
+    currentOccupantsIndex_.removeEntry(oldNickname);
+    currentOccupantsIndex_.addEntry(newNickname, {newNickname});
 
     // adjust completer
     completer_->removeWord(oldNickname);
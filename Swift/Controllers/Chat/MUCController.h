@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <boost/signals2.hpp>
 #include <boost/signals2/connection.hpp>
@@ -25,6 +26,8 @@
 #include <Swift/Controllers/Roster/RosterItem.h>
 #include <Swift/Controllers/UIInterfaces/ChatWindow.h>
 
+#include <SwifTools/SearchIndex.h>
+
 namespace Swift {
     class StanzaChannel;
     class IQRouter;
@@ -71,6 +74,12 @@ namespace Swift {
             const boost::optional<std::string> getPassword() const;
             bool isImpromptu() const;
             std::map<std::string, JID> getParticipantJIDs() const;
+
+            /**
+             * Returns the nicks of the other occupants containing the
+             * characters of the search in order, ignoring case.
+             */
+            std::vector<std::string> getMatchingParticipantNicks(const std::string& search) const;
             void sendInvites(const std::vector<JID>& jids, const std::string& reason) const;
             void setChatWindowTitle(const std::string& title);
 
@@ -117,6 +126,8 @@ namespace Swift {
             bool shouldUpdateJoinParts();
             virtual void dayTicked() override { clearPresenceQueue(); }
             void processUserPart();
+            void clearCurrentOccupants();
+            void endOccupantBatch();
             virtual void handleBareJIDCapsChanged(const JID& jid) override;
             void handleConfigureRequest(Form::ref);
             void handleConfigurationFailed(ErrorPayload::ref);
@@ -160,6 +171,7 @@ namespace Swift {
             boost::signals2::scoped_connection avatarChangedConnection_;
             std::shared_ptr<Timer> loginCheckTimer_;
             std::set<std::string> currentOccupants_;
+            SearchIndex currentOccupantsIndex_;
             std::vector<NickJoinPart> joinParts_;
             boost::posix_time::ptime lastActivity_;
             boost::optional<std::string> password_;
@@ -290,3 +290,53 @@ TEST_F(ChatMessageParserTest, testWithDefaultConfiguration) {
     ASSERT_EQ(HighlightAction(), result.getHighlightActionGroupMessage());
     ASSERT_EQ(HighlightAction(), result.getHighlightActionSender());
 }
+
+TEST_F(ChatMessageParserTest, testEarlierKeywordTakesPrecedence) {
+    auto config = mergeHighlightConfig(highlightConfigFromKeyword("new york", false), highlightConfigFromKeyword("york city", false));
+    config->keywordHighlights[1].action.setFrontColor(std::string("#343434"));
+    auto testling = ChatMessageParser(emoticons_, config);
+    auto result = testling.parseMessageBody("New York City");
+    assertHighlight(result, 0, "New York", config->keywordHighlights[0].action);
+    assertText(result, 1, " City");
+}
+
+TEST_F(ChatMessageParserTest, testOwnMentionTakesPrecedenceOverKeyword) {
+    auto config = highlightConfigFromKeyword("juliet", false);
+    config->ownMentionAction.setFrontColor(std::string("#f0f0f0"));
+    auto ownMentionActionForPart = config->ownMentionAction;
+    ownMentionActionForPart.setSoundFilePath(boost::optional<std::string>());
+    auto testling = ChatMessageParser(emoticons_, config);
+    testling.setNick("Juliet");
+    auto result = testling.parseMessageBody("Juliet :) and juliet");
+    assertHighlight(result, 0, "Juliet", ownMentionActionForPart);
+    assertText(result, 1, " ");
+    assertEmoticon(result, 2, smile1_, smile1Path_);
+    assertText(result, 3, " and ");
+    assertHighlight(result, 4, "juliet", ownMentionActionForPart);
+    ASSERT_EQ(config->ownMentionAction, result.getHighlightActionOwnMention());
+}
+
+TEST_F(ChatMessageParserTest, testChangedConfigurationAndNickAreUsed) {
+    auto config = highlightConfigFromKeyword("one", false);
+    config->ownMentionAction.setFrontColor(std::string("#f0f0f0"));
+    auto testling = ChatMessageParser(emoticons_, config);
+    auto result = testling.parseMessageBody("one two Juliet");
+    assertHighlight(result, 0, "one", config->keywordHighlights[0].action);
+    assertText(result, 1, " two Juliet");
+
+    config->keywordHighlights[0].keyword = "two";
+    testling.setNick("Juliet");
+    result = testling.parseMessageBody("one two Juliet");
+    assertText(result, 0, "one ");
+    assertHighlight(result, 1, "two", config->keywordHighlights[0].action);
+    assertText(result, 2, " ");
+    ASSERT_EQ(std::string("Juliet"), std::dynamic_pointer_cast<ChatWindow::ChatHighlightingMessagePart>(result.getParts()[3])->text);
+}
+
+TEST_F(ChatMessageParserTest, testOwnMessagesGetEmoticonsButNoHighlights) {
+    auto config = highlightConfigFromKeyword("trigger", false);
+    auto testling = ChatMessageParser(emoticons_, config);
+    auto result = testling.parseMessageBody("trigger :)", "", true);
+    assertText(result, 0, "trigger ");
+    assertEmoticon(result, 1, smile1_, smile1Path_);
+}
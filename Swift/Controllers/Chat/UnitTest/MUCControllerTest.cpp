@@ -64,6 +64,9 @@ class MUCControllerTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testSubjectChangeIncorrectC);
     CPPUNIT_TEST(testHandleOccupantNicknameChanged);
     CPPUNIT_TEST(testHandleOccupantNicknameChangedRoster);
+    CPPUNIT_TEST(testOccupantsDisplayedWhenJoinCompletes);
+    CPPUNIT_TEST(testGetMatchingParticipantNicks);
+    CPPUNIT_TEST(testGetMatchingParticipantNicks_AfterOwnLeave);
     CPPUNIT_TEST(testHandleChangeSubjectRequest);
 
     CPPUNIT_TEST(testNonImpromptuMUCWindowTitle);
@@ -554,6 +557,8 @@ public:
         muc_->insertOccupant(MUCOccupant("TestUserOne", MUCOccupant::Participant, MUCOccupant::Owner));
         muc_->insertOccupant(MUCOccupant("TestUserTwo", MUCOccupant::Participant, MUCOccupant::Owner));
         muc_->insertOccupant(MUCOccupant("TestUserThree", MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->insertOccupant(MUCOccupant(nick_, MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->onJoinComplete(nick_);
         CPPUNIT_ASSERT_EQUAL(1, occupantCount("TestUserOne"));
         CPPUNIT_ASSERT_EQUAL(1, occupantCount("TestUserTwo"));
         CPPUNIT_ASSERT_EQUAL(1, occupantCount("TestUserThree"));
@@ -565,6 +570,60 @@ public:
         CPPUNIT_ASSERT_EQUAL(1, occupantCount("TestUserThree"));
     }
 
+    void testOccupantsDisplayedWhenJoinCompletes() {
+        muc_->insertOccupant(MUCOccupant("TestUserOne", MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->insertOccupant(MUCOccupant("TestUserTwo", MUCOccupant::Moderator, MUCOccupant::Owner));
+        muc_->insertOccupant(MUCOccupant(nick_, MUCOccupant::Participant, MUCOccupant::Owner));
+
+        Roster* roster = window_->getRosterModel();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), roster->getRoot()->getChildren().size());
+        CPPUNIT_ASSERT(roster->getRoot()->getDisplayedChildren().empty());
+
+        muc_->onJoinComplete(nick_);
+
+        const std::vector<RosterItem*>& groups = roster->getRoot()->getDisplayedChildren();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), groups.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Moderators"), groups[0]->getDisplayName());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), roster->getGroup("Participants")->getDisplayedChildren().size());
+
+        // Later occupants are shown straight away
+        muc_->insertOccupant(MUCOccupant("TestUserThree", MUCOccupant::Participant, MUCOccupant::Owner));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), roster->getGroup("Participants")->getDisplayedChildren().size());
+    }
+
+    void testGetMatchingParticipantNicks() {
+        muc_->insertOccupant(MUCOccupant("TestUserOne", MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->insertOccupant(MUCOccupant("TestUserTwo", MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->insertOccupant(MUCOccupant(nick_, MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->onJoinComplete(nick_);
+
+        std::vector<std::string> nicks = controller_->getMatchingParticipantNicks("one");
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), nicks.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("TestUserOne"), nicks[0]);
+
+        // The own nick is left out
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), controller_->getMatchingParticipantNicks("").size());
+
+        muc_->renameOccupant("TestUserOne", "Renamed");
+        CPPUNIT_ASSERT(controller_->getMatchingParticipantNicks("one").empty());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), controller_->getMatchingParticipantNicks("renamed").size());
+    }
+
+    void testGetMatchingParticipantNicks_AfterOwnLeave() {
+        muc_->insertOccupant(MUCOccupant("TestUserOne", MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->insertOccupant(MUCOccupant(nick_, MUCOccupant::Participant, MUCOccupant::Owner));
+        muc_->onJoinComplete(nick_);
+
+        muc_->onOccupantLeft(MUCOccupant(nick_, MUCOccupant::Participant, MUCOccupant::Owner), MUC::LeaveKick, "");
+        CPPUNIT_ASSERT(controller_->getMatchingParticipantNicks("").empty());
+
+        muc_->onJoinComplete(nick_);
+        muc_->insertOccupant(MUCOccupant("TestUserTwo", MUCOccupant::Participant, MUCOccupant::Owner));
+        std::vector<std::string> nicks = controller_->getMatchingParticipantNicks("");
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), nicks.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("TestUserTwo"), nicks[0]);
+    }
+
     void testRoleAffiliationStatesVerify(const std::map<std::string, MUCOccupant> &occupants) {
         /* verify that the roster is in sync */
         GroupRosterItem* group = window_->getRosterModel()->getRoot();
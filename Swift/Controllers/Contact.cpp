@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2016 Isode Limited.
+ * Copyright (c) 2016-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -40,38 +40,24 @@ bool Contact::equalityPredicate(const Contact::ref& a, const Contact::ref& b) {
 }
 
 bool Contact::sortPredicate(const Contact::ref& a, const Contact::ref& b, const std::string& search) {
+    return getSortKey(a, search) < getSortKey(b, search);
+}
+
+Contact::SortKey Contact::getSortKey(const Contact::ref& contact, const std::string& search) {
     /* perform case insensitive comparisons */
-    std::string aLower = a->name;
-    boost::to_lower(aLower);
-    std::string bLower = b->name;
-    boost::to_lower(bLower);
+    std::string nameLower = contact->name;
+    boost::to_lower(nameLower);
     std::string searchLower = search;
     boost::to_lower(searchLower);
 
-    /* name starts with the search term */
-    if (aLower.find(searchLower) == 0 && bLower.find(searchLower) != 0) {
-        return true;
-    } else if (bLower.find(searchLower) == 0 && aLower.find(searchLower) != 0) {
-        return false;
-    }
-
-    /* name contains search term */
-    if (aLower.find(searchLower) != std::string::npos && bLower.find(searchLower) == std::string::npos) {
-        return true;
-    } else if (bLower.find(searchLower) != std::string::npos && aLower.find(searchLower) == std::string::npos) {
-        return false;
-    }
+    /* names starting with the search term go first, then names containing it */
+    size_t position = nameLower.find(searchLower);
+    int rank = position == 0 ? 0 : (position != std::string::npos ? 1 : 2);
 
     /* Levenshtein should be done here */
-    /* if edit distances are equal, fall through to the tests below */
-
-    /* lexicographical sort */
-    if (a->statusType == b->statusType) {
-        return aLower.compare(bLower) < 0;
-    }
 
-    /* online status */
-    return a->statusType < b->statusType;
+    /* then by online status, and lexicographically */
+    return SortKey(rank, contact->statusType, nameLower);
 }
 
 }
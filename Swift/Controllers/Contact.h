@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,6 +13,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <tuple>
 
 #include <boost/filesystem/path.hpp>
 
@@ -24,6 +26,7 @@ namespace Swift {
 class Contact : public std::enable_shared_from_this<Contact> {
     public:
         typedef std::shared_ptr<Contact> ref;
+        typedef std::tuple<int, StatusShow::Type, std::string> SortKey;
 
         Contact();
         Contact(const std::string& name, const JID& jid, StatusShow::Type statusType, const boost::filesystem::path& path);
@@ -32,6 +35,12 @@ class Contact : public std::enable_shared_from_this<Contact> {
         static bool equalityPredicate(const Contact::ref& a, const Contact::ref& b);
         static bool sortPredicate(const Contact::ref& a, const Contact::ref& b, const std::string& search);
 
+        /**
+         * Returns the key that sortPredicate compares, so that many contacts can be
+         * sorted without lowercasing their names for every comparison.
+         */
+        static SortKey getSortKey(const Contact::ref& contact, const std::string& search);
+
     public:
         std::string name;
         JID jid;
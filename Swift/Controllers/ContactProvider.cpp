@@ -4,6 +4,12 @@
  * See Documentation/Licenses/BSD-simplified.txt for more information.
  */
 
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
 #include <Swift/Controllers/ContactProvider.h>
 
 namespace Swift {
@@ -12,4 +18,8 @@ ContactProvider::~ContactProvider() {
 
 }
 
+std::vector<Contact::ref> ContactProvider::getMatchingContacts(const std::string& /*search*/, bool withMUCNicks) {
+    return getContacts(withMUCNicks);
+}
+
 }
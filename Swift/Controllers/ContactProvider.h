@@ -5,13 +5,14 @@
  */
 
 /*
- * Copyright (c) 2014 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <Swift/Controllers/Contact.h>
@@ -22,6 +23,13 @@ class ContactProvider {
     public:
         virtual ~ContactProvider();
         virtual std::vector<Contact::ref> getContacts(bool withMUCNicks) = 0;
+
+        /**
+         * Returns (at least) the contacts matching the search, as used by
+         * ContactSuggester. Providers that index their contacts can avoid
+         * creating all of them; the default returns all contacts.
+         */
+        virtual std::vector<Contact::ref> getMatchingContacts(const std::string& search, bool withMUCNicks);
 };
 
 }
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,11 +14,10 @@
 
 #include <algorithm>
 #include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
-#include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string/find.hpp>
-#include <boost/bind.hpp>
 #include <boost/lambda/bind.hpp>
 #include <boost/lambda/lambda.hpp>
 
@@ -31,6 +30,10 @@ namespace lambda = boost::lambda;
 
 namespace Swift {
 
+static char foldCase(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
 ContactSuggester::ContactSuggester() {
 }
 
@@ -55,30 +58,40 @@ std::vector<Contact::ref> ContactSuggester::getSuggestions(const std::string& se
     std::vector<Contact::ref> results;
 
     for (auto provider : contactProviders_) {
-        append(results, provider->getContacts(withMUCNicks));
+        append(results, provider->getMatchingContacts(search, withMUCNicks));
     }
 
     std::sort(results.begin(), results.end(), Contact::lexicographicalSortPredicate);
     results.erase(std::unique(results.begin(), results.end(), Contact::equalityPredicate), results.end());
     results.erase(std::remove_if(results.begin(), results.end(), !lambda::bind(&matchContact, search, lambda::_1)),
         results.end());
-    std::sort(results.begin(), results.end(), boost::bind(&Contact::sortPredicate, _1, _2, search));
+
+    // Compute the keys of Contact::sortPredicate once per contact
+    std::vector<std::pair<Contact::SortKey, Contact::ref> > sortKeys;
+    for (const auto& contact : results) {
+        sortKeys.push_back(std::make_pair(Contact::getSortKey(contact, search), contact));
+    }
+    std::stable_sort(sortKeys.begin(), sortKeys.end(), [](const std::pair<Contact::SortKey, Contact::ref>& a, const std::pair<Contact::SortKey, Contact::ref>& b) {
+        return a.first < b.first;
+    });
+    for (size_t i = 0; i < sortKeys.size(); ++i) {
+        results[i] = sortKeys[i].second;
+    }
 
     return results;
 }
 
-bool ContactSuggester::fuzzyMatch(std::string text, std::string match) {
-    std::string lowerText = text;
-    boost::algorithm::to_lower(lowerText);
-    std::string lowerMatch = match;
-    boost::algorithm::to_lower(lowerMatch);
-    size_t lastMatch = 0;
-    for (char i : lowerMatch) {
-        size_t where = lowerText.find_first_of(i, lastMatch);
-        if (where == std::string::npos) {
+bool ContactSuggester::fuzzyMatch(const std::string& text, const std::string& match) {
+    size_t position = 0;
+    for (char c : match) {
+        c = foldCase(c);
+        while (position < text.size() && foldCase(text[position]) != c) {
+            position++;
+        }
+        if (position == text.size()) {
             return false;
         }
-        lastMatch = where + 1;
+        position++;
     }
     return true;
 }
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -35,7 +35,7 @@ namespace Swift {
         /**
          * Performs fuzzy matching on the string text. Matches when each character of match string is present in sequence in text string.
          */
-        static bool fuzzyMatch(std::string text, std::string match);
+        static bool fuzzyMatch(const std::string& text, const std::string& match);
 
     private:
         std::vector<ContactProvider*> contactProviders_;
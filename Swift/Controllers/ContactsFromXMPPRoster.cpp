@@ -5,13 +5,15 @@
  */
 
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swift/Controllers/ContactsFromXMPPRoster.h>
 
+#include <boost/bind.hpp>
+
 #include <Swiften/Avatars/AvatarManager.h>
 #include <Swiften/Presence/PresenceOracle.h>
 #include <Swiften/Roster/XMPPRoster.h>
@@ -20,21 +22,70 @@
 namespace Swift {
 
 ContactsFromXMPPRoster::ContactsFromXMPPRoster(XMPPRoster* roster, AvatarManager* avatarManager, PresenceOracle* presenceOracle) : roster_(roster), avatarManager_(avatarManager), presenceOracle_(presenceOracle) {
+    roster_->onJIDAdded.connect(boost::bind(&ContactsFromXMPPRoster::handleJIDAdded, this, _1));
+    roster_->onJIDRemoved.connect(boost::bind(&ContactsFromXMPPRoster::handleJIDRemoved, this, _1));
+    roster_->onJIDUpdated.connect(boost::bind(&ContactsFromXMPPRoster::handleJIDUpdated, this, _1, _2, _3));
+    roster_->onRosterCleared.connect(boost::bind(&ContactsFromXMPPRoster::handleRosterCleared, this));
+    for (const auto& rosterItem : roster_->getItems()) {
+        indexContact(rosterItem.getJID(), rosterItem.getName());
+    }
 }
 
 ContactsFromXMPPRoster::~ContactsFromXMPPRoster() {
+    roster_->onJIDAdded.disconnect(boost::bind(&ContactsFromXMPPRoster::handleJIDAdded, this, _1));
+    roster_->onJIDRemoved.disconnect(boost::bind(&ContactsFromXMPPRoster::handleJIDRemoved, this, _1));
+    roster_->onJIDUpdated.disconnect(boost::bind(&ContactsFromXMPPRoster::handleJIDUpdated, this, _1, _2, _3));
+    roster_->onRosterCleared.disconnect(boost::bind(&ContactsFromXMPPRoster::handleRosterCleared, this));
 }
 
 std::vector<Contact::ref> ContactsFromXMPPRoster::getContacts(bool /*withMUCNicks*/) {
     std::vector<Contact::ref> results;
     std::vector<XMPPRosterItem> rosterItems = roster_->getItems();
     for (const auto& rosterItem : rosterItems) {
-        Contact::ref contact = std::make_shared<Contact>(rosterItem.getName().empty() ? rosterItem.getJID().toString() : rosterItem.getName(), rosterItem.getJID(), StatusShow::None,"");
-        contact->statusType = presenceOracle_->getAccountPresence(contact->jid) ? presenceOracle_->getAccountPresence(contact->jid)->getShow() : StatusShow::None;
-        contact->avatarPath = avatarManager_->getAvatarPath(contact->jid);
-        results.push_back(contact);
+        results.push_back(createContact(rosterItem.getJID(), rosterItem.getName()));
+    }
+    return results;
+}
+
+std::vector<Contact::ref> ContactsFromXMPPRoster::getMatchingContacts(const std::string& search, bool /*withMUCNicks*/) {
+    std::vector<Contact::ref> results;
+    for (const auto& match : index_.find(search)) {
+        JID jid(match.key);
+        results.push_back(createContact(jid, roster_->getNameForJID(jid)));
     }
     return results;
 }
 
+Contact::ref ContactsFromXMPPRoster::createContact(const JID& jid, const std::string& name) const {
+    Contact::ref contact = std::make_shared<Contact>(name.empty() ? jid.toString() : name, jid, StatusShow::None,"");
+    contact->statusType = presenceOracle_->getAccountPresence(contact->jid) ? presenceOracle_->getAccountPresence(contact->jid)->getShow() : StatusShow::None;
+    contact->avatarPath = avatarManager_->getAvatarPath(contact->jid);
+    return contact;
+}
+
+void ContactsFromXMPPRoster::indexContact(const JID& jid, const std::string& name) {
+    std::vector<std::string> texts;
+    texts.push_back(name.empty() ? jid.toString() : name);
+    if (jid.isValid()) {
+        texts.push_back(jid.toString());
+    }
+    index_.addEntry(jid.toString(), texts);
+}
+
+void ContactsFromXMPPRoster::handleJIDAdded(const JID& jid) {
+    indexContact(jid, roster_->getNameForJID(jid));
+}
+
+void ContactsFromXMPPRoster::handleJIDRemoved(const JID& jid) {
+    index_.removeEntry(jid.toString());
+}
+
+void ContactsFromXMPPRoster::handleJIDUpdated(const JID& jid, const std::string& /*oldName*/, const std::vector<std::string>& /*oldGroups*/) {
+    indexContact(jid, roster_->getNameForJID(jid));
+}
+
+void ContactsFromXMPPRoster::handleRosterCleared() {
+    index_.clear();
+}
+
 }
@@ -5,13 +5,18 @@
  */
 
 /*
- * Copyright (c) 2014 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
+#include <vector>
+
+#include <SwifTools/SearchIndex.h>
+
 #include <Swift/Controllers/ContactProvider.h>
 
 namespace Swift {
@@ -20,16 +25,32 @@ class PresenceOracle;
 class AvatarManager;
 class XMPPRoster;
 
+/**
+ * Provides the contacts of the roster. The names and JIDs of the contacts
+ * are indexed as the roster changes, so that searches don't go over the
+ * whole roster.
+ */
 class ContactsFromXMPPRoster : public ContactProvider {
     public:
         ContactsFromXMPPRoster(XMPPRoster* roster, AvatarManager* avatarManager, PresenceOracle* presenceOracle);
         virtual ~ContactsFromXMPPRoster();
 
         virtual std::vector<Contact::ref> getContacts(bool withMUCNicks);
+        virtual std::vector<Contact::ref> getMatchingContacts(const std::string& search, bool withMUCNicks);
+
+    private:
+        Contact::ref createContact(const JID& jid, const std::string& name) const;
+        void indexContact(const JID& jid, const std::string& name);
+        void handleJIDAdded(const JID& jid);
+        void handleJIDRemoved(const JID& jid);
+        void handleJIDUpdated(const JID& jid, const std::string& oldName, const std::vector<std::string>& oldGroups);
+        void handleRosterCleared();
+
     private:
         XMPPRoster* roster_;
         AvatarManager* avatarManager_;
         PresenceOracle* presenceOracle_;
+        SearchIndex index_;
 };
 
 }
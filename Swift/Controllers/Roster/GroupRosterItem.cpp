@@ -6,13 +6,15 @@
 
 #include <Swift/Controllers/Roster/GroupRosterItem.h>
 
+#include <algorithm>
+#include <cassert>
 #include <memory>
 
 #include <boost/bind.hpp>
 
 namespace Swift {
 
-GroupRosterItem::GroupRosterItem(const std::string& name, GroupRosterItem* parent, bool sortByStatus) : RosterItem(name, parent), sortByStatus_(sortByStatus), manualSort_(false) {
+GroupRosterItem::GroupRosterItem(const std::string& name, GroupRosterItem* parent, bool sortByStatus) : RosterItem(name, parent), sortByStatus_(sortByStatus), batching_(false), manualSort_(false) {
     expanded_ = true;
 }
 
@@ -78,6 +80,7 @@ void GroupRosterItem::addChild(RosterItem* item) {
 void GroupRosterItem::removeAll() {
     std::vector<RosterItem*>::iterator it = children_.begin();
     displayedChildren_.clear();
+    displayedKeys_.clear();
     while (it != children_.end()) {
         ContactRosterItem* contact = dynamic_cast<ContactRosterItem*>(*it);
         if (contact) {
@@ -104,7 +107,10 @@ std::unique_ptr<ContactRosterItem> GroupRosterItem::removeChild(const JID& jid)
     while (it != children_.end()) {
         ContactRosterItem* contact = dynamic_cast<ContactRosterItem*>(*it);
         if (contact && contact->getJID() == jid) {
-            displayedChildren_.erase(std::remove(displayedChildren_.begin(), displayedChildren_.end(), contact), displayedChildren_.end());
+            auto displayed = findDisplayed(contact);
+            if (displayed != displayedChildren_.end()) {
+                removeDisplayed(displayed);
+            }
             removed = std::unique_ptr<ContactRosterItem>(contact);
             it = children_.erase(it);
             continue;
@@ -129,7 +135,10 @@ std::unique_ptr<GroupRosterItem> GroupRosterItem::removeGroupChild(const std::st
     while (it != children_.end()) {
         GroupRosterItem* group = dynamic_cast<GroupRosterItem*>(*it);
         if (group && group->getDisplayName() == groupName) {
-            displayedChildren_.erase(std::remove(displayedChildren_.begin(), displayedChildren_.end(), group), displayedChildren_.end());
+            auto displayed = findDisplayed(group);
+            if (displayed != displayedChildren_.end()) {
+                removeDisplayed(displayed);
+            }
             removed = std::unique_ptr<GroupRosterItem>(group);
             it = children_.erase(it);
             continue;
@@ -141,19 +150,6 @@ std::unique_ptr<GroupRosterItem> GroupRosterItem::removeGroupChild(const std::st
     return removed;
 }
 
-/**
- * Returns false if the list didn't need a resort
- */
-bool GroupRosterItem::sortDisplayed() {
-    /* Not doing this until we import boost::algorithm*/
-//    if (boost::is_sorted(displayedChildren_begin(), displayedChildren_.end(), itemLessThan)) {
-//        return false;
-//    }
-    //Sholudn't need stable_sort here
-    std::sort(displayedChildren_.begin(), displayedChildren_.end(), sortByStatus_? itemLessThanWithStatus : itemLessThanWithoutStatus);
-    return true;
-}
-
 bool GroupRosterItem::itemLessThanWithoutStatus(const RosterItem* left, const RosterItem* right) {
     return left->getSortableDisplayName() < right->getSortableDisplayName();
 }
@@ -180,50 +176,162 @@ bool GroupRosterItem::itemLessThanWithStatus(const RosterItem* left, const Roste
     }
 }
 
+bool GroupRosterItem::itemLessThan(const RosterItem* left, const RosterItem* right) const {
+    return sortByStatus_ ? itemLessThanWithStatus(left, right) : itemLessThanWithoutStatus(left, right);
+}
+
+GroupRosterItem::SortKey GroupRosterItem::getSortKey(const RosterItem* item) const {
+    const ContactRosterItem* contact = sortByStatus_ ? dynamic_cast<const ContactRosterItem*>(item) : nullptr;
+    return SortKey(contact != nullptr, contact ? contact->getSimplifiedStatusShow() : StatusShow::Online, item->getSortableDisplayName());
+}
+
+/**
+ * Displayed children are found with a binary search on the sort keys they
+ * were put in place with. This also finds a child whose sort key has just
+ * changed, before it is repositioned.
+ */
+std::vector<RosterItem*>::iterator GroupRosterItem::findDisplayed(RosterItem* item) {
+    auto key = displayedKeys_.find(item);
+    if (key == displayedKeys_.end()) {
+        return displayedChildren_.end();
+    }
+    auto result = std::lower_bound(displayedChildren_.begin(), displayedChildren_.end(), key->second, [this](const RosterItem* child, const SortKey& key) {
+        return displayedKeys_.find(child)->second < key;
+    });
+    // Only children with an equal key are passed here
+    while (result != displayedChildren_.end() && *result != item) {
+        ++result;
+    }
+    assert(result != displayedChildren_.end());
+    return result;
+}
+
+/**
+ * The displayed children are always kept sorted, so a single child can be
+ * inserted, removed or moved with a binary search instead of a full sort.
+ */
+void GroupRosterItem::insertDisplayed(RosterItem* item) {
+    auto position = std::upper_bound(displayedChildren_.begin(), displayedChildren_.end(), item, [this](const RosterItem* left, const RosterItem* right) {
+        return itemLessThan(left, right);
+    });
+    DisplayedChildrenChange change(DisplayedChildrenChange::Insert, static_cast<size_t>(position - displayedChildren_.begin()));
+    onDisplayedChildrenAboutToChange(change);
+    displayedChildren_.insert(displayedChildren_.begin() + change.index, item);
+    displayedKeys_[item] = getSortKey(item);
+    onDisplayedChildrenChanged(change);
+}
+
+void GroupRosterItem::removeDisplayed(std::vector<RosterItem*>::iterator item) {
+    DisplayedChildrenChange change(DisplayedChildrenChange::Remove, static_cast<size_t>(item - displayedChildren_.begin()));
+    onDisplayedChildrenAboutToChange(change);
+    displayedKeys_.erase(*item);
+    displayedChildren_.erase(displayedChildren_.begin() + change.index);
+    onDisplayedChildrenChanged(change);
+}
+
+/**
+ * Moves a displayed child whose sort key changed to its new position.
+ * Returns false if the child was not displayed, or is still in order.
+ */
+bool GroupRosterItem::repositionDisplayed(RosterItem* item) {
+    auto current = findDisplayed(item);
+    if (current == displayedChildren_.end()) {
+        return false;
+    }
+    displayedKeys_[item] = getSortKey(item);
+    auto lessThan = [this](const RosterItem* left, const RosterItem* right) {
+        return itemLessThan(left, right);
+    };
+    size_t index = static_cast<size_t>(current - displayedChildren_.begin());
+    size_t newIndex;
+    if (current != displayedChildren_.begin() && itemLessThan(item, *(current - 1))) {
+        newIndex = static_cast<size_t>(std::upper_bound(displayedChildren_.begin(), current, item, lessThan) - displayedChildren_.begin());
+    }
+    else if (current + 1 != displayedChildren_.end() && itemLessThan(*(current + 1), item)) {
+        newIndex = static_cast<size_t>(std::upper_bound(current + 1, displayedChildren_.end(), item, lessThan) - displayedChildren_.begin()) - 1;
+    }
+    else {
+        return false;
+    }
+
+    DisplayedChildrenChange change(DisplayedChildrenChange::Move, index, newIndex);
+    onDisplayedChildrenAboutToChange(change);
+    auto begin = displayedChildren_.begin();
+    if (newIndex < index) {
+        std::rotate(begin + newIndex, begin + index, begin + index + 1);
+    }
+    else {
+        std::rotate(begin + index, begin + index + 1, begin + newIndex + 1);
+    }
+    onDisplayedChildrenChanged(change);
+    return true;
+}
+
+void GroupRosterItem::beginBatch() {
+    batching_ = true;
+}
+
+void GroupRosterItem::endBatch(const std::vector<RosterItem*>& displayedChildren) {
+    batching_ = false;
+    displayedChildren_ = displayedChildren;
+    displayedKeys_.clear();
+    for (auto child : displayedChildren) {
+        displayedKeys_[child] = getSortKey(child);
+    }
+    // Keep the order of children that compare equal, as insertDisplayed() does
+    std::stable_sort(displayedChildren_.begin(), displayedChildren_.end(), [this](const RosterItem* left, const RosterItem* right) {
+        return itemLessThan(left, right);
+    });
+}
+
+void GroupRosterItem::endBatch() {
+    batching_ = false;
+}
+
 void GroupRosterItem::setDisplayed(RosterItem* item, bool displayed) {
-    bool found = false;
-    for (auto& i : displayedChildren_) {
-        if (i == item) {
-            found = true;
-        }
+    if (batching_) {
+        return;
     }
-    if (found == displayed) {
+    auto current = findDisplayed(item);
+    if ((current != displayedChildren_.end()) == displayed) {
         return;
     }
     if (displayed) {
-        displayedChildren_.push_back(item);
-        sortDisplayed();
+        insertDisplayed(item);
     } else {
-        displayedChildren_.erase(std::remove(displayedChildren_.begin(), displayedChildren_.end(), item), displayedChildren_.end());
+        removeDisplayed(current);
     }
     onChildrenChanged();
     onDataChanged();
 }
 
-void GroupRosterItem::handleDataChanged(RosterItem* /*item*/) {
-    if (sortDisplayed()) {
+void GroupRosterItem::handleDataChanged(RosterItem* item) {
+    if (!batching_ && repositionDisplayed(item)) {
         onChildrenChanged();
     }
 }
 
 void GroupRosterItem::handleChildrenChanged(GroupRosterItem* group) {
-    size_t oldSize = getDisplayedChildren().size();
-    if (group->getDisplayedChildren().size() > 0) {
-        bool found = false;
-        for (auto& i : displayedChildren_) {
-            if (i == group) {
-                found = true;
-            }
+    if (batching_) {
+        return;
+    }
+    auto current = findDisplayed(group);
+    bool changed = false;
+    if (!group->getDisplayedChildren().empty()) {
+        if (current == displayedChildren_.end()) {
+            insertDisplayed(group);
+            changed = true;
         }
-        if (!found) {
-            displayedChildren_.push_back(group);
-            sortDisplayed();
+        else {
+            // The group's sort key may have changed too
+            changed = repositionDisplayed(group);
         }
-    } else {
-        displayedChildren_.erase(std::remove(displayedChildren_.begin(), displayedChildren_.end(), group), displayedChildren_.end());
+    } else if (current != displayedChildren_.end()) {
+        removeDisplayed(current);
+        changed = true;
     }
 
-    if (oldSize != getDisplayedChildren().size() || sortDisplayed()) {
+    if (changed) {
         onChildrenChanged();
         onDataChanged();
     }
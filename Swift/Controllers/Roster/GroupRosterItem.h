@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <Swift/Controllers/Roster/ContactRosterItem.h>
@@ -16,6 +18,24 @@ namespace Swift {
 
 class GroupRosterItem : public RosterItem {
     public:
+        /**
+         * A change of a single displayed child, or of all of them.
+         */
+        struct DisplayedChildrenChange {
+            enum Type {
+                Insert, ///< index is the index the child is inserted at
+                Remove, ///< index is the index of the removed child
+                Move, ///< index is the old index of the child, and newIndex the index after the move
+                Reset
+            };
+
+            DisplayedChildrenChange(Type type, size_t index = 0, size_t newIndex = 0) : type(type), index(index), newIndex(newIndex) {}
+
+            Type type;
+            size_t index;
+            size_t newIndex;
+        };
+
         GroupRosterItem(const std::string& name, GroupRosterItem* parent, bool sortByStatus);
         virtual ~GroupRosterItem();
 
@@ -28,6 +48,26 @@ class GroupRosterItem : public RosterItem {
         void removeAll();
 
         void setDisplayed(RosterItem* item, bool displayed);
+
+        /**
+         * Until endBatch() is called, changes to the children leave the
+         * displayed children alone, and setDisplayed() has no effect.
+         * Removed children are still taken out of the displayed children
+         * straight away.
+         */
+        void beginBatch();
+
+        /**
+         * Replaces the displayed children with the given ones, sorted. Does
+         * not emit a changed signal.
+         */
+        void endBatch(const std::vector<RosterItem*>& displayedChildren);
+
+        /**
+         * Ends the batch keeping the displayed children, for batches in
+         * which nothing changed.
+         */
+        void endBatch();
         void setExpanded(bool expanded);
         bool isExpanded() const;
         void setManualSort(const std::string& manualSortValue);
@@ -36,20 +76,42 @@ class GroupRosterItem : public RosterItem {
         boost::signals2::signal<void (bool)> onExpandedChanged;
         boost::signals2::signal<void ()> onChildrenChanged;
 
+        /**
+         * Emitted before and after the displayed children change, so that
+         * views can update only the affected rows. onChildrenChanged is
+         * still emitted afterwards.
+         */
+        boost::signals2::signal<void (const DisplayedChildrenChange&)> onDisplayedChildrenAboutToChange;
+        boost::signals2::signal<void (const DisplayedChildrenChange&)> onDisplayedChildrenChanged;
+
         static bool itemLessThanWithStatus(const RosterItem* left, const RosterItem* right);
         static bool itemLessThanWithoutStatus(const RosterItem* left, const RosterItem* right);
 
     private:
+        /**
+         * What itemLessThan() compares: whether the item is a contact, its
+         * status (if sorted by status) and its sortable display name.
+         */
+        typedef std::tuple<bool, StatusShow::Type, std::string> SortKey;
+
         void handleChildrenChanged(GroupRosterItem* group);
         void handleDataChanged(RosterItem* item);
-        bool sortDisplayed();
+        bool itemLessThan(const RosterItem* left, const RosterItem* right) const;
+        SortKey getSortKey(const RosterItem* item) const;
+        std::vector<RosterItem*>::iterator findDisplayed(RosterItem* item);
+        void insertDisplayed(RosterItem* item);
+        void removeDisplayed(std::vector<RosterItem*>::iterator item);
+        bool repositionDisplayed(RosterItem* item);
 
     private:
         std::string name_;
         bool expanded_;
         std::vector<RosterItem*> children_;
         std::vector<RosterItem*> displayedChildren_;
+        // The sort key of each displayed child at the time it was last put in place
+        std::unordered_map<const RosterItem*, SortKey> displayedKeys_;
         bool sortByStatus_;
+        bool batching_;
         bool manualSort_;
         std::string manualSortValue_;
 };
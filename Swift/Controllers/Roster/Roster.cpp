@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #include <Swift/Controllers/Roster/Roster.h>
 
 #include <algorithm>
+#include <cassert>
 #include <deque>
 #include <memory>
 #include <set>
@@ -24,7 +25,7 @@
 namespace Swift {
 
 Roster::Roster(bool sortByStatus, bool fullJIDMapping) : fullJIDMapping_(fullJIDMapping), sortByStatus_(sortByStatus), root_(std::make_unique<GroupRosterItem>("Dummy-Root", nullptr, sortByStatus_)) {
-    root_->onChildrenChanged.connect(boost::bind(&Roster::handleChildrenChanged, this, root_.get()));
+    connectGroup(root_.get());
 }
 
 Roster::~Roster() {
@@ -78,15 +79,24 @@ GroupRosterItem* Roster::getGroup(const std::string& groupName) {
         }
     }
     GroupRosterItem* group = new GroupRosterItem(groupName, root_.get(), sortByStatus_);
+    if (isBatching()) {
+        group->beginBatch();
+    }
     root_->addChild(group);
-    group->onChildrenChanged.connect(boost::bind(&Roster::handleChildrenChanged, this, group));
+    connectGroup(group);
     group->onDataChanged.connect(boost::bind(&Roster::handleDataChanged, this, group));
     return group;
 }
 
+void Roster::connectGroup(GroupRosterItem* group) {
+    group->onChildrenChanged.connect(boost::bind(&Roster::handleChildrenChanged, this, group));
+    group->onDisplayedChildrenAboutToChange.connect(boost::bind(boost::ref(onDisplayedChildrenAboutToChange), group, _1));
+    group->onDisplayedChildrenChanged.connect(boost::bind(boost::ref(onDisplayedChildrenChanged), group, _1));
+}
+
 void Roster::setBlockingSupported(bool isSupported) {
     if (!blockingSupported_) {
-        for (auto i : itemMap_) {
+        for (auto& i : itemMap_) {
             for (auto* item : i.second) {
                 item->setBlockState(ContactRosterItem::IsUnblocked);
             }
@@ -100,13 +110,100 @@ void Roster::removeGroup(const std::string& group) {
 }
 
 void Roster::handleDataChanged(RosterItem* item) {
+    if (isBatching()) {
+        batchChanged_ = true;
+        return;
+    }
     onDataChanged(item);
 }
 
 void Roster::handleChildrenChanged(GroupRosterItem* item) {
+    if (isBatching()) {
+        batchChanged_ = true;
+        return;
+    }
     onChildrenChanged(item);
 }
 
+void Roster::beginBatch() {
+    if (batchDepth_++ > 0) {
+        return;
+    }
+    batchChanged_ = false;
+    std::deque<GroupRosterItem*> queue;
+    queue.push_back(root_.get());
+    while (!queue.empty()) {
+        GroupRosterItem* group = queue.front();
+        queue.pop_front();
+        group->beginBatch();
+        for (auto* child : group->getChildren()) {
+            if (GroupRosterItem* childGroup = dynamic_cast<GroupRosterItem*>(child)) {
+                queue.push_back(childGroup);
+            }
+        }
+    }
+}
+
+void Roster::endBatch() {
+    assert(batchDepth_ > 0);
+    if (--batchDepth_ > 0) {
+        return;
+    }
+    if (!batchChanged_) {
+        // Nothing happened that could have changed the displayed children
+        std::deque<GroupRosterItem*> queue;
+        queue.push_back(root_.get());
+        while (!queue.empty()) {
+            GroupRosterItem* group = queue.front();
+            queue.pop_front();
+            group->endBatch();
+            for (auto* child : group->getChildren()) {
+                if (GroupRosterItem* childGroup = dynamic_cast<GroupRosterItem*>(child)) {
+                    queue.push_back(childGroup);
+                }
+            }
+        }
+        return;
+    }
+    GroupRosterItem::DisplayedChildrenChange reset(GroupRosterItem::DisplayedChildrenChange::Reset);
+    onDisplayedChildrenAboutToChange(root_.get(), reset);
+    std::vector<GroupRosterItem*> addedGroups;
+    endGroupBatch(root_.get(), addedGroups);
+    onDisplayedChildrenChanged(root_.get(), reset);
+    for (auto* group : addedGroups) {
+        onGroupAdded(group);
+    }
+    onChildrenChanged(root_.get());
+    onDataChanged(root_.get());
+}
+
+/**
+ * Ends the batch of the group and of all groups below it, filtering their
+ * contacts. Groups that had nothing displayed before and do now are added
+ * to addedGroups.
+ */
+void Roster::endGroupBatch(GroupRosterItem* group, std::vector<GroupRosterItem*>& addedGroups) {
+    bool wasDisplayed = !group->getDisplayedChildren().empty();
+    std::vector<RosterItem*> displayedChildren;
+    for (auto* child : group->getChildren()) {
+        if (GroupRosterItem* childGroup = dynamic_cast<GroupRosterItem*>(child)) {
+            endGroupBatch(childGroup, addedGroups);
+            if (!childGroup->getDisplayedChildren().empty()) {
+                displayedChildren.push_back(childGroup);
+            }
+        }
+        else if (ContactRosterItem* contact = dynamic_cast<ContactRosterItem*>(child)) {
+            if (isDisplayed(contact)) {
+                displayedChildren.push_back(contact);
+            }
+        }
+    }
+    group->endBatch(displayedChildren);
+    if (!wasDisplayed && !displayedChildren.empty() && group != root_.get()) {
+        addedGroups.push_back(group);
+    }
+}
+
 void Roster::addContact(const JID& jid, const JID& displayJID, const std::string& name, const std::string& groupName, const boost::filesystem::path& avatarPath) {
     GroupRosterItem* group(getGroup(groupName));
     ContactRosterItem *item = new ContactRosterItem(jid, displayJID, name, group);
@@ -138,8 +235,11 @@ struct JIDEqualsTo {
 };
 
 void Roster::removeAll() {
+    GroupRosterItem::DisplayedChildrenChange reset(GroupRosterItem::DisplayedChildrenChange::Reset);
+    onDisplayedChildrenAboutToChange(root_.get(), reset);
     root_->removeAll();
     itemMap_.clear();
+    onDisplayedChildrenChanged(root_.get(), reset);
     onChildrenChanged(root_.get());
     onDataChanged(root_.get());
 }
@@ -228,13 +328,21 @@ void Roster::removeFilter(RosterFilter* filter) {
     onFilterRemoved(filter);
 }
 
-void Roster::filterContact(ContactRosterItem* contact, GroupRosterItem* group) {
-    size_t oldDisplayedSize = group->getDisplayedChildren().size();
+bool Roster::isDisplayed(ContactRosterItem* contact) const {
     bool hide = true;
     for (auto* filter : filters_) {
         hide &= (*filter)(contact);
     }
-    group->setDisplayed(contact, filters_.empty() || !hide);
+    return filters_.empty() || !hide;
+}
+
+void Roster::filterContact(ContactRosterItem* contact, GroupRosterItem* group) {
+    if (isBatching()) {
+        batchChanged_ = true;
+        return;
+    }
+    size_t oldDisplayedSize = group->getDisplayedChildren().size();
+    group->setDisplayed(contact, isDisplayed(contact));
     size_t newDisplayedSize = group->getDisplayedChildren().size();
     if (oldDisplayedSize == 0 && newDisplayedSize > 0) {
         onGroupAdded(group);
@@ -251,6 +359,10 @@ void Roster::filterGroup(GroupRosterItem* group) {
 }
 
 void Roster::filterAll() {
+    if (isBatching()) {
+        batchChanged_ = true;
+        return;
+    }
     std::deque<RosterItem*> queue;
     queue.push_back(root_.get());
     while (!queue.empty()) {
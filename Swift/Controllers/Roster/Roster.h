@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/signals2.hpp>
@@ -17,14 +18,13 @@
 #include <Swiften/JID/JID.h>
 
 #include <Swift/Controllers/Roster/ContactRosterItem.h>
+#include <Swift/Controllers/Roster/GroupRosterItem.h>
 #include <Swift/Controllers/Roster/ItemOperations/RosterItemOperation.h>
 #include <Swift/Controllers/Roster/RosterFilter.h>
 
 namespace Swift {
 
 class RosterItem;
-class GroupRosterItem;
-class ContactRosterItem;
 
 class Roster {
     public:
@@ -44,8 +44,23 @@ class Roster {
         GroupRosterItem* getRoot() const;
         std::set<JID> getJIDs() const;
 
+        /**
+         * Defers filtering, sorting and change signals until the matching
+         * endBatch(). The displayed children are then rebuilt at once, and
+         * views are told with a single Reset. Batches can be nested.
+         *
+         * Removing contacts or groups still takes effect immediately.
+         */
+        void beginBatch();
+        void endBatch();
+        bool isBatching() const {
+            return batchDepth_ > 0;
+        }
+
         std::vector<RosterFilter*> getFilters() {return filters_;}
         boost::signals2::signal<void (GroupRosterItem*)> onChildrenChanged;
+        boost::signals2::signal<void (GroupRosterItem*, const GroupRosterItem::DisplayedChildrenChange&)> onDisplayedChildrenAboutToChange;
+        boost::signals2::signal<void (GroupRosterItem*, const GroupRosterItem::DisplayedChildrenChange&)> onDisplayedChildrenChanged;
         boost::signals2::signal<void (GroupRosterItem*)> onGroupAdded;
         boost::signals2::signal<void (RosterItem*)> onDataChanged;
         boost::signals2::signal<void (JID&)> onVCardUpdateRequested;
@@ -57,17 +72,22 @@ class Roster {
     private:
         void handleDataChanged(RosterItem* item);
         void handleChildrenChanged(GroupRosterItem* item);
+        void connectGroup(GroupRosterItem* group);
+        void endGroupBatch(GroupRosterItem* group, std::vector<GroupRosterItem*>& addedGroups);
+        bool isDisplayed(ContactRosterItem* contact) const;
         void filterGroup(GroupRosterItem* item);
         void filterContact(ContactRosterItem* contact, GroupRosterItem* group);
         void filterAll();
 
     private:
         std::vector<RosterFilter*> filters_;
-        typedef std::map<JID, std::vector<ContactRosterItem*> > ItemMap;
+        typedef std::unordered_map<JID, std::vector<ContactRosterItem*> > ItemMap;
         ItemMap itemMap_;
         bool fullJIDMapping_;
         bool sortByStatus_;
         bool blockingSupported_ = false;
+        int batchDepth_ = 0;
+        bool batchChanged_ = false;
         const std::unique_ptr<GroupRosterItem> root_;
 };
 
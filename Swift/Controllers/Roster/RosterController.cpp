@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -76,6 +76,7 @@ RosterController::RosterController(const JID& jid, XMPPRoster* xmppRoster, Avata
     xmppRoster_->onJIDUpdated.connect(boost::bind(&RosterController::handleOnJIDUpdated, this, _1, _2, _3));
     xmppRoster_->onJIDRemoved.connect(boost::bind(&RosterController::handleOnJIDRemoved, this, _1));
     xmppRoster_->onRosterCleared.connect(boost::bind(&RosterController::handleRosterCleared, this));
+    xmppRoster_->onInitialRosterPopulated.connect(boost::bind(&RosterController::handleInitialRosterPopulated, this));
     subscriptionManager_->onPresenceSubscriptionRequest.connect(boost::bind(&RosterController::handleSubscriptionRequest, this, _1, _2));
     uiEventConnection_ = uiEventStream->onUIEvent.connect(boost::bind(&RosterController::handleUIEvent, this, _1));
 
@@ -120,6 +121,11 @@ RosterController::~RosterController() {
 
 void RosterController::setEnabled(bool enabled) {
     if (!enabled) {
+        // The roster will not finish loading after a disconnect
+        if (loadingRoster_) {
+            loadingRoster_ = false;
+            roster_->endBatch();
+        }
         roster_->applyOnItems(AppearOffline());
     }
 }
@@ -158,6 +164,18 @@ void RosterController::applyAllPresenceTo(const JID& jid) {
 
 void RosterController::handleRosterCleared() {
     roster_->removeAll();
+    // The roster is cleared before it is (re)loaded, so add all contacts in one batch
+    if (!loadingRoster_) {
+        loadingRoster_ = true;
+        roster_->beginBatch();
+    }
+}
+
+void RosterController::handleInitialRosterPopulated() {
+    if (loadingRoster_) {
+        loadingRoster_ = false;
+        roster_->endBatch();
+    }
 }
 
 void RosterController::handleOnJIDRemoved(const JID& jid) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -72,6 +72,7 @@ namespace Swift {
         private:
             void handleOnJIDAdded(const JID &jid);
             void handleRosterCleared();
+            void handleInitialRosterPopulated();
             void handleOnJIDRemoved(const JID &jid);
             void handleOnJIDUpdated(const JID &jid, const std::string& oldName, const std::vector<std::string>& oldGroups);
             void handleStartChatRequest(const JID& contact);
@@ -115,6 +116,7 @@ namespace Swift {
             RosterVCardProvider* rosterVCardProvider_;
             std::shared_ptr<ContactRosterItem> ownContact_;
             std::unique_ptr<FeatureOracle> featureOracle_;
+            bool loadingRoster_ = false;
 
             boost::signals2::scoped_connection blockingOnStateChangedConnection_;
             boost::signals2::scoped_connection blockingOnItemAddedConnection_;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -62,6 +62,8 @@ class RosterControllerTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testRemoveResultsInUnavailablePresence);
         CPPUNIT_TEST(testOwnContactInRosterPresence);
         CPPUNIT_TEST(testMultiResourceFileTransferFeature);
+        CPPUNIT_TEST(testInitialRosterDisplayedWhenPopulated);
+        CPPUNIT_TEST(testInitialRosterBatchEndedOnDisconnect);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -435,6 +437,42 @@ class RosterControllerTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(false, item->supportsFeature(ContactRosterItem::FileTransferFeature));
         }
 
+        void testInitialRosterDisplayedWhenPopulated() {
+            xmppRoster_->clear();
+            xmppRoster_->addContact(JID("test@testdomain.com"), "Name", {"group1"}, RosterItemPayload::Both);
+            xmppRoster_->addContact(JID("test2@testdomain.com"), "Name2", {"group2"}, RosterItemPayload::Both);
+            Presence::ref presence(new Presence());
+            presence->setFrom(JID("test@testdomain.com/bob"));
+            stanzaChannel_->onPresenceReceived(presence);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), getUIRosterChildren().size());
+            CPPUNIT_ASSERT(mainWindow_->roster->getRoot()->getDisplayedChildren().empty());
+
+            xmppRoster_->onInitialRosterPopulated();
+
+            // Offline contacts are hidden
+            CPPUNIT_ASSERT(!mainWindow_->roster->isBatching());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), mainWindow_->roster->getRoot()->getDisplayedChildren().size());
+            CPPUNIT_ASSERT_EQUAL(static_cast<RosterItem*>(groupChild(0)), mainWindow_->roster->getRoot()->getDisplayedChildren()[0]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), groupChild(0)->getDisplayedChildren().size());
+        }
+
+        void testInitialRosterBatchEndedOnDisconnect() {
+            xmppRoster_->clear();
+            xmppRoster_->addContact(JID("test@testdomain.com"), "Name", {"group1"}, RosterItemPayload::Both);
+            CPPUNIT_ASSERT(mainWindow_->roster->isBatching());
+
+            rosterController_->setEnabled(false);
+            CPPUNIT_ASSERT(!mainWindow_->roster->isBatching());
+
+            // Later changes are displayed straight away again
+            Presence::ref presence(new Presence());
+            presence->setFrom(JID("test@testdomain.com/bob"));
+            stanzaChannel_->onPresenceReceived(presence);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), mainWindow_->roster->getRoot()->getDisplayedChildren().size());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), groupChild(0)->getDisplayedChildren().size());
+        }
+
         void assertVectorsEqual(const std::vector<std::string>& v1, const std::vector<std::string>& v2, int line) {
             for (const auto& entry : v1) {
                 if (std::find(v2.begin(), v2.end(), entry) == v2.end()) {
@@ -1,10 +1,13 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <memory>
+#include <vector>
+
+#include <boost/bind.hpp>
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
@@ -23,6 +26,9 @@ class RosterTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testRemoveSecondContactSameBare);
         CPPUNIT_TEST(testApplyPresenceLikeMUC);
         CPPUNIT_TEST(testReSortLikeMUC);
+        CPPUNIT_TEST(testDisplayedChildrenChanges);
+        CPPUNIT_TEST(testBatch);
+        CPPUNIT_TEST(testRemoveContactDuringBatch);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -131,8 +137,136 @@ class RosterTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("group1"), kids[1]->getDisplayName());
         }
 
+        void testDisplayedChildrenChanges() {
+            roster_->onDisplayedChildrenAboutToChange.connect(boost::bind(&RosterTest::handleDisplayedChildrenAboutToChange, this, _1, _2));
+            roster_->onDisplayedChildrenChanged.connect(boost::bind(&RosterTest::handleDisplayedChildrenChanged, this, _1, _2));
+
+            roster_->addContact(jid1_, jid1_, "Bert", "group1", "");
+            GroupRosterItem* group = roster_->getGroup("group1");
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), changes_.size());
+            assertChange(0, group, GroupRosterItem::DisplayedChildrenChange::Insert, 0);
+            assertChange(1, roster_->getRoot(), GroupRosterItem::DisplayedChildrenChange::Insert, 0);
+
+            roster_->addContact(jid2_, jid2_, "Ernie", "group1", "");
+            roster_->addContact(jid3_, jid3_, "Cookie", "group1", "");
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), changes_.size());
+            assertChange(2, group, GroupRosterItem::DisplayedChildrenChange::Insert, 1);
+            assertChange(3, group, GroupRosterItem::DisplayedChildrenChange::Insert, 1);
+
+            // Coming online moves Ernie in front of the offline contacts
+            std::shared_ptr<Presence> presence = std::make_shared<Presence>();
+            presence->setFrom(jid2_);
+            roster_->applyOnItems(SetPresence(presence));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(5), changes_.size());
+            assertChange(4, group, GroupRosterItem::DisplayedChildrenChange::Move, 2, 0);
+
+            roster_->removeContact(jid3_);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(6), changes_.size());
+            assertChange(5, group, GroupRosterItem::DisplayedChildrenChange::Remove, 2);
+
+            const std::vector<RosterItem*>& children = group->getDisplayedChildren();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), children.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("Ernie"), children[0]->getDisplayName());
+            CPPUNIT_ASSERT_EQUAL(std::string("Bert"), children[1]->getDisplayName());
+            CPPUNIT_ASSERT_EQUAL(changes_.size(), aboutToChangeCount_);
+        }
+
+        void testBatch() {
+            roster_->onDisplayedChildrenAboutToChange.connect(boost::bind(&RosterTest::handleDisplayedChildrenAboutToChange, this, _1, _2));
+            roster_->onDisplayedChildrenChanged.connect(boost::bind(&RosterTest::handleDisplayedChildrenChanged, this, _1, _2));
+            roster_->onGroupAdded.connect(boost::bind(&RosterTest::handleGroupAdded, this, _1));
+
+            roster_->beginBatch();
+            roster_->beginBatch();
+            roster_->addContact(jid1_, jid1_, "Bert", "group1", "");
+            roster_->addContact(jid2_, jid2_, "Ernie", "group1", "");
+            roster_->addContact(jid3_, jid3_, "Cookie", "group2", "");
+            std::shared_ptr<Presence> presence = std::make_shared<Presence>();
+            presence->setFrom(jid2_);
+            roster_->applyOnItems(SetPresence(presence));
+            roster_->endBatch();
+
+            CPPUNIT_ASSERT(roster_->isBatching());
+            CPPUNIT_ASSERT(roster_->getRoot()->getDisplayedChildren().empty());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), aboutToChangeCount_);
+            CPPUNIT_ASSERT(changes_.empty());
+            CPPUNIT_ASSERT(addedGroups_.empty());
+
+            roster_->endBatch();
+
+            CPPUNIT_ASSERT(!roster_->isBatching());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), aboutToChangeCount_);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), changes_.size());
+            assertChange(0, roster_->getRoot(), GroupRosterItem::DisplayedChildrenChange::Reset, 0);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), addedGroups_.size());
+
+            const std::vector<RosterItem*>& groups = roster_->getRoot()->getDisplayedChildren();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), groups.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("group1"), groups[0]->getDisplayName());
+            CPPUNIT_ASSERT_EQUAL(std::string("group2"), groups[1]->getDisplayName());
+            const std::vector<RosterItem*>& children = roster_->getGroup("group1")->getDisplayedChildren();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), children.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("Ernie"), children[0]->getDisplayName());
+            CPPUNIT_ASSERT_EQUAL(std::string("Bert"), children[1]->getDisplayName());
+
+            // Changes after the batch are applied straight away again
+            roster_->addContact(jid3_, jid3_, "Cookie", "group1", "");
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), roster_->getGroup("group1")->getDisplayedChildren().size());
+        }
+
+        void testRemoveContactDuringBatch() {
+            roster_->addContact(jid1_, jid1_, "Bert", "group1", "");
+            roster_->addContact(jid2_, jid2_, "Ernie", "group1", "");
+            roster_->onDisplayedChildrenChanged.connect(boost::bind(&RosterTest::handleDisplayedChildrenChanged, this, _1, _2));
+
+            roster_->beginBatch();
+            roster_->addContact(jid3_, jid3_, "Cookie", "group1", "");
+            roster_->removeContact(jid1_);
+
+            GroupRosterItem* group = roster_->getGroup("group1");
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), changes_.size());
+            assertChange(0, group, GroupRosterItem::DisplayedChildrenChange::Remove, 0);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), group->getDisplayedChildren().size());
+
+            roster_->endBatch();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), group->getDisplayedChildren().size());
+            CPPUNIT_ASSERT_EQUAL(std::string("Cookie"), group->getDisplayedChildren()[0]->getDisplayName());
+            CPPUNIT_ASSERT_EQUAL(std::string("Ernie"), group->getDisplayedChildren()[1]->getDisplayName());
+        }
+
+    private:
+        struct Change {
+            Change(GroupRosterItem* group, const GroupRosterItem::DisplayedChildrenChange& change) : group(group), change(change) {}
+            GroupRosterItem* group;
+            GroupRosterItem::DisplayedChildrenChange change;
+        };
+
+        void handleDisplayedChildrenAboutToChange(GroupRosterItem*, const GroupRosterItem::DisplayedChildrenChange&) {
+            aboutToChangeCount_++;
+        }
+
+        void handleDisplayedChildrenChanged(GroupRosterItem* group, const GroupRosterItem::DisplayedChildrenChange& change) {
+            changes_.push_back(Change(group, change));
+        }
+
+        void handleGroupAdded(GroupRosterItem* group) {
+            addedGroups_.push_back(group);
+        }
+
+        void assertChange(size_t index, GroupRosterItem* group, GroupRosterItem::DisplayedChildrenChange::Type type, size_t childIndex, size_t newChildIndex = 0) {
+            CPPUNIT_ASSERT_EQUAL(group, changes_[index].group);
+            CPPUNIT_ASSERT_EQUAL(type, changes_[index].change.type);
+            CPPUNIT_ASSERT_EQUAL(childIndex, changes_[index].change.index);
+            if (type == GroupRosterItem::DisplayedChildrenChange::Move) {
+                CPPUNIT_ASSERT_EQUAL(newChildIndex, changes_[index].change.newIndex);
+            }
+        }
+
     private:
         std::unique_ptr<Roster> roster_;
+        std::vector<Change> changes_;
+        size_t aboutToChangeCount_ = 0;
+        std::vector<GroupRosterItem*> addedGroups_;
         JID jid1_;
         JID jid2_;
         JID jid3_;
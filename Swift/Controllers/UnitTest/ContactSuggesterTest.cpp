@@ -1,10 +1,12 @@
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
+#include <algorithm>
 #include <memory>
+#include <string>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
@@ -12,7 +14,14 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
+#include <Swiften/Avatars/NullAvatarManager.h>
+#include <Swiften/Client/DummyStanzaChannel.h>
+#include <Swiften/Presence/PresenceOracle.h>
+#include <Swiften/Roster/XMPPRosterImpl.h>
+
+#include <Swift/Controllers/ContactProvider.h>
 #include <Swift/Controllers/ContactSuggester.h>
+#include <Swift/Controllers/ContactsFromXMPPRoster.h>
 
 using namespace Swift;
 
@@ -21,8 +30,20 @@ class ContactSuggesterTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(equalityTest);
     CPPUNIT_TEST(lexicographicalSortTest);
     CPPUNIT_TEST(sortTest);
+    CPPUNIT_TEST(fuzzyMatchTest);
+    CPPUNIT_TEST(suggestionsSortedTest);
+    CPPUNIT_TEST(suggestionsFromRosterTest);
     CPPUNIT_TEST_SUITE_END();
 
+    class TestContactProvider : public ContactProvider {
+        public:
+            virtual std::vector<Contact::ref> getContacts(bool) {
+                return contacts;
+            }
+
+            std::vector<Contact::ref> contacts;
+    };
+
 public:
 
     std::vector<std::string> wordList() {
@@ -123,6 +144,73 @@ public:
         }
     }
 
+    void fuzzyMatchTest() {
+        CPPUNIT_ASSERT(ContactSuggester::fuzzyMatch("Alice Wonderland", "awl"));
+        CPPUNIT_ASSERT(ContactSuggester::fuzzyMatch("alice", "ALI"));
+        CPPUNIT_ASSERT(ContactSuggester::fuzzyMatch("alice", ""));
+        CPPUNIT_ASSERT(!ContactSuggester::fuzzyMatch("alice", "ea"));
+        CPPUNIT_ASSERT(!ContactSuggester::fuzzyMatch("alice", "alicea"));
+    }
+
+    void suggestionsSortedTest() {
+        TestContactProvider provider;
+        std::vector<std::string> words = wordList();
+        std::vector<StatusShow::Type> statuses = statusList();
+        for (size_t i = 0; i < words.size(); ++i) {
+            for (size_t j = 0; j < statuses.size(); ++j) {
+                provider.contacts.push_back(std::make_shared<Contact>(words[i] + std::to_string(j), JID(), statuses[j], ""));
+            }
+        }
+        ContactSuggester testling;
+        testling.addContactProvider(&provider);
+
+        for (const auto& word : words) {
+            std::vector<Contact::ref> suggestions = testling.getSuggestions(word, false);
+            std::vector<Contact::ref> expected;
+            for (const auto& contact : provider.contacts) {
+                if (ContactSuggester::matchContact(word, contact)) {
+                    expected.push_back(contact);
+                }
+            }
+            std::stable_sort(expected.begin(), expected.end(), boost::bind(Contact::sortPredicate, _1, _2, word));
+            CPPUNIT_ASSERT_EQUAL(expected.size(), suggestions.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                CPPUNIT_ASSERT_EQUAL(expected[i]->name, suggestions[i]->name);
+            }
+        }
+    }
+
+    void suggestionsFromRosterTest() {
+        XMPPRosterImpl roster;
+        DummyStanzaChannel stanzaChannel;
+        PresenceOracle presenceOracle(&stanzaChannel, &roster);
+        NullAvatarManager avatarManager;
+        roster.addContact(JID("alice@wonderland.lit"), "Alice", std::vector<std::string>(), RosterItemPayload::Both);
+        ContactsFromXMPPRoster provider(&roster, &avatarManager, &presenceOracle);
+        roster.addContact(JID("bob@example.com"), "", std::vector<std::string>(), RosterItemPayload::Both);
+        roster.addContact(JID("carol@wonderland.lit"), "Carol", std::vector<std::string>(), RosterItemPayload::Both);
+        ContactSuggester testling;
+        testling.addContactProvider(&provider);
+
+        std::vector<Contact::ref> suggestions = testling.getSuggestions("wonder", false);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), suggestions.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Alice"), suggestions[0]->name);
+        CPPUNIT_ASSERT_EQUAL(std::string("Carol"), suggestions[1]->name);
+
+        roster.addContact(JID("carol@wonderland.lit"), "Dave", std::vector<std::string>(), RosterItemPayload::Both);
+        roster.removeContact(JID("alice@wonderland.lit"));
+        suggestions = testling.getSuggestions("wonder", false);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), suggestions.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("Dave"), suggestions[0]->name);
+
+        suggestions = testling.getSuggestions("bob", false);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), suggestions.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("bob@example.com"), suggestions[0]->name);
+
+        roster.clear();
+        CPPUNIT_ASSERT(testling.getSuggestions("", false).empty());
+    }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ContactSuggesterTest);
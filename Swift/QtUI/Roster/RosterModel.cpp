@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -28,7 +28,7 @@
 
 namespace Swift {
 
-RosterModel::RosterModel(QtTreeWidget* view, bool screenReaderMode) : roster_(nullptr), view_(view), screenReader_(screenReaderMode) {
+RosterModel::RosterModel(QtTreeWidget* view, bool screenReaderMode) : roster_(nullptr), view_(view), screenReader_(screenReaderMode), pendingChange_(NoPendingChange) {
     const int tooltipAvatarSize = 96; // maximal suggested size according to XEP-0153
     cachedImageScaler_ = new QtScaledAvatarCache(tooltipAvatarSize);
 }
@@ -40,7 +40,8 @@ RosterModel::~RosterModel() {
 void RosterModel::setRoster(Roster* roster) {
     roster_ = roster;
     if (roster_) {
-        roster->onChildrenChanged.connect(boost::bind(&RosterModel::handleChildrenChanged, this, _1));
+        roster->onDisplayedChildrenAboutToChange.connect(boost::bind(&RosterModel::handleDisplayedChildrenAboutToChange, this, _1, _2));
+        roster->onDisplayedChildrenChanged.connect(boost::bind(&RosterModel::handleDisplayedChildrenChanged, this, _1, _2));
         roster->onDataChanged.connect(boost::bind(&RosterModel::handleDataChanged, this, _1));
     }
     reLayout();
@@ -50,6 +51,10 @@ void RosterModel::reLayout() {
     //emit layoutChanged();
     beginResetModel();
     endResetModel(); // TODO: Not sure if this isn't too early?
+    emitExpandedStates();
+}
+
+void RosterModel::emitExpandedStates() {
     if (!roster_) {
         return;
     }
@@ -60,8 +65,76 @@ void RosterModel::reLayout() {
     }
 }
 
-void RosterModel::handleChildrenChanged(GroupRosterItem* /*group*/) {
-    reLayout();
+void RosterModel::handleDisplayedChildrenAboutToChange(GroupRosterItem* group, const GroupRosterItem::DisplayedChildrenChange& change) {
+    pendingChange_ = NoPendingChange;
+    if (change.type == GroupRosterItem::DisplayedChildrenChange::Reset) {
+        beginResetModel();
+        pendingChange_ = PendingReset;
+        return;
+    }
+
+    // Children of groups that are not displayed are not part of the model
+    QModelIndex parent = (group == roster_->getRoot()) ? QModelIndex() : index(group);
+    if (group != roster_->getRoot() && !parent.isValid()) {
+        return;
+    }
+    int row = static_cast<int>(change.index);
+    switch (change.type) {
+        case GroupRosterItem::DisplayedChildrenChange::Insert:
+            beginInsertRows(parent, row, row);
+            pendingChange_ = PendingRowsChange;
+            break;
+        case GroupRosterItem::DisplayedChildrenChange::Remove:
+            beginRemoveRows(parent, row, row);
+            pendingChange_ = PendingRowsChange;
+            break;
+        case GroupRosterItem::DisplayedChildrenChange::Move: {
+            // Qt expects the destination as the row the child is moved in front of, before the move
+            int destination = static_cast<int>(change.newIndex > change.index ? change.newIndex + 1 : change.newIndex);
+            if (beginMoveRows(parent, row, row, parent, destination)) {
+                pendingChange_ = PendingRowsChange;
+            }
+            else {
+                beginResetModel();
+                pendingChange_ = PendingReset;
+            }
+            break;
+        }
+        case GroupRosterItem::DisplayedChildrenChange::Reset:
+            break;
+    }
+}
+
+void RosterModel::handleDisplayedChildrenChanged(GroupRosterItem* group, const GroupRosterItem::DisplayedChildrenChange& change) {
+    PendingChange pendingChange = pendingChange_;
+    pendingChange_ = NoPendingChange;
+    if (pendingChange == NoPendingChange) {
+        return;
+    }
+    if (pendingChange == PendingReset) {
+        endResetModel();
+        emitExpandedStates();
+        return;
+    }
+    switch (change.type) {
+        case GroupRosterItem::DisplayedChildrenChange::Insert: {
+            endInsertRows();
+            // Let the view restore the expansion state of new groups
+            GroupRosterItem* child = dynamic_cast<GroupRosterItem*>(group->getDisplayedChildren()[change.index]);
+            if (child) {
+                emit itemExpanded(index(child), child->isExpanded());
+            }
+            break;
+        }
+        case GroupRosterItem::DisplayedChildrenChange::Remove:
+            endRemoveRows();
+            break;
+        case GroupRosterItem::DisplayedChildrenChange::Move:
+            endMoveRows();
+            break;
+        case GroupRosterItem::DisplayedChildrenChange::Reset:
+            break;
+    }
 }
 
 void RosterModel::handleDataChanged(RosterItem* item) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -46,7 +46,8 @@ namespace Swift {
             void itemExpanded(const QModelIndex& item, bool expanded);
         private:
             void handleDataChanged(RosterItem* item);
-            void handleChildrenChanged(GroupRosterItem* item);
+            void handleDisplayedChildrenAboutToChange(GroupRosterItem* group, const GroupRosterItem::DisplayedChildrenChange& change);
+            void handleDisplayedChildrenChanged(GroupRosterItem* group, const GroupRosterItem::DisplayedChildrenChange& change);
             RosterItem* getItem(const QModelIndex& index) const;
             QColor intToColor(int color) const;
             QColor getTextColor(RosterItem* item) const;
@@ -60,12 +61,20 @@ namespace Swift {
             int getChildCount(RosterItem* item) const;
             bool getIsIdle(RosterItem* item) const;
             void reLayout();
+            void emitExpandedStates();
             /** calculates screenreader-friendly text if in screenreader mode, otherwise uses alternative text */
             QString getScreenReaderTextOr(RosterItem* item, const QString& alternative) const;
         private:
+            enum PendingChange {
+                NoPendingChange,
+                PendingRowsChange,
+                PendingReset
+            };
+
             Roster* roster_;
             QtTreeWidget* view_;
             QtScaledAvatarCache* cachedImageScaler_;
             bool screenReader_;
+            PendingChange pendingChange_;
     };
 }
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Base/Histogram.h>
+
+#include <cmath>
+
+namespace Swift {
+
+static size_t getBucket(std::uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0 && bucket < Histogram::BUCKETS - 1) {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+double Histogram::Snapshot::getMean() const {
+    return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
+
+std::uint64_t Histogram::Snapshot::getPercentile(double percentile) const {
+    std::uint64_t total = 0;
+    for (const auto& bucket : buckets) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * total));
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS - 1; ++i) {
+        seen += buckets[i];
+        if (seen >= rank && seen > 0) {
+            std::uint64_t upperBound = i == 0 ? 0 : (std::uint64_t(1) << i) - 1;
+            return upperBound < max ? upperBound : max;
+        }
+    }
+    return max;
+}
+
+Histogram::Histogram() {
+    reset();
+}
+
+void Histogram::add(std::uint64_t value) {
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    buckets_[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Snapshot Histogram::getSnapshot() const {
+    Snapshot snapshot;
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    snapshot.max = max_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void Histogram::reset() {
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+}
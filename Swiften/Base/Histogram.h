@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+    /**
+     * A histogram of non-negative values (typically durations in
+     * nanoseconds), with buckets that double in size.
+     *
+     * Values can be added and snapshots taken from any thread, without
+     * locking.
+     */
+    class SWIFTEN_API Histogram {
+        public:
+            /**
+             * Bucket 0 counts the value 0, bucket i counts the values in
+             * [2^(i-1), 2^i). The last bucket also counts all larger values.
+             */
+            static const size_t BUCKETS = 48;
+
+            struct SWIFTEN_API Snapshot {
+                Snapshot() : count(0), sum(0), max(0) {
+                    buckets.fill(0);
+                }
+
+                double getMean() const;
+
+                /**
+                 * Returns an upper bound for the given percentile (between 0
+                 * and 100) of the values, or 0 if there are none.
+                 */
+                std::uint64_t getPercentile(double percentile) const;
+
+                std::uint64_t count;
+                std::uint64_t sum;
+                std::uint64_t max;
+                std::array<std::uint64_t, BUCKETS> buckets;
+            };
+
+        public:
+            Histogram();
+
+            void add(std::uint64_t value);
+
+            /**
+             * Returns the current values. Values added concurrently may be
+             * partially included.
+             */
+            Snapshot getSnapshot() const;
+
+            void reset();
+
+        private:
+            std::atomic<std::uint64_t> count_;
+            std::atomic<std::uint64_t> sum_;
+            std::atomic<std::uint64_t> max_;
+            std::array<std::atomic<std::uint64_t>, BUCKETS> buckets_;
+    };
+}
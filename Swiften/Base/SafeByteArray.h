@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -50,6 +51,14 @@ namespace Swift {
         return std::make_shared<SafeByteArray>(c, c + n);
     }
 
+    /**
+     * Zeroes the contents of \p data, as is done when its memory is freed,
+     * so that the buffer can be kept for reuse.
+     */
+    inline void scrubSafeByteArray(SafeByteArray& data) {
+        std::fill(data.begin(), data.end(), 0);
+    }
+
     /* WARNING! This breaks the safety of the data in the safe byte array.
      * Do not use in modes that require data safety. */
     inline std::string safeByteArrayToString(const SafeByteArray& b) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #include <Swiften/Base/Platform.h>
 
 #include <cassert>
+#include <cstring>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
@@ -158,11 +159,18 @@ bool String::isValidXMPPCharacter(std::uint32_t codepoint) {
 }
 
 std::string String::sanitizeXMPPString(const std::string& input) {
-    std::string result;
-    result.reserve(input.length());
+    std::string result(input);
+    if (!result.empty()) {
+        result.resize(sanitizeXMPPString(&result[0], result.size()));
+    }
+    result.shrink_to_fit();
+    return result;
+}
 
-    auto it = input.data();
-    const auto end = it + input.length();
+size_t String::sanitizeXMPPString(char* data, size_t size) {
+    const char* it = data;
+    const char* const end = data + size;
+    char* out = data;
 
     std::size_t consumed;
     bool status = UTF8_ACCEPT;
@@ -171,7 +179,9 @@ std::string String::sanitizeXMPPString(const std::string& input) {
         const auto codepoint = getNextCodepoint(it, end, consumed, status);
         if (status) {
             if (isValidXMPPCharacter(codepoint)) {
-                std::copy(it, it + consumed, std::back_inserter(result));
+                // The output never runs ahead of the input, so this can be done in place
+                std::memmove(out, it, consumed);
+                out += consumed;
             }
             it += consumed;
         }
@@ -179,8 +189,7 @@ std::string String::sanitizeXMPPString(const std::string& input) {
             ++it;
         }
     }
-    result.shrink_to_fit();
-    return result;
+    return static_cast<size_t>(out - data);
 }
 
 std::vector<std::string> String::split(const std::string& s, char c) {
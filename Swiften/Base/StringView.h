@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include <boost/functional/hash.hpp>
+
+namespace Swift {
+    /**
+     * A non-owning reference to a contiguous sequence of characters.
+     *
+     * The referenced data is not copied, and needs to outlive the view.
+     */
+    class StringView {
+        public:
+            StringView() : data_(nullptr), size_(0) {
+            }
+
+            StringView(const char* data, size_t size) : data_(data), size_(size) {
+            }
+
+            StringView(const char* data) : data_(data), size_(std::strlen(data)) {
+            }
+
+            StringView(const std::string& s) : data_(s.data()), size_(s.size()) {
+            }
+
+            const char* data() const {
+                return data_;
+            }
+
+            size_t size() const {
+                return size_;
+            }
+
+            bool empty() const {
+                return size_ == 0;
+            }
+
+            const char* begin() const {
+                return data_;
+            }
+
+            const char* end() const {
+                return data_ + size_;
+            }
+
+            std::string toString() const {
+                return std::string(data_, size_);
+            }
+
+            bool operator==(const StringView& o) const {
+                return size_ == o.size_ && (size_ == 0 || std::memcmp(data_, o.data_, size_) == 0);
+            }
+
+            bool operator!=(const StringView& o) const {
+                return !(*this == o);
+            }
+
+            struct Hash {
+                size_t operator()(const StringView& s) const {
+                    return boost::hash_range(s.begin(), s.end());
+                }
+            };
+
+        private:
+            const char* data_;
+            size_t size_;
+    };
+}
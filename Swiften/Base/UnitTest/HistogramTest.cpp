@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <thread>
+#include <vector>
+
+#include <Swiften/Base/Histogram.h>
+
+#include <gtest/gtest.h>
+
+using namespace Swift;
+
+TEST(HistogramTest, testGetSnapshot_Empty) {
+    Histogram testling;
+
+    Histogram::Snapshot snapshot = testling.getSnapshot();
+
+    ASSERT_EQ(0U, snapshot.count);
+    ASSERT_EQ(0U, snapshot.max);
+    ASSERT_EQ(0.0, snapshot.getMean());
+    ASSERT_EQ(0U, snapshot.getPercentile(50));
+}
+
+TEST(HistogramTest, testAdd) {
+    Histogram testling;
+
+    testling.add(0);
+    testling.add(1);
+    testling.add(5);
+    testling.add(6);
+    testling.add(100);
+
+    Histogram::Snapshot snapshot = testling.getSnapshot();
+    ASSERT_EQ(5U, snapshot.count);
+    ASSERT_EQ(112U, snapshot.sum);
+    ASSERT_EQ(100U, snapshot.max);
+    ASSERT_EQ(1U, snapshot.buckets[0]);
+    ASSERT_EQ(1U, snapshot.buckets[1]);
+    ASSERT_EQ(2U, snapshot.buckets[3]);
+    ASSERT_EQ(1U, snapshot.buckets[7]);
+    ASSERT_DOUBLE_EQ(22.4, snapshot.getMean());
+}
+
+TEST(HistogramTest, testAdd_LargeValue) {
+    Histogram testling;
+
+    testling.add(~std::uint64_t(0));
+
+    Histogram::Snapshot snapshot = testling.getSnapshot();
+    ASSERT_EQ(1U, snapshot.buckets[Histogram::BUCKETS - 1]);
+    ASSERT_EQ(~std::uint64_t(0), snapshot.getPercentile(100));
+}
+
+TEST(HistogramTest, testGetPercentile) {
+    Histogram testling;
+    for (std::uint64_t i = 1; i <= 100; ++i) {
+        testling.add(i);
+    }
+
+    Histogram::Snapshot snapshot = testling.getSnapshot();
+
+    // Upper bounds of the buckets the percentiles fall in
+    ASSERT_EQ(63U, snapshot.getPercentile(50));
+    ASSERT_EQ(100U, snapshot.getPercentile(99));
+    ASSERT_EQ(1U, snapshot.getPercentile(1));
+}
+
+TEST(HistogramTest, testReset) {
+    Histogram testling;
+    testling.add(10);
+
+    testling.reset();
+
+    Histogram::Snapshot snapshot = testling.getSnapshot();
+    ASSERT_EQ(0U, snapshot.count);
+    ASSERT_EQ(0U, snapshot.max);
+    ASSERT_EQ(0U, snapshot.buckets[4]);
+}
+
+TEST(HistogramTest, testAdd_MultipleThreads) {
+    Histogram testling;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.push_back(std::thread([&testling, i]() {
+            for (std::uint64_t j = 0; j < 10000; ++j) {
+                testling.add(j + i);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Histogram::Snapshot snapshot = testling.getSnapshot();
+    ASSERT_EQ(40000U, snapshot.count);
+    ASSERT_EQ(10002U, snapshot.max);
+}
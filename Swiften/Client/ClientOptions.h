@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,6 +11,7 @@
 #include <Swiften/Base/API.h>
 #include <Swiften/Base/SafeString.h>
 #include <Swiften/Base/URL.h>
+#include <Swiften/Compress/ZLibCompressor.h>
 #include <Swiften/TLS/TLSOptions.h>
 
 namespace Swift {
@@ -40,6 +41,14 @@ namespace Swift {
          */
         bool useStreamCompression = true;
 
+        /**
+         * The zlib parameters for compressing the stream, when stream
+         * compression is used.
+         *
+         * Default: level 9, 32 KB window, memory level 8
+         */
+        ZLibCompressor::Options streamCompressionOptions;
+
         /**
          * Sets whether TLS encryption should be used.
          *
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -40,6 +40,7 @@ CoreClient::CoreClient(const JID& jid, const SafeByteArray& password, NetworkFac
 
     iqRouter_ = new IQRouter(stanzaChannel_);
     iqRouter_->setJID(jid);
+    iqRouter_->setTimerFactory(networkFactories->getTimerFactory());
 }
 
 CoreClient::~CoreClient() {
@@ -141,6 +142,7 @@ void CoreClient::connect(const ClientOptions& o) {
             options.tlsOptions,
             options.httpTrafficFilter));
         sessionStream_ = boshSessionStream_;
+        sessionStream_->setMetrics(streamMetrics_);
         sessionStream_->onDataRead.connect(boost::bind(&CoreClient::handleDataRead, this, _1));
         sessionStream_->onDataWritten.connect(boost::bind(&CoreClient::handleDataWritten, this, _1));
         if (certificate_ && !certificate_->isNull()) {
@@ -206,10 +208,14 @@ void CoreClient::handleConnectorFinished(std::shared_ptr<Connection> connection,
 
         connection_ = connection;
 
-        sessionStream_ = std::make_shared<BasicSessionStream>(ClientStreamType, connection_, getPayloadParserFactories(), getPayloadSerializers(), networkFactories->getTLSContextFactory(), networkFactories->getTimerFactory(), networkFactories->getXMLParserFactory(), options.tlsOptions);
+        std::shared_ptr<BasicSessionStream> basicSessionStream = std::make_shared<BasicSessionStream>(ClientStreamType, connection_, getPayloadParserFactories(), getPayloadSerializers(), networkFactories->getTLSContextFactory(), networkFactories->getTimerFactory(), networkFactories->getXMLParserFactory(), options.tlsOptions);
+        basicSessionStream->setCompressionOptions(options.streamCompressionOptions);
+        sessionStream_ = basicSessionStream;
+        sessionStream_->setMetrics(streamMetrics_);
         if (certificate_) {
             sessionStream_->setTLSCertificate(certificate_);
         }
+        sessionStream_->setTLSServerIdentity(jid_.getDomain());
         sessionStream_->onDataRead.connect(boost::bind(&CoreClient::handleDataRead, this, _1));
         sessionStream_->onDataWritten.connect(boost::bind(&CoreClient::handleDataWritten, this, _1));
 
@@ -405,6 +411,13 @@ void CoreClient::setCertificateTrustChecker(CertificateTrustChecker* checker) {
     certificateTrustChecker = checker;
 }
 
+void CoreClient::setStreamMetrics(std::shared_ptr<StreamMetrics> metrics) {
+    streamMetrics_ = metrics;
+    if (sessionStream_) {
+        sessionStream_->setMetrics(metrics);
+    }
+}
+
 
 void CoreClient::handlePresenceReceived(Presence::ref presence) {
     onPresenceReceived(presence);
@@ -34,6 +34,7 @@ namespace Swift {
     class SessionStream;
     class Stanza;
     class StanzaChannel;
+    class StreamMetrics;
 
     /**
      * The central class for communicating with an XMPP server.
@@ -141,6 +142,17 @@ namespace Swift {
              */
             void setCertificateTrustChecker(CertificateTrustChecker*);
 
+            /**
+             * Sets the metrics to collect for the stream to the server, or
+             * nullptr to stop collecting them. The same metrics are used
+             * after reconnecting.
+             */
+            void setStreamMetrics(std::shared_ptr<StreamMetrics> metrics);
+
+            std::shared_ptr<StreamMetrics> getStreamMetrics() const {
+                return streamMetrics_;
+            }
+
         public:
             /**
              * Emitted when the client was disconnected from the network.
@@ -236,5 +248,6 @@ namespace Swift {
             CertificateWithKey::ref certificate_;
             bool disconnectRequested_;
             CertificateTrustChecker* certificateTrustChecker;
+            std::shared_ptr<StreamMetrics> streamMetrics_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -29,6 +29,7 @@ CoreComponent::CoreComponent(const JID& jid, const std::string& secret, NetworkF
 
     iqRouter_ = new IQRouter(stanzaChannel_);
     iqRouter_->setFrom(jid);
+    iqRouter_->setTimerFactory(networkFactories->getTimerFactory());
 }
 
 CoreComponent::~CoreComponent() {
@@ -65,6 +66,7 @@ void CoreComponent::handleConnectorFinished(std::shared_ptr<Connection> connecti
 
         assert(!sessionStream_);
         sessionStream_ = std::make_shared<BasicSessionStream>(ComponentStreamType, connection_, getPayloadParserFactories(), getPayloadSerializers(), nullptr, networkFactories->getTimerFactory(), networkFactories->getXMLParserFactory(), TLSOptions());
+        sessionStream_->setMetrics(streamMetrics_);
         sessionStream_->onDataRead.connect(boost::bind(&CoreComponent::handleDataRead, this, _1));
         sessionStream_->onDataWritten.connect(boost::bind(&CoreComponent::handleDataWritten, this, _1));
 
@@ -166,4 +168,11 @@ void CoreComponent::sendData(const std::string& data) {
     sessionStream_->writeData(data);
 }
 
+void CoreComponent::setStreamMetrics(std::shared_ptr<StreamMetrics> metrics) {
+    streamMetrics_ = metrics;
+    if (sessionStream_) {
+        sessionStream_->setMetrics(metrics);
+    }
+}
+
 }
@@ -30,6 +30,7 @@ namespace Swift {
     class ComponentSession;
     class IQRouter;
     class NetworkFactories;
+    class StreamMetrics;
 
     /**
      * The central class for communicating with an XMPP server as a component.
@@ -72,6 +73,12 @@ namespace Swift {
                 return jid_;
             }
 
+            /**
+             * Sets the metrics to collect for the stream to the server, or
+             * nullptr to stop collecting them.
+             */
+            void setStreamMetrics(std::shared_ptr<StreamMetrics> metrics);
+
         public:
             boost::signals2::signal<void (const ComponentError&)> onError;
             boost::signals2::signal<void ()> onConnected;
@@ -98,6 +105,7 @@ namespace Swift {
             std::shared_ptr<Connection> connection_;
             std::shared_ptr<BasicSessionStream> sessionStream_;
             std::shared_ptr<ComponentSession> session_;
+            std::shared_ptr<StreamMetrics> streamMetrics_;
             bool disconnectRequested_;
     };
 }
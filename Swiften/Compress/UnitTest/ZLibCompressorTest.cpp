@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,6 +11,7 @@
 
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/Compress/ZLibCompressor.h>
+#include <Swiften/Compress/ZLibDecompressor.h>
 
 using namespace Swift;
 
@@ -20,6 +21,10 @@ class ZLibCompressorTest : public CppUnit::TestFixture
         CPPUNIT_TEST_SUITE(ZLibCompressorTest);
         CPPUNIT_TEST(testProcess);
         CPPUNIT_TEST(testProcess_Twice);
+        CPPUNIT_TEST(testProcess_IntoBuffer);
+        CPPUNIT_TEST(testProcess_Options);
+        CPPUNIT_TEST(testProcess_InvalidOptions);
+        CPPUNIT_TEST(testProcess_Incompressible);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -39,6 +44,55 @@ class ZLibCompressorTest : public CppUnit::TestFixture
 
             CPPUNIT_ASSERT_EQUAL(createSafeByteArray("\x4a\x4a\x2c\x02\x00\x00\x00\xff\xff",9), result);
         }
+
+        void testProcess_IntoBuffer() {
+            ZLibCompressor testling;
+            SafeByteArray result(createSafeByteArray("previous contents"));
+            testling.process(createSafeByteArray("foo"), result);
+            testling.process(createSafeByteArray("bar"), result);
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("\x4a\x4a\x2c\x02\x00\x00\x00\xff\xff",9), result);
+        }
+
+        void testProcess_Options() {
+            ZLibCompressor::Options options;
+            options.level = 1;
+            options.windowBits = 10;
+            options.memoryLevel = 2;
+            ZLibCompressor testling(options);
+            SafeByteArray original(createSafeByteArray("<message to='alice@wonderland.lit'><body>Hi</body></message><message to='alice@wonderland.lit'><body>Hi</body></message>"));
+
+            SafeByteArray result = testling.process(original);
+
+            CPPUNIT_ASSERT(result.size() < original.size());
+            CPPUNIT_ASSERT_EQUAL(original, ZLibDecompressor().process(result));
+        }
+
+        void testProcess_InvalidOptions() {
+            ZLibCompressor::Options options;
+            options.level = 10;
+            options.windowBits = 16;
+            options.memoryLevel = 0;
+            ZLibCompressor testling(options);
+
+            SafeByteArray result = testling.process(createSafeByteArray("foo"));
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("\x78\xda\x4a\xcb\xcf\x07\x00\x00\x00\xff\xff", 11), result);
+        }
+
+        void testProcess_Incompressible() {
+            SafeByteArray original;
+            unsigned int state = 1;
+            for (size_t i = 0; i < 5000; ++i) {
+                state = state * 1103515245 + 12345;
+                original.push_back(static_cast<unsigned char>(state >> 16));
+            }
+            ZLibCompressor testling;
+
+            SafeByteArray result = testling.process(original);
+
+            CPPUNIT_ASSERT_EQUAL(original, ZLibDecompressor().process(result));
+        }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ZLibCompressorTest);
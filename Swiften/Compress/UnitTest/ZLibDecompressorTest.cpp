@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -25,6 +25,9 @@ class ZLibDecompressorTest : public CppUnit::TestFixture
         CPPUNIT_TEST(testProcess_Invalid);
         CPPUNIT_TEST(testProcess_Huge);
         CPPUNIT_TEST(testProcess_ChunkSize);
+        CPPUNIT_TEST(testProcess_HighRatio);
+        CPPUNIT_TEST(testProcess_IntoBuffer);
+        CPPUNIT_TEST(testProcess_AfterHighRatio);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -75,6 +78,41 @@ class ZLibDecompressorTest : public CppUnit::TestFixture
 
             CPPUNIT_ASSERT_EQUAL(original, decompressed);
         }
+
+        void testProcess_HighRatio() {
+            ZLibCompressor compressor;
+            ZLibDecompressor testling;
+            SafeByteArray small(createSafeByteArray("<presence/>"));
+            SafeByteArray large(100000, 'a');
+
+            // The output estimate is based on the first ratio, which is much
+            // lower than the second one
+            CPPUNIT_ASSERT_EQUAL(small, testling.process(compressor.process(small)));
+            CPPUNIT_ASSERT_EQUAL(large, testling.process(compressor.process(large)));
+        }
+
+        void testProcess_IntoBuffer() {
+            ZLibDecompressor testling;
+            SafeByteArray result(10000, 'x');
+            testling.process(createSafeByteArray("\x78\xda\x4a\xcb\xcf\x07\x00\x00\x00\xff\xff", 11), result);
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("foo"), result);
+        }
+
+        void testProcess_AfterHighRatio() {
+            ZLibCompressor compressor;
+            ZLibDecompressor testling;
+            SafeByteArray large(1000000, 'a');
+            SafeByteArray small(createSafeByteArray("<presence/>"));
+            CPPUNIT_ASSERT_EQUAL(large, testling.process(compressor.process(large)));
+
+            // The ratio of the first data does not make every later buffer huge
+            SafeByteArray result;
+            testling.process(compressor.process(small), result);
+
+            CPPUNIT_ASSERT_EQUAL(small, result);
+            CPPUNIT_ASSERT(result.capacity() <= 16 * 1024);
+        }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ZLibDecompressorTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,6 +8,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <cassert>
 
 #include <boost/numeric/conversion/cast.hpp>
@@ -20,6 +21,8 @@
 namespace Swift {
 
 static const size_t CHUNK_SIZE = 1024; // If you change this, also change the unittest
+// The ratio of earlier data is up to the peer, so don't trust it too much
+static const size_t MAX_OUTPUT_SIZE_ESTIMATE = 16 * CHUNK_SIZE;
 
 
 ZLibCodecompressor::ZLibCodecompressor() : p(new Private()) {
@@ -34,25 +37,52 @@ ZLibCodecompressor::~ZLibCodecompressor() {
 
 SafeByteArray ZLibCodecompressor::process(const SafeByteArray& input) {
     SafeByteArray output;
+    process(input, output);
+    return output;
+}
+
+void ZLibCodecompressor::process(const SafeByteArray& input, SafeByteArray& output) {
     p->stream.avail_in = static_cast<unsigned int>(input.size());
     p->stream.next_in = reinterpret_cast<Bytef*>(const_cast<unsigned char*>(vecptr(input)));
+
+    // Start from an estimate of the output size, and double the buffer if
+    // it turns out to be too small, instead of growing it chunk by chunk.
+    // Whatever the buffer holds already is overwritten rather than cleared,
+    // so only the part it grows by gets zeroed.
+    size_t estimate = std::min(MAX_OUTPUT_SIZE_ESTIMATE, std::max(CHUNK_SIZE, getOutputSizeEstimate(input.size())));
+    if (output.size() < estimate) {
+        output.resize(estimate);
+    }
     size_t outputPosition = 0;
-    do {
-        output.resize(outputPosition + CHUNK_SIZE);
-        p->stream.avail_out = CHUNK_SIZE;
+    while (true) {
+        size_t available = output.size() - outputPosition;
+        p->stream.avail_out = static_cast<unsigned int>(available);
         p->stream.next_out = reinterpret_cast<Bytef*>(vecptr(output) + outputPosition);
         int result = processZStream();
         if (result != Z_OK && result != Z_BUF_ERROR) {
             throw ZLibException(/* p->stream.msg */);
         }
-        outputPosition += CHUNK_SIZE;
+        outputPosition += available - p->stream.avail_out;
+        if (p->stream.avail_out != 0) {
+            break;
+        }
+        output.resize(2 * output.size());
     }
-    while (p->stream.avail_out == 0);
     if (p->stream.avail_in != 0) {
         throw ZLibException();
     }
-    output.resize(outputPosition - p->stream.avail_out);
-    return output;
+    output.resize(outputPosition);
+
+    p->totalInput += input.size();
+    p->totalOutput += outputPosition;
+}
+
+size_t ZLibCodecompressor::getOutputSizeEstimate(size_t inputSize) const {
+    if (p->totalInput == 0) {
+        return inputSize;
+    }
+    // Round the ratio up, and leave some room for the flush
+    return static_cast<size_t>(inputSize * ((p->totalOutput + p->totalInput - 1) / p->totalInput)) + CHUNK_SIZE;
 }
 
 }
@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include <Swiften/Base/API.h>
@@ -18,8 +19,27 @@ namespace Swift {
             virtual ~ZLibCodecompressor();
 
             SafeByteArray process(const SafeByteArray& data);
+
+            /**
+             * Processes the data into the given output buffer, replacing its
+             * contents. Passing the same buffer every time avoids allocating
+             * a new one for every call.
+             */
+            void process(const SafeByteArray& data, SafeByteArray& output);
+
             virtual int processZStream() = 0;
 
+        protected:
+            /**
+             * Returns how much output to expect for the given amount of input.
+             * The output buffer grows if the estimate is too small. Estimates
+             * above 16 KiB are capped.
+             *
+             * By default, this assumes the same ratio as all data processed
+             * before.
+             */
+            virtual size_t getOutputSizeEstimate(size_t inputSize) const;
+
         protected:
             struct Private;
             const std::unique_ptr<Private> p;
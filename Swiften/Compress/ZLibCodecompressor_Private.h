@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2016 Isode Limited.
+ * Copyright (c) 2012-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,6 +12,10 @@
 
 namespace Swift {
     struct ZLibCodecompressor::Private {
+        Private() : totalInput(0), totalOutput(0) {}
+
         z_stream stream;
+        unsigned long long totalInput;
+        unsigned long long totalOutput;
     };
 }
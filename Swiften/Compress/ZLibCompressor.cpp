@@ -1,24 +1,30 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Compress/ZLibCompressor.h>
 
-#include <cassert>
 #include <zlib.h>
 
+#include <Swiften/Base/Log.h>
 #include <Swiften/Compress/ZLibCodecompressor_Private.h>
+#include <Swiften/Compress/ZLibException.h>
 
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 
 namespace Swift {
 
-ZLibCompressor::ZLibCompressor() {
-    int result = deflateInit(&p->stream, COMPRESSION_LEVEL);
-    assert(result == Z_OK);
-    (void) result;
+ZLibCompressor::ZLibCompressor(const Options& options) {
+    Options validOptions(options);
+    if (!options.isValid()) {
+        SWIFT_LOG(warning) << "Invalid compression options (level " << options.level << ", window bits " << options.windowBits << ", memory level " << options.memoryLevel << "); using the defaults" << std::endl;
+        validOptions = Options();
+    }
+    if (deflateInit2(&p->stream, validOptions.level, Z_DEFLATED, validOptions.windowBits, validOptions.memoryLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw ZLibException();
+    }
 }
 
 ZLibCompressor::~ZLibCompressor() {
@@ -29,4 +35,9 @@ int ZLibCompressor::processZStream() {
     return deflate(&p->stream, Z_SYNC_FLUSH);
 }
 
+size_t ZLibCompressor::getOutputSizeEstimate(size_t inputSize) const {
+    // The bound does not include the empty block ending a sync flush
+    return deflateBound(&p->stream, static_cast<uLong>(inputSize)) + 6;
+}
+
 }
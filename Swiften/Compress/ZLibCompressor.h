@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,12 +12,47 @@
 namespace Swift {
     class SWIFTEN_API ZLibCompressor : public ZLibCodecompressor {
         public:
-            ZLibCompressor();
+            /**
+             * The zlib parameters used for compressing (see deflateInit2()).
+             */
+            struct Options {
+                Options() : level(9), windowBits(15), memoryLevel(8) {}
+
+                /**
+                 * From 1 (fastest) to 9 (smallest output), or 0 for no
+                 * compression.
+                 */
+                int level;
+
+                /**
+                 * The base two logarithm of the window size, from 9 to 15.
+                 * Smaller windows use less memory, but compress worse.
+                 */
+                int windowBits;
+
+                /**
+                 * How much memory to use for the compression state, from 1 to
+                 * 9. More memory makes compression faster and better.
+                 */
+                int memoryLevel;
+
+                bool isValid() const {
+                    return level >= 0 && level <= 9 && windowBits >= 9 && windowBits <= 15 && memoryLevel >= 1 && memoryLevel <= 9;
+                }
+            };
+
+        public:
+            /**
+             * Invalid options are replaced by the defaults.
+             *
+             * @throws ZLibException if zlib can't be initialized.
+             */
+            ZLibCompressor(const Options& options = Options());
             virtual ~ZLibCompressor();
 
             virtual int processZStream();
 
-        private:
-            static const int COMPRESSION_LEVEL = 9;
+        protected:
+            virtual size_t getOutputSizeEstimate(size_t inputSize) const;
     };
 }
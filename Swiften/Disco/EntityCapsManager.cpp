@@ -6,6 +6,9 @@
 
 #include <Swiften/Disco/EntityCapsManager.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <boost/bind.hpp>
 
 #include <Swiften/Client/StanzaChannel.h>
@@ -22,12 +25,12 @@ EntityCapsManager::EntityCapsManager(CapsProvider* capsProvider, StanzaChannel*
 void EntityCapsManager::handlePresenceReceived(std::shared_ptr<Presence> presence) {
     JID from = presence->getFrom();
     if (presence->isAvailable()) {
-        std::shared_ptr<CapsInfo> capsInfo = presence->getPayload<CapsInfo>();
-        if (!capsInfo || capsInfo->getHash() != "sha-1" || presence->getPayload<ErrorPayload>()) {
+        const CapsInfo* capsInfo = presence->getPayloadPtr<CapsInfo>();
+        if (!capsInfo || capsInfo->getHash() != "sha-1" || presence->getPayloadPtr<ErrorPayload>()) {
             return;
         }
         std::string hash = capsInfo->getVersion();
-        std::map<JID, std::string>::iterator i = caps.find(from);
+        std::unordered_map<JID, std::string>::iterator i = caps.find(from);
         if (i == caps.end() || i->second != hash) {
             caps.insert(std::make_pair(from, hash));
             DiscoInfo::ref disco = capsProvider->getCaps(hash);
@@ -41,7 +44,7 @@ void EntityCapsManager::handlePresenceReceived(std::shared_ptr<Presence> presenc
         }
     }
     else {
-        std::map<JID, std::string>::iterator i = caps.find(from);
+        std::unordered_map<JID, std::string>::iterator i = caps.find(from);
         if (i != caps.end()) {
             caps.erase(i);
             onCapsChanged(from);
@@ -51,25 +54,37 @@ void EntityCapsManager::handlePresenceReceived(std::shared_ptr<Presence> presenc
 
 void EntityCapsManager::handleStanzaChannelAvailableChanged(bool available) {
     if (available) {
-        std::map<JID, std::string> capsCopy;
-        capsCopy.swap(caps);
-        for (std::map<JID,std::string>::const_iterator i = capsCopy.begin(); i != capsCopy.end(); ++i) {
-            onCapsChanged(i->first);
+        std::vector<JID> changedJIDs;
+        changedJIDs.reserve(caps.size());
+        for (const auto& entry : caps) {
+            changedJIDs.push_back(entry.first);
         }
+        caps.clear();
+        notifyCapsChanged(changedJIDs);
     }
 }
 
 void EntityCapsManager::handleCapsAvailable(const std::string& hash) {
     // TODO: Use Boost.Bimap ?
-    for (std::map<JID,std::string>::const_iterator i = caps.begin(); i != caps.end(); ++i) {
-        if (i->second == hash) {
-            onCapsChanged(i->first);
+    std::vector<JID> changedJIDs;
+    for (const auto& entry : caps) {
+        if (entry.second == hash) {
+            changedJIDs.push_back(entry.first);
         }
     }
+    notifyCapsChanged(changedJIDs);
+}
+
+void EntityCapsManager::notifyCapsChanged(std::vector<JID>& jids) {
+    // Keep the notifications in a predictable order, independent of the hashing
+    std::sort(jids.begin(), jids.end());
+    for (const auto& jid : jids) {
+        onCapsChanged(jid);
+    }
 }
 
 DiscoInfo::ref EntityCapsManager::getCaps(const JID& jid) const {
-    std::map<JID, std::string>::const_iterator i = caps.find(jid);
+    std::unordered_map<JID, std::string>::const_iterator i = caps.find(jid);
     if (i != caps.end()) {
         return capsProvider->getCaps(i->second);
     }
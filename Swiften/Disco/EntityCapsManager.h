@@ -6,7 +6,8 @@
 
 #pragma once
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/signals2.hpp>
 
@@ -42,10 +43,11 @@ namespace Swift {
             void handlePresenceReceived(std::shared_ptr<Presence>);
             void handleStanzaChannelAvailableChanged(bool);
             void handleCapsAvailable(const std::string&);
+            void notifyCapsChanged(std::vector<JID>&);
 
         private:
             CapsProvider* capsProvider;
-            std::map<JID, std::string> caps;
+            std::unordered_map<JID, std::string> caps;
             LRUCache<std::string, DiscoInfo::ref, 64> lruDiscoCache;
     };
 }
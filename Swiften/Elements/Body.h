@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,6 +14,7 @@
 namespace Swift {
     class SWIFTEN_API Body : public Payload {
         public:
+            SWIFTEN_PAYLOAD_TYPE(Body)
             Body(const std::string& text = "") : text_(text) {
             }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,7 @@ namespace Swift {
     class SWIFTEN_API CapsInfo : public Payload {
         public:
             typedef std::shared_ptr<CapsInfo> ref;
+            SWIFTEN_PAYLOAD_TYPE(CapsInfo)
 
             CapsInfo(const std::string& node = "", const std::string& version = "", const std::string& hash = "sha-1") : node_(node), version_(version), hash_(hash) {}
 
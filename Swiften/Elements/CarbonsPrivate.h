@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -15,6 +15,7 @@ namespace Swift {
     class SWIFTEN_API CarbonsPrivate : public Payload {
         public:
             typedef std::shared_ptr<CarbonsPrivate> ref;
+            SWIFTEN_PAYLOAD_TYPE(CarbonsPrivate)
 
         public:
             virtual ~CarbonsPrivate();
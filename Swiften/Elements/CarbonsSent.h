@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,7 @@ namespace Swift {
     class SWIFTEN_API CarbonsSent : public Payload {
         public:
             typedef std::shared_ptr<CarbonsSent> ref;
+            SWIFTEN_PAYLOAD_TYPE(CarbonsSent)
 
         public:
             virtual ~CarbonsSent();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -15,6 +15,7 @@ namespace Swift {
     class SWIFTEN_API ChatState : public Payload {
         public:
             typedef std::shared_ptr<ChatState> ref;
+            SWIFTEN_PAYLOAD_TYPE(ChatState)
 
         public:
             enum ChatStateType {Active, Composing, Paused, Inactive, Gone};
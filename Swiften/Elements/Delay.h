@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,7 @@
 namespace Swift {
     class SWIFTEN_API Delay : public Payload {
         public:
+            SWIFTEN_PAYLOAD_TYPE(Delay)
             Delay() {}
             Delay(const boost::posix_time::ptime& time, const JID& from = JID()) : time_(time), from_(from) {}
 
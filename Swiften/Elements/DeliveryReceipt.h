@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,6 +22,7 @@ namespace Swift {
 class SWIFTEN_API DeliveryReceipt : public Payload {
     public:
         typedef std::shared_ptr<DeliveryReceipt> ref;
+        SWIFTEN_PAYLOAD_TYPE(DeliveryReceipt)
 
     public:
         DeliveryReceipt() {}
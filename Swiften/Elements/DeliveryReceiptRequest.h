@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,7 @@ namespace Swift {
 class SWIFTEN_API DeliveryReceiptRequest : public Payload {
     public:
         typedef std::shared_ptr<DeliveryReceiptRequest> ref;
+        SWIFTEN_PAYLOAD_TYPE(DeliveryReceiptRequest)
 
     public:
         DeliveryReceiptRequest() {}
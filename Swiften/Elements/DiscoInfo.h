@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,7 @@ namespace Swift {
     class SWIFTEN_API DiscoInfo : public Payload {
         public:
             typedef std::shared_ptr<DiscoInfo> ref;
+            SWIFTEN_PAYLOAD_TYPE(DiscoInfo)
 
             static const std::string ChatStatesFeature;
             static const std::string ClientStatesFeature;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,7 @@ namespace Swift {
     class SWIFTEN_API ErrorPayload : public Payload {
         public:
             typedef std::shared_ptr<ErrorPayload> ref;
+            SWIFTEN_PAYLOAD_TYPE(ErrorPayload)
 
             enum Type { Cancel, Continue, Modify, Auth, Wait };
 
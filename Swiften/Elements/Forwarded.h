@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2016 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -18,6 +18,7 @@ namespace Swift {
     class SWIFTEN_API Forwarded : public Payload {
         public:
             typedef std::shared_ptr<Forwarded> ref;
+            SWIFTEN_PAYLOAD_TYPE(Forwarded)
 
         public:
             virtual ~Forwarded();
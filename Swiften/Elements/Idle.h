@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -24,6 +24,7 @@ namespace Swift {
     class SWIFTEN_API Idle : public Payload {
     public:
         typedef std::shared_ptr<Idle> ref;
+        SWIFTEN_PAYLOAD_TYPE(Idle)
 
     public:
         Idle() {}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,7 @@ namespace Swift {
     class SWIFTEN_API MUCInvitationPayload : public Payload {
         public:
             typedef std::shared_ptr<MUCInvitationPayload> ref;
+            SWIFTEN_PAYLOAD_TYPE(MUCInvitationPayload)
             MUCInvitationPayload() : continuation_(false), impromptu_(false) {
             }
 
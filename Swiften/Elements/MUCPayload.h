@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,6 +19,7 @@ namespace Swift {
     class SWIFTEN_API MUCPayload : public Payload {
         public:
             typedef std::shared_ptr<MUCPayload> ref;
+            SWIFTEN_PAYLOAD_TYPE(MUCPayload)
 
             MUCPayload() {
                 maxChars_ = -1;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,6 +22,7 @@ namespace Swift {
     class SWIFTEN_API MUCUserPayload : public Payload {
         public:
             typedef std::shared_ptr<MUCUserPayload> ref;
+            SWIFTEN_PAYLOAD_TYPE(MUCUserPayload)
 
             struct StatusCode {
                 StatusCode() : code(0) {}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -28,7 +28,7 @@ namespace Swift {
             Message() : type_(Chat) { }
 
             std::string getSubject() const {
-                std::shared_ptr<Subject> subject(getPayload<Subject>());
+                const Subject* subject = getPayloadPtr<Subject>();
                 if (subject) {
                     return subject->getText();
                 }
@@ -40,11 +40,11 @@ namespace Swift {
             }
 
             bool hasSubject() {
-                return getPayload<Subject>() != nullptr;
+                return getPayloadPtr<Subject>() != nullptr;
             }
 
             boost::optional<std::string> getBody() const {
-                std::shared_ptr<Body> body(getPayload<Body>());
+                const Body* body = getPayloadPtr<Body>();
                 boost::optional<std::string> bodyData;
                 if (body) {
                     bodyData = body->getText();
@@ -66,8 +66,7 @@ namespace Swift {
             }
 
             bool isError() {
-                std::shared_ptr<Swift::ErrorPayload> error(getPayload<Swift::ErrorPayload>());
-                return getType() == Message::Error || error;
+                return getType() == Message::Error || getPayloadPtr<Swift::ErrorPayload>() != nullptr;
             }
 
             Type getType() const { return type_; }
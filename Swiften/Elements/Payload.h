@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,19 +7,75 @@
 #pragma once
 
 #include <memory>
+#include <type_traits>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Element.h>
 
+/**
+ * Gives a payload class its own type ID, so that Stanza::getPayloadPtr() and
+ * friends can find payloads of this class by comparing IDs instead of using
+ * dynamic_cast. Use it in the public section of the class.
+ *
+ * Since lookups of a registered class only compare IDs, a registered class
+ * must not have registered subclasses.
+ */
+#define SWIFTEN_PAYLOAD_TYPE(cls) \
+        typedef cls PayloadTypeClass; \
+        static Swift::Payload::TypeID getStaticTypeID() { \
+            static const char id = 0; \
+            return &id; \
+        } \
+        virtual Swift::Payload::TypeID getTypeID() const override { \
+            return getStaticTypeID(); \
+        }
+
 namespace Swift {
     class SWIFTEN_API Payload : public Element {
         public:
             typedef std::shared_ptr<Payload> ref;
+            typedef const void* TypeID;
+
         public:
             Payload() {}
             SWIFTEN_DEFAULT_COPY_CONSTRUCTOR(Payload)
             virtual ~Payload();
 
             SWIFTEN_DEFAULT_COPY_ASSIGMNENT_OPERATOR(Payload)
+
+            /**
+             * Returns the type ID of the class of this payload, or nullptr
+             * if the class has not been registered with SWIFTEN_PAYLOAD_TYPE.
+             */
+            virtual TypeID getTypeID() const {
+                return nullptr;
+            }
     };
+
+    namespace Detail {
+        template<typename T, typename Enable = void>
+        struct PayloadCast {
+            static T* cast(Payload* payload) {
+                return dynamic_cast<T*>(payload);
+            }
+        };
+
+        template<typename T>
+        struct PayloadCast<T, typename std::enable_if<std::is_same<typename T::PayloadTypeClass, T>::value>::type> {
+            static T* cast(Payload* payload) {
+                return payload->getTypeID() == T::getStaticTypeID() ? static_cast<T*>(payload) : nullptr;
+            }
+        };
+    }
+
+    /**
+     * Returns the payload as a T, or nullptr if it is not a T.
+     *
+     * This only compares type IDs if T is registered with SWIFTEN_PAYLOAD_TYPE,
+     * and falls back to dynamic_cast otherwise.
+     */
+    template<typename T>
+    T* payloadCast(Payload* payload) {
+        return Detail::PayloadCast<T>::cast(payload);
+    }
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,7 +22,7 @@ Presence::~Presence() {
 }
 
 int Presence::getPriority() const {
-    std::shared_ptr<Priority> priority(getPayload<Priority>());
+    const Priority* priority = getPayloadPtr<Priority>();
     return (priority ? priority->getPriority() : 0);
 }
 
@@ -31,7 +31,7 @@ void Presence::setPriority(int priority) {
 }
 
 std::string Presence::getStatus() const {
-    std::shared_ptr<Status> status(getPayload<Status>());
+    const Status* status = getPayloadPtr<Status>();
     if (status) {
         return status->getText();
     }
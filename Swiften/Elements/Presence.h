@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -40,7 +40,7 @@ namespace Swift {
             void setType(Type type) { type_ = type; }
 
             StatusShow::Type getShow() const {
-                std::shared_ptr<StatusShow> show(getPayload<StatusShow>());
+                const StatusShow* show = getPayloadPtr<StatusShow>();
                 if (show) {
                     return show->getType();
                 }
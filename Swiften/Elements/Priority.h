@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,6 +12,7 @@
 namespace Swift {
     class SWIFTEN_API Priority : public Payload {
         public:
+            SWIFTEN_PAYLOAD_TYPE(Priority)
             Priority(int priority = 0) : priority_(priority) {
             }
 
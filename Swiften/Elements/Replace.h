@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,6 +22,7 @@ namespace Swift {
     class SWIFTEN_API Replace : public Payload {
         public:
             typedef std::shared_ptr<Replace> ref;
+            SWIFTEN_PAYLOAD_TYPE(Replace)
             Replace(const std::string& id = std::string()) : replaceID_(id) {}
             const std::string& getID() const {
                 return replaceID_;
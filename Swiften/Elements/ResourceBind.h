@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -15,6 +15,7 @@
 namespace Swift {
     class SWIFTEN_API ResourceBind : public Payload {
         public:
+            SWIFTEN_PAYLOAD_TYPE(ResourceBind)
             ResourceBind() {}
 
             void setJID(const JID& jid) {
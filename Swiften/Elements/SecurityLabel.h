@@ -15,6 +15,7 @@
 namespace Swift {
     class SWIFTEN_API SecurityLabel : public Payload {
         public:
+            SWIFTEN_PAYLOAD_TYPE(SecurityLabel)
 
             SecurityLabel();
 
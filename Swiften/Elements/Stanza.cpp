@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -51,14 +51,14 @@ std::shared_ptr<Payload> Stanza::getPayloadOfSameType(std::shared_ptr<Payload> p
 }
 
 boost::optional<boost::posix_time::ptime> Stanza::getTimestamp() const {
-    std::shared_ptr<Delay> delay = getPayload<Delay>();
+    const Delay* delay = getPayloadPtr<Delay>();
     return delay ? delay->getStamp() : boost::optional<boost::posix_time::ptime>();
 }
 
 boost::optional<boost::posix_time::ptime> Stanza::getTimestampFrom(const JID& jid) const {
-    std::vector< std::shared_ptr<Delay> > delays = getPayloads<Delay>();
-    for (auto& delay : delays) {
-        if (delay->getFrom() == jid) {
+    for (const auto& payload : payloads_) {
+        const Delay* delay = payloadCast<Delay>(payload.get());
+        if (delay && delay->getFrom() == jid) {
             return delay->getStamp();
         }
     }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,12 +14,11 @@
 #include <boost/optional/optional.hpp>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Elements/Payload.h>
 #include <Swiften/Elements/ToplevelElement.h>
 #include <Swiften/JID/JID.h>
 
 namespace Swift {
-    class Payload;
-
     class SWIFTEN_API Stanza : public ToplevelElement {
         public:
             typedef std::shared_ptr<Stanza> ref;
@@ -31,14 +30,31 @@ namespace Swift {
             virtual ~Stanza();
             SWIFTEN_DEFAULT_COPY_CONSTRUCTOR(Stanza)
 
+            /**
+             * Returns the first payload of type T, without taking a reference
+             * to it. The pointer is valid as long as the payload is part of
+             * this stanza.
+             *
+             * For payload classes registered with SWIFTEN_PAYLOAD_TYPE, this
+             * only compares type IDs.
+             */
             template<typename T>
-            std::shared_ptr<T> getPayload() const {
+            T* getPayloadPtr() const {
                 for (const auto& payload : payloads_) {
-                    std::shared_ptr<T> result(std::dynamic_pointer_cast<T>(payload));
-                    if (result) {
+                    if (T* result = payloadCast<T>(payload.get())) {
                         return result;
                     }
                 }
+                return nullptr;
+            }
+
+            template<typename T>
+            std::shared_ptr<T> getPayload() const {
+                for (const auto& payload : payloads_) {
+                    if (T* result = payloadCast<T>(payload.get())) {
+                        return std::shared_ptr<T>(payload, result);
+                    }
+                }
                 return std::shared_ptr<T>();
             }
 
@@ -46,15 +62,13 @@ namespace Swift {
             std::vector< std::shared_ptr<T> > getPayloads() const {
                 std::vector< std::shared_ptr<T> > results;
                 for (const auto& payload : payloads_) {
-                    std::shared_ptr<T> result(std::dynamic_pointer_cast<T>(payload));
-                    if (result) {
-                        results.push_back(result);
+                    if (T* result = payloadCast<T>(payload.get())) {
+                        results.push_back(std::shared_ptr<T>(payload, result));
                     }
                 }
                 return results;
             }
 
-
             const std::vector< std::shared_ptr<Payload> >& getPayloads() const {
                 return payloads_;
             }
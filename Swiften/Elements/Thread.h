@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,6 +14,7 @@
 namespace Swift {
     class SWIFTEN_API Thread : public Payload {
         public:
+            SWIFTEN_PAYLOAD_TYPE(Thread)
             Thread(const std::string& text = "", const std::string& parent = "");
             virtual ~Thread();
             void setText(const std::string& text);
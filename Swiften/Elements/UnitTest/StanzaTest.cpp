@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -25,6 +25,10 @@ class StanzaTest : public CppUnit::TestFixture
         CPPUNIT_TEST(testGetPayload);
         CPPUNIT_TEST(testGetPayloads);
         CPPUNIT_TEST(testGetPayload_NoSuchPayload);
+        CPPUNIT_TEST(testGetPayloadPtr);
+        CPPUNIT_TEST(testGetPayloadPtr_NoSuchPayload);
+        CPPUNIT_TEST(testGetPayloadPtr_UnregisteredType);
+        CPPUNIT_TEST(testGetPayloadPtr_SubclassOfRegisteredType);
         CPPUNIT_TEST(testDestructor);
         CPPUNIT_TEST(testDestructor_Copy);
         CPPUNIT_TEST(testUpdatePayload_ExistingPayload);
@@ -56,6 +60,18 @@ class StanzaTest : public CppUnit::TestFixture
                 MyPayload3() {}
         };
 
+        class MyRegisteredPayload : public Payload {
+            public:
+                SWIFTEN_PAYLOAD_TYPE(MyRegisteredPayload)
+
+                MyRegisteredPayload() {}
+        };
+
+        class MyRegisteredPayloadSubclass : public MyRegisteredPayload {
+            public:
+                MyRegisteredPayloadSubclass() {}
+        };
+
         class DestroyingPayload : public Payload {
             public:
                 DestroyingPayload(bool* alive) : alive_(alive) {
@@ -121,6 +137,43 @@ class StanzaTest : public CppUnit::TestFixture
             CPPUNIT_ASSERT(!p);
         }
 
+        void testGetPayloadPtr() {
+            Message m;
+            std::shared_ptr<MyRegisteredPayload> payload = std::make_shared<MyRegisteredPayload>();
+            m.addPayload(std::make_shared<MyPayload1>());
+            m.addPayload(payload);
+
+            CPPUNIT_ASSERT_EQUAL(payload.get(), m.getPayloadPtr<MyRegisteredPayload>());
+            CPPUNIT_ASSERT_EQUAL(payload, m.getPayload<MyRegisteredPayload>());
+        }
+
+        void testGetPayloadPtr_NoSuchPayload() {
+            Message m;
+            m.addPayload(std::make_shared<MyPayload1>());
+
+            CPPUNIT_ASSERT(!m.getPayloadPtr<MyRegisteredPayload>());
+            CPPUNIT_ASSERT(!m.getPayloadPtr<MyPayload2>());
+        }
+
+        void testGetPayloadPtr_UnregisteredType() {
+            Message m;
+            std::shared_ptr<MyPayload2> payload = std::make_shared<MyPayload2>();
+            m.addPayload(std::make_shared<MyRegisteredPayload>());
+            m.addPayload(payload);
+
+            CPPUNIT_ASSERT_EQUAL(payload.get(), m.getPayloadPtr<MyPayload2>());
+        }
+
+        void testGetPayloadPtr_SubclassOfRegisteredType() {
+            Message m;
+            std::shared_ptr<MyRegisteredPayloadSubclass> payload = std::make_shared<MyRegisteredPayloadSubclass>();
+            m.addPayload(payload);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<MyRegisteredPayload*>(payload.get()), m.getPayloadPtr<MyRegisteredPayload>());
+            CPPUNIT_ASSERT_EQUAL(payload.get(), m.getPayloadPtr<MyRegisteredPayloadSubclass>());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), m.getPayloads<MyRegisteredPayload>().size());
+        }
+
         void testGetPayloads() {
             Message m;
             std::shared_ptr<MyPayload2> payload1(new MyPayload2());
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,7 @@ namespace Swift {
     class SWIFTEN_API VCard : public Payload {
         public:
             typedef std::shared_ptr<VCard> ref;
+            SWIFTEN_PAYLOAD_TYPE(VCard)
 
             struct EMailAddress {
                 EMailAddress() : isHome(false), isWork(false), isInternet(false), isPreferred(false), isX400(false) {
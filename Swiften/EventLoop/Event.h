@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <utility>
 
 #include <boost/function.hpp>
 
@@ -15,7 +16,7 @@
 namespace Swift {
     class Event {
         public:
-            Event(std::shared_ptr<EventOwner> owner, const boost::function<void()>& callback) : id(~0U), owner(owner), callback(callback) {
+            Event(std::shared_ptr<EventOwner> owner, boost::function<void()> callback) : id(~0U), owner(std::move(owner)), callback(std::move(callback)) {
             }
 
             bool operator==(const Event& o) const {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,19 +8,25 @@
 
 #include <algorithm>
 #include <cassert>
-#include <vector>
-
-#include <boost/bind.hpp>
-#include <boost/lambda/bind.hpp>
-#include <boost/lambda/lambda.hpp>
-#include <boost/optional.hpp>
 
+#include <Swiften/Base/Histogram.h>
 #include <Swiften/Base/Log.h>
 
-namespace lambda = boost::lambda;
-
 namespace Swift {
 
+// Must be a power of 2
+static const std::uint64_t QUEUE_SIZE = 1024;
+
+struct EventLoop::Slot {
+    Slot() : sequence(0), event(0, Event(std::shared_ptr<EventOwner>(), boost::function<void()>())) {
+    }
+
+    // The position this slot can be written at next, or that position + 1 once
+    // the slot holds an event.
+    std::atomic<std::uint64_t> sequence;
+    QueuedEvent event;
+};
+
 inline void invokeCallback(const Event& event) {
     try {
         assert(!event.callback.empty());
@@ -34,14 +40,17 @@ inline void invokeCallback(const Event& event) {
     }
 }
 
-EventLoop::EventLoop() : nextEventID_(0), handlingEvents_(false) {
+EventLoop::EventLoop() : nextEventID_(0), nextDequeuedID_(0), pendingEvents_(0), handlingEvents_(false), slots_(new Slot[QUEUE_SIZE]), enqueuePosition_(0), dequeuePosition_(0), overflowing_(false), dispatchLatencyHistogram_(nullptr) {
+    for (std::uint64_t i = 0; i < QUEUE_SIZE; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
 }
 
 EventLoop::~EventLoop() {
 }
 
 void EventLoop::handleNextEvents() {
-    const int eventsBatched = 100;
+    const size_t eventsBatched = 100;
     // If handleNextEvents is already in progress, e.g. in case of a recursive call due to
     // the event loop implementation, then do no handle further events. Instead call
     // eventPosted() to continue event handling later.
@@ -50,20 +59,24 @@ void EventLoop::handleNextEvents() {
         handlingEvents_ = true;
         std::unique_lock<std::recursive_mutex> lock(removeEventsMutex_);
         {
-            std::vector<Event> nextEvents;
-            {
-                std::unique_lock<std::recursive_mutex> lock(eventsMutex_);
-                for (int n = 0; ((n < eventsBatched) && !events_.empty()); n++) {
-                    nextEvents.push_back(events_.front());
-                    events_.pop_front();
+            // Only handle the events that were posted before we started, so events
+            // posted by the callbacks are handled in the next round.
+            size_t eventsToHandle = std::min(eventsBatched, pendingEvents_.load());
+            QueuedEvent event(0, Event(std::shared_ptr<EventOwner>(), boost::function<void()>()));
+            for (size_t n = 0; n < eventsToHandle && popEvent(event); n++) {
+                pendingEvents_--;
+                Histogram* dispatchLatencyHistogram = dispatchLatencyHistogram_.load(std::memory_order_relaxed);
+                if (dispatchLatencyHistogram && event.postTime != std::chrono::steady_clock::time_point()) {
+                    dispatchLatencyHistogram->add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - event.postTime).count()));
                 }
-                callEventPosted = !events_.empty();
-            }
-            if (!nextEvents.empty()) {
-                for (const auto& event : nextEvents) {
-                    invokeCallback(event);
+                bool removed = isRemoved(event);
+                markDequeued(event.id);
+                if (!removed) {
+                    invokeCallback(event.event);
                 }
+                event.event = Event(std::shared_ptr<EventOwner>(), boost::function<void()>());
             }
+            callEventPosted = pendingEvents_.load() > 0;
         }
         handlingEvents_ = false;
     }
@@ -74,29 +87,132 @@ void EventLoop::handleNextEvents() {
 }
 
 void EventLoop::postEvent(boost::function<void ()> callback, std::shared_ptr<EventOwner> owner) {
-    Event event(owner, callback);
-    bool callEventPosted = false;
-    {
-        std::unique_lock<std::recursive_mutex> lock(eventsMutex_);
-
-        callEventPosted = events_.empty();
+    QueuedEvent event(nextEventID_++, Event(std::move(owner), std::move(callback)));
+    event.event.id = static_cast<unsigned int>(event.id);
+    if (dispatchLatencyHistogram_.load(std::memory_order_relaxed)) {
+        event.postTime = std::chrono::steady_clock::now();
+    }
 
-        event.id = nextEventID_;
-        nextEventID_++;
-        events_.push_back(event);
+    // Once an event went to the overflow queue, all subsequent events go there as well
+    // until the overflow queue is drained, so that events from one thread stay in order.
+    if (overflowing_.load() || !pushEvent(event)) {
+        std::lock_guard<std::mutex> lock(overflowMutex_);
+        overflowing_ = true;
+        overflowEvents_.push_back(std::move(event));
     }
-    if (callEventPosted) {
+
+    // Only count the event once it can be dequeued.
+    if (pendingEvents_++ == 0) {
         eventPosted();
     }
 }
 
+void EventLoop::setDispatchLatencyHistogram(Histogram* histogram) {
+    dispatchLatencyHistogram_.store(histogram);
+}
+
 void EventLoop::removeEventsFromOwner(std::shared_ptr<EventOwner> owner) {
-    std::unique_lock<std::recursive_mutex> removeLock(removeEventsMutex_, std::defer_lock);
-    std::unique_lock<std::recursive_mutex> eventsLock(eventsMutex_, std::defer_lock);
+    std::unique_lock<std::recursive_mutex> lock(removeEventsMutex_);
+    std::uint64_t removalID = nextEventID_.load();
+    if (removalID <= nextDequeuedID_) {
+        // None of the owner's events are queued anymore.
+        removedOwners_.erase(owner.get());
+        return;
+    }
+    removedOwners_[owner.get()] = removalID;
+    removalsByID_.insert(std::make_pair(removalID, owner.get()));
+}
+
+bool EventLoop::pushEvent(QueuedEvent& event) {
+    std::uint64_t position = enqueuePosition_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots_[position & (QUEUE_SIZE - 1)];
+        std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.event.id = event.id;
+                slot.event.event = std::move(event.event);
+                slot.event.postTime = event.postTime;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (sequence < position) {
+            // The consumer has not freed this slot yet: the ring is full.
+            return false;
+        }
+        else {
+            position = enqueuePosition_.load(std::memory_order_relaxed);
+        }
+    }
+}
 
-    std::lock(removeLock, eventsLock);
+bool EventLoop::popEvent(QueuedEvent& event) {
+    Slot& slot = slots_[dequeuePosition_ & (QUEUE_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) == dequeuePosition_ + 1) {
+        event.id = slot.event.id;
+        event.event = std::move(slot.event.event);
+        event.postTime = slot.event.postTime;
+        slot.event.event = Event(std::shared_ptr<EventOwner>(), boost::function<void()>());
+        slot.sequence.store(dequeuePosition_ + QUEUE_SIZE, std::memory_order_release);
+        dequeuePosition_++;
+        return true;
+    }
+    // Only fall back to the overflow queue once the ring is empty. A producer that is still
+    // writing its event may have posted earlier than the events in the overflow queue.
+    if (overflowing_.load() && enqueuePosition_.load() == dequeuePosition_) {
+        if (dequeuedOverflowEvents_.empty()) {
+            std::lock_guard<std::mutex> lock(overflowMutex_);
+            if (overflowEvents_.empty()) {
+                overflowing_ = false;
+                return false;
+            }
+            dequeuedOverflowEvents_.swap(overflowEvents_);
+        }
+        event.id = dequeuedOverflowEvents_.front().id;
+        event.event = std::move(dequeuedOverflowEvents_.front().event);
+        event.postTime = dequeuedOverflowEvents_.front().postTime;
+        dequeuedOverflowEvents_.pop_front();
+        return true;
+    }
+    return false;
+}
 
-    events_.remove_if(lambda::bind(&Event::owner, lambda::_1) == owner);
+void EventLoop::markDequeued(std::uint64_t id) {
+    // Events from different threads can be dequeued out of ID order, so keep track of
+    // the IDs that were dequeued ahead of the lowest one that is still queued.
+    if (id != nextDequeuedID_) {
+        dequeuedAheadIDs_.insert(id);
+        return;
+    }
+    nextDequeuedID_++;
+    while (!dequeuedAheadIDs_.empty() && dequeuedAheadIDs_.erase(nextDequeuedID_) > 0) {
+        nextDequeuedID_++;
+    }
+
+    // Drop the removals for which all events posted before them have been dequeued.
+    while (!removalsByID_.empty() && removalsByID_.begin()->first <= nextDequeuedID_) {
+        auto removal = removalsByID_.begin();
+        auto i = removedOwners_.find(removal->second);
+        // The owner may have been removed again later.
+        if (i != removedOwners_.end() && i->second == removal->first) {
+            removedOwners_.erase(i);
+        }
+        removalsByID_.erase(removal);
+    }
+}
+
+size_t EventLoop::getRemovedOwnerCount() {
+    std::unique_lock<std::recursive_mutex> lock(removeEventsMutex_);
+    return removedOwners_.size();
+}
+
+bool EventLoop::isRemoved(const QueuedEvent& event) const {
+    if (!event.event.owner || removedOwners_.empty()) {
+        return false;
+    }
+    auto i = removedOwners_.find(event.event.owner.get());
+    return i != removedOwners_.end() && event.id < i->second;
 }
 
 }
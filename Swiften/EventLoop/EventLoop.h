@@ -1,13 +1,20 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <boost/function.hpp>
 
@@ -16,12 +23,16 @@
 
 namespace Swift {
     class EventOwner;
+    class Histogram;
 
     /**
      *    The \ref EventLoop class provides the abstract interface for implementing event loops to use with Swiften.
      *
      *  Events are added to the event queue using the \ref postEvent method and can be removed from the queue using
      *  the \ref removeEventsFromOwner method.
+     *
+     *  Posting an event does not take a lock: events are stored in a fixed-size ring buffer, which producers claim
+     *  slots in atomically. Only when the ring buffer is full, events are appended to a locked overflow queue.
      */
     class SWIFTEN_API EventLoop {
         public:
@@ -38,9 +49,18 @@ namespace Swift {
             /**
              * The \ref removeEventsFromOwner method removes all events from the specified \p owner from the
              * event queue.
+             * The events are not removed from the queue right away; they are skipped when they are dequeued.
              */
             void removeEventsFromOwner(std::shared_ptr<EventOwner> owner);
 
+            /**
+             * Records the time in nanoseconds between posting an event and
+             * handling it in \p histogram, or stops recording if it is nullptr.
+             * The histogram needs to outlive the event loop, or be unset first.
+             * This can be called from any thread.
+             */
+            void setDispatchLatencyHistogram(Histogram* histogram);
+
         protected:
             /**
              * The \ref handleNextEvents method is called by an implementation of the abstract \ref EventLoop class
@@ -61,11 +81,52 @@ namespace Swift {
              */
             virtual void eventPosted() = 0;
 
+            /**
+             * Returns the number of removed owners whose events may still be queued.
+             * Mainly for testing.
+             */
+            size_t getRemovedOwnerCount();
+
         private:
-            unsigned int nextEventID_;
-            std::list<Event> events_;
+            struct QueuedEvent {
+                QueuedEvent(std::uint64_t id, Event event) : id(id), event(std::move(event)) {}
+
+                std::uint64_t id;
+                Event event;
+                // Only set when dispatch latency is recorded
+                std::chrono::steady_clock::time_point postTime;
+            };
+            struct Slot;
+
+            bool pushEvent(QueuedEvent& event);
+            bool popEvent(QueuedEvent& event);
+            bool isRemoved(const QueuedEvent& event) const;
+            void markDequeued(std::uint64_t id);
+
+        private:
+            std::atomic<std::uint64_t> nextEventID_;
+            // The lowest ID that has not been dequeued yet
+            std::uint64_t nextDequeuedID_;
+            std::unordered_set<std::uint64_t> dequeuedAheadIDs_;
+            std::atomic<size_t> pendingEvents_;
             bool handlingEvents_;
-            std::recursive_mutex eventsMutex_;
+
+            std::unique_ptr<Slot[]> slots_;
+            std::atomic<std::uint64_t> enqueuePosition_;
+            std::uint64_t dequeuePosition_;
+
+            std::atomic<bool> overflowing_;
+            std::deque<QueuedEvent> overflowEvents_;
+            std::mutex overflowMutex_;
+            std::deque<QueuedEvent> dequeuedOverflowEvents_;
+
+            // Events of removed owners are skipped when they are dequeued, if they were
+            // posted before the owner was removed (i.e. their ID is lower than the one stored here).
+            // They are dropped once all events with a lower ID have been dequeued.
+            std::unordered_map<EventOwner*, std::uint64_t> removedOwners_;
+            std::multimap<std::uint64_t, EventOwner*> removalsByID_;
             std::recursive_mutex removeEventsMutex_;
+
+            std::atomic<Histogram*> dispatchLatencyHistogram_;
     };
 }
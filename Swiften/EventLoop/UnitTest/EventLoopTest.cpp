@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,6 +11,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
+#include <Swiften/Base/Histogram.h>
 #include <Swiften/Base/sleep.h>
 #include <Swiften/EventLoop/DummyEventLoop.h>
 #include <Swiften/EventLoop/EventOwner.h>
@@ -23,6 +24,12 @@ class EventLoopTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testPost);
         CPPUNIT_TEST(testRemove);
         CPPUNIT_TEST(testHandleEvent_Recursive);
+        CPPUNIT_TEST(testPost_ManyEvents);
+        CPPUNIT_TEST(testPost_MultipleThreads);
+        CPPUNIT_TEST(testRemove_FromEvent);
+        CPPUNIT_TEST(testRemove_PostAfterRemove);
+        CPPUNIT_TEST(testRemove_PrunedOnceDequeued);
+        CPPUNIT_TEST(testDispatchLatency);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -74,17 +81,136 @@ class EventLoopTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(1, events_[1]);
         }
 
+        void testPost_ManyEvents() {
+            DummyEventLoop testling;
+
+            for (int i = 0; i < 5000; ++i) {
+                testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, i));
+            }
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(5000, static_cast<int>(events_.size()));
+            for (int i = 0; i < 5000; ++i) {
+                CPPUNIT_ASSERT_EQUAL(i, events_[i]);
+            }
+        }
+
+        void testPost_MultipleThreads() {
+            SimpleEventLoop testling;
+            const int threadCount = 4;
+            const int eventsPerThread = 2000;
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; ++t) {
+                threads.push_back(std::thread([&testling, t, this]() {
+                    for (int i = 0; i < eventsPerThread; ++i) {
+                        testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, t * eventsPerThread + i));
+                    }
+                }));
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            testling.stop();
+            testling.run();
+
+            CPPUNIT_ASSERT_EQUAL(threadCount * eventsPerThread, static_cast<int>(events_.size()));
+            std::vector<int> lastEvents(threadCount, -1);
+            for (int event : events_) {
+                int thread = event / eventsPerThread;
+                CPPUNIT_ASSERT(event > lastEvents[thread]);
+                lastEvents[thread] = event;
+            }
+        }
+
+        void testRemove_FromEvent() {
+            DummyEventLoop testling;
+            std::shared_ptr<MyEventOwner> eventOwner1(new MyEventOwner());
+            std::shared_ptr<MyEventOwner> eventOwner2(new MyEventOwner());
+
+            testling.postEvent(boost::bind(&EventLoopTest::removeEvents, this, &testling, eventOwner2), eventOwner1);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 1), eventOwner2);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 2), eventOwner1);
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(events_.size()));
+            CPPUNIT_ASSERT_EQUAL(2, events_[0]);
+        }
+
+        void testRemove_PostAfterRemove() {
+            DummyEventLoop testling;
+            std::shared_ptr<MyEventOwner> eventOwner(new MyEventOwner());
+
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 1), eventOwner);
+            testling.removeEventsFromOwner(eventOwner);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 2), eventOwner);
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(events_.size()));
+            CPPUNIT_ASSERT_EQUAL(2, events_[0]);
+        }
+
+        void testRemove_PrunedOnceDequeued() {
+            RemovedOwnersEventLoop testling;
+            std::shared_ptr<MyEventOwner> eventOwner1(new MyEventOwner());
+            std::shared_ptr<MyEventOwner> eventOwner2(new MyEventOwner());
+
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 1), eventOwner1);
+            testling.removeEventsFromOwner(eventOwner1);
+            testling.postEvent(boost::bind(&EventLoopTest::logRemovedOwnerCount, this, &testling), eventOwner2);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 2), eventOwner1);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getRemovedOwnerCount());
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(events_.size()));
+            CPPUNIT_ASSERT_EQUAL(0, events_[0]);
+            CPPUNIT_ASSERT_EQUAL(2, events_[1]);
+
+            testling.removeEventsFromOwner(eventOwner2);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getRemovedOwnerCount());
+        }
+
+        void testDispatchLatency() {
+            DummyEventLoop testling;
+            Histogram histogram;
+
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 1));
+            testling.setDispatchLatencyHistogram(&histogram);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 2));
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 3));
+            Swift::sleep(10);
+            testling.processEvents();
+            testling.setDispatchLatencyHistogram(nullptr);
+            testling.postEvent(boost::bind(&EventLoopTest::logEvent, this, 4));
+            testling.processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(events_.size()));
+            Histogram::Snapshot snapshot = histogram.getSnapshot();
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), snapshot.count);
+            CPPUNIT_ASSERT(snapshot.max >= 10 * 1000 * 1000);
+        }
+
     private:
         struct MyEventOwner : public EventOwner {};
+        struct RemovedOwnersEventLoop : public DummyEventLoop {
+            using DummyEventLoop::getRemovedOwnerCount;
+        };
         void logEvent(int i) {
             events_.push_back(i);
         }
+        void logRemovedOwnerCount(RemovedOwnersEventLoop* loop) {
+            events_.push_back(static_cast<int>(loop->getRemovedOwnerCount()));
+        }
         void runEventLoop(DummyEventLoop* loop, std::shared_ptr<MyEventOwner> eventOwner) {
             loop->processEvents();
             CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(events_.size()));
             loop->postEvent(boost::bind(&EventLoopTest::logEvent, this, 1), eventOwner);
         }
 
+        void removeEvents(DummyEventLoop* loop, std::shared_ptr<MyEventOwner> eventOwner) {
+            loop->removeEventsFromOwner(eventOwner);
+        }
+
     private:
         std::vector<int> events_;
 };
@@ -1,67 +1,581 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
+/*
+ * Generates load on an XMPP server, and reports latency percentiles and
+ * throughput of the operations of a scripted workload.
+ *
+ * All clients first connect, at the given ramp rate. Once every client is
+ * connected (or failed to connect), each client runs the workload:
+ *
+ *   connect    Only measures the time to connect and log in
+ *   ping-pong  Sends a message to the next client, which echoes it back
+ *   presence   Floods the next client with directed presences, and measures
+ *              their one-way delivery time
+ *   roster     Fetches the roster
+ *   iq         Asks the server for its software version
+ *   muc        Joins and leaves a room, and measures the join time
+ *
+ * Apart from the presence storm, every client waits for an operation to
+ * complete before starting the next one.
+ *
+ * With --local, an in-process Limber server is started on the loopback
+ * interface, with one account per client. Otherwise, the account is taken
+ * from the SWIFT_BENCHTOOL_JID and SWIFT_BENCHTOOL_PASS environment variables.
+ * A %d in the JID is replaced by the index of the client, to spread the
+ * clients over multiple accounts.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
-#include <thread>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
 
-#include <Swiften/Base/sleep.h>
-#include <Swiften/Client/Client.h>
-#include <Swiften/Client/ClientXMLTracer.h>
-#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/Base/IDGenerator.h>
+#include <Swiften/Client/ClientOptions.h>
+#include <Swiften/Client/CoreClient.h>
+#include <Swiften/Elements/MUCPayload.h>
+#include <Swiften/Elements/Message.h>
+#include <Swiften/Elements/Presence.h>
 #include <Swiften/EventLoop/SimpleEventLoop.h>
 #include <Swiften/Network/BoostNetworkFactories.h>
+#include <Swiften/Network/HostAddress.h>
+#include <Swiften/Network/Timer.h>
 #include <Swiften/Network/TimerFactory.h>
+#include <Swiften/Queries/Requests/GetSoftwareVersionRequest.h>
 #include <Swiften/Roster/GetRosterRequest.h>
 #include <Swiften/TLS/BlindCertificateTrustChecker.h>
 
+#ifdef HAVE_LIMBER
+#include <Limber/Server/Server.h>
+#include <Limber/Server/SimpleUserRegistry.h>
+#endif
+
 using namespace Swift;
 
+typedef std::chrono::steady_clock Clock;
+
+enum Workload {
+    ConnectWorkload,
+    PingPongWorkload,
+    PresenceWorkload,
+    RosterWorkload,
+    IQWorkload,
+    MUCWorkload
+};
+
+// Indexed by Workload
+static const char* workloadNames[] = { "connect", "ping-pong", "presence", "roster", "iq", "muc" };
+
+struct Options {
+    Options() : clients(100), ramp(0), workload(ConnectWorkload), iterations(100), timeout(60), local(false) {}
+
+    int clients;
+    int ramp; ///< Clients connected per second, or 0 to connect all at once
+    Workload workload;
+    int iterations;
+    JID room;
+    int timeout; ///< Seconds
+    bool local;
+};
+
 static SimpleEventLoop eventLoop;
 static BoostNetworkFactories networkFactories(&eventLoop);
-static int numberOfConnectedClients = 0;
-static int numberOfInstances = 100;
 
+static double toMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+class Benchmark {
+    public:
+        Benchmark(const Options& options, const ClientOptions& clientOptions) : options_(options), clientOptions_(clientOptions), connecting_(0), pending_(0), operations_(0), errors_(0), expectedPresences_(0), receivedPresences_(0), timedOut_(false), stopping_(false), disconnecting_(0) {
+        }
+
+        ~Benchmark() {
+            if (shutdownTimer_) {
+                shutdownTimer_->stop();
+            }
+            for (auto& state : clients_) {
+                delete state->client;
+            }
+        }
+
+        void addClient(const JID& jid, const std::string& password) {
+            std::unique_ptr<ClientState> state(new ClientState(clients_.size()));
+            state->client = new CoreClient(jid, createSafeByteArray(password), &networkFactories);
+            state->client->setCertificateTrustChecker(&trustChecker_);
+            state->client->onConnected.connect(boost::bind(&Benchmark::handleConnected, this, state.get()));
+            state->client->onDisconnected.connect(boost::bind(&Benchmark::handleDisconnected, this, state.get(), _1));
+            state->client->onMessageReceived.connect(boost::bind(&Benchmark::handleMessageReceived, this, state.get(), _1));
+            state->client->onPresenceReceived.connect(boost::bind(&Benchmark::handlePresenceReceived, this, state.get(), _1));
+            clients_.push_back(std::move(state));
+        }
+
+        void run() {
+            timeoutTimer_ = networkFactories.getTimerFactory()->createTimer(options_.timeout * 1000);
+            timeoutTimer_->onTick.connect(boost::bind(&Benchmark::handleTimeout, this));
+            timeoutTimer_->start();
+
+            pending_ = clients_.size();
+            connectStart_ = Clock::now();
+            connectNextClients();
+            eventLoop.run();
+        }
+
+        void printReport() const {
+            int connected = 0;
+            for (const auto& state : clients_) {
+                if (state->connected) {
+                    connected++;
+                }
+            }
+            std::cout << "Workload: " << workloadNames[options_.workload] << (timedOut_ ? " (timed out)" : "") << std::endl;
+            std::cout << "Clients: " << connected << " connected, " << clients_.size() - connected << " failed in " << std::fixed << std::setprecision(3) << toMilliseconds(workloadStart_ - connectStart_) / 1000 << " s" << std::endl;
+            printLatencies("Connect", connectLatencies_);
+            if (options_.workload == ConnectWorkload) {
+                return;
+            }
+            double seconds = toMilliseconds(workloadEnd_ - workloadStart_) / 1000;
+            std::cout << "Operations: " << operations_ << " in " << seconds << " s (" << std::setprecision(1) << (seconds > 0 ? operations_ / seconds : 0) << "/s), " << errors_ << " errors" << std::endl;
+            printLatencies("Latency", latencies_);
+        }
+
+    private:
+        struct ClientState {
+            ClientState(size_t index) : index(index), client(nullptr), connected(false), finished(false), remaining(0), joined(false) {}
+
+            size_t index;
+            CoreClient* client;
+            Clock::time_point start;
+            bool connected;
+            bool finished;
+            int remaining;
+            std::string pendingID;
+            bool joined;
+        };
+
+        void connectNextClients() {
+            size_t count = clients_.size() - connecting_;
+            int interval = 0;
+            if (options_.ramp > 0) {
+                // Connect in batches, as timers are not precise enough for high rates
+                interval = std::max(1000 / options_.ramp, 10);
+                count = std::min(count, static_cast<size_t>(std::max(options_.ramp * interval / 1000, 1)));
+            }
+            for (size_t i = 0; i < count; ++i) {
+                ClientState* state = clients_[connecting_++].get();
+                state->start = Clock::now();
+                state->client->connect(clientOptions_);
+            }
+            if (connecting_ < clients_.size()) {
+                rampTimer_ = networkFactories.getTimerFactory()->createTimer(interval);
+                rampTimer_->onTick.connect(boost::bind(&Benchmark::connectNextClients, this));
+                rampTimer_->start();
+            }
+        }
+
+        void handleConnected(ClientState* state) {
+            state->connected = true;
+            connectLatencies_.push_back(Clock::now() - state->start);
+            handleClientReady();
+        }
+
+        void handleDisconnected(ClientState* state, const boost::optional<ClientError>& error) {
+            if (stopping_) {
+                if (--disconnecting_ == 0) {
+                    eventLoop.stop();
+                }
+                return;
+            }
+            if (error) {
+                errors_++;
+            }
+            if (!state->connected) {
+                handleClientReady();
+            }
+            else if (!state->finished) {
+                finish(state);
+            }
+        }
+
+        void handleClientReady() {
+            if (--pending_ > 0) {
+                return;
+            }
+            workloadStart_ = Clock::now();
+            for (auto& state : clients_) {
+                if (state->connected) {
+                    state->remaining = options_.iterations;
+                    pending_++;
+                }
+            }
+            if (options_.workload == ConnectWorkload || pending_ == 0) {
+                stop();
+                return;
+            }
+            if (options_.workload == PresenceWorkload) {
+                expectedPresences_ = pending_ * options_.iterations;
+            }
+            for (auto& state : clients_) {
+                if (state->connected) {
+                    startOperation(state.get());
+                }
+            }
+        }
 
-static void handleConnected() {
-    numberOfConnectedClients++;
-    std::cout << "Connected " << numberOfConnectedClients << std::endl;
+        const JID& getPeer(const ClientState* state) const {
+            return clients_[(state->index + 1) % clients_.size()]->client->getJID();
+        }
+
+        JID getOccupantJID(const ClientState* state) const {
+            return JID(options_.room.getNode(), options_.room.getDomain(), "bench" + std::to_string(state->index));
+        }
+
+        void startOperation(ClientState* state) {
+            state->start = Clock::now();
+            switch (options_.workload) {
+                case ConnectWorkload:
+                    break;
+                case PingPongWorkload: {
+                    std::shared_ptr<Message> message = std::make_shared<Message>();
+                    message->setTo(getPeer(state));
+                    message->setBody(std::string("ping"));
+                    state->pendingID = idGenerator_.generateID();
+                    message->setID(state->pendingID);
+                    state->client->sendMessage(message);
+                    break;
+                }
+                case PresenceWorkload:
+                    // All presences are sent at once; the stream only finishes once they are all received
+                    for (; state->remaining > 0; --state->remaining) {
+                        std::shared_ptr<Presence> presence = std::make_shared<Presence>();
+                        presence->setTo(getPeer(state));
+                        presence->setStatus(std::to_string(Clock::now().time_since_epoch().count()));
+                        state->client->sendPresence(presence);
+                    }
+                    finish(state);
+                    break;
+                case RosterWorkload: {
+                    GetRosterRequest::ref request = GetRosterRequest::create(state->client->getIQRouter());
+                    request->onResponse.connect(boost::bind(&Benchmark::handleResponse, this, state, _2));
+                    request->send();
+                    break;
+                }
+                case IQWorkload: {
+                    GetSoftwareVersionRequest::ref request = GetSoftwareVersionRequest::create(JID(state->client->getJID().getDomain()), state->client->getIQRouter());
+                    request->onResponse.connect(boost::bind(&Benchmark::handleResponse, this, state, _2));
+                    request->send();
+                    break;
+                }
+                case MUCWorkload: {
+                    std::shared_ptr<Presence> presence = std::make_shared<Presence>();
+                    presence->setTo(getOccupantJID(state));
+                    presence->addPayload(std::make_shared<MUCPayload>());
+                    state->client->sendPresence(presence);
+                    break;
+                }
+            }
+        }
+
+        void handleResponse(ClientState* state, ErrorPayload::ref error) {
+            if (error) {
+                errors_++;
+            }
+            completeOperation(state);
+        }
+
+        void handleMessageReceived(ClientState* state, std::shared_ptr<Message> message) {
+            if (options_.workload != PingPongWorkload) {
+                return;
+            }
+            if (message->getType() == Message::Error) {
+                errors_++;
+                completeOperation(state);
+            }
+            else if (message->getBody() == std::string("ping")) {
+                std::shared_ptr<Message> reply = std::make_shared<Message>();
+                reply->setTo(message->getFrom());
+                reply->setBody(std::string("pong"));
+                reply->setID(message->getID());
+                state->client->sendMessage(reply);
+            }
+            else if (message->getBody() == std::string("pong") && message->getID() == state->pendingID) {
+                completeOperation(state);
+            }
+        }
+
+        void handlePresenceReceived(ClientState* state, std::shared_ptr<Presence> presence) {
+            if (options_.workload == PresenceWorkload) {
+                if (presence->getType() == Presence::Error) {
+                    errors_++;
+                    expectedPresences_--;
+                }
+                else {
+                    try {
+                        Clock::time_point sent(Clock::duration(boost::lexical_cast<Clock::rep>(presence->getStatus())));
+                        latencies_.push_back(Clock::now() - sent);
+                        operations_++;
+                        receivedPresences_++;
+                    }
+                    catch (const boost::bad_lexical_cast&) {
+                        return;
+                    }
+                }
+                if (receivedPresences_ >= expectedPresences_ && pending_ == 0) {
+                    stop();
+                }
+            }
+            else if (options_.workload == MUCWorkload && presence->getFrom() == getOccupantJID(state)) {
+                if (presence->getType() == Presence::Error) {
+                    errors_++;
+                    completeOperation(state);
+                }
+                else if (!state->joined && presence->getType() == Presence::Available) {
+                    state->joined = true;
+                    latencies_.push_back(Clock::now() - state->start);
+                    std::shared_ptr<Presence> leave = std::make_shared<Presence>();
+                    leave->setTo(getOccupantJID(state));
+                    leave->setType(Presence::Unavailable);
+                    state->client->sendPresence(leave);
+                }
+                else if (state->joined && presence->getType() == Presence::Unavailable) {
+                    state->joined = false;
+                    operations_++;
+                    if (--state->remaining > 0) {
+                        startOperation(state);
+                    }
+                    else {
+                        finish(state);
+                    }
+                }
+            }
+        }
+
+        void completeOperation(ClientState* state) {
+            if (state->finished) {
+                return;
+            }
+            latencies_.push_back(Clock::now() - state->start);
+            operations_++;
+            if (--state->remaining > 0) {
+                startOperation(state);
+            }
+            else {
+                finish(state);
+            }
+        }
+
+        void finish(ClientState* state) {
+            state->finished = true;
+            if (--pending_ > 0) {
+                return;
+            }
+            if (options_.workload != PresenceWorkload || receivedPresences_ >= expectedPresences_) {
+                stop();
+            }
+        }
+
+        void handleTimeout() {
+            timedOut_ = true;
+            stop();
+        }
+
+        void stop() {
+            if (stopping_) {
+                return;
+            }
+            stopping_ = true;
+            workloadEnd_ = Clock::now();
+            if (workloadStart_ == Clock::time_point()) {
+                workloadStart_ = workloadEnd_;
+            }
+            timeoutTimer_->stop();
+            if (rampTimer_) {
+                rampTimer_->stop();
+            }
+
+            // Log out cleanly, but don't wait forever for unresponsive servers
+            for (auto& state : clients_) {
+                if (state->client->isActive()) {
+                    disconnecting_++;
+                    state->client->disconnect();
+                }
+            }
+            if (disconnecting_ == 0) {
+                eventLoop.stop();
+                return;
+            }
+            shutdownTimer_ = networkFactories.getTimerFactory()->createTimer(5000);
+            shutdownTimer_->onTick.connect(boost::bind(&SimpleEventLoop::stop, &eventLoop));
+            shutdownTimer_->start();
+        }
+
+        static void printLatencies(const std::string& name, std::vector<Clock::duration> latencies) {
+            if (latencies.empty()) {
+                return;
+            }
+            std::sort(latencies.begin(), latencies.end());
+            auto percentile = [&latencies](double p) {
+                size_t rank = static_cast<size_t>(p / 100 * latencies.size() + 0.5);
+                return toMilliseconds(latencies[std::min(std::max(rank, static_cast<size_t>(1)), latencies.size()) - 1]);
+            };
+            std::cout << name << " (ms): p50 " << std::setprecision(3) << percentile(50) << ", p90 " << percentile(90) << ", p99 " << percentile(99) << ", max " << toMilliseconds(latencies.back()) << std::endl;
+        }
+
+    private:
+        Options options_;
+        ClientOptions clientOptions_;
+        BlindCertificateTrustChecker trustChecker_;
+        IDGenerator idGenerator_;
+        std::vector<std::unique_ptr<ClientState> > clients_;
+        size_t connecting_;
+        size_t pending_;
+        Timer::ref rampTimer_;
+        Timer::ref timeoutTimer_;
+        Timer::ref shutdownTimer_;
+        Clock::time_point connectStart_;
+        Clock::time_point workloadStart_;
+        Clock::time_point workloadEnd_;
+        std::vector<Clock::duration> connectLatencies_;
+        std::vector<Clock::duration> latencies_;
+        int operations_;
+        int errors_;
+        size_t expectedPresences_;
+        size_t receivedPresences_;
+        bool timedOut_;
+        bool stopping_;
+        size_t disconnecting_;
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl
+              << "  --clients N     Number of clients (default: 100)" << std::endl
+              << "  --ramp N        Clients to connect per second (default: all at once)" << std::endl
+              << "  --workload W    connect, ping-pong, presence, roster, iq or muc (default: connect)" << std::endl
+              << "  --iterations N  Operations per client (default: 100)" << std::endl
+              << "  --room JID      Room to join for the muc workload" << std::endl
+              << "  --timeout S     Seconds after which the run is aborted (default: 60)" << std::endl
+#ifdef HAVE_LIMBER
+              << "  --local         Run against an in-process server" << std::endl
+#endif
+              ;
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string option(argv[i]);
+            if (option == "--local") {
+                options.local = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return false;
+            }
+            std::string value(argv[++i]);
+            if (option == "--clients") {
+                options.clients = boost::lexical_cast<int>(value);
+            }
+            else if (option == "--ramp") {
+                options.ramp = boost::lexical_cast<int>(value);
+            }
+            else if (option == "--workload") {
+                const char** workload = std::find(std::begin(workloadNames), std::end(workloadNames), value);
+                if (workload == std::end(workloadNames)) {
+                    return false;
+                }
+                options.workload = static_cast<Workload>(workload - std::begin(workloadNames));
+            }
+            else if (option == "--iterations") {
+                options.iterations = boost::lexical_cast<int>(value);
+            }
+            else if (option == "--room") {
+                options.room = JID(value);
+            }
+            else if (option == "--timeout") {
+                options.timeout = boost::lexical_cast<int>(value);
+            }
+            else {
+                return false;
+            }
+        }
+    }
+    catch (const boost::bad_lexical_cast&) {
+        return false;
+    }
+    return options.clients > 0 && options.ramp >= 0 && options.iterations > 0 && options.timeout > 0;
 }
 
-int main(int, char**) {
-    char* jid = getenv("SWIFT_BENCHTOOL_JID");
-    if (!jid) {
-        std::cerr << "Please set the SWIFT_BENCHTOOL_JID environment variable" << std::endl;
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
         return -1;
     }
-    char* pass = getenv("SWIFT_BENCHTOOL_PASS");
-    if (!pass) {
-        std::cerr << "Please set the SWIFT_BENCHTOOL_PASS environment variable" << std::endl;
+    if (options.workload == MUCWorkload && (!options.room.isValid() || options.local)) {
+        std::cerr << "The muc workload needs a --room on a server with a MUC service" << std::endl;
         return -1;
     }
 
-    BlindCertificateTrustChecker trustChecker;
-    std::vector<CoreClient*> clients;
-    for (int i = 0; i < numberOfInstances; ++i) {
-        CoreClient* client = new Swift::CoreClient(JID(jid), createSafeByteArray(std::string(pass)), &networkFactories);
-        client->setCertificateTrustChecker(&trustChecker);
-        client->onConnected.connect(&handleConnected);
-        clients.push_back(client);
+    ClientOptions clientOptions;
+    std::unique_ptr<Benchmark> benchmark;
+#ifdef HAVE_LIMBER
+    SimpleUserRegistry userRegistry;
+    std::unique_ptr<Server> server;
+    if (options.local) {
+        for (int i = 0; i < options.clients; ++i) {
+            userRegistry.addUser(JID("bench" + std::to_string(i) + "@localhost"), "bench");
+        }
+        server = std::unique_ptr<Server>(new Server(&userRegistry, &eventLoop, 0, *HostAddress::fromString("127.0.0.1")));
+        if (server->start()) {
+            std::cerr << "Unable to start the local server" << std::endl;
+            return -1;
+        }
+        clientOptions.manualHostname = "127.0.0.1";
+        clientOptions.manualPort = server->getAddressPort().getPort();
+        clientOptions.allowPLAINWithoutTLS = true;
+        benchmark = std::unique_ptr<Benchmark>(new Benchmark(options, clientOptions));
+        for (int i = 0; i < options.clients; ++i) {
+            benchmark->addClient(JID("bench" + std::to_string(i) + "@localhost"), "bench");
+        }
     }
-
-    for (auto& client : clients) {
-        client->connect();
+#else
+    if (options.local) {
+        std::cerr << "Local mode is not available in this build" << std::endl;
+        return -1;
     }
-
-    eventLoop.run();
-
-    for (auto& client : clients) {
-        delete client;
+#endif
+    if (!options.local) {
+        char* jid = getenv("SWIFT_BENCHTOOL_JID");
+        if (!jid) {
+            std::cerr << "Please set the SWIFT_BENCHTOOL_JID environment variable" << std::endl;
+            return -1;
+        }
+        char* pass = getenv("SWIFT_BENCHTOOL_PASS");
+        if (!pass) {
+            std::cerr << "Please set the SWIFT_BENCHTOOL_PASS environment variable" << std::endl;
+            return -1;
+        }
+        benchmark = std::unique_ptr<Benchmark>(new Benchmark(options, clientOptions));
+        for (int i = 0; i < options.clients; ++i) {
+            benchmark->addClient(JID(boost::replace_all_copy(std::string(jid), "%d", std::to_string(i))), pass);
+        }
     }
 
+    benchmark->run();
+    benchmark->printReport();
+
     return 0;
 }
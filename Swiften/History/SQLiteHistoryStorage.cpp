@@ -1,84 +1,217 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/History/SQLiteHistoryStorage.h>
 
-#include <iostream>
+#include <limits>
 
-#include <boost/bind.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <sqlite3.h>
 
+#include <Swiften/Base/Log.h>
 #include <Swiften/Base/Path.h>
 
-inline std::string getEscapedString(const std::string& s) {
-    std::string result(s);
+namespace {
+    /**
+     * Resets a cached statement when going out of scope, so that it can be
+     * executed again.
+     */
+    class StatementResetter {
+        public:
+            StatementResetter(sqlite3_stmt* statement) : statement_(statement) {
+            }
+
+            ~StatementResetter() {
+                sqlite3_reset(statement_);
+                sqlite3_clear_bindings(statement_);
+            }
+
+        private:
+            sqlite3_stmt* statement_;
+    };
+
+    long long getSecondsSinceEpoch(const boost::posix_time::ptime& time) {
+        return (time - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
+    }
+
+    boost::posix_time::ptime getTimeFromSecondsSinceEpoch(long long secondsSinceEpoch) {
+        return boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(static_cast<long>(secondsSinceEpoch)));
+    }
+
+    std::string getColumnText(sqlite3_stmt* statement, int column) {
+        const unsigned char* text = sqlite3_column_text(statement, column);
+        return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+    }
+
+    /**
+     * Escapes the wildcards of a LIKE pattern, using a backslash as the escape
+     * character.
+     */
+    std::string escapeLikePattern(const std::string& text) {
+        std::string result;
+        for (char c : text) {
+            if (c == '%' || c == '_' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
 
-    size_t pos = result.find('\'');
-    while (pos != std::string::npos) {
-        result.insert(pos, "'");
-        pos = result.find('\'', pos + 2);
+    void bindText(sqlite3_stmt* statement, int index, const std::string& text) {
+        sqlite3_bind_text(statement, index, text.data(), boost::numeric_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+
+    /**
+     * Returns the condition matching the messages of type ?3 between the
+     * bare JIDs with IDs ?1 (self) and ?2 (contact). If the resource is
+     * matched as well, the resource of the contact is bound to ?4.
+     */
+    std::string getConversationCondition(bool matchResource) {
+        if (matchResource) {
+            return "type=?3 AND ((fromBare=?1 AND toBare=?2 AND toResource=?4) OR (fromBare=?2 AND fromResource=?4 AND toBare=?1))";
+        }
+        return "type=?3 AND ((fromBare=?1 AND toBare=?2) OR (fromBare=?2 AND toBare=?1))";
+    }
+
+    void bindConversation(sqlite3_stmt* statement, long long selfID, long long contactID, Swift::HistoryMessage::Type type, const Swift::JID& contactJID) {
+        sqlite3_bind_int64(statement, 1, selfID);
+        sqlite3_bind_int64(statement, 2, contactID);
+        sqlite3_bind_int(statement, 3, type);
+        if (!contactJID.isBare()) {
+            bindText(statement, 4, contactJID.getResource());
+        }
     }
-    return result;
 }
 
 namespace Swift {
 
-SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file) : db_(nullptr) {
-    thread_ = new std::thread(boost::bind(&SQLiteHistoryStorage::run, this));
-
+SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file) : db_(nullptr), thread_(nullptr), stopping_(false) {
     sqlite3_open(pathToString(file).c_str(), &db_);
     if (!db_) {
-        std::cerr << "Error opening database " << pathToString(file) << std::endl;
+        SWIFT_LOG(error) << "Error opening database " << pathToString(file) << std::endl;
     }
 
-    char* errorMessage;
-    int result = sqlite3_exec(db_, "CREATE TABLE IF NOT EXISTS messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)", nullptr, nullptr, &errorMessage);
-    if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
-        sqlite3_free(errorMessage);
-    }
+    // Readers don't block the writer thread in WAL mode, and WAL only needs
+    // to be synced on checkpoints.
+    exec("PRAGMA journal_mode=WAL");
+    exec("PRAGMA synchronous=NORMAL");
+    exec("CREATE TABLE IF NOT EXISTS messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)");
+    exec("CREATE TABLE IF NOT EXISTS jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL)");
+    exec("CREATE INDEX IF NOT EXISTS messages_from_to ON messages('fromBare', 'toBare', 'type', 'time')");
+    exec("CREATE INDEX IF NOT EXISTS messages_to_from ON messages('toBare', 'fromBare', 'type', 'time')");
 
-    result = sqlite3_exec(db_, "CREATE TABLE IF NOT EXISTS jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL)", nullptr, nullptr, &errorMessage);
-    if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
-        sqlite3_free(errorMessage);
-    }
+    thread_ = new std::thread(&SQLiteHistoryStorage::run, this);
 }
 
 SQLiteHistoryStorage::~SQLiteHistoryStorage() {
-    sqlite3_close(db_);
+    {
+        std::lock_guard<std::mutex> lock(pendingMessagesMutex_);
+        stopping_ = true;
+    }
+    pendingMessagesAvailable_.notify_one();
+    thread_->join();
     delete thread_;
+
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    writePendingMessages();
+    for (const auto& statement : statements_) {
+        sqlite3_finalize(statement.second);
+    }
+    sqlite3_close(db_);
 }
 
 void SQLiteHistoryStorage::addMessage(const HistoryMessage& message) {
-    int secondsSinceEpoch = (message.getTime() - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
-
-    std::string statement = std::string("INSERT INTO messages('message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') VALUES(") +
-                    "'" + getEscapedString(message.getMessage()) + "', " +
-                    boost::lexical_cast<std::string>(getIDForJID(message.getFromJID().toBare())) + ", '" +
-                    getEscapedString(message.getFromJID().getResource()) + "', " +
-                    boost::lexical_cast<std::string>(getIDForJID(message.getToJID().toBare())) + ", '" +
-                    getEscapedString(message.getToJID().getResource()) + "', " +
-                    boost::lexical_cast<std::string>(message.getType()) + ", " +
-                    boost::lexical_cast<std::string>(secondsSinceEpoch) + ", " +
-                    boost::lexical_cast<std::string>(message.getOffset()) + ")";
+    {
+        std::lock_guard<std::mutex> lock(pendingMessagesMutex_);
+        pendingMessages_.push_back(message);
+    }
+    pendingMessagesAvailable_.notify_one();
+}
+
+void SQLiteHistoryStorage::run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(pendingMessagesMutex_);
+            pendingMessagesAvailable_.wait(lock, [this]() { return stopping_ || !pendingMessages_.empty(); });
+            if (stopping_) {
+                return;
+            }
+        }
+        // Messages added while this batch is written are collected in the
+        // next batch.
+        std::lock_guard<std::mutex> lock(dbMutex_);
+        writePendingMessages();
+    }
+}
+
+void SQLiteHistoryStorage::writePendingMessages() const {
+    // Prepare the statement first, so that the messages stay queued if it
+    // can't be prepared
+    sqlite3_stmt* insertStatement = getStatement("INSERT INTO messages('message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') VALUES(?, ?, ?, ?, ?, ?, ?, ?)");
+    if (!insertStatement) {
+        return;
+    }
+    std::vector<HistoryMessage> messages;
+    {
+        std::lock_guard<std::mutex> lock(pendingMessagesMutex_);
+        messages.swap(pendingMessages_);
+    }
+    if (messages.empty()) {
+        return;
+    }
+
+    exec("BEGIN TRANSACTION");
+    for (const auto& message : messages) {
+        StatementResetter resetter(insertStatement);
+        bindText(insertStatement, 1, message.getMessage());
+        sqlite3_bind_int64(insertStatement, 2, getIDForJID(message.getFromJID().toBare()));
+        bindText(insertStatement, 3, message.getFromJID().getResource());
+        sqlite3_bind_int64(insertStatement, 4, getIDForJID(message.getToJID().toBare()));
+        bindText(insertStatement, 5, message.getToJID().getResource());
+        sqlite3_bind_int(insertStatement, 6, message.getType());
+        sqlite3_bind_int64(insertStatement, 7, getSecondsSinceEpoch(message.getTime()));
+        sqlite3_bind_int(insertStatement, 8, message.getOffset());
+        if (sqlite3_step(insertStatement) != SQLITE_DONE) {
+            SWIFT_LOG(error) << "SQL error: " << sqlite3_errmsg(db_) << std::endl;
+        }
+    }
+    exec("COMMIT TRANSACTION");
+}
+
+void SQLiteHistoryStorage::exec(const std::string& statement) const {
     char* errorMessage;
     int result = sqlite3_exec(db_, statement.c_str(), nullptr, nullptr, &errorMessage);
     if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
+        SWIFT_LOG(error) << "SQL error: " << errorMessage << std::endl;
         sqlite3_free(errorMessage);
     }
 }
 
+sqlite3_stmt* SQLiteHistoryStorage::getStatement(const std::string& query) const {
+    auto i = statements_.find(query);
+    if (i != statements_.end()) {
+        return i->second;
+    }
+    sqlite3_stmt* statement = nullptr;
+    int r = sqlite3_prepare_v2(db_, query.c_str(), boost::numeric_cast<int>(query.size()), &statement, nullptr);
+    if (r != SQLITE_OK) {
+        SWIFT_LOG(error) << "SQL error: " << sqlite3_errmsg(db_) << std::endl;
+        sqlite3_finalize(statement);
+        return nullptr;
+    }
+    statements_[query] = statement;
+    return statement;
+}
+
 std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
-    sqlite3_stmt* selectStatement;
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    writePendingMessages();
 
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
@@ -88,52 +221,40 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID&
         return std::vector<HistoryMessage>();
     }
 
-    std::string selectQuery = "SELECT * FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
-    if (contactJID.isBare()) {
-        // match only bare jid
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-                boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-    else {
-        // match resource too
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-                boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
-                getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
-                getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + ")))";
+    sqlite3_stmt* selectStatement = getStatement(
+            "SELECT message, fromBare, fromResource, toBare, toResource, type, time, offset FROM messages WHERE " +
+            getConversationCondition(!contactJID.isBare()) + " AND time>=?5 AND time<?6 ORDER BY rowid");
+    if (!selectStatement) {
+        return std::vector<HistoryMessage>();
     }
-
+    StatementResetter resetter(selectStatement);
+    bindConversation(selectStatement, *selfID, *contactID, type, contactJID);
     if (!date.is_not_a_date()) {
-        int lowerBound = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
-        int upperBound = lowerBound + 86400;
-
-        selectQuery += " AND (time>=" + boost::lexical_cast<std::string>(lowerBound) +
-                " AND time<" + boost::lexical_cast<std::string>(upperBound) + ")";
+        long long lowerBound = getSecondsSinceEpoch(boost::posix_time::ptime(date));
+        sqlite3_bind_int64(selectStatement, 5, lowerBound);
+        sqlite3_bind_int64(selectStatement, 6, lowerBound + 86400);
     }
-
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    else {
+        sqlite3_bind_int64(selectStatement, 5, std::numeric_limits<sqlite3_int64>::min());
+        sqlite3_bind_int64(selectStatement, 6, std::numeric_limits<sqlite3_int64>::max());
     }
-    r = sqlite3_step(selectStatement);
 
     // Retrieve result
     std::vector<HistoryMessage> result;
+    int r = sqlite3_step(selectStatement);
     while (r == SQLITE_ROW) {
-        std::string message(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+        std::string message(getColumnText(selectStatement, 0));
 
         // fromJID
-        boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int(selectStatement, 1)));
-        std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 2)));
+        boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int64(selectStatement, 1)));
+        std::string fromResource(getColumnText(selectStatement, 2));
         if (fromJID) {
             fromJID = boost::optional<JID>(JID(fromJID->getNode(), fromJID->getDomain(), fromResource));
         }
 
         // toJID
-        boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int(selectStatement, 3)));
-        std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 4)));
+        boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int64(selectStatement, 3)));
+        std::string toResource(getColumnText(selectStatement, 4));
         if (toJID) {
             toJID = boost::optional<JID>(JID(toJID->getNode(), toJID->getDomain(), toResource));
         }
@@ -142,8 +263,7 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID&
         HistoryMessage::Type type = static_cast<HistoryMessage::Type>(sqlite3_column_int(selectStatement, 5));
 
         // timestamp
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 6));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+        boost::posix_time::ptime time(getTimeFromSecondsSinceEpoch(sqlite3_column_int64(selectStatement, 6)));
 
         // offset from utc
         int offset = sqlite3_column_int(selectStatement, 7);
@@ -152,14 +272,13 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID&
         r = sqlite3_step(selectStatement);
     }
     if (r != SQLITE_DONE) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+        SWIFT_LOG(error) << "SQL error: " << sqlite3_errmsg(db_) << std::endl;
     }
-    sqlite3_finalize(selectStatement);
 
     return result;
 }
 
-long long SQLiteHistoryStorage::getIDForJID(const JID& jid) {
+long long SQLiteHistoryStorage::getIDForJID(const JID& jid) const {
     boost::optional<long long> id = getIDFromJID(jid);
     if (id) {
         return *id;
@@ -169,52 +288,69 @@ long long SQLiteHistoryStorage::getIDForJID(const JID& jid) {
     }
 }
 
-long long SQLiteHistoryStorage::addJID(const JID& jid) {
-    std::string statement = std::string("INSERT INTO jids('jid') VALUES('") + getEscapedString(jid.toString()) + "')";
-    char* errorMessage;
-    int result = sqlite3_exec(db_, statement.c_str(), nullptr, nullptr, &errorMessage);
-    if (result != SQLITE_OK) {
-        std::cerr << "SQL Error: " << errorMessage << std::endl;
-        sqlite3_free(errorMessage);
+long long SQLiteHistoryStorage::addJID(const JID& jid) const {
+    sqlite3_stmt* insertStatement = getStatement("INSERT INTO jids('jid') VALUES(?)");
+    if (!insertStatement) {
+        return 0;
     }
-    return sqlite3_last_insert_rowid(db_);
+    StatementResetter resetter(insertStatement);
+    bindText(insertStatement, 1, jid.toString());
+    if (sqlite3_step(insertStatement) != SQLITE_DONE) {
+        SWIFT_LOG(error) << "SQL error: " << sqlite3_errmsg(db_) << std::endl;
+    }
+    long long id = sqlite3_last_insert_rowid(db_);
+    jidIDs_[jid] = id;
+    idJIDs_[id] = jid;
+    return id;
 }
 
 boost::optional<JID> SQLiteHistoryStorage::getJIDFromID(long long id) const {
+    auto i = idJIDs_.find(id);
+    if (i != idJIDs_.end()) {
+        return i->second;
+    }
+
     boost::optional<JID> result;
-    sqlite3_stmt* selectStatement;
-    std::string selectQuery("SELECT jid FROM jids WHERE id=" + boost::lexical_cast<std::string>(id));
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    sqlite3_stmt* selectStatement = getStatement("SELECT jid FROM jids WHERE id=?");
+    if (!selectStatement) {
+        return result;
     }
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        result = boost::optional<JID>(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+    StatementResetter resetter(selectStatement);
+    sqlite3_bind_int64(selectStatement, 1, id);
+    if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+        result = JID(getColumnText(selectStatement, 0));
+        idJIDs_[id] = *result;
+        jidIDs_[*result] = id;
     }
-    sqlite3_finalize(selectStatement);
     return result;
 }
 
 boost::optional<long long> SQLiteHistoryStorage::getIDFromJID(const JID& jid) const {
+    auto i = jidIDs_.find(jid);
+    if (i != jidIDs_.end()) {
+        return i->second;
+    }
+
     boost::optional<long long> result;
-    sqlite3_stmt* selectStatement;
-    std::string selectQuery("SELECT id FROM jids WHERE jid='" + jid.toString() + "'");
-    long long r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    sqlite3_stmt* selectStatement = getStatement("SELECT id FROM jids WHERE jid=?");
+    if (!selectStatement) {
+        return result;
     }
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        result = boost::optional<long long>(sqlite3_column_int(selectStatement, 0));
+    StatementResetter resetter(selectStatement);
+    bindText(selectStatement, 1, jid.toString());
+    if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+        result = sqlite3_column_int64(selectStatement, 0);
+        jidIDs_[jid] = *result;
+        idJIDs_[*result] = jid;
     }
-    sqlite3_finalize(selectStatement);
     return result;
 }
 
 ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    writePendingMessages();
+
     ContactsMap result;
-    sqlite3_stmt* selectStatement;
 
     // get id
     boost::optional<long long> id = getIDFromJID(selfJID);
@@ -222,32 +358,36 @@ ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage
         return result;
     }
 
-    // get contacts
-    std::string query = "SELECT DISTINCT messages.'fromBare', messages.'fromResource', messages.'toBare', messages.'toResource', messages.'time' "
-        "FROM messages WHERE (type="
-        + boost::lexical_cast<std::string>(type) + " AND (toBare="
-        + boost::lexical_cast<std::string>(*id) + " OR fromBare=" + boost::lexical_cast<std::string>(*id) + "))";
+    // get contacts, and the days (since the epoch) with messages from or to them
+    std::string query = "SELECT DISTINCT messages.'fromBare', messages.'fromResource', messages.'toBare', messages.'toResource', "
+        "CASE WHEN messages.'time' >= 0 THEN messages.'time' / 86400 ELSE (messages.'time' - 86399) / 86400 END "
+        "FROM messages WHERE (type=?1 AND (toBare=?2 OR fromBare=?2))";
 
     // match keyword
-    if (getEscapedString(keyword).length()) {
-        query += " AND message LIKE '%" + getEscapedString(keyword) + "%'";
+    if (!keyword.empty()) {
+        query += " AND message LIKE ?3 ESCAPE '\\'";
     }
 
-    int r = sqlite3_prepare(db_, query.c_str(), boost::numeric_cast<int>(query.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    sqlite3_stmt* selectStatement = getStatement(query);
+    if (!selectStatement) {
+        return result;
+    }
+    StatementResetter resetter(selectStatement);
+    sqlite3_bind_int(selectStatement, 1, type);
+    sqlite3_bind_int64(selectStatement, 2, *id);
+    if (!keyword.empty()) {
+        bindText(selectStatement, 3, "%" + escapeLikePattern(keyword) + "%");
     }
 
-    r = sqlite3_step(selectStatement);
+    int r = sqlite3_step(selectStatement);
     while (r == SQLITE_ROW) {
-        int fromBareID = sqlite3_column_int(selectStatement, 0);
-        std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 1)));
-        int toBareID = sqlite3_column_int(selectStatement, 2);
-        std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 3)));
+        long long fromBareID = sqlite3_column_int64(selectStatement, 0);
+        std::string fromResource(getColumnText(selectStatement, 1));
+        long long toBareID = sqlite3_column_int64(selectStatement, 2);
+        std::string toResource(getColumnText(selectStatement, 3));
         std::string resource;
 
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 4));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+        boost::gregorian::date date = boost::gregorian::date(1970, 1, 1) + boost::gregorian::days(static_cast<long>(sqlite3_column_int64(selectStatement, 4)));
 
         boost::optional<JID> contactJID;
 
@@ -261,27 +401,28 @@ ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage
         }
 
         // check if it is a MUC contact (from a private conversation)
-        if (type == HistoryMessage::PrivateMessage) {
+        if (type == HistoryMessage::PrivateMessage && contactJID) {
             contactJID = boost::optional<JID>(JID(contactJID->getNode(), contactJID->getDomain(), resource));
         }
 
         if (contactJID) {
-            result[*contactJID].insert(time.date());
+            result[*contactJID].insert(date);
         }
 
         r = sqlite3_step(selectStatement);
     }
 
     if (r != SQLITE_DONE) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+        SWIFT_LOG(error) << "SQL error: " << sqlite3_errmsg(db_) << std::endl;
     }
-    sqlite3_finalize(selectStatement);
 
     return result;
 }
 
 boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const {
-    sqlite3_stmt* selectStatement;
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    writePendingMessages();
+
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
 
@@ -290,39 +431,18 @@ boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& self
         return boost::gregorian::date(boost::gregorian::not_a_date_time);
     }
 
-    std::string selectQuery = "SELECT time FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
-    if (contactJID.isBare()) {
-        // match only bare jid
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-                boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-    else {
-        // match resource too
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-                boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
-                getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
-                getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-
-    int timeStamp = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds() + (reverseOrder ? 0 : 86400);
-
-    selectQuery += " AND time" + (reverseOrder ? std::string("<") : std::string(">")) + boost::lexical_cast<std::string>(timeStamp);
-    selectQuery += " ORDER BY time " + (reverseOrder ? std::string("DESC") : std::string("ASC")) + " LIMIT 1";
-
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    sqlite3_stmt* selectStatement = getStatement(
+            "SELECT time FROM messages WHERE " + getConversationCondition(!contactJID.isBare()) +
+            (reverseOrder ? " AND time<?5 ORDER BY time DESC LIMIT 1" : " AND time>?5 ORDER BY time ASC LIMIT 1"));
+    if (!selectStatement) {
+        return boost::gregorian::date(boost::gregorian::not_a_date_time);
     }
+    StatementResetter resetter(selectStatement);
+    bindConversation(selectStatement, *selfID, *contactID, type, contactJID);
+    sqlite3_bind_int64(selectStatement, 5, getSecondsSinceEpoch(boost::posix_time::ptime(date)) + (reverseOrder ? 0 : 86400));
 
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 0));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
-        std::cout << "next day is: " << time.date() << "\n";
-        return time.date();
+    if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+        return getTimeFromSecondsSinceEpoch(sqlite3_column_int64(selectStatement, 0)).date();
     }
 
     return boost::gregorian::date(boost::gregorian::not_a_date_time);
@@ -349,6 +469,9 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromPreviousDate(co
 }
 
 boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    writePendingMessages();
+
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> mucID = getIDFromJID(mucJID.toBare());
 
@@ -357,21 +480,16 @@ boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID
         return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
     }
 
-
-    sqlite3_stmt* selectStatement;
-    std::string selectQuery = "SELECT messages.'time', messages.'offset' from messages WHERE type=1 AND (toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + " AND fromBare=" +
-                boost::lexical_cast<std::string>(*mucID) + ") ORDER BY time DESC LIMIT 1";
-
-    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
-    if (r != SQLITE_OK) {
-        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+    sqlite3_stmt* selectStatement = getStatement("SELECT messages.'time', messages.'offset' from messages WHERE type=1 AND (toBare=?1 AND fromBare=?2) ORDER BY time DESC LIMIT 1");
+    if (!selectStatement) {
+        return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
     }
+    StatementResetter resetter(selectStatement);
+    sqlite3_bind_int64(selectStatement, 1, *selfID);
+    sqlite3_bind_int64(selectStatement, 2, *mucID);
 
-    r = sqlite3_step(selectStatement);
-    if (r == SQLITE_ROW) {
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 0));
-        boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
+    if (sqlite3_step(selectStatement) == SQLITE_ROW) {
+        boost::posix_time::ptime time(getTimeFromSecondsSinceEpoch(sqlite3_column_int64(selectStatement, 0)));
         int offset = sqlite3_column_int(selectStatement, 1);
 
         return time - boost::posix_time::hours(offset);
@@ -380,7 +498,4 @@ boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID
     return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
 }
 
-void SQLiteHistoryStorage::run() {
-}
-
 }
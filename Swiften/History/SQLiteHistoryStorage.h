@@ -1,12 +1,17 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
@@ -15,8 +20,16 @@
 #include <Swiften/History/HistoryStorage.h>
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace Swift {
+    /**
+     * Stores the history in an SQLite database.
+     *
+     * Added messages are written by a background thread, in one transaction
+     * per batch. Queries first write out the messages that are still pending,
+     * so they always see every message added before.
+     */
     class SWIFTEN_API SQLiteHistoryStorage : public HistoryStorage {
         public:
             SQLiteHistoryStorage(const boost::filesystem::path& file);
@@ -31,14 +44,28 @@ namespace Swift {
 
         private:
             void run();
+            void writePendingMessages() const;
+            void exec(const std::string& statement) const;
+            sqlite3_stmt* getStatement(const std::string& query) const;
             boost::gregorian::date getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const;
-            long long getIDForJID(const JID&);
-            long long addJID(const JID&);
+            long long getIDForJID(const JID&) const;
+            long long addJID(const JID&) const;
 
             boost::optional<JID> getJIDFromID(long long id) const;
             boost::optional<long long> getIDFromJID(const JID& jid) const;
 
             sqlite3* db_;
             std::thread* thread_;
+
+            // Guards the database, the prepared statements, and the JID caches
+            mutable std::mutex dbMutex_;
+            mutable std::unordered_map<std::string, sqlite3_stmt*> statements_;
+            mutable std::unordered_map<JID, long long> jidIDs_;
+            mutable std::unordered_map<long long, JID> idJIDs_;
+
+            mutable std::mutex pendingMessagesMutex_;
+            std::condition_variable pendingMessagesAvailable_;
+            mutable std::vector<HistoryMessage> pendingMessages_;
+            bool stopping_;
     };
 }
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/History/SQLiteHistoryStorage.h>
+
+using namespace Swift;
+
+class SQLiteHistoryStorageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SQLiteHistoryStorageTest);
+        CPPUNIT_TEST(testGetMessagesFromDate);
+        CPPUNIT_TEST(testGetMessagesFromDate_MatchesResource);
+        CPPUNIT_TEST(testGetMessagesFromDate_UnknownContact);
+        CPPUNIT_TEST(testGetMessagesFromNextDate);
+        CPPUNIT_TEST(testGetMessagesFromPreviousDate);
+        CPPUNIT_TEST(testGetContacts_Keyword);
+        CPPUNIT_TEST(testGetContacts_KeywordWithWildcards);
+        CPPUNIT_TEST(testGetLastTimeStampFromMUC);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            testling_ = std::unique_ptr<SQLiteHistoryStorage>(new SQLiteHistoryStorage(":memory:"));
+        }
+
+        void tearDown() {
+            testling_.reset();
+        }
+
+        void testGetMessagesFromDate() {
+            HistoryMessage message1("Hi", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-01 10:00:00"));
+            HistoryMessage message2("It's late", JID("bob@example.com/home"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Chat, time("2017-03-01 10:01:00"));
+            testling_->addMessage(message1);
+            testling_->addMessage(HistoryMessage("Other", JID("carol@example.com/home"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Chat, time("2017-03-01 10:02:00")));
+            testling_->addMessage(HistoryMessage("Other day", JID("bob@example.com/home"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Chat, time("2017-03-02 10:00:00")));
+            testling_->addMessage(message2);
+
+            std::vector<HistoryMessage> messages = testling_->getMessagesFromDate(JID("alice@wonderland.lit"), JID("bob@example.com"), HistoryMessage::Chat, date("2017-03-01"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), messages.size());
+            CPPUNIT_ASSERT(message1 == messages[0]);
+            CPPUNIT_ASSERT(message2 == messages[1]);
+        }
+
+        void testGetMessagesFromDate_MatchesResource() {
+            testling_->addMessage(HistoryMessage("Hi", JID("alice@wonderland.lit/rabbithole"), JID("room@rooms.example.com/bob"), HistoryMessage::PrivateMessage, time("2017-03-01 10:00:00")));
+            testling_->addMessage(HistoryMessage("Hi", JID("alice@wonderland.lit/rabbithole"), JID("room@rooms.example.com/carol"), HistoryMessage::PrivateMessage, time("2017-03-01 10:01:00")));
+
+            std::vector<HistoryMessage> messages = testling_->getMessagesFromDate(JID("alice@wonderland.lit"), JID("room@rooms.example.com/carol"), HistoryMessage::PrivateMessage, date("2017-03-01"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), messages.size());
+            CPPUNIT_ASSERT_EQUAL(JID("room@rooms.example.com/carol"), messages[0].getToJID());
+        }
+
+        void testGetMessagesFromDate_UnknownContact() {
+            testling_->addMessage(HistoryMessage("Hi", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-01 10:00:00")));
+
+            CPPUNIT_ASSERT(testling_->getMessagesFromDate(JID("alice@wonderland.lit"), JID("carol@example.com"), HistoryMessage::Chat, date("2017-03-01")).empty());
+        }
+
+        void testGetMessagesFromNextDate() {
+            testling_->addMessage(HistoryMessage("1", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-01 10:00:00")));
+            testling_->addMessage(HistoryMessage("2", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-05 10:00:00")));
+
+            std::vector<HistoryMessage> messages = testling_->getMessagesFromNextDate(JID("alice@wonderland.lit"), JID("bob@example.com"), HistoryMessage::Chat, date("2017-03-01"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("2"), messages[0].getMessage());
+        }
+
+        void testGetMessagesFromPreviousDate() {
+            testling_->addMessage(HistoryMessage("1", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-01 10:00:00")));
+            testling_->addMessage(HistoryMessage("2", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-05 10:00:00")));
+
+            std::vector<HistoryMessage> messages = testling_->getMessagesFromPreviousDate(JID("alice@wonderland.lit"), JID("bob@example.com"), HistoryMessage::Chat, date("2017-03-05"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), messages.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("1"), messages[0].getMessage());
+        }
+
+        void testGetContacts_Keyword() {
+            testling_->addMessage(HistoryMessage("It's late", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-01 10:00:00")));
+            testling_->addMessage(HistoryMessage("Hi", JID("carol@example.com/home"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Chat, time("2017-03-02 10:00:00")));
+
+            ContactsMap contacts = testling_->getContacts(JID("alice@wonderland.lit"), HistoryMessage::Chat, "it's");
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), contacts.size());
+            CPPUNIT_ASSERT(contacts.find(JID("bob@example.com")) != contacts.end());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), testling_->getContacts(JID("alice@wonderland.lit"), HistoryMessage::Chat, "").size());
+        }
+
+        void testGetContacts_KeywordWithWildcards() {
+            testling_->addMessage(HistoryMessage("100% sure", JID("alice@wonderland.lit/rabbithole"), JID("bob@example.com/home"), HistoryMessage::Chat, time("2017-03-01 10:00:00")));
+            testling_->addMessage(HistoryMessage("100 percent", JID("carol@example.com/home"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Chat, time("2017-03-02 10:00:00")));
+            testling_->addMessage(HistoryMessage("a_b", JID("dave@example.com/home"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Chat, time("2017-03-03 10:00:00")));
+            testling_->addMessage(HistoryMessage("axb", JID("eve@example.com/home"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Chat, time("2017-03-04 10:00:00")));
+
+            ContactsMap contacts = testling_->getContacts(JID("alice@wonderland.lit"), HistoryMessage::Chat, "100%");
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), contacts.size());
+            CPPUNIT_ASSERT(contacts.find(JID("bob@example.com")) != contacts.end());
+
+            contacts = testling_->getContacts(JID("alice@wonderland.lit"), HistoryMessage::Chat, "a_b");
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), contacts.size());
+            CPPUNIT_ASSERT(contacts.find(JID("dave@example.com")) != contacts.end());
+        }
+
+        void testGetLastTimeStampFromMUC() {
+            testling_->addMessage(HistoryMessage("1", JID("room@rooms.example.com/bob"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Groupchat, time("2017-03-01 10:00:00"), 1));
+            testling_->addMessage(HistoryMessage("2", JID("room@rooms.example.com/bob"), JID("alice@wonderland.lit/rabbithole"), HistoryMessage::Groupchat, time("2017-03-01 11:00:00"), 1));
+
+            CPPUNIT_ASSERT_EQUAL(time("2017-03-01 10:00:00"), testling_->getLastTimeStampFromMUC(JID("alice@wonderland.lit"), JID("room@rooms.example.com")));
+        }
+
+    private:
+        static boost::posix_time::ptime time(const std::string& s) {
+            return boost::posix_time::time_from_string(s);
+        }
+
+        static boost::gregorian::date date(const std::string& s) {
+            return boost::gregorian::from_simple_string(s);
+        }
+
+    private:
+        std::unique_ptr<SQLiteHistoryStorage> testling_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SQLiteHistoryStorageTest);
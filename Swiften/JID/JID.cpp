@@ -1,23 +1,31 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #define SWIFTEN_CACHE_JID_PREP
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #ifdef SWIFTEN_CACHE_JID_PREP
+#include <array>
+#include <functional>
 #include <mutex>
-#include <unordered_map>
 #endif
 
+#include <boost/functional/hash.hpp>
 #include <boost/optional.hpp>
 
+#ifdef SWIFTEN_CACHE_JID_PREP
+#include <Swiften/Base/LRUCache.h>
+#endif
 #include <Swiften/Base/String.h>
+#include <Swiften/Base/StringView.h>
 #include <Swiften/IDN/IDNConverter.h>
 #include <Swiften/JID/JID.h>
 
@@ -28,15 +36,6 @@
 
 using namespace Swift;
 
-#ifdef SWIFTEN_CACHE_JID_PREP
-typedef std::unordered_map<std::string, std::string> PrepCache;
-
-static std::mutex namePrepCacheMutex;
-static PrepCache nodePrepCache;
-static PrepCache domainPrepCache;
-static PrepCache resourcePrepCache;
-#endif
-
 static const std::vector<char> escapedChars = {' ', '"', '&', '\'', '/', '<', '>', '@', ':'};
 
 static IDNConverter* idnConverter = nullptr;
@@ -52,6 +51,159 @@ namespace {
 }
 #endif
 
+static std::atomic<std::uint64_t> prepFastPathHits(0);
+static std::atomic<std::uint64_t> prepCacheHits(0);
+static std::atomic<std::uint64_t> prepCacheMisses(0);
+
+// Stringprep works on a 1024 byte buffer that includes the terminating zero,
+// so it fails on input larger than this.
+static const size_t MAX_PREP_SIZE = 1023;
+
+// The functions below check whether a component consists of ASCII characters
+// that the corresponding stringprep profile accepts and leaves unchanged, so
+// that preparing it can be skipped.
+
+static bool isCanonicalASCIINode(const std::string& node) {
+    if (node.size() > MAX_PREP_SIZE) {
+        return false;
+    }
+    for (char c : node) {
+        if (c <= 0x20 || c >= 0x7F || (c >= 'A' && c <= 'Z')) {
+            return false;
+        }
+        switch (c) {
+            case '"': case '&': case '\'': case '/': case ':': case '<': case '>': case '@':
+                return false;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+static bool isCanonicalASCIIResource(const std::string& resource) {
+    if (resource.size() > MAX_PREP_SIZE) {
+        return false;
+    }
+    for (char c : resource) {
+        if (c < 0x20 || c >= 0x7F) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Also implies that IDNA encoding (with the STD3 ASCII rules) succeeds.
+static bool isCanonicalASCIIDomain(const std::string& domain) {
+    if (domain.empty() || domain.size() > MAX_PREP_SIZE) {
+        return false;
+    }
+    size_t labelStart = 0;
+    while (true) {
+        size_t labelEnd = domain.find('.', labelStart);
+        if (labelEnd == std::string::npos) {
+            labelEnd = domain.size();
+        }
+        size_t labelSize = labelEnd - labelStart;
+        if (labelSize == 0 || labelSize > 63) {
+            return false;
+        }
+        if (domain[labelStart] == '-' || domain[labelEnd - 1] == '-') {
+            return false;
+        }
+        // Leave labels such as ACE labels ("xn--") to the IDN converter
+        if (labelSize >= 4 && domain[labelStart + 2] == '-' && domain[labelStart + 3] == '-') {
+            return false;
+        }
+        for (size_t i = labelStart; i < labelEnd; ++i) {
+            char c = domain[i];
+            if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-')) {
+                return false;
+            }
+        }
+        if (labelEnd == domain.size()) {
+            return true;
+        }
+        labelStart = labelEnd + 1;
+    }
+}
+
+#ifdef SWIFTEN_CACHE_JID_PREP
+namespace {
+    /**
+     * A bounded cache of stringprep results. The entries are spread over
+     * shards that are locked independently, and each shard evicts its least
+     * recently used entries.
+     */
+    class PrepCache {
+        public:
+            boost::optional<std::string> getPrepared(const std::string& s, IDNConverter::StringPrepProfile profile) {
+                Shard& shard = shards_[std::hash<std::string>()(s) % SHARDS];
+                {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    boost::optional<std::string> cached = shard.cache.get(s);
+                    if (cached) {
+                        ++prepCacheHits;
+                        return cached;
+                    }
+                }
+                ++prepCacheMisses;
+
+                std::string prepared;
+                try {
+                    prepared = idnConverter->getStringPrepared(s, profile);
+                }
+                catch (...) {
+                    return boost::none;
+                }
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.cache.insert(s, prepared);
+                return prepared;
+            }
+
+        private:
+            static const size_t SHARDS = 16;
+            static const size_t SHARD_SIZE = 1024;
+
+            struct Shard {
+                std::mutex mutex;
+                LRUCache<std::string, std::string, SHARD_SIZE> cache;
+            };
+
+            std::array<Shard, SHARDS> shards_;
+    };
+
+    PrepCache& getPrepCache(IDNConverter::StringPrepProfile profile) {
+        static PrepCache nodePrepCache;
+        static PrepCache domainPrepCache;
+        static PrepCache resourcePrepCache;
+        switch (profile) {
+            case IDNConverter::XMPPNodePrep: return nodePrepCache;
+            case IDNConverter::NamePrep: return domainPrepCache;
+            default: return resourcePrepCache;
+        }
+    }
+}
+#endif
+
+static bool getPrepared(const std::string& s, IDNConverter::StringPrepProfile profile, bool isCanonical, std::string& result) {
+    if (isCanonical) {
+        ++prepFastPathHits;
+        result = s;
+        return true;
+    }
+#ifdef SWIFTEN_CACHE_JID_PREP
+    boost::optional<std::string> prepared = getPrepCache(profile).getPrepared(s, profile);
+    if (!prepared) {
+        return false;
+    }
+    result = std::move(*prepared);
+#else
+    result = idnConverter->getStringPrepared(s, profile);
+#endif
+    return true;
+}
+
 static std::string getEscaped(char c) {
     return makeString() << '\\' << std::hex << static_cast<int>(c);
 }
@@ -65,22 +217,33 @@ static bool getEscapeSequenceValue(const std::string& sequence, unsigned char& v
     return (!s.fail() && !s.bad() && (value == 0x5C || std::find(escapedChars.begin(), escapedChars.end(), value) != escapedChars.end()));
 }
 
+static int compareParts(const StringView& a, const StringView& b) {
+    int result = std::char_traits<char>::compare(a.data(), b.data(), std::min(a.size(), b.size()));
+    if (result != 0) {
+        return result < 0 ? -1 : 1;
+    }
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    return 0;
+}
+
 namespace Swift {
 
-JID::JID(const char* jid) : valid_(true) {
+JID::JID(const char* jid) : hash_(0), valid_(true), hasResource_(false) {
     assert(jid);
     initializeFromString(std::string(jid));
 }
 
-JID::JID(const std::string& jid) : valid_(true) {
+JID::JID(const std::string& jid) : hash_(0), valid_(true), hasResource_(false) {
     initializeFromString(jid);
 }
 
-JID::JID(const std::string& node, const std::string& domain) : valid_(true), hasResource_(false) {
+JID::JID(const std::string& node, const std::string& domain) : hash_(0), valid_(true), hasResource_(false) {
     nameprepAndSetComponents(node, domain, "");
 }
 
-JID::JID(const std::string& node, const std::string& domain, const std::string& resource) : valid_(true), hasResource_(true) {
+JID::JID(const std::string& node, const std::string& domain, const std::string& resource) : hash_(0), valid_(true), hasResource_(true) {
     if (resource.empty()) {
         valid_ = false;
     }
@@ -115,95 +278,81 @@ void JID::initializeFromString(const std::string& jid) {
 
 
 void JID::nameprepAndSetComponents(const std::string& node, const std::string& domain, const std::string& resource) {
-    if (domain.empty() || !idnConverter->getIDNAEncoded(domain)) {
+    if (domain.empty()) {
         valid_ = false;
         return;
     }
-
-    if (hasResource_ && resource.empty()) {
+    bool domainIsCanonical = isCanonicalASCIIDomain(domain);
+    if (!domainIsCanonical && !idnConverter->getIDNAEncoded(domain)) {
         valid_ = false;
         return;
     }
-#ifndef SWIFTEN_CACHE_JID_PREP
-    node_ = idnConverter->getStringPrepared(node, IDNConverter::XMPPNodePrep);
-    domain_ = idnConverter->getStringPrepared(domain, IDNConverter::NamePrep);
-    resource_ = idnConverter->getStringPrepared(resource, IDNConverter::XMPPResourcePrep);
-#else
-    std::unique_lock<std::mutex> lock(namePrepCacheMutex);
-
-    std::pair<PrepCache::iterator, bool> r;
 
-    r = nodePrepCache.insert(std::make_pair(node, std::string()));
-    if (r.second) {
-        try {
-            r.first->second = idnConverter->getStringPrepared(node, IDNConverter::XMPPNodePrep);
-        }
-        catch (...) {
-            nodePrepCache.erase(r.first);
-            valid_ = false;
-            return;
-        }
-    }
-    node_ = r.first->second;
-
-    r = domainPrepCache.insert(std::make_pair(domain, std::string()));
-    if (r.second) {
-        try {
-            r.first->second = idnConverter->getStringPrepared(domain, IDNConverter::NamePrep);
-        }
-        catch (...) {
-            domainPrepCache.erase(r.first);
-            valid_ = false;
-            return;
-        }
+    if (hasResource_ && resource.empty()) {
+        valid_ = false;
+        return;
     }
-    domain_ = r.first->second;
-
-    r = resourcePrepCache.insert(std::make_pair(resource, std::string()));
-    if (r.second) {
-        try {
-            r.first->second = idnConverter->getStringPrepared(resource, IDNConverter::XMPPResourcePrep);
-        }
-        catch (...) {
-            resourcePrepCache.erase(r.first);
-            valid_ = false;
-            return;
-        }
+    std::string preparedNode, preparedDomain, preparedResource;
+    if (!getPrepared(node, IDNConverter::XMPPNodePrep, isCanonicalASCIINode(node), preparedNode) ||
+            !getPrepared(domain, IDNConverter::NamePrep, domainIsCanonical, preparedDomain) ||
+            !getPrepared(resource, IDNConverter::XMPPResourcePrep, isCanonicalASCIIResource(resource), preparedResource)) {
+        valid_ = false;
+        return;
     }
-    resource_ = r.first->second;
-#endif
 
-    if (domain_.empty()) {
+    if (preparedDomain.empty()) {
         valid_ = false;
         return;
     }
+    node_ = std::move(preparedNode);
+    domain_ = std::move(preparedDomain);
+    resource_ = std::move(preparedResource);
+    updateHash();
+}
+
+/**
+ * Combines the hashes of the parts, so that no string with the whole JID
+ * needs to be built.
+ */
+void JID::updateHash() {
+    StringView::Hash hash;
+    std::size_t result = 0;
+    boost::hash_combine(result, hash(StringView(node_)));
+    boost::hash_combine(result, hash(StringView(domain_)));
+    if (hasResource_) {
+        boost::hash_combine(result, hash(StringView(resource_)));
+    }
+    hash_ = static_cast<std::uint32_t>(result);
 }
 
 std::string JID::toString() const {
     std::string string;
+    string.reserve(node_.size() + domain_.size() + resource_.size() + 2);
     if (!node_.empty()) {
-        string += node_ + "@";
+        string += node_;
+        string += '@';
     }
     string += domain_;
     if (!isBare()) {
-        string += "/" + resource_;
+        string += '/';
+        string += resource_;
     }
     return string;
 }
 
 int JID::compare(const Swift::JID& o, CompareType compareType) const {
-    if (node_ < o.node_) { return -1; }
-    if (node_ > o.node_) { return 1; }
-    if (domain_ < o.domain_) { return -1; }
-    if (domain_ > o.domain_) { return 1; }
-    if (compareType == WithResource) {
-        if (hasResource_ != o.hasResource_) {
-            return hasResource_ ? 1 : -1;
-        }
-        if (resource_ < o.resource_) { return -1; }
-        if (resource_ > o.resource_) { return 1; }
+    int result = compareParts(StringView(node_), StringView(o.node_));
+    if (result != 0) {
+        return result;
     }
-    return 0;
+    result = compareParts(StringView(domain_), StringView(o.domain_));
+    if (result != 0 || compareType != WithResource) {
+        return result;
+    }
+    if (hasResource_ != o.hasResource_) {
+        return hasResource_ ? 1 : -1;
+    }
+    return compareParts(StringView(resource_), StringView(o.resource_));
 }
 
 std::string JID::getEscapedNode(const std::string& node) {
@@ -231,11 +380,12 @@ std::string JID::getEscapedNode(const std::string& node) {
 }
 
 std::string JID::getUnescapedNode() const {
+    const std::string& node = getNode();
     std::string result;
-    for (std::string::const_iterator j = node_.begin(); j != node_.end();) {
+    for (std::string::const_iterator j = node.begin(); j != node.end();) {
         if (*j == '\\') {
             std::string::const_iterator innerEnd = j + 1;
-            for (size_t i = 0; i < 2 && innerEnd != node_.end(); ++i, ++innerEnd) {
+            for (size_t i = 0; i < 2 && innerEnd != node.end(); ++i, ++innerEnd) {
             }
             unsigned char value;
             if (getEscapeSequenceValue(std::string(j + 1, innerEnd), value)) {
@@ -254,6 +404,20 @@ void JID::setIDNConverter(IDNConverter* converter) {
     idnConverter = converter;
 }
 
+JID::PrepCacheStatistics JID::getPrepCacheStatistics() {
+    PrepCacheStatistics statistics;
+    statistics.fastPathHits = prepFastPathHits;
+    statistics.hits = prepCacheHits;
+    statistics.misses = prepCacheMisses;
+    return statistics;
+}
+
+void JID::resetPrepCacheStatistics() {
+    prepFastPathHits = 0;
+    prepCacheHits = 0;
+    prepCacheMisses = 0;
+}
+
 std::ostream& operator<<(std::ostream& os, const JID& j) {
     os << j.toString();
     return os;
@@ -1,11 +1,14 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <string>
 
@@ -26,6 +29,9 @@ namespace Swift {
      *
      * A JID can be invalid (when isValid() returns false). No member methods are
      * guaranteed to work correctly if they do.
+     *
+     * The hash of the JID is computed on construction, so JIDs can be used
+     * as keys of hashed containers at little cost.
      */
     class SWIFTEN_API JID {
         public:
@@ -132,6 +138,9 @@ namespace Swift {
                 JID result(*this);
                 result.hasResource_ = false;
                 result.resource_ = "";
+                if (valid_) {
+                    result.updateHash();
+                }
                 return result;
             }
 
@@ -146,9 +155,20 @@ namespace Swift {
             std::string toString() const;
 
             bool equals(const JID& o, CompareType compareType) const {
+                if (compareType == WithResource && hash_ != o.hash_) {
+                    return false;
+                }
                 return compare(o, compareType) == 0;
             }
 
+            /**
+             * Returns the hash of the JID, including its resource. Equal JIDs
+             * have equal hashes.
+             */
+            std::size_t getHash() const {
+                return hash_;
+            }
+
             int compare(const JID& o, CompareType compareType) const;
 
             operator std::string() const {
@@ -162,11 +182,11 @@ namespace Swift {
             SWIFTEN_API friend std::ostream& operator<<(std::ostream& os, const Swift::JID& j);
 
             friend bool operator==(const Swift::JID& a, const Swift::JID& b) {
-                return a.compare(b, Swift::JID::WithResource) == 0;
+                return a.equals(b, Swift::JID::WithResource);
             }
 
             friend bool operator!=(const Swift::JID& a, const Swift::JID& b) {
-                return a.compare(b, Swift::JID::WithResource) != 0;
+                return !a.equals(b, Swift::JID::WithResource);
             }
 
             /**
@@ -182,17 +202,45 @@ namespace Swift {
              */
             static void setIDNConverter(IDNConverter*);
 
+            /**
+             * Counters of the cache of prepared JID components.
+             */
+            struct PrepCacheStatistics {
+                /**
+                 * Components that were canonical ASCII already, and needed
+                 * neither the cache nor stringprep.
+                 */
+                std::uint64_t fastPathHits = 0;
+                std::uint64_t hits = 0;
+                std::uint64_t misses = 0;
+            };
+
+            static PrepCacheStatistics getPrepCacheStatistics();
+            static void resetPrepCacheStatistics();
+
         private:
             void nameprepAndSetComponents(const std::string& node, const std::string& domain, const std::string& resource);
             void initializeFromString(const std::string&);
+            void updateHash();
 
         private:
-            bool valid_;
             std::string node_;
             std::string domain_;
-            bool hasResource_;
             std::string resource_;
+            // 32 bits, so that it fits next to the flags in the padding of the object
+            std::uint32_t hash_;
+            bool valid_;
+            bool hasResource_;
     };
 
     SWIFTEN_API std::ostream& operator<<(std::ostream& os, const Swift::JID& j);
 }
+
+namespace std {
+    template<>
+    struct hash<Swift::JID> {
+        size_t operator()(const Swift::JID& jid) const {
+            return jid.getHash();
+        }
+    };
+}
@@ -1,9 +1,11 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
+#include <unordered_map>
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
@@ -62,6 +64,13 @@ class JIDTest : public CppUnit::TestFixture
         CPPUNIT_TEST(testGetEscapedNode_BackslashAtEnd);
         CPPUNIT_TEST(testGetUnescapedNode);
         CPPUNIT_TEST(testGetUnescapedNode_XEP106Examples);
+        CPPUNIT_TEST(testGetHash_EqualJIDs);
+        CPPUNIT_TEST(testGetHash_BareJIDFromFullJID);
+        CPPUNIT_TEST(testUnorderedMapKey);
+        CPPUNIT_TEST(testCompare_BareJIDFromFullJID);
+        CPPUNIT_TEST(testPrepCache_CanonicalASCIISkipsCache);
+        CPPUNIT_TEST(testPrepCache_NonCanonical);
+        CPPUNIT_TEST(testPrepCache_InvalidASCIIDomain);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -425,6 +434,78 @@ class JIDTest : public CppUnit::TestFixture
             CPPUNIT_ASSERT_EQUAL(std::string("c:\\cool stuff"), JID("c\\3a\\cool\\20stuff@example.com").getUnescapedNode());
             CPPUNIT_ASSERT_EQUAL(std::string("c:\\5commas"), JID("c\\3a\\5c5commas@example.com").getUnescapedNode());
         }
+
+        void testGetHash_EqualJIDs() {
+            CPPUNIT_ASSERT_EQUAL(JID("foo@bar/baz").getHash(), JID("foo", "Bar", "baz").getHash());
+            CPPUNIT_ASSERT(JID("foo@bar/baz").getHash() != JID("foo@bar").getHash());
+        }
+
+        void testGetHash_BareJIDFromFullJID() {
+            JID testling("foo@bar/baz");
+
+            CPPUNIT_ASSERT_EQUAL(JID("foo@bar").getHash(), testling.toBare().getHash());
+        }
+
+        void testUnorderedMapKey() {
+            std::unordered_map<JID, int> testling;
+            testling[JID("foo@bar/baz")] = 1;
+            testling[JID("foo@bar")] = 2;
+            testling[JID("Foo@Bar/baz")] = 3;
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), testling.size());
+            CPPUNIT_ASSERT_EQUAL(3, testling[JID("foo@bar/baz")]);
+            CPPUNIT_ASSERT_EQUAL(2, testling[JID("foo@bar/baz").toBare()]);
+        }
+
+        void testCompare_BareJIDFromFullJID() {
+            JID testling = JID("foo@bar/baz").toBare();
+
+            CPPUNIT_ASSERT_EQUAL(JID("foo@bar"), testling);
+            CPPUNIT_ASSERT_EQUAL(std::string("foo@bar"), testling.toString());
+            CPPUNIT_ASSERT_EQUAL(std::string(""), testling.getResource());
+            CPPUNIT_ASSERT_EQUAL(0, testling.compare(JID("foo@bar/qux"), JID::WithoutResource));
+            CPPUNIT_ASSERT_EQUAL(-1, testling.compare(JID("foo@bar/qux"), JID::WithResource));
+            CPPUNIT_ASSERT_EQUAL(1, JID("foo@bar/qux").compare(testling, JID::WithResource));
+        }
+
+        void testPrepCache_CanonicalASCIISkipsCache() {
+            JID::resetPrepCacheStatistics();
+
+            JID testling("alice@wonder-land.lit/Tea Party");
+
+            CPPUNIT_ASSERT(testling.isValid());
+            CPPUNIT_ASSERT_EQUAL(std::string("alice"), testling.getNode());
+            CPPUNIT_ASSERT_EQUAL(std::string("wonder-land.lit"), testling.getDomain());
+            CPPUNIT_ASSERT_EQUAL(std::string("Tea Party"), testling.getResource());
+            JID::PrepCacheStatistics statistics = JID::getPrepCacheStatistics();
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(3), statistics.fastPathHits);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), statistics.hits);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), statistics.misses);
+        }
+
+        void testPrepCache_NonCanonical() {
+            JID::resetPrepCacheStatistics();
+
+            JID testling1("PrepCache@PrepCache.LIT/Cache\xCE\xA9");
+            JID testling2("PrepCache@PrepCache.LIT/Cache\xCE\xA9");
+
+            CPPUNIT_ASSERT_EQUAL(std::string("prepcache"), testling2.getNode());
+            CPPUNIT_ASSERT_EQUAL(std::string("prepcache.lit"), testling2.getDomain());
+            CPPUNIT_ASSERT_EQUAL(std::string("Cache\xCE\xA9"), testling2.getResource());
+            CPPUNIT_ASSERT(testling1 == testling2);
+            JID::PrepCacheStatistics statistics = JID::getPrepCacheStatistics();
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), statistics.fastPathHits);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(3), statistics.hits);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(3), statistics.misses);
+        }
+
+        void testPrepCache_InvalidASCIIDomain() {
+            CPPUNIT_ASSERT(!JID("foo@-bar.lit").isValid());
+            CPPUNIT_ASSERT(!JID("foo@bar-.lit").isValid());
+            CPPUNIT_ASSERT(!JID("foo@bar_baz.lit").isValid());
+            CPPUNIT_ASSERT(!JID("foo@" + std::string(64, 'a') + ".lit").isValid());
+            CPPUNIT_ASSERT(JID("foo@" + std::string(63, 'a') + ".lit").isValid());
+        }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(JIDTest);
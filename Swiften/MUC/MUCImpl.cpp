@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -69,8 +69,8 @@ std::map<std::string, MUCOccupant> MUCImpl::getOccupants() const {
 bool MUCImpl::isEqualExceptID(const Presence& lhs, const Presence& rhs) {
     bool isEqual = false;
     if (lhs.getFrom() == rhs.getFrom() && lhs.getTo() == rhs.getTo() && lhs.getStatus() == rhs.getStatus() && lhs.getShow() == rhs.getShow()) {
-        CapsInfo::ref lhsCaps = lhs.getPayload<CapsInfo>();
-        CapsInfo::ref rhsCaps = rhs.getPayload<CapsInfo>();
+        const CapsInfo* lhsCaps = lhs.getPayloadPtr<CapsInfo>();
+        const CapsInfo* rhsCaps = rhs.getPayloadPtr<CapsInfo>();
 
         if (!!lhsCaps && !!rhsCaps) {
             isEqual = (*lhsCaps == *rhsCaps);
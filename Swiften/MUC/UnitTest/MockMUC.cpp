@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -23,6 +23,20 @@ void MockMUC::insertOccupant(const MUCOccupant& occupant)
     onOccupantJoined(occupant);
 }
 
+void MockMUC::renameOccupant(const std::string& oldNick, const std::string& newNick)
+{
+    std::map<std::string, MUCOccupant>::iterator i = occupants_.find(oldNick);
+    if (i != occupants_.end()) {
+        MUCOccupant occupant(newNick, i->second.getRole(), i->second.getAffiliation());
+        if (i->second.getRealJID()) {
+            occupant.setRealJID(*i->second.getRealJID());
+        }
+        occupants_.erase(i);
+        occupants_.insert(std::make_pair(newNick, occupant));
+    }
+    onOccupantNicknameChanged(oldNick, newNick);
+}
+
 const MUCOccupant& MockMUC::getOccupant(const std::string& nick) {
     return occupants_.find(nick)->second;
 }
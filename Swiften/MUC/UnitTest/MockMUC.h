@@ -38,6 +38,11 @@ namespace Swift {
              */
             void insertOccupant(const MUCOccupant& occupant);
 
+            /**
+             * Cause a user to appear to have changed their nickname. For testing only.
+             */
+            void renameOccupant(const std::string& oldNick, const std::string& newNick);
+
             /**
              * Returns the (bare) JID of the MUC.
              */
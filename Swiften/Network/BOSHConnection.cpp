@@ -43,6 +43,7 @@ BOSHConnection::BOSHConnection(const URL& boshURL, Connector::ref connector, XML
 {
     if (boshURL_.getScheme() == "https") {
         tlsLayer_ = std::make_shared<TLSLayer>(tlsContextFactory, tlsOptions);
+        tlsLayer_->getContext()->setServerIdentity(boshURL_.getHost() + ":" + std::to_string(URL::getPortOrDefaultPort(boshURL_)));
         // The following dummyLayer_ is needed as the TLSLayer will pass the decrypted data to its parent layer.
         // The dummyLayer_ will serve as the parent layer.
         dummyLayer_ = std::make_shared<DummyStreamLayer>(tlsLayer_.get());
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,16 +10,15 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <boost/asio/placeholders.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/bind.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
-#include <Swiften/Base/Algorithm.h>
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/Log.h>
-#include <Swiften/Base/SafeAllocator.h>
 #include <Swiften/Base/sleep.h>
 #include <Swiften/EventLoop/EventLoop.h>
 #include <Swiften/Network/HostAddressPort.h>
@@ -27,32 +26,73 @@
 namespace Swift {
 
 static const size_t BUFFER_SIZE = 4096;
+static const size_t MAX_POOLED_READ_BUFFERS = 4;
 
 // -----------------------------------------------------------------------------
 
-// A reference-counted non-modifiable buffer class.
-class SharedBuffer {
+// Presents the buffers of a write as one buffer sequence, without copying the
+// underlying vector when asio copies the sequence.
+class BoostConnection::WriteBufferSequence {
     public:
-        SharedBuffer(const SafeByteArray& data) :
-                data_(new std::vector<char, SafeAllocator<char> >(data.begin(), data.end())),
-                buffer_(boost::asio::buffer(*data_)) {
+        WriteBufferSequence(const std::vector<boost::asio::const_buffer>& buffers) : buffers_(&buffers) {
         }
 
         // ConstBufferSequence requirements.
         typedef boost::asio::const_buffer value_type;
-        typedef const boost::asio::const_buffer* const_iterator;
-        const boost::asio::const_buffer* begin() const { return &buffer_; }
-        const boost::asio::const_buffer* end() const { return &buffer_ + 1; }
+        typedef std::vector<boost::asio::const_buffer>::const_iterator const_iterator;
+        const_iterator begin() const { return buffers_->begin(); }
+        const_iterator end() const { return buffers_->end(); }
 
     private:
-        std::shared_ptr< std::vector<char, SafeAllocator<char> > > data_;
-        boost::asio::const_buffer buffer_;
+        const std::vector<boost::asio::const_buffer>* buffers_;
+};
+
+// -----------------------------------------------------------------------------
+
+// Recycles read buffers between reads. A buffer handed out by acquire() goes back
+// into the pool once the last reference to it (e.g. from a posted onDataRead event)
+// is released, so a steady stream of reads does not allocate.
+class BoostConnection::ReadBufferPool : public std::enable_shared_from_this<ReadBufferPool> {
+    public:
+        std::shared_ptr<SafeByteArray> acquire() {
+            std::unique_ptr<SafeByteArray> buffer;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!buffers_.empty()) {
+                    buffer = std::move(buffers_.back());
+                    buffers_.pop_back();
+                }
+            }
+            if (buffer) {
+                buffer->resize(BUFFER_SIZE);
+            }
+            else {
+                buffer = std::unique_ptr<SafeByteArray>(new SafeByteArray(BUFFER_SIZE));
+            }
+            std::shared_ptr<ReadBufferPool> pool = shared_from_this();
+            return std::shared_ptr<SafeByteArray>(buffer.release(), [pool](SafeByteArray* released) {
+                pool->release(released);
+            });
+        }
+
+    private:
+        void release(SafeByteArray* buffer) {
+            std::unique_ptr<SafeByteArray> ownedBuffer(buffer);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (buffers_.size() < MAX_POOLED_READ_BUFFERS) {
+                buffers_.push_back(std::move(ownedBuffer));
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<SafeByteArray> > buffers_;
 };
 
 // -----------------------------------------------------------------------------
 
 BoostConnection::BoostConnection(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) :
-    eventLoop(eventLoop), ioService(ioService), socket_(*ioService), writing_(false), closeSocketAfterNextWrite_(false) {
+    eventLoop(eventLoop), ioService(ioService), socket_(*ioService), readBufferPool_(std::make_shared<ReadBufferPool>()), writing_(false), queuedWriteBytes_(0), writeHighWatermark_(0), writeQueueFull_(false), closeSocketAfterNextWrite_(false) {
 }
 
 BoostConnection::~BoostConnection() {
@@ -93,17 +133,35 @@ void BoostConnection::closeSocket() {
 
 void BoostConnection::write(const SafeByteArray& data) {
     std::lock_guard<std::mutex> lock(writeMutex_);
+    writeQueue_.push_back(std::make_shared<SafeByteArray>(data));
+    queuedWriteBytes_ += data.size();
+    if (writeHighWatermark_ > 0 && !writeQueueFull_ && queuedWriteBytes_ >= writeHighWatermark_) {
+        writeQueueFull_ = true;
+        eventLoop->postEvent(boost::ref(onWriteQueueFull), shared_from_this());
+    }
     if (!writing_) {
         writing_ = true;
-        doWrite(data);
-    }
-    else {
-        append(writeQueue_, data);
+        doWrite();
     }
 }
 
-void BoostConnection::doWrite(const SafeByteArray& data) {
-    boost::asio::async_write(socket_, SharedBuffer(data),
+void BoostConnection::setWriteHighWatermark(size_t bytes) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    writeHighWatermark_ = bytes;
+}
+
+size_t BoostConnection::getQueuedWriteBytes() const {
+    return queuedWriteBytes_.load();
+}
+
+// Sends all queued buffers with a single gathering write. Needs to be called with writeMutex_ locked.
+void BoostConnection::doWrite() {
+    writingBuffers_.swap(writeQueue_);
+    writingBufferSequence_.clear();
+    for (const auto& buffer : writingBuffers_) {
+        writingBufferSequence_.push_back(boost::asio::buffer(*buffer));
+    }
+    boost::asio::async_write(socket_, WriteBufferSequence(writingBufferSequence_),
             boost::bind(&BoostConnection::handleDataWritten, shared_from_this(), boost::asio::placeholders::error));
 }
 
@@ -119,7 +177,7 @@ void BoostConnection::handleConnectFinished(const boost::system::error_code& err
 }
 
 void BoostConnection::doRead() {
-    readBuffer_ = std::make_shared<SafeByteArray>(BUFFER_SIZE);
+    readBuffer_ = readBufferPool_->acquire();
     std::lock_guard<std::mutex> lock(readCloseMutex_);
     socket_.async_read_some(
             boost::asio::buffer(*readBuffer_),
@@ -154,15 +212,22 @@ void BoostConnection::handleDataWritten(const boost::system::error_code& error)
     }
     {
         std::lock_guard<std::mutex> lock(writeMutex_);
+        for (const auto& buffer : writingBuffers_) {
+            queuedWriteBytes_ -= buffer->size();
+        }
+        writingBuffers_.clear();
         if (writeQueue_.empty()) {
             writing_ = false;
+            if (writeQueueFull_) {
+                writeQueueFull_ = false;
+                eventLoop->postEvent(boost::ref(onWriteQueueDrained), shared_from_this());
+            }
             if (closeSocketAfterNextWrite_) {
                 closeSocket();
             }
         }
         else {
-            doWrite(writeQueue_);
-            writeQueue_.clear();
+            doWrite();
         }
     }
 }
@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -51,24 +53,38 @@ namespace Swift {
             std::vector<Certificate::ref> getPeerCertificateChain() const;
             std::shared_ptr<CertificateVerificationError> getPeerCertificateVerificationError() const;
 
+            virtual void setWriteHighWatermark(size_t bytes);
+
+            virtual size_t getQueuedWriteBytes() const;
+
         private:
+            class ReadBufferPool;
+            class WriteBufferSequence;
+
             BoostConnection(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop);
 
             void handleConnectFinished(const boost::system::error_code& error);
             void handleSocketRead(const boost::system::error_code& error, size_t bytesTransferred);
             void handleDataWritten(const boost::system::error_code& error);
             void doRead();
-            void doWrite(const SafeByteArray& data);
+            void doWrite();
             void closeSocket();
 
         private:
             EventLoop* eventLoop;
             std::shared_ptr<boost::asio::io_service> ioService;
             boost::asio::ip::tcp::socket socket_;
+            std::shared_ptr<ReadBufferPool> readBufferPool_;
             std::shared_ptr<SafeByteArray> readBuffer_;
             std::mutex writeMutex_;
             bool writing_;
-            SafeByteArray writeQueue_;
+            std::vector<std::shared_ptr<SafeByteArray> > writeQueue_;
+            std::vector<std::shared_ptr<SafeByteArray> > writingBuffers_;
+            std::vector<boost::asio::const_buffer> writingBufferSequence_;
+            // Only changed with writeMutex_ locked, but read without
+            std::atomic<size_t> queuedWriteBytes_;
+            size_t writeHighWatermark_;
+            bool writeQueueFull_;
             bool closeSocketAfterNextWrite_;
             std::mutex readCloseMutex_;
     };
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,14 +7,18 @@
 #include <Swiften/Network/BoostConnectionFactory.h>
 
 #include <Swiften/Network/BoostConnection.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 
 namespace Swift {
 
-BoostConnectionFactory::BoostConnectionFactory(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), eventLoop(eventLoop) {
+BoostConnectionFactory::BoostConnectionFactory(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), ioServicePool(nullptr), eventLoop(eventLoop) {
+}
+
+BoostConnectionFactory::BoostConnectionFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop) : ioServicePool(ioServicePool), eventLoop(eventLoop) {
 }
 
 std::shared_ptr<Connection> BoostConnectionFactory::createConnection() {
-    return BoostConnection::create(ioService, eventLoop);
+    return BoostConnection::create(ioServicePool ? ioServicePool->getNextIOService() : ioService, eventLoop);
 }
 
 }
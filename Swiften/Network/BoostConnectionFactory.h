@@ -13,14 +13,22 @@
 #include <Swiften/Network/ConnectionFactory.h>
 
 namespace Swift {
+    class BoostIOServicePool;
+
     class SWIFTEN_API BoostConnectionFactory : public ConnectionFactory {
         public:
             BoostConnectionFactory(std::shared_ptr<boost::asio::io_service>, EventLoop* eventLoop);
 
+            /**
+             * Creates connections on the io_services of the given pool, in round-robin order.
+             */
+            BoostConnectionFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop);
+
             virtual std::shared_ptr<Connection> createConnection();
 
         private:
             std::shared_ptr<boost::asio::io_service> ioService;
+            BoostIOServicePool* ioServicePool;
             EventLoop* eventLoop;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,13 +16,22 @@
 
 #include <Swiften/Base/Log.h>
 #include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 
 namespace Swift {
 
-BoostConnectionServer::BoostConnectionServer(int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : port_(port), ioService_(ioService), eventLoop(eventLoop), acceptor_(nullptr) {
+BoostConnectionServer::BoostConnectionServer(int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop, BoostIOServicePool* ioServicePool) : port_(port), ioService_(ioService), ioServicePool_(ioServicePool), eventLoop(eventLoop), acceptor_(nullptr) {
 }
 
-BoostConnectionServer::BoostConnectionServer(const HostAddress &address, int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : address_(address), port_(port), ioService_(ioService), eventLoop(eventLoop), acceptor_(nullptr) {
+BoostConnectionServer::BoostConnectionServer(const HostAddress &address, int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop, BoostIOServicePool* ioServicePool) : address_(address), port_(port), ioService_(ioService), ioServicePool_(ioServicePool), eventLoop(eventLoop), acceptor_(nullptr) {
+}
+
+BoostConnectionServer::ref BoostConnectionServer::create(int port, BoostIOServicePool* ioServicePool, EventLoop* eventLoop) {
+    return ref(new BoostConnectionServer(port, ioServicePool->getIOService(0), eventLoop, ioServicePool));
+}
+
+BoostConnectionServer::ref BoostConnectionServer::create(const HostAddress &address, int port, BoostIOServicePool* ioServicePool, EventLoop* eventLoop) {
+    return ref(new BoostConnectionServer(address, port, ioServicePool->getIOService(0), eventLoop, ioServicePool));
 }
 
 void BoostConnectionServer::start() {
@@ -76,7 +85,7 @@ void BoostConnectionServer::stop(boost::optional<Error> e) {
 }
 
 void BoostConnectionServer::acceptNextConnection() {
-    BoostConnection::ref newConnection(BoostConnection::create(ioService_, eventLoop));
+    BoostConnection::ref newConnection(BoostConnection::create(ioServicePool_ ? ioServicePool_->getNextIOService() : ioService_, eventLoop));
     acceptor_->async_accept(newConnection->getSocket(),
         boost::bind(&BoostConnectionServer::handleAccept, shared_from_this(), newConnection, boost::asio::placeholders::error));
 }
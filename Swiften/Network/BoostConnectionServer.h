@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,6 +19,8 @@
 #include <Swiften/Network/ConnectionServer.h>
 
 namespace Swift {
+    class BoostIOServicePool;
+
     class SWIFTEN_API BoostConnectionServer : public ConnectionServer, public EventOwner, public std::enable_shared_from_this<BoostConnectionServer> {
         public:
             typedef std::shared_ptr<BoostConnectionServer> ref;
@@ -31,6 +33,14 @@ namespace Swift {
                 return ref(new BoostConnectionServer(address, port, ioService, eventLoop));
             }
 
+            /**
+             * Creates a server that spreads the accepted connections over the
+             * io_services of the given pool.
+             */
+            static ref create(int port, BoostIOServicePool* ioServicePool, EventLoop* eventLoop);
+
+            static ref create(const HostAddress &address, int port, BoostIOServicePool* ioServicePool, EventLoop* eventLoop);
+
             virtual boost::optional<Error> tryStart(); // FIXME: This should become the new start
             virtual void start();
             virtual void stop();
@@ -40,8 +50,8 @@ namespace Swift {
             boost::signals2::signal<void (boost::optional<Error>)> onStopped;
 
         private:
-            BoostConnectionServer(int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop);
-            BoostConnectionServer(const HostAddress &address, int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop);
+            BoostConnectionServer(int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop, BoostIOServicePool* ioServicePool = nullptr);
+            BoostConnectionServer(const HostAddress &address, int port, std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop, BoostIOServicePool* ioServicePool = nullptr);
 
             void stop(boost::optional<Error> e);
             void acceptNextConnection();
@@ -51,6 +61,7 @@ namespace Swift {
             HostAddress address_;
             int port_;
             std::shared_ptr<boost::asio::io_service> ioService_;
+            BoostIOServicePool* ioServicePool_;
             EventLoop* eventLoop;
             boost::asio::ip::tcp::acceptor* acceptor_;
     };
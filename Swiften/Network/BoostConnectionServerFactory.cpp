@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2016 Isode Limited.
+ * Copyright (c) 2016-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,17 +13,27 @@
 #include <Swiften/Network/BoostConnectionServerFactory.h>
 
 #include <Swiften/Network/BoostConnectionServer.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 
 namespace Swift {
 
-BoostConnectionServerFactory::BoostConnectionServerFactory(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), eventLoop(eventLoop) {
+BoostConnectionServerFactory::BoostConnectionServerFactory(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) : ioService(ioService), ioServicePool(nullptr), eventLoop(eventLoop) {
+}
+
+BoostConnectionServerFactory::BoostConnectionServerFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop) : ioServicePool(ioServicePool), eventLoop(eventLoop) {
 }
 
 std::shared_ptr<ConnectionServer> BoostConnectionServerFactory::createConnectionServer(int port) {
+    if (ioServicePool) {
+        return BoostConnectionServer::create(port, ioServicePool, eventLoop);
+    }
     return BoostConnectionServer::create(port, ioService, eventLoop);
 }
 
 std::shared_ptr<ConnectionServer> BoostConnectionServerFactory::createConnectionServer(const Swift::HostAddress &hostAddress, int port) {
+    if (ioServicePool) {
+        return BoostConnectionServer::create(hostAddress, port, ioServicePool, eventLoop);
+    }
     return BoostConnectionServer::create(hostAddress, port, ioService, eventLoop);
 }
 
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,18 +19,25 @@
 #include <Swiften/Network/ConnectionServerFactory.h>
 
 namespace Swift {
+    class BoostIOServicePool;
     class ConnectionServer;
 
     class SWIFTEN_API BoostConnectionServerFactory : public ConnectionServerFactory {
         public:
             BoostConnectionServerFactory(std::shared_ptr<boost::asio::io_service>, EventLoop* eventLoop);
 
+            /**
+             * Creates servers that spread their connections over the io_services of the given pool.
+             */
+            BoostConnectionServerFactory(BoostIOServicePool* ioServicePool, EventLoop* eventLoop);
+
             virtual std::shared_ptr<ConnectionServer> createConnectionServer(int port);
 
             virtual std::shared_ptr<ConnectionServer> createConnectionServer(const Swift::HostAddress &hostAddress, int port);
 
         private:
             std::shared_ptr<boost::asio::io_service> ioService;
+            BoostIOServicePool* ioServicePool;
             EventLoop* eventLoop;
     };
 }
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Network/BoostIOServicePool.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace Swift {
+
+BoostIOServicePool::BoostIOServicePool(size_t size) : next_(0) {
+    if (size == 0) {
+        size = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < size; ++i) {
+        threads_.push_back(std::unique_ptr<BoostIOServiceThread>(new BoostIOServiceThread()));
+    }
+}
+
+BoostIOServicePool::~BoostIOServicePool() {
+}
+
+std::shared_ptr<boost::asio::io_service> BoostIOServicePool::getNextIOService() {
+    return getIOService(next_++ % threads_.size());
+}
+
+}
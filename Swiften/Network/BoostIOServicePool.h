@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Network/BoostIOServiceThread.h>
+
+namespace Swift {
+    /**
+     * A set of io_services, each run by its own thread.
+     *
+     * Connections are spread over the io_services in round-robin order, so that
+     * socket I/O of many connections is not limited to a single thread. All
+     * callbacks are still delivered through the EventLoop.
+     */
+    class SWIFTEN_API BoostIOServicePool {
+        public:
+            /**
+             * @param size The number of io_services (and threads) to create. If 0,
+             * one is created per hardware thread.
+             */
+            BoostIOServicePool(size_t size = 0);
+            ~BoostIOServicePool();
+
+            size_t getSize() const {
+                return threads_.size();
+            }
+
+            std::shared_ptr<boost::asio::io_service> getIOService(size_t index) const {
+                return threads_[index]->getIOService();
+            }
+
+            /**
+             * Returns the io_services of the pool in round-robin order.
+             */
+            std::shared_ptr<boost::asio::io_service> getNextIOService();
+
+        private:
+            std::vector<std::unique_ptr<BoostIOServiceThread> > threads_;
+            std::atomic<size_t> next_;
+    };
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,6 +12,7 @@
 #include <Swiften/IDN/PlatformIDNConverter.h>
 #include <Swiften/Network/BoostConnectionFactory.h>
 #include <Swiften/Network/BoostConnectionServerFactory.h>
+#include <Swiften/Network/BoostIOServicePool.h>
 #include <Swiften/Network/BoostTimerFactory.h>
 #include <Swiften/Network/NullNATTraverser.h>
 #include <Swiften/Network/PlatformNATTraversalWorker.h>
@@ -29,9 +30,19 @@
 namespace Swift {
 
 BoostNetworkFactories::BoostNetworkFactories(EventLoop* eventLoop, std::shared_ptr<boost::asio::io_service> ioService) : ioServiceThread(ioService), eventLoop(eventLoop) {
-    timerFactory = new BoostTimerFactory(ioServiceThread.getIOService(), eventLoop);
     connectionFactory = new BoostConnectionFactory(ioServiceThread.getIOService(), eventLoop);
     connectionServerFactory = new BoostConnectionServerFactory(ioServiceThread.getIOService(), eventLoop);
+    createFactories();
+}
+
+BoostNetworkFactories::BoostNetworkFactories(EventLoop* eventLoop, unsigned int ioThreads) : ioServicePool(new BoostIOServicePool(ioThreads)), ioServiceThread(ioServicePool->getIOService(0)), eventLoop(eventLoop) {
+    connectionFactory = new BoostConnectionFactory(ioServicePool.get(), eventLoop);
+    connectionServerFactory = new BoostConnectionServerFactory(ioServicePool.get(), eventLoop);
+    createFactories();
+}
+
+void BoostNetworkFactories::createFactories() {
+    timerFactory = new BoostTimerFactory(ioServiceThread.getIOService(), eventLoop);
 #ifdef SWIFT_EXPERIMENTAL_FT
     natTraverser = new PlatformNATTraversalWorker(eventLoop);
 #else
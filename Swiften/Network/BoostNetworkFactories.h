@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Network/BoostIOServiceThread.h>
 #include <Swiften/Network/NetworkFactories.h>
 
 namespace Swift {
+    class BoostIOServicePool;
     class EventLoop;
     class NATTraverser;
     class PlatformTLSFactories;
@@ -23,6 +26,15 @@ namespace Swift {
              * used for the construction of the BoostIOServiceThread.
              */
             BoostNetworkFactories(EventLoop* eventLoop, std::shared_ptr<boost::asio::io_service> ioService = std::shared_ptr<boost::asio::io_service>());
+
+            /**
+             * Construct the network factories, using the provided EventLoop, and
+             * spread the connections over a pool of I/O threads.
+             * @param ioThreads The number of I/O threads, each running their own
+             * io_service. If 0, one thread is started per hardware thread.
+             * Timers and name resolution use the first io_service of the pool.
+             */
+            BoostNetworkFactories(EventLoop* eventLoop, unsigned int ioThreads);
             virtual ~BoostNetworkFactories() override;
 
             virtual TimerFactory* getTimerFactory() const override {
@@ -37,6 +49,14 @@ namespace Swift {
                 return &ioServiceThread;
             }
 
+            /**
+             * Returns the pool of I/O threads, or nullptr if all connections
+             * use the io_service of getIOServiceThread().
+             */
+            BoostIOServicePool* getIOServicePool() const {
+                return ioServicePool.get();
+            }
+
             DomainNameResolver* getDomainNameResolver() const override {
                 return domainNameResolver;
             }
@@ -76,6 +96,10 @@ namespace Swift {
             }
 
         private:
+            void createFactories();
+
+        private:
+            std::unique_ptr<BoostIOServicePool> ioServicePool;
             BoostIOServiceThread ioServiceThread;
             TimerFactory* timerFactory;
             ConnectionFactory* connectionFactory;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -36,10 +36,39 @@ namespace Swift {
             virtual HostAddressPort getLocalAddress() const = 0;
             virtual HostAddressPort getRemoteAddress() const = 0;
 
+            /**
+             * Returns the number of written bytes that have not been sent
+             * yet, if the connection keeps track of them.
+             */
+            virtual size_t getQueuedWriteBytes() const {
+                return 0;
+            }
+
+            /**
+             * Sets the number of written bytes that may be waiting to be sent
+             * before onWriteQueueFull is emitted. A value of 0 (the default)
+             * disables the signal. Connections that do not keep track of
+             * their unsent data ignore this.
+             */
+            virtual void setWriteHighWatermark(size_t /* bytes */) {
+            }
+
         public:
             boost::signals2::signal<void (bool /* error */)> onConnectFinished;
             boost::signals2::signal<void (const boost::optional<Error>&)> onDisconnected;
             boost::signals2::signal<void (std::shared_ptr<SafeByteArray>)> onDataRead;
             boost::signals2::signal<void ()> onDataWritten;
+
+            /**
+             * Emitted when the amount of data waiting to be sent reaches the
+             * high watermark.
+             */
+            boost::signals2::signal<void ()> onWriteQueueFull;
+
+            /**
+             * Emitted when all data has been sent after onWriteQueueFull was
+             * emitted.
+             */
+            boost::signals2::signal<void ()> onWriteQueueDrained;
     };
 }
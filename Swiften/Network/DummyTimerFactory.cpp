@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #include <Swiften/Network/DummyTimerFactory.h>
 
 #include <algorithm>
+#include <vector>
 
 #include <Swiften/Network/Timer.h>
 
@@ -48,12 +49,19 @@ std::shared_ptr<Timer> DummyTimerFactory::createTimer(int milliseconds) {
 
 void DummyTimerFactory::setTime(int time) {
     assert(time > currentTime);
+    std::vector<std::shared_ptr<DummyTimer> > expiredTimers;
     for (auto&& timer : timers) {
         if (timer->getAlarmTime() > currentTime && timer->getAlarmTime() <= time && timer->isRunning) {
-            timer->onTick();
+            expiredTimers.push_back(timer);
         }
     }
+    // Timers restarted from onTick count from the new time
     currentTime = time;
+    for (auto&& timer : expiredTimers) {
+        if (timer->isRunning) {
+            timer->onTick();
+        }
+    }
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2016 Isode Limited.
+ * Copyright (c) 2012-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -109,6 +109,10 @@ HostAddressPort ProxiedConnection::getRemoteAddress() const {
     return connection_->getRemoteAddress();
 }
 
+size_t ProxiedConnection::getQueuedWriteBytes() const {
+    return connection_ ? connection_->getQueuedWriteBytes() : 0;
+}
+
 void ProxiedConnection::setProxyInitializeFinished(bool success) {
     connected_ = success;
     if (!success) {
@@ -30,6 +30,7 @@ namespace Swift {
 
             virtual HostAddressPort getLocalAddress() const;
             virtual HostAddressPort getRemoteAddress() const;
+            virtual size_t getQueuedWriteBytes() const;
 
         private:
             void handleConnectFinished(Connection::ref connection);
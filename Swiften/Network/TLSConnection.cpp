@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -70,6 +70,10 @@ HostAddressPort TLSConnection::getRemoteAddress() const {
     return connection->getRemoteAddress();
 }
 
+size_t TLSConnection::getQueuedWriteBytes() const {
+    return connection ? connection->getQueuedWriteBytes() : 0;
+}
+
 TLSContext* TLSConnection::getTLSContext() const {
     return context;
 }
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Network/TimerWheel.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost/bind.hpp>
+
+#include <Swiften/Network/TimerFactory.h>
+
+namespace Swift {
+
+TimerWheel::TimerWheel(TimerFactory* timerFactory, int resolution, size_t slots) : resolution_(resolution), running_(false), slots_(slots), currentSlot_(0), nextID_(1) {
+    assert(resolution > 0);
+    assert(slots > 0);
+    timer_ = timerFactory->createTimer(resolution);
+    timer_->onTick.connect(boost::bind(&TimerWheel::handleTick, this));
+}
+
+TimerWheel::~TimerWheel() {
+    timer_->stop();
+    timer_->onTick.disconnect(boost::bind(&TimerWheel::handleTick, this));
+}
+
+TimerWheel::ID TimerWheel::schedule(int milliseconds, std::function<void ()> callback) {
+    size_t ticks = milliseconds > 0 ? static_cast<size_t>((milliseconds + resolution_ - 1) / resolution_) : 0;
+    if (running_) {
+        // Part of the current tick has already passed
+        ticks += 1;
+    }
+    ticks = std::max<size_t>(ticks, 1);
+
+    ID id = nextID_++;
+    size_t slot = (currentSlot_ + ticks) % slots_.size();
+    Entry entry = { id, (ticks - 1) / slots_.size(), callback };
+    entries_[id] = std::make_pair(slot, slots_[slot].insert(slots_[slot].end(), entry));
+
+    if (!running_) {
+        running_ = true;
+        timer_->start();
+    }
+    return id;
+}
+
+void TimerWheel::cancel(ID id) {
+    auto i = entries_.find(id);
+    if (i != entries_.end()) {
+        slots_[i->second.first].erase(i->second.second);
+        entries_.erase(i);
+    }
+}
+
+void TimerWheel::handleTick() {
+    currentSlot_ = (currentSlot_ + 1) % slots_.size();
+
+    // Collect the expired entries first, since their callbacks can
+    // schedule and cancel other timeouts.
+    std::vector<std::function<void ()> > expired;
+    Slot& slot = slots_[currentSlot_];
+    for (Slot::iterator i = slot.begin(); i != slot.end(); ) {
+        if (i->rounds == 0) {
+            expired.push_back(i->callback);
+            entries_.erase(i->id);
+            i = slot.erase(i);
+        }
+        else {
+            --i->rounds;
+            ++i;
+        }
+    }
+
+    // Callbacks scheduled from here on still see the wheel as running, and
+    // are accounted for when restarting the timer below.
+    for (auto&& callback : expired) {
+        callback();
+    }
+
+    if (entries_.empty()) {
+        running_ = false;
+    }
+    else {
+        timer_->start();
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Network/Timer.h>
+
+namespace Swift {
+    class TimerFactory;
+
+    /**
+     * Runs a large number of timeouts off a single Timer.
+     *
+     * Timeouts are kept in a ring of slots, one per tick of the given
+     * resolution, so scheduling and cancelling a timeout takes constant
+     * time. The timer only runs while there are timeouts pending.
+     */
+    class SWIFTEN_API TimerWheel : public boost::noncopyable {
+        public:
+            typedef size_t ID;
+
+            TimerWheel(TimerFactory* timerFactory, int resolution = 100, size_t slots = 512);
+            ~TimerWheel();
+
+            /**
+             * Calls the callback once, after at least the given number of
+             * milliseconds, and at most one resolution later.
+             *
+             * @return An ID that can be passed to cancel(); never 0.
+             */
+            ID schedule(int milliseconds, std::function<void ()> callback);
+
+            /**
+             * Cancels a pending timeout. Does nothing if the timeout already
+             * expired.
+             */
+            void cancel(ID id);
+
+            size_t getPendingCount() const {
+                return entries_.size();
+            }
+
+        private:
+            struct Entry {
+                ID id;
+                size_t rounds;
+                std::function<void ()> callback;
+            };
+            typedef std::list<Entry> Slot;
+
+            void handleTick();
+
+        private:
+            int resolution_;
+            Timer::ref timer_;
+            bool running_;
+            std::vector<Slot> slots_;
+            size_t currentSlot_;
+            std::unordered_map<ID, std::pair<size_t, Slot::iterator> > entries_;
+            ID nextID_;
+    };
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/Network/BoostConnection.h>
+#include <Swiften/Network/BoostConnectionFactory.h>
+#include <Swiften/Network/BoostIOServicePool.h>
+
+using namespace Swift;
+
+class BoostIOServicePoolTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(BoostIOServicePoolTest);
+        CPPUNIT_TEST(testGetNextIOService);
+        CPPUNIT_TEST(testIOServicesRunInSeparateThreads);
+        CPPUNIT_TEST(testConnectionFactory_RoundRobin);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testGetNextIOService() {
+            BoostIOServicePool testling(3);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), testling.getSize());
+            CPPUNIT_ASSERT(testling.getIOService(0) == testling.getNextIOService());
+            CPPUNIT_ASSERT(testling.getIOService(1) == testling.getNextIOService());
+            CPPUNIT_ASSERT(testling.getIOService(2) == testling.getNextIOService());
+            CPPUNIT_ASSERT(testling.getIOService(0) == testling.getNextIOService());
+            CPPUNIT_ASSERT(testling.getIOService(0) != testling.getIOService(1));
+        }
+
+        void testIOServicesRunInSeparateThreads() {
+            BoostIOServicePool testling(3);
+
+            for (size_t i = 0; i < testling.getSize(); ++i) {
+                testling.getIOService(i)->post([this]() {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    threads_.insert(std::this_thread::get_id());
+                    condition_.notify_one();
+                });
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (threads_.size() < 3) {
+                condition_.wait(lock);
+            }
+            CPPUNIT_ASSERT(threads_.find(std::this_thread::get_id()) == threads_.end());
+        }
+
+        void testConnectionFactory_RoundRobin() {
+            DummyEventLoop eventLoop;
+            BoostIOServicePool pool(2);
+            BoostConnectionFactory testling(&pool, &eventLoop);
+
+            BoostConnection::ref connection1 = std::dynamic_pointer_cast<BoostConnection>(testling.createConnection());
+            BoostConnection::ref connection2 = std::dynamic_pointer_cast<BoostConnection>(testling.createConnection());
+            BoostConnection::ref connection3 = std::dynamic_pointer_cast<BoostConnection>(testling.createConnection());
+
+            CPPUNIT_ASSERT(&connection1->getSocket().get_io_service() == pool.getIOService(0).get());
+            CPPUNIT_ASSERT(&connection2->getSocket().get_io_service() == pool.getIOService(1).get());
+            CPPUNIT_ASSERT(&connection3->getSocket().get_io_service() == pool.getIOService(0).get());
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::set<std::thread::id> threads_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BoostIOServicePoolTest);
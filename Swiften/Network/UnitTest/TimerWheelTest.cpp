@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/Network/TimerWheel.h>
+
+using namespace Swift;
+
+class TimerWheelTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(TimerWheelTest);
+        CPPUNIT_TEST(testSchedule);
+        CPPUNIT_TEST(testSchedule_RoundsUpToResolution);
+        CPPUNIT_TEST(testSchedule_LongerThanOneRevolution);
+        CPPUNIT_TEST(testSchedule_FromCallback);
+        CPPUNIT_TEST(testCancel);
+        CPPUNIT_TEST(testCancel_Expired);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            timerFactory_ = std::unique_ptr<DummyTimerFactory>(new DummyTimerFactory());
+            currentTime_ = 0;
+        }
+
+        void tearDown() {
+            timerFactory_.reset();
+        }
+
+        void testSchedule() {
+            TimerWheel testling(timerFactory_.get(), 100, 8);
+            testling.schedule(300, boost::bind(&TimerWheelTest::handleTimeout, this, "a"));
+            // The wheel is already running, so this gets an extra tick
+            testling.schedule(100, boost::bind(&TimerWheelTest::handleTimeout, this, "b"));
+
+            advanceTime(200);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), expired_.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("b"), expired_[0]);
+
+            advanceTime(300);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), expired_.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("a"), expired_[1]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getPendingCount());
+        }
+
+        void testSchedule_RoundsUpToResolution() {
+            TimerWheel testling(timerFactory_.get(), 100, 8);
+            testling.schedule(150, boost::bind(&TimerWheelTest::handleTimeout, this, "a"));
+
+            advanceTime(100);
+            CPPUNIT_ASSERT(expired_.empty());
+
+            advanceTime(200);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), expired_.size());
+        }
+
+        void testSchedule_LongerThanOneRevolution() {
+            TimerWheel testling(timerFactory_.get(), 100, 8);
+            testling.schedule(2000, boost::bind(&TimerWheelTest::handleTimeout, this, "a"));
+            testling.schedule(800, boost::bind(&TimerWheelTest::handleTimeout, this, "b"));
+
+            advanceTime(1900);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), expired_.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("b"), expired_[0]);
+
+            advanceTime(2000);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), expired_.size());
+        }
+
+        void testSchedule_FromCallback() {
+            TimerWheel testling(timerFactory_.get(), 100, 8);
+            testling_ = &testling;
+            testling.schedule(100, boost::bind(&TimerWheelTest::handleTimeoutAndReschedule, this));
+
+            advanceTime(100);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), expired_.size());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getPendingCount());
+
+            advanceTime(400);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), expired_.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("rescheduled"), expired_[1]);
+        }
+
+        void testCancel() {
+            TimerWheel testling(timerFactory_.get(), 100, 8);
+            TimerWheel::ID id = testling.schedule(200, boost::bind(&TimerWheelTest::handleTimeout, this, "a"));
+            testling.schedule(200, boost::bind(&TimerWheelTest::handleTimeout, this, "b"));
+            testling.cancel(id);
+
+            advanceTime(1000);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), expired_.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("b"), expired_[0]);
+        }
+
+        void testCancel_Expired() {
+            TimerWheel testling(timerFactory_.get(), 100, 8);
+            TimerWheel::ID id = testling.schedule(100, boost::bind(&TimerWheelTest::handleTimeout, this, "a"));
+            advanceTime(100);
+
+            testling.cancel(id);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), expired_.size());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getPendingCount());
+        }
+
+    private:
+        // Moves the clock forward one tick at a time
+        void advanceTime(int time) {
+            for (int t = currentTime_ + 100; t <= time; t += 100) {
+                timerFactory_->setTime(t);
+            }
+            currentTime_ = time;
+        }
+
+        void handleTimeout(const std::string& name) {
+            expired_.push_back(name);
+        }
+
+        void handleTimeoutAndReschedule() {
+            expired_.push_back("first");
+            testling_->schedule(200, boost::bind(&TimerWheelTest::handleTimeout, this, "rescheduled"));
+        }
+
+    private:
+        std::unique_ptr<DummyTimerFactory> timerFactory_;
+        int currentTime_;
+        TimerWheel* testling_;
+        std::vector<std::string> expired_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,8 +10,10 @@
 #include <string>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Base/StringView.h>
 #include <Swiften/Elements/ToplevelElement.h>
 #include <Swiften/Parser/AttributeMap.h>
+#include <Swiften/Parser/XMLAttributeView.h>
 
 namespace Swift {
     class SWIFTEN_API ElementParser {
@@ -22,6 +24,15 @@ namespace Swift {
             virtual void handleEndElement(const std::string& element, const std::string& ns) = 0;
             virtual void handleCharacterData(const std::string& data) = 0;
 
+            /**
+             * Variants of the callbacks above taking the views reported by
+             * the XML parser, which are not valid beyond the call. The
+             * default implementations copy the data and forward it to the
+             * std::string based callbacks.
+             */
+            virtual void handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes);
+            virtual void handleCharacterDataView(const StringView& data);
+
             virtual std::shared_ptr<ToplevelElement> getElement() const = 0;
     };
 }
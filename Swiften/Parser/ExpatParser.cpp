@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #include <Swiften/Parser/ExpatParser.h>
 
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <string>
 
@@ -14,8 +15,10 @@
 
 #include <boost/numeric/conversion/cast.hpp>
 
-#include <Swiften/Base/String.h>
+#include <Swiften/Base/StringView.h>
+#include <Swiften/Parser/XMLAttributeView.h>
 #include <Swiften/Parser/XMLParserClient.h>
+#include <Swiften/Parser/XMLSymbolTable.h>
 
 #pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
 
@@ -24,67 +27,79 @@ namespace Swift {
 static const char NAMESPACE_SEPARATOR = '\x01';
 
 struct ExpatParser::Private {
-    XML_Parser parser_;
-};
-
-static void handleStartElement(void* parser, const XML_Char* name, const XML_Char** attributes) {
-    std::pair<std::string,std::string> nsTagPair = String::getSplittedAtFirst(name, NAMESPACE_SEPARATOR);
-    if (nsTagPair.second == "") {
-        nsTagPair.second = nsTagPair.first;
-        nsTagPair.first = "";
+    Private(ExpatParser* parser) : parser(parser) {
     }
-    AttributeMap attributeValues;
-    const XML_Char** currentAttribute = attributes;
-    while (*currentAttribute) {
-        std::pair<std::string,std::string> nsAttributePair = String::getSplittedAtFirst(*currentAttribute, NAMESPACE_SEPARATOR);
-        if (nsAttributePair.second == "") {
-            nsAttributePair.second = nsAttributePair.first;
-            nsAttributePair.first = "";
+
+    ExpatParser* parser;
+    XML_Parser parser_;
+    XMLSymbolTable symbols;
+    XMLAttributeViews attributes;
+
+    void splitName(const XML_Char* name, const std::string*& localName, const std::string*& ns) {
+        const char* separator = std::strchr(name, NAMESPACE_SEPARATOR);
+        if (separator) {
+            ns = &symbols.intern(StringView(name, static_cast<size_t>(separator - name)));
+            localName = &symbols.intern(StringView(separator + 1));
+        }
+        else {
+            ns = &symbols.getEmpty();
+            localName = &symbols.intern(StringView(name));
         }
-        attributeValues.addAttribute(nsAttributePair.second, nsAttributePair.first, std::string(*(currentAttribute+1)));
-        currentAttribute += 2;
     }
 
-    static_cast<XMLParser*>(parser)->getClient()->handleStartElement(nsTagPair.second, nsTagPair.first, attributeValues);
-}
-
-static void handleEndElement(void* parser, const XML_Char* name) {
-    std::pair<std::string,std::string> nsTagPair = String::getSplittedAtFirst(name, NAMESPACE_SEPARATOR);
-    if (nsTagPair.second == "") {
-        nsTagPair.second = nsTagPair.first;
-        nsTagPair.first = "";
+    static void handleStartElement(void* data, const XML_Char* name, const XML_Char** attributes) {
+        Private* p = static_cast<Private*>(data);
+        p->symbols.reset();
+        const std::string* tag;
+        const std::string* ns;
+        p->splitName(name, tag, ns);
+        p->attributes.clear();
+        for (const XML_Char** currentAttribute = attributes; *currentAttribute; currentAttribute += 2) {
+            const std::string* attributeName;
+            const std::string* attributeNS;
+            p->splitName(*currentAttribute, attributeName, attributeNS);
+            p->attributes.push_back(XMLAttributeView(*attributeName, *attributeNS, StringView(*(currentAttribute+1))));
+        }
+        p->parser->getClient()->handleStartElementView(*tag, *ns, p->attributes);
     }
-    static_cast<XMLParser*>(parser)->getClient()->handleEndElement(nsTagPair.second, nsTagPair.first);
-}
 
-static void handleCharacterData(void* parser, const XML_Char* data, int len) {
-    assert(len >= 0);
-    static_cast<XMLParser*>(parser)->getClient()->handleCharacterData(std::string(data, static_cast<size_t>(len)));
-}
+    static void handleEndElement(void* data, const XML_Char* name) {
+        Private* p = static_cast<Private*>(data);
+        p->symbols.reset();
+        const std::string* tag;
+        const std::string* ns;
+        p->splitName(name, tag, ns);
+        p->parser->getClient()->handleEndElement(*tag, *ns);
+    }
 
-static void handleXMLDeclaration(void*, const XML_Char*, const XML_Char*, int) {
-}
+    static void handleCharacterData(void* data, const XML_Char* characters, int len) {
+        assert(len >= 0);
+        static_cast<Private*>(data)->parser->getClient()->handleCharacterDataView(StringView(characters, static_cast<size_t>(len)));
+    }
 
-static void handleEntityDeclaration(void* parser, const XML_Char*, int, const XML_Char*, int, const XML_Char*, const XML_Char*, const XML_Char*, const XML_Char*) {
-    static_cast<ExpatParser*>(parser)->stopParser();
-}
+    static void handleXMLDeclaration(void*, const XML_Char*, const XML_Char*, int) {
+    }
 
+    static void handleEntityDeclaration(void* data, const XML_Char*, int, const XML_Char*, int, const XML_Char*, const XML_Char*, const XML_Char*, const XML_Char*) {
+        static_cast<Private*>(data)->parser->stopParser();
+    }
+};
 
-ExpatParser::ExpatParser(XMLParserClient* client) : XMLParser(client), p(new Private()) {
+ExpatParser::ExpatParser(XMLParserClient* client) : XMLParser(client), p(new Private(this)) {
     p->parser_ = XML_ParserCreateNS("UTF-8", NAMESPACE_SEPARATOR);
-    XML_SetUserData(p->parser_, this);
-    XML_SetElementHandler(p->parser_, handleStartElement, handleEndElement);
-    XML_SetCharacterDataHandler(p->parser_, handleCharacterData);
-    XML_SetXmlDeclHandler(p->parser_, handleXMLDeclaration);
-    XML_SetEntityDeclHandler(p->parser_, handleEntityDeclaration);
+    XML_SetUserData(p->parser_, p.get());
+    XML_SetElementHandler(p->parser_, &Private::handleStartElement, &Private::handleEndElement);
+    XML_SetCharacterDataHandler(p->parser_, &Private::handleCharacterData);
+    XML_SetXmlDeclHandler(p->parser_, &Private::handleXMLDeclaration);
+    XML_SetEntityDeclHandler(p->parser_, &Private::handleEntityDeclaration);
 }
 
 ExpatParser::~ExpatParser() {
     XML_ParserFree(p->parser_);
 }
 
-bool ExpatParser::parse(const std::string& data) {
-    bool success = XML_Parse(p->parser_, data.c_str(), boost::numeric_cast<int>(data.size()), false) == XML_STATUS_OK;
+bool ExpatParser::parse(const char* data, size_t size) {
+    bool success = XML_Parse(p->parser_, data, boost::numeric_cast<int>(size), false) == XML_STATUS_OK;
     /*if (!success) {
         std::cout << "ERROR: " << XML_ErrorString(XML_GetErrorCode(p->parser_)) << " while parsing " << data << std::endl;
     }*/
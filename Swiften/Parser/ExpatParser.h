@@ -19,7 +19,8 @@ namespace Swift {
             ExpatParser(XMLParserClient* client);
             ~ExpatParser();
 
-            bool parse(const std::string& data);
+            using XMLParser::parse;
+            bool parse(const char* data, size_t size);
 
             void stopParser();
 
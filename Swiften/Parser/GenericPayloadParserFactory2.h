@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -29,6 +29,10 @@ namespace Swift {
                 return (tag_.empty() ? true : element == tag_) && (xmlns_.empty() ? true : xmlns_ == ns);
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(tag_, xmlns_);
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new PARSER_TYPE(parsers_);
             }
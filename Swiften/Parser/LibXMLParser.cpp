@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,42 +16,55 @@
 #include <libxml/parser.h>
 
 #include <Swiften/Base/Log.h>
+#include <Swiften/Base/StringView.h>
+#include <Swiften/Parser/XMLAttributeView.h>
 #include <Swiften/Parser/XMLParserClient.h>
+#include <Swiften/Parser/XMLSymbolTable.h>
 
 namespace Swift {
 
 struct LibXMLParser::Private {
+    Private(LibXMLParser* parser) : parser(parser) {
+    }
+
+    LibXMLParser* parser;
     xmlSAXHandler handler_;
     xmlParserCtxtPtr context_;
-};
+    XMLSymbolTable symbols;
+    XMLAttributeViews attributes;
 
-static void handleStartElement(void* parser, const xmlChar* name, const xmlChar*, const xmlChar* xmlns, int, const xmlChar**, int nbAttributes, int nbDefaulted, const xmlChar ** attributes) {
-    AttributeMap attributeValues;
-    if (nbDefaulted != 0) {
-        // Just because i don't understand what this means yet :-)
-        SWIFT_LOG(error) << "Unexpected nbDefaulted on XML element" << std::endl;
+    const std::string& intern(const xmlChar* name) {
+        return name ? symbols.intern(StringView(reinterpret_cast<const char*>(name))) : symbols.getEmpty();
     }
-    for (int i = 0; i < nbAttributes*5; i += 5) {
-        std::string attributeNS = "";
-        if (attributes[i+2]) {
-            attributeNS = std::string(reinterpret_cast<const char*>(attributes[i+2]));
+
+    static void handleStartElement(void* data, const xmlChar* name, const xmlChar*, const xmlChar* xmlns, int, const xmlChar**, int nbAttributes, int nbDefaulted, const xmlChar ** attributes) {
+        Private* p = static_cast<Private*>(data);
+        p->symbols.reset();
+        p->attributes.clear();
+        if (nbDefaulted != 0) {
+            // Just because i don't understand what this means yet :-)
+            SWIFT_LOG(error) << "Unexpected nbDefaulted on XML element" << std::endl;
+        }
+        for (int i = 0; i < nbAttributes*5; i += 5) {
+            p->attributes.push_back(XMLAttributeView(
+                    p->intern(attributes[i]),
+                    p->intern(attributes[i+2]),
+                    StringView(reinterpret_cast<const char*>(attributes[i+3]),
+                        boost::numeric_cast<size_t>(attributes[i+4]-attributes[i+3]))));
         }
-        attributeValues.addAttribute(
-                std::string(reinterpret_cast<const char*>(attributes[i])),
-                attributeNS,
-                std::string(reinterpret_cast<const char*>(attributes[i+3]),
-                    boost::numeric_cast<size_t>(attributes[i+4]-attributes[i+3])));
+        p->parser->getClient()->handleStartElementView(p->intern(name), p->intern(xmlns), p->attributes);
     }
-    static_cast<XMLParser*>(parser)->getClient()->handleStartElement(reinterpret_cast<const char*>(name), (xmlns ? reinterpret_cast<const char*>(xmlns) : std::string()), attributeValues);
-}
 
-static void handleEndElement(void *parser, const xmlChar* name, const xmlChar*, const xmlChar* xmlns) {
-    static_cast<XMLParser*>(parser)->getClient()->handleEndElement(reinterpret_cast<const char*>(name), (xmlns ? reinterpret_cast<const char*>(xmlns) : std::string()));
-}
+    static void handleEndElement(void* data, const xmlChar* name, const xmlChar*, const xmlChar* xmlns) {
+        Private* p = static_cast<Private*>(data);
+        p->symbols.reset();
+        p->parser->getClient()->handleEndElement(p->intern(name), p->intern(xmlns));
+    }
 
-static void handleCharacterData(void* parser, const xmlChar* data, int len) {
-    static_cast<XMLParser*>(parser)->getClient()->handleCharacterData(std::string(reinterpret_cast<const char*>(data), boost::numeric_cast<size_t>(len)));
-}
+    static void handleCharacterData(void* data, const xmlChar* characters, int len) {
+        static_cast<Private*>(data)->parser->getClient()->handleCharacterDataView(StringView(reinterpret_cast<const char*>(characters), boost::numeric_cast<size_t>(len)));
+    }
+};
 
 static void handleError(void*, const char* /*m*/, ... ) {
     /*
@@ -67,7 +80,7 @@ static void handleWarning(void*, const char*, ... ) {
 
 bool LibXMLParser::initialized = false;
 
-LibXMLParser::LibXMLParser(XMLParserClient* client) : XMLParser(client), p(new Private()) {
+LibXMLParser::LibXMLParser(XMLParserClient* client) : XMLParser(client), p(new Private(this)) {
     // Initialize libXML for multithreaded applications
     if (!initialized) {
         xmlInitParser();
@@ -76,13 +89,13 @@ LibXMLParser::LibXMLParser(XMLParserClient* client) : XMLParser(client), p(new P
 
     memset(&p->handler_, 0, sizeof(p->handler_) );
     p->handler_.initialized = XML_SAX2_MAGIC;
-    p->handler_.startElementNs = &handleStartElement;
-    p->handler_.endElementNs = &handleEndElement;
-    p->handler_.characters = &handleCharacterData;
+    p->handler_.startElementNs = &Private::handleStartElement;
+    p->handler_.endElementNs = &Private::handleEndElement;
+    p->handler_.characters = &Private::handleCharacterData;
     p->handler_.warning = &handleWarning;
     p->handler_.error = &handleError;
 
-    p->context_ = xmlCreatePushParserCtxt(&p->handler_, this, nullptr, 0, nullptr);
+    p->context_ = xmlCreatePushParserCtxt(&p->handler_, p.get(), nullptr, 0, nullptr);
     xmlCtxtUseOptions(p->context_, XML_PARSE_NOENT);
     assert(p->context_);
 }
@@ -93,8 +106,8 @@ LibXMLParser::~LibXMLParser() {
     }
 }
 
-bool LibXMLParser::parse(const std::string& data) {
-    if (xmlParseChunk(p->context_, data.c_str(), boost::numeric_cast<int>(data.size()), false) == XML_ERR_OK) {
+bool LibXMLParser::parse(const char* data, size_t size) {
+    if (xmlParseChunk(p->context_, data, boost::numeric_cast<int>(size), false) == XML_ERR_OK) {
         return true;
     }
     xmlError* error = xmlCtxtGetLastError(p->context_);
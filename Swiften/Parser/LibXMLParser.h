@@ -22,7 +22,8 @@ namespace Swift {
             LibXMLParser(XMLParserClient* client);
             virtual ~LibXMLParser();
 
-            bool parse(const std::string& data);
+            using XMLParser::parse;
+            bool parse(const char* data, size_t size);
 
         private:
             static bool initialized;
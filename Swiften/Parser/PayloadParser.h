@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,8 +9,10 @@
 #include <memory>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Base/StringView.h>
 #include <Swiften/Elements/Payload.h>
 #include <Swiften/Parser/AttributeMap.h>
+#include <Swiften/Parser/XMLAttributeView.h>
 
 namespace Swift {
 
@@ -42,6 +44,14 @@ namespace Swift {
              */
             virtual void handleCharacterData(const std::string& data) = 0;
 
+            /**
+             * Variants of the handlers above taking views that are not valid
+             * beyond the call. The default implementations copy the data and
+             * forward it to the std::string based handlers.
+             */
+            virtual void handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes);
+            virtual void handleCharacterDataView(const StringView& data);
+
             /**
              * Retrieve a pointer to the payload.
              */
@@ -1,11 +1,14 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
+#include <utility>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Parser/AttributeMap.h>
 
@@ -25,6 +28,15 @@ namespace Swift {
              */
             virtual bool canParse(const std::string& element, const std::string& ns, const AttributeMap& attributes) const = 0;
 
+            /**
+             * Returns the element name and namespace a top-level element needs to have for canParse() to succeed.
+             * An empty name or namespace matches any element.
+             *
+             * PayloadParserFactoryCollection uses this key to avoid calling canParse() on factories that cannot
+             * match. The default key matches every element.
+             */
+            virtual std::pair<std::string, std::string> getIndexKey() const;
+
             /**
              * Creates a new payload parser.
              */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,35 +8,80 @@
 
 #include <algorithm>
 
-#include <boost/bind.hpp>
-
 #include <Swiften/Parser/PayloadParserFactory.h>
 
 namespace Swift {
 
-PayloadParserFactoryCollection::PayloadParserFactoryCollection() : defaultFactory_(nullptr) {
+PayloadParserFactoryCollection::PayloadParserFactoryCollection() : nextSequence_(0), defaultFactory_(nullptr) {
 }
 
 PayloadParserFactoryCollection::~PayloadParserFactoryCollection() {
 }
 
 void PayloadParserFactoryCollection::addFactory(PayloadParserFactory* factory) {
-    factories_.push_back(factory);
+    std::pair<std::string, std::string> key = factory->getIndexKey();
+    index_[key.second][key.first].push_back(Entry(nextSequence_++, factory));
 }
 
 void PayloadParserFactoryCollection::removeFactory(PayloadParserFactory* factory) {
-    factories_.erase(std::remove(factories_.begin(), factories_.end(), factory), factories_.end());
+    for (auto& nsEntries : index_) {
+        for (auto& elementEntries : nsEntries.second) {
+            Entries& entries = elementEntries.second;
+            entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.factory == factory; }), entries.end());
+        }
+    }
 }
 
 void PayloadParserFactoryCollection::setDefaultFactory(PayloadParserFactory* factory) {
     defaultFactory_ = factory;
 }
 
+const PayloadParserFactoryCollection::Entries* PayloadParserFactoryCollection::findEntries(const std::string& ns, const std::string& element) const {
+    auto i = index_.find(ns);
+    if (i == index_.end()) {
+        return nullptr;
+    }
+    auto j = i->second.find(element);
+    if (j == i->second.end() || j->second.empty()) {
+        return nullptr;
+    }
+    return &j->second;
+}
+
 PayloadParserFactory* PayloadParserFactoryCollection::getPayloadParserFactory(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
-    std::vector<PayloadParserFactory*>::reverse_iterator i = std::find_if(
-            factories_.rbegin(), factories_.rend(),
-            boost::bind(&PayloadParserFactory::canParse, _1, element, ns, attributes));
-    return (i != factories_.rend() ? *i : defaultFactory_);
+    // Each list of candidates is sorted by the order in which the factories were added.
+    // Walk the (at most 4) lists backwards in lockstep, so that the most recently added
+    // factory that can parse the element wins.
+    static const std::string empty;
+    const Entries* candidates[4] = {
+        findEntries(ns, element),
+        element.empty() ? nullptr : findEntries(ns, empty),
+        ns.empty() ? nullptr : findEntries(empty, element),
+        element.empty() || ns.empty() ? nullptr : findEntries(empty, empty)
+    };
+    Entries::const_reverse_iterator positions[4];
+    for (size_t i = 0; i < 4; ++i) {
+        if (candidates[i]) {
+            positions[i] = candidates[i]->rbegin();
+        }
+    }
+    while (true) {
+        const Entry* next = nullptr;
+        size_t nextList = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            if (candidates[i] && positions[i] != candidates[i]->rend() && (!next || positions[i]->sequence > next->sequence)) {
+                next = &*positions[i];
+                nextList = i;
+            }
+        }
+        if (!next) {
+            return defaultFactory_;
+        }
+        if (next->factory->canParse(element, ns, attributes)) {
+            return next->factory;
+        }
+        ++positions[nextList];
+    }
 }
 
 }
@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <Swiften/Base/API.h>
@@ -14,6 +16,13 @@
 namespace Swift {
     class PayloadParserFactory;
 
+    /**
+     * A collection of payload parser factories.
+     *
+     * Factories are indexed by the key returned by PayloadParserFactory::getIndexKey(), so that only
+     * the factories that can match an element's name and namespace are asked whether they can parse it.
+     * If more than one factory can parse an element, the one added last is used.
+     */
     class SWIFTEN_API PayloadParserFactoryCollection {
         public:
             PayloadParserFactoryCollection();
@@ -26,7 +35,20 @@ namespace Swift {
             PayloadParserFactory* getPayloadParserFactory(const std::string& element, const std::string& ns, const AttributeMap& attributes);
 
         private:
-            std::vector<PayloadParserFactory*> factories_;
+            struct Entry {
+                Entry(size_t sequence, PayloadParserFactory* factory) : sequence(sequence), factory(factory) {}
+
+                size_t sequence;
+                PayloadParserFactory* factory;
+            };
+            typedef std::vector<Entry> Entries;
+            typedef std::unordered_map<std::string, Entries> ElementIndex;
+
+            const Entries* findEntries(const std::string& ns, const std::string& element) const;
+
+        private:
+            std::unordered_map<std::string, ElementIndex> index_;
+            size_t nextSequence_;
             PayloadParserFactory* defaultFactory_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -26,4 +26,8 @@ void BodyParser::handleCharacterData(const std::string& data) {
     text_ += data;
 }
 
+void BodyParser::handleCharacterDataView(const StringView& data) {
+    text_.append(data.data(), data.size());
+}
+
 }
@@ -22,6 +22,10 @@ namespace Swift {
                      || element == "paused" || element == "inactive" || element == "gone");
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string(), std::string("http://jabber.org/protocol/chatstates"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new ChatStateParser();
             }
@@ -27,6 +27,10 @@ namespace Swift {
                     (element == "active" || element == "inactive");
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string(), std::string("urn:xmpp:csi:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new ClientStateParser();
             }
@@ -26,6 +26,10 @@ namespace Swift {
                 return ns == "urn:xmpp:receipts" && element == "received";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string("received"), std::string("urn:xmpp:receipts"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new DeliveryReceiptParser();
             }
@@ -20,6 +20,10 @@ namespace Swift {
                 return ns == "jabber:x:data";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string(), std::string("jabber:x:data"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new FormParser();
             }
@@ -5,7 +5,7 @@
  */
 
 /*
- * Copyright (c) 2014-2015 Isode Limited.
+ * Copyright (c) 2014-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -29,6 +29,10 @@ namespace Swift {
                 return element == "description" && ns == "urn:xmpp:jingle:apps:file-transfer:4";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string("description"), std::string("urn:xmpp:jingle:apps:file-transfer:4"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new JingleFileTransferDescriptionParser(factories);
             }
@@ -20,6 +20,10 @@ namespace Swift {
                 return element == "join" && ns == "urn:xmpp:mix:0";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string("join"), std::string("urn:xmpp:mix:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new MIXJoinParser();
             }
@@ -26,6 +26,10 @@ namespace Swift {
                 return element == "mix" && ns == "urn:xmpp:mix:0";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const override {
+                return std::make_pair(std::string("mix"), std::string("urn:xmpp:mix:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() override {
                 return new MIXPayloadParser();
             }
@@ -20,6 +20,10 @@ namespace Swift {
                 return element == "register" && ns == "urn:xmpp:mix:0";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const override {
+                return std::make_pair(std::string("register"), std::string("urn:xmpp:mix:0"));
+            }
+
             virtual PayloadParser* createPayloadParser() override {
                 return new MIXRegisterNickParser();
             }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -22,6 +22,10 @@ namespace Swift {
                 return element == "query" && ns == "http://jabber.org/protocol/muc#owner";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string("query"), std::string("http://jabber.org/protocol/muc#owner"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new MUCOwnerPayloadParser(factories);
             }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,6 +21,10 @@ namespace Swift {
                 return ns == "http://jabber.org/protocol/pubsub#errors";
             }
 
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(std::string(), std::string("http://jabber.org/protocol/pubsub#errors"));
+            }
+
             virtual PayloadParser* createPayloadParser() {
                 return new PubSubErrorParser();
             }
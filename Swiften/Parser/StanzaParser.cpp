@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -57,6 +57,22 @@ void StanzaParser::handleStartElement(const std::string& element, const std::str
     ++currentDepth_;
 }
 
+/**
+ * The stanza element and the payload elements are passed on as an
+ * AttributeMap, as the stanza attributes and the payload parser factories
+ * need one. Elements within payloads are passed on as views.
+ */
+void StanzaParser::handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes) {
+    if (inPayload()) {
+        assert(currentPayloadParser_);
+        currentPayloadParser_->handleStartElementView(element, ns, attributes);
+        ++currentDepth_;
+    }
+    else {
+        ElementParser::handleStartElementView(element, ns, attributes);
+    }
+}
+
 void StanzaParser::handleEndElement(const std::string& element, const std::string& ns) {
     assert(inStanza());
     if (inPayload()) {
@@ -82,4 +98,10 @@ void StanzaParser::handleCharacterData(const std::string& data) {
     }
 }
 
+void StanzaParser::handleCharacterDataView(const StringView& data) {
+    if (currentPayloadParser_) {
+        currentPayloadParser_->handleCharacterDataView(data);
+    }
+}
+
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -28,6 +28,8 @@ namespace Swift {
             void handleStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes);
             void handleEndElement(const std::string& element, const std::string& ns);
             void handleCharacterData(const std::string& data);
+            void handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes);
+            void handleCharacterDataView(const StringView& data);
 
             virtual std::shared_ptr<ToplevelElement> getElement() const = 0;
             virtual void handleStanzaAttributes(const AttributeMap&) {}
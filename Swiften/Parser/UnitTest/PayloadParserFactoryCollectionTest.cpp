@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -20,6 +20,10 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
         CPPUNIT_TEST(testGetPayloadParserFactory_TwoMatchingFactories);
         CPPUNIT_TEST(testGetPayloadParserFactory_MatchWithDefaultFactory);
         CPPUNIT_TEST(testGetPayloadParserFactory_NoMatchWithDefaultFactory);
+        CPPUNIT_TEST(testGetPayloadParserFactory_IndexedFactories);
+        CPPUNIT_TEST(testGetPayloadParserFactory_LastAddedWinsAcrossKeys);
+        CPPUNIT_TEST(testGetPayloadParserFactory_IndexedFactoryRejects);
+        CPPUNIT_TEST(testRemoveFactory);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -88,6 +92,61 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
             CPPUNIT_ASSERT(factory == &factory2);
         }
 
+        void testGetPayloadParserFactory_IndexedFactories() {
+            PayloadParserFactoryCollection testling;
+            IndexedFactory factory1("query", "jabber:iq:roster");
+            testling.addFactory(&factory1);
+            IndexedFactory factory2("query", "jabber:iq:version");
+            testling.addFactory(&factory2);
+            IndexedFactory factory3("", "jabber:x:data");
+            testling.addFactory(&factory3);
+
+            CPPUNIT_ASSERT(&factory1 == testling.getPayloadParserFactory("query", "jabber:iq:roster", AttributeMap()));
+            CPPUNIT_ASSERT(&factory2 == testling.getPayloadParserFactory("query", "jabber:iq:version", AttributeMap()));
+            CPPUNIT_ASSERT(&factory3 == testling.getPayloadParserFactory("x", "jabber:x:data", AttributeMap()));
+            CPPUNIT_ASSERT(!testling.getPayloadParserFactory("query", "jabber:iq:last", AttributeMap()));
+            CPPUNIT_ASSERT_EQUAL(1, factory3.canParseCalls);
+        }
+
+        void testGetPayloadParserFactory_LastAddedWinsAcrossKeys() {
+            PayloadParserFactoryCollection testling;
+            IndexedFactory factory1("query", "jabber:iq:roster");
+            testling.addFactory(&factory1);
+            DummyFactory factory2("query");
+            testling.addFactory(&factory2);
+            IndexedFactory factory3("bar", "jabber:iq:roster");
+            testling.addFactory(&factory3);
+
+            CPPUNIT_ASSERT(&factory2 == testling.getPayloadParserFactory("query", "jabber:iq:roster", AttributeMap()));
+            CPPUNIT_ASSERT(&factory3 == testling.getPayloadParserFactory("bar", "jabber:iq:roster", AttributeMap()));
+        }
+
+        void testGetPayloadParserFactory_IndexedFactoryRejects() {
+            PayloadParserFactoryCollection testling;
+            IndexedFactory factory1("query", "jabber:iq:roster");
+            testling.addFactory(&factory1);
+            IndexedFactory factory2("query", "jabber:iq:roster");
+            factory2.accept = false;
+            testling.addFactory(&factory2);
+
+            CPPUNIT_ASSERT(&factory1 == testling.getPayloadParserFactory("query", "jabber:iq:roster", AttributeMap()));
+            CPPUNIT_ASSERT_EQUAL(1, factory2.canParseCalls);
+        }
+
+        void testRemoveFactory() {
+            PayloadParserFactoryCollection testling;
+            IndexedFactory factory1("query", "jabber:iq:roster");
+            testling.addFactory(&factory1);
+            DummyFactory factory2("query");
+            testling.addFactory(&factory2);
+            testling.removeFactory(&factory2);
+
+            CPPUNIT_ASSERT(&factory1 == testling.getPayloadParserFactory("query", "jabber:iq:roster", AttributeMap()));
+
+            testling.removeFactory(&factory1);
+
+            CPPUNIT_ASSERT(!testling.getPayloadParserFactory("query", "jabber:iq:roster", AttributeMap()));
+        }
 
     private:
         struct DummyFactory : public PayloadParserFactory {
@@ -98,6 +157,22 @@ class PayloadParserFactoryCollectionTest : public CppUnit::TestFixture
             virtual PayloadParser* createPayloadParser() { return nullptr; }
             std::string element;
         };
+
+        struct IndexedFactory : public PayloadParserFactory {
+            IndexedFactory(const std::string& element, const std::string& ns) : element(element), ns(ns), accept(true), canParseCalls(0) {}
+            virtual bool canParse(const std::string& e, const std::string& n, const AttributeMap&) const {
+                canParseCalls++;
+                return accept && (element.empty() || element == e) && ns == n;
+            }
+            virtual std::pair<std::string, std::string> getIndexKey() const {
+                return std::make_pair(element, ns);
+            }
+            virtual PayloadParser* createPayloadParser() { return nullptr; }
+            std::string element;
+            std::string ns;
+            bool accept;
+            mutable int canParseCalls;
+        };
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PayloadParserFactoryCollectionTest);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -31,11 +31,13 @@ class XMLParserTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testParse_InvalidXML);
         CPPUNIT_TEST(testParse_InErrorState);
         CPPUNIT_TEST(testParse_Incremental);
+        CPPUNIT_TEST(testParse_Buffer);
         CPPUNIT_TEST(testParse_WhitespaceInAttribute);
         CPPUNIT_TEST(testParse_AttributeWithoutNamespace);
         CPPUNIT_TEST(testParse_AttributeWithNamespace);
         CPPUNIT_TEST(testParse_BillionLaughs);
         CPPUNIT_TEST(testParse_InternalEntity);
+        CPPUNIT_TEST(testParse_Views);
         //CPPUNIT_TEST(testParse_UndefinedPrefix);
         //CPPUNIT_TEST(testParse_UndefinedAttributePrefix);
         CPPUNIT_TEST_SUITE_END();
@@ -189,6 +191,21 @@ class XMLParserTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[1].data);
         }
 
+        void testParse_Buffer() {
+            ParserType testling(&client_);
+            const char data[] = "<iq></iq><garbage";
+
+            CPPUNIT_ASSERT(testling.parse(data, 9));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), client_.events.size());
+
+            CPPUNIT_ASSERT_EQUAL(Client::StartElement, client_.events[0].type);
+            CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[0].data);
+
+            CPPUNIT_ASSERT_EQUAL(Client::EndElement, client_.events[1].type);
+            CPPUNIT_ASSERT_EQUAL(std::string("iq"), client_.events[1].data);
+        }
+
         void testParse_InvalidXML() {
             ParserType testling(&client_);
 
@@ -316,7 +333,64 @@ class XMLParserTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("bar:baz"), client_.events[0].attributes.getEntries()[0].getAttribute().getName());
         }
 
+        void testParse_Views() {
+            ViewClient client;
+            ParserType testling(&client);
+
+            CPPUNIT_ASSERT(testling.parse("<iq xmlns='jabber:client' type='get'>a&amp;b<query/><query/></iq>"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), client.startElements);
+            CPPUNIT_ASSERT_EQUAL(std::string("iq"), client.element);
+            CPPUNIT_ASSERT_EQUAL(std::string("jabber:client"), client.ns);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), client.attributes.size());
+            CPPUNIT_ASSERT_EQUAL(std::string("type"), client.attributes[0].first);
+            CPPUNIT_ASSERT_EQUAL(std::string("get"), client.attributes[0].second);
+            CPPUNIT_ASSERT_EQUAL(std::string("a&b"), client.characterData);
+            CPPUNIT_ASSERT(client.internedElement);
+        }
+
     private:
+        class ViewClient : public XMLParserClient {
+            public:
+                ViewClient() : startElements(0), internedElement(false), lastElement(nullptr) {}
+
+                virtual void handleStartElement(const std::string&, const std::string&, const AttributeMap&) {
+                    CPPUNIT_FAIL("Unexpected std::string callback");
+                }
+
+                virtual void handleEndElement(const std::string&, const std::string&) {
+                }
+
+                virtual void handleCharacterData(const std::string&) {
+                    CPPUNIT_FAIL("Unexpected std::string callback");
+                }
+
+                virtual void handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes) {
+                    if (startElements == 0) {
+                        this->element = element;
+                        this->ns = ns;
+                        for (const auto& attribute : attributes) {
+                            this->attributes.push_back(std::make_pair(attribute.getName(), attribute.getValue().toString()));
+                        }
+                    }
+                    internedElement = (lastElement == &element);
+                    lastElement = &element;
+                    ++startElements;
+                }
+
+                virtual void handleCharacterDataView(const StringView& data) {
+                    characterData += data.toString();
+                }
+
+                size_t startElements;
+                bool internedElement;
+                const std::string* lastElement;
+                std::string element;
+                std::string ns;
+                std::vector< std::pair<std::string, std::string> > attributes;
+                std::string characterData;
+        };
+
         class Client : public XMLParserClient {
             public:
                 enum Type { StartElement, EndElement, CharacterData };
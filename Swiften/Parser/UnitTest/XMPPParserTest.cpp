@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -17,6 +17,7 @@
 #include <Swiften/Elements/StreamFeatures.h>
 #include <Swiften/Elements/UnknownElement.h>
 #include <Swiften/Parser/ElementParser.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
 #include <Swiften/Parser/PayloadParserFactoryCollection.h>
 #include <Swiften/Parser/PlatformXMLParserFactory.h>
 #include <Swiften/Parser/XMPPParser.h>
@@ -31,6 +32,7 @@ class XMPPParserTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testParse_Presence);
         CPPUNIT_TEST(testParse_IQ);
         CPPUNIT_TEST(testParse_Message);
+        CPPUNIT_TEST(testParse_MessageWithPayloads);
         CPPUNIT_TEST(testParse_StreamFeatures);
         CPPUNIT_TEST(testParse_UnknownElement);
         CPPUNIT_TEST(testParse_StrayCharacterData);
@@ -104,6 +106,22 @@ class XMPPParserTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(dynamic_cast<Message*>(client_.events[1].element.get()));
         }
 
+        void testParse_MessageWithPayloads() {
+            FullPayloadParserFactoryCollection factories;
+            XMPPParser testling(&client_, &factories, &xmlParserFactory_);
+
+            CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns:stream='http://etherx.jabber.org/streams'>"));
+            CPPUNIT_ASSERT(testling.parse("<message from='alice@wonderland.lit/rabbithole' id='a1'><body>Hi</body><x xmlns='urn:test'><y z='1'>text</y></x></message>"));
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(client_.events.size()));
+            Message* message = dynamic_cast<Message*>(client_.events[1].element.get());
+            CPPUNIT_ASSERT(message);
+            CPPUNIT_ASSERT_EQUAL(JID("alice@wonderland.lit/rabbithole"), message->getFrom());
+            CPPUNIT_ASSERT_EQUAL(std::string("a1"), message->getID());
+            CPPUNIT_ASSERT(message->getBody());
+            CPPUNIT_ASSERT_EQUAL(std::string("Hi"), *message->getBody());
+        }
+
         void testParse_StreamFeatures() {
             XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -19,6 +19,8 @@ namespace Swift {
             virtual void handleStartElement(const std::string&, const std::string&, const AttributeMap&) {}
             virtual void handleEndElement(const std::string&, const std::string&) {}
             virtual void handleCharacterData(const std::string&) {}
+            virtual void handleStartElementView(const std::string&, const std::string&, const XMLAttributeViews&) {}
+            virtual void handleCharacterDataView(const StringView&) {}
 
             virtual std::shared_ptr<Payload> getPayload() const {
                 return std::shared_ptr<Payload>();
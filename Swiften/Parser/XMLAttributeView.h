@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Swiften/Base/StringView.h>
+
+namespace Swift {
+    /**
+     * A non-owning view on an attribute reported by an XML parser.
+     *
+     * The name and namespace are interned by the parser; the value points into
+     * the parser's buffer. None of them are valid beyond the callback.
+     */
+    class XMLAttributeView {
+        public:
+            XMLAttributeView(const std::string& name, const std::string& ns, const StringView& value) : name(&name), ns(&ns), value(value) {
+            }
+
+            const std::string& getName() const {
+                return *name;
+            }
+
+            const std::string& getNamespace() const {
+                return *ns;
+            }
+
+            const StringView& getValue() const {
+                return value;
+            }
+
+        private:
+            const std::string* name;
+            const std::string* ns;
+            StringView value;
+    };
+
+    typedef std::vector<XMLAttributeView> XMLAttributeViews;
+}
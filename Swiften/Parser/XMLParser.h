@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #include <Swiften/Base/API.h>
@@ -18,7 +19,15 @@ namespace Swift {
             XMLParser(XMLParserClient* client);
             virtual ~XMLParser();
 
-            virtual bool parse(const std::string& data) = 0;
+            bool parse(const std::string& data) {
+                return parse(data.data(), data.size());
+            }
+
+            /**
+             * Feeds a chunk of raw data to the parser, without copying it.
+             * The data only needs to stay valid for the duration of the call.
+             */
+            virtual bool parse(const char* data, size_t size) = 0;
 
             XMLParserClient* getClient() const {
                 return client_;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,5 +11,16 @@ namespace Swift {
 XMLParserClient::~XMLParserClient() {
 }
 
+void XMLParserClient::handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes) {
+    AttributeMap attributeMap;
+    for (const auto& attribute : attributes) {
+        attributeMap.addAttribute(attribute.getName(), attribute.getNamespace(), attribute.getValue().toString());
+    }
+    handleStartElement(element, ns, attributeMap);
 }
 
+void XMLParserClient::handleCharacterDataView(const StringView& data) {
+    handleCharacterData(data.toString());
+}
+
+}
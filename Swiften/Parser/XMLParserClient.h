@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,7 +7,9 @@
 #pragma once
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Base/StringView.h>
 #include <Swiften/Parser/AttributeMap.h>
+#include <Swiften/Parser/XMLAttributeView.h>
 
 namespace Swift {
     class SWIFTEN_API XMLParserClient {
@@ -17,5 +19,17 @@ namespace Swift {
             virtual void handleStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes) = 0;
             virtual void handleEndElement(const std::string& element, const std::string& ns) = 0;
             virtual void handleCharacterData(const std::string& data) = 0;
+
+            /**
+             * Allocation-free variants of the callbacks above, which are the
+             * ones XML parsers invoke. Element and namespace names are interned
+             * by the parser; attribute values and character data point into
+             * the parser's buffer. None of them stay valid beyond the call.
+             *
+             * The default implementations copy the data and forward it to
+             * the std::string based callbacks.
+             */
+            virtual void handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes);
+            virtual void handleCharacterDataView(const StringView& data);
     };
 }
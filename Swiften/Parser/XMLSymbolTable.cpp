@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Parser/XMLSymbolTable.h>
+
+namespace Swift {
+
+// XMPP streams use a small vocabulary of names. This limit only guards
+// against peers that send an endless stream of distinct names.
+static const size_t MAX_SYMBOLS = 1024;
+
+XMLSymbolTable::XMLSymbolTable() {
+}
+
+const std::string& XMLSymbolTable::intern(const StringView& name) {
+    if (name.empty()) {
+        return empty_;
+    }
+    auto i = symbols_.find(name);
+    if (i != symbols_.end()) {
+        return *i->second;
+    }
+    std::unique_ptr<std::string> symbol(new std::string(name.data(), name.size()));
+    const std::string& result = *symbol;
+    symbols_.insert(std::make_pair(StringView(result), std::move(symbol)));
+    return result;
+}
+
+void XMLSymbolTable::reset() {
+    if (symbols_.size() > MAX_SYMBOLS) {
+        symbols_.clear();
+    }
+}
+
+}
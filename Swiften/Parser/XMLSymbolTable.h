@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/StringView.h>
+
+namespace Swift {
+    /**
+     * Interns element, attribute and namespace names for an XML parser, so
+     * that recurring names do not cause a string allocation every time they
+     * are reported to the parser client.
+     *
+     * The table is bounded: once it holds more than a fixed number of symbols,
+     * the next call to reset() discards them all. Interned strings are
+     * therefore only guaranteed to stay valid until the next reset().
+     */
+    class SWIFTEN_API XMLSymbolTable : public boost::noncopyable {
+        public:
+            XMLSymbolTable();
+
+            const std::string& intern(const StringView& name);
+
+            const std::string& getEmpty() const {
+                return empty_;
+            }
+
+            /**
+             * Drops all symbols if the table grew beyond its size limit.
+             * Parsers call this before reporting a new event.
+             */
+            void reset();
+
+            size_t getSize() const {
+                return symbols_.size();
+            }
+
+        private:
+            std::unordered_map<StringView, std::unique_ptr<std::string>, StringView::Hash> symbols_;
+            const std::string empty_;
+    };
+}
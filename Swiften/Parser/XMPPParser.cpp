@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -45,6 +45,17 @@
 
 namespace Swift {
 
+namespace {
+    std::string getAttribute(const XMLAttributeViews& attributes, const std::string& name) {
+        for (const auto& attribute : attributes) {
+            if (attribute.getName() == name && attribute.getNamespace().empty()) {
+                return attribute.getValue().toString();
+            }
+        }
+        return "";
+    }
+}
+
 XMPPParser::XMPPParser(
         XMPPParserClient* client,
         PayloadParserFactoryCollection* payloadParserFactories,
@@ -63,19 +74,31 @@ XMPPParser::~XMPPParser() {
 }
 
 bool XMPPParser::parse(const std::string& data) {
-    bool xmlParseResult = xmlParser_->parse(data);
+    return parse(data.data(), data.size());
+}
+
+bool XMPPParser::parse(const char* data, size_t size) {
+    bool xmlParseResult = xmlParser_->parse(data, size);
     return xmlParseResult && !parseErrorOccurred_;
 }
 
 void XMPPParser::handleStartElement(const std::string& element, const std::string& ns, const AttributeMap& attributes) {
+    XMLAttributeViews attributeViews;
+    for (const auto& attribute : attributes.getEntries()) {
+        attributeViews.push_back(XMLAttributeView(attribute.getAttribute().getName(), attribute.getAttribute().getNamespace(), attribute.getValue()));
+    }
+    handleStartElementView(element, ns, attributeViews);
+}
+
+void XMPPParser::handleStartElementView(const std::string& element, const std::string& ns, const XMLAttributeViews& attributes) {
     if (!parseErrorOccurred_) {
         if (level_ == TopLevel) {
             if (element == "stream" && ns == "http://etherx.jabber.org/streams") {
                 ProtocolHeader header;
-                header.setFrom(attributes.getAttribute("from"));
-                header.setTo(attributes.getAttribute("to"));
-                header.setID(attributes.getAttribute("id"));
-                header.setVersion(attributes.getAttribute("version"));
+                header.setFrom(getAttribute(attributes, "from"));
+                header.setTo(getAttribute(attributes, "to"));
+                header.setID(getAttribute(attributes, "id"));
+                header.setVersion(getAttribute(attributes, "version"));
                 client_->handleStreamStart(header);
             }
             else {
@@ -87,7 +110,7 @@ void XMPPParser::handleStartElement(const std::string& element, const std::strin
                 assert(!currentElementParser_);
                 currentElementParser_ = createElementParser(element, ns);
             }
-            currentElementParser_->handleStartElement(element, ns, attributes);
+            currentElementParser_->handleStartElementView(element, ns, attributes);
         }
     }
     ++level_;
@@ -114,13 +137,13 @@ void XMPPParser::handleEndElement(const std::string& element, const std::string&
 }
 
 void XMPPParser::handleCharacterData(const std::string& data) {
-    if (!parseErrorOccurred_) {
-        if (currentElementParser_) {
-            currentElementParser_->handleCharacterData(data);
-        }
-    //else {
-    //    std::cerr << "XMPPParser: Ignoring stray character data: " << data << std::endl;
-    //}
+    handleCharacterDataView(data);
+}
+
+void XMPPParser::handleCharacterDataView(const StringView& data) {
+    // Whitespace between top-level elements is dropped without copying it.
+    if (!parseErrorOccurred_ && currentElementParser_) {
+        currentElementParser_->handleCharacterDataView(data);
     }
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -84,7 +84,7 @@ Presence::ref PresenceOracle::getLastPresence(const JID& jid) const {
     if (i == entries_.end()) {
         return Presence::ref();
     }
-    PresenceMap presenceMap = i->second;
+    const PresenceMap& presenceMap = i->second;
     PresenceMap::const_iterator j = presenceMap.find(jid);
     if (j != presenceMap.end()) {
         return j->second;
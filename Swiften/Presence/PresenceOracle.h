@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,6 +8,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 
 #include <boost/signals2.hpp>
 
@@ -70,7 +71,7 @@ namespace Swift {
 
         private:
             typedef std::map<JID, Presence::ref> PresenceMap;
-            typedef std::map<JID, PresenceMap> PresencesMap;
+            typedef std::unordered_map<JID, PresenceMap> PresencesMap;
             PresencesMap entries_;
             StanzaChannel* stanzaChannel_;
             XMPPRoster* xmppRoster_;
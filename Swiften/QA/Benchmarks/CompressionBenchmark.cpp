@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures stream compression throughput and ratio for a number of zlib
+ * settings, over a corpus of stanzas that are compressed one at a time, like
+ * CompressionLayer does.
+ *
+ * The corpus is either a file with one stanza per line (e.g. taken from
+ * an XML console trace), or a generated one with a roster, MUC history and
+ * presence broadcasts.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Compress/ZLibCompressor.h>
+#include <Swiften/Compress/ZLibDecompressor.h>
+
+using namespace Swift;
+
+static const int ITERATIONS = 20;
+
+static std::vector<SafeByteArray> createCorpus() {
+    std::vector<SafeByteArray> corpus;
+
+    std::string roster = "<iq type='result' id='roster_1' to='alice@wonderland.lit/rabbithole'><query xmlns='jabber:iq:roster' ver='ver14'>";
+    for (int i = 0; i < 500; ++i) {
+        roster += "<item jid='contact" + std::to_string(i) + "@example" + std::to_string(i % 7) + ".com' name='Contact " + std::to_string(i) + "' subscription='both'><group>" + (i % 3 == 0 ? "Friends" : "Work") + "</group></item>";
+    }
+    roster += "</query></iq>";
+    corpus.push_back(createSafeByteArray(roster));
+
+    for (int i = 0; i < 300; ++i) {
+        corpus.push_back(createSafeByteArray(
+            "<message from='coven@chat.shakespeare.lit/witch" + std::to_string(i % 5) + "' to='alice@wonderland.lit/rabbithole' type='groupchat' id='msg" + std::to_string(i) + "'>"
+            "<body>Message number " + std::to_string(i) + " of the history, about the cauldron and the weather.</body>"
+            "<delay xmlns='urn:xmpp:delay' from='coven@chat.shakespeare.lit' stamp='2017-05-01T10:" + std::to_string(10 + i % 50) + ":00Z'/>"
+            "</message>"));
+    }
+
+    for (int i = 0; i < 500; ++i) {
+        corpus.push_back(createSafeByteArray(
+            "<presence from='contact" + std::to_string(i) + "@example" + std::to_string(i % 7) + ".com/laptop' to='alice@wonderland.lit/rabbithole'>"
+            "<show>away</show><status>Out to lunch</status><priority>5</priority>"
+            "<c xmlns='http://jabber.org/protocol/caps' hash='sha-1' node='http://swift.im' ver='QgayPKawpkPSDYmwT/WM94uAlu0='/>"
+            "<x xmlns='vcard-temp:x:update'><photo>a3f549fa9705e7ead2905de0b6a804227ecdd404</photo></x>"
+            "</presence>"));
+    }
+    return corpus;
+}
+
+static std::vector<SafeByteArray> readCorpus(const std::string& file) {
+    std::vector<SafeByteArray> corpus;
+    std::ifstream input(file.c_str());
+    std::string line;
+    while (std::getline(input, line)) {
+        if (!line.empty()) {
+            corpus.push_back(createSafeByteArray(line));
+        }
+    }
+    return corpus;
+}
+
+static double toMegabytesPerSecond(size_t bytes, std::chrono::steady_clock::duration duration) {
+    return (static_cast<double>(bytes) / (1024 * 1024)) / std::chrono::duration<double>(duration).count();
+}
+
+static void measure(const std::string& name, const ZLibCompressor::Options& options, const std::vector<SafeByteArray>& corpus, bool reuseBuffers) {
+    size_t inputSize = 0;
+    size_t outputSize = 0;
+    std::chrono::steady_clock::duration compressionTime(0);
+    std::chrono::steady_clock::duration decompressionTime(0);
+
+    for (int i = 0; i < ITERATIONS; ++i) {
+        ZLibCompressor compressor(options);
+        ZLibDecompressor decompressor;
+        std::vector<SafeByteArray> compressed;
+        compressed.reserve(corpus.size());
+
+        SafeByteArray buffer;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& stanza : corpus) {
+            if (reuseBuffers) {
+                compressor.process(stanza, buffer);
+                outputSize += buffer.size();
+            }
+            else {
+                outputSize += compressor.process(stanza).size();
+            }
+        }
+        compressionTime += std::chrono::steady_clock::now() - start;
+
+        // Decompress a separately compressed stream, so both can be timed
+        // on their own
+        ZLibCompressor streamCompressor(options);
+        for (const auto& stanza : corpus) {
+            compressed.push_back(streamCompressor.process(stanza));
+        }
+        start = std::chrono::steady_clock::now();
+        for (const auto& data : compressed) {
+            if (reuseBuffers) {
+                decompressor.process(data, buffer);
+            }
+            else {
+                decompressor.process(data);
+            }
+        }
+        decompressionTime += std::chrono::steady_clock::now() - start;
+
+        for (const auto& stanza : corpus) {
+            inputSize += stanza.size();
+        }
+    }
+
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << toMegabytesPerSecond(inputSize, compressionTime)
+            << std::setw(12) << toMegabytesPerSecond(inputSize, decompressionTime)
+            << std::setw(8) << std::setprecision(2) << static_cast<double>(inputSize) / outputSize << std::endl;
+}
+
+static ZLibCompressor::Options createOptions(int level, int windowBits, int memoryLevel) {
+    ZLibCompressor::Options options;
+    options.level = level;
+    options.windowBits = windowBits;
+    options.memoryLevel = memoryLevel;
+    return options;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<SafeByteArray> corpus = argc > 1 ? readCorpus(argv[1]) : createCorpus();
+    if (corpus.empty()) {
+        std::cerr << "Empty corpus" << std::endl;
+        return 1;
+    }
+    size_t corpusSize = 0;
+    for (const auto& stanza : corpus) {
+        corpusSize += stanza.size();
+    }
+    std::cout << "Corpus: " << corpus.size() << " stanzas, " << corpusSize << " bytes" << std::endl;
+    std::cout << std::left << std::setw(34) << "Setting" << std::right << std::setw(10) << "MB/s in" << std::setw(12) << "MB/s out" << std::setw(8) << "Ratio" << std::endl;
+
+    measure("level 9, window 15, mem 8 (new)", createOptions(9, 15, 8), corpus, false);
+    measure("level 9, window 15, mem 8 (reuse)", createOptions(9, 15, 8), corpus, true);
+    measure("level 6, window 15, mem 8", createOptions(6, 15, 8), corpus, true);
+    measure("level 1, window 15, mem 8", createOptions(1, 15, 8), corpus, true);
+    measure("level 6, window 15, mem 9", createOptions(6, 15, 9), corpus, true);
+    measure("level 6, window 12, mem 8", createOptions(6, 12, 8), corpus, true);
+    measure("level 6, window 10, mem 4", createOptions(6, 10, 4), corpus, true);
+    measure("level 1, window 9, mem 1", createOptions(1, 9, 1), corpus, true);
+    return 0;
+}
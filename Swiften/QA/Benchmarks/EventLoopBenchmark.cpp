@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures the throughput of posting events to an EventLoop from a number of
+ * producer threads, while a single thread dispatches them.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+
+using namespace Swift;
+
+static const int NUMBER_OF_EVENTS = 1000000;
+
+class Counter {
+    public:
+        Counter(SimpleEventLoop* eventLoop, int expected) : eventLoop_(eventLoop), expected_(expected), count_(0) {
+        }
+
+        void handleEvent() {
+            if (++count_ == expected_) {
+                eventLoop_->stop();
+            }
+        }
+
+    private:
+        SimpleEventLoop* eventLoop_;
+        int expected_;
+        int count_;
+};
+
+static void produce(SimpleEventLoop* eventLoop, Counter* counter, int events) {
+    for (int i = 0; i < events; ++i) {
+        eventLoop->postEvent(boost::bind(&Counter::handleEvent, counter));
+    }
+}
+
+int main(int, char**) {
+    std::cout << "Post/dispatch throughput (" << NUMBER_OF_EVENTS << " events)" << std::endl;
+    for (int producers = 1; producers <= 8; producers *= 2) {
+        SimpleEventLoop eventLoop;
+        int eventsPerProducer = NUMBER_OF_EVENTS / producers;
+        Counter counter(&eventLoop, eventsPerProducer * producers);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < producers; ++i) {
+            threads.push_back(std::thread(&produce, &eventLoop, &counter, eventsPerProducer));
+        }
+        eventLoop.run();
+        auto duration = std::chrono::steady_clock::now() - start;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        double seconds = std::chrono::duration_cast<std::chrono::duration<double> >(duration).count();
+        std::cout << "  " << producers << " producer(s): " << static_cast<int>(eventsPerProducer * producers / seconds) << " events/s" << std::endl;
+    }
+    return 0;
+}
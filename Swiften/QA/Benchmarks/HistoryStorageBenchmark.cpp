@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures how fast SQLiteHistoryStorage stores a large history in a
+ * database file, and how fast it answers the queries of the history view
+ * afterwards.
+ *
+ * Usage: HistoryStorageBenchmark [number of messages]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/History/SQLiteHistoryStorage.h>
+
+using namespace Swift;
+
+static const int NUMBER_OF_CONTACTS = 200;
+static const int NUMBER_OF_DAYS = 365;
+static const int NUMBER_OF_QUERIES = 1000;
+
+static double getSecondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int numberOfMessages = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("history-%%%%-%%%%.db");
+    std::mt19937 random(42);
+    JID self("alice@wonderland.lit/rabbithole");
+    std::vector<JID> contacts;
+    for (int i = 0; i < NUMBER_OF_CONTACTS; ++i) {
+        contacts.push_back(JID("contact" + boost::lexical_cast<std::string>(i) + "@example.com/home"));
+    }
+    boost::posix_time::ptime firstDay(boost::gregorian::date(2016, 1, 1));
+
+    {
+        SQLiteHistoryStorage storage(file);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numberOfMessages; ++i) {
+            const JID& contact = contacts[random() % contacts.size()];
+            boost::posix_time::ptime time = firstDay + boost::posix_time::seconds(static_cast<long>(static_cast<long long>(i) * NUMBER_OF_DAYS * 86400 / numberOfMessages));
+            if (i % 2 == 0) {
+                storage.addMessage(HistoryMessage("Message " + boost::lexical_cast<std::string>(i), self, contact, HistoryMessage::Chat, time));
+            }
+            else {
+                storage.addMessage(HistoryMessage("Message " + boost::lexical_cast<std::string>(i), contact, self, HistoryMessage::Chat, time));
+            }
+        }
+        // Queries wait for the pending messages to be written
+        storage.getLastTimeStampFromMUC(self, contacts[0]);
+        double seconds = getSecondsSince(start);
+        std::cout << "Insert: " << numberOfMessages << " messages in " << seconds << " s (" << numberOfMessages / seconds << " messages/s)" << std::endl;
+
+        start = std::chrono::steady_clock::now();
+        size_t results = 0;
+        for (int i = 0; i < NUMBER_OF_QUERIES; ++i) {
+            boost::gregorian::date day = firstDay.date() + boost::gregorian::days(static_cast<long>(random() % NUMBER_OF_DAYS));
+            results += storage.getMessagesFromDate(self.toBare(), contacts[random() % contacts.size()].toBare(), HistoryMessage::Chat, day).size();
+        }
+        seconds = getSecondsSince(start);
+        std::cout << "getMessagesFromDate: " << seconds * 1000000 / NUMBER_OF_QUERIES << " us/query (" << results / NUMBER_OF_QUERIES << " messages/query)" << std::endl;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUMBER_OF_QUERIES; ++i) {
+            boost::gregorian::date day = firstDay.date() + boost::gregorian::days(static_cast<long>(random() % NUMBER_OF_DAYS));
+            storage.getMessagesFromNextDate(self.toBare(), contacts[random() % contacts.size()].toBare(), HistoryMessage::Chat, day);
+        }
+        seconds = getSecondsSince(start);
+        std::cout << "getMessagesFromNextDate: " << seconds * 1000000 / NUMBER_OF_QUERIES << " us/query" << std::endl;
+
+        start = std::chrono::steady_clock::now();
+        ContactsMap contactsMap = storage.getContacts(self.toBare(), HistoryMessage::Chat, "");
+        seconds = getSecondsSince(start);
+        std::cout << "getContacts: " << seconds * 1000 << " ms (" << contactsMap.size() << " contacts)" << std::endl;
+    }
+
+    boost::filesystem::remove(file);
+    boost::filesystem::remove(file.string() + "-wal");
+    boost::filesystem::remove(file.string() + "-shm");
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures the cost of finding the parser factory and the serializer for the
+ * payloads of a typical message stanza, with collections the size of the
+ * full payload collections. The linear lookups replicate the scans that
+ * PayloadParserFactoryCollection and PayloadSerializerCollection used to do.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Elements/Payload.h>
+#include <Swiften/Parser/GenericPayloadParser.h>
+#include <Swiften/Parser/GenericPayloadParserFactory.h>
+#include <Swiften/Parser/PayloadParserFactoryCollection.h>
+#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/PayloadSerializerCollection.h>
+
+using namespace Swift;
+
+static const int NUMBER_OF_FACTORIES = 100;
+static const int NUMBER_OF_STANZAS = 200000;
+
+template<int N>
+class BenchmarkPayload : public Payload {
+};
+
+class BenchmarkParser : public GenericPayloadParser<BenchmarkPayload<0> > {
+    public:
+        virtual void handleStartElement(const std::string&, const std::string&, const AttributeMap&) {}
+        virtual void handleEndElement(const std::string&, const std::string&) {}
+        virtual void handleCharacterData(const std::string&) {}
+};
+
+template<int N>
+class BenchmarkSerializer : public GenericPayloadSerializer<BenchmarkPayload<N> > {
+    public:
+        virtual std::string serializePayload(std::shared_ptr<BenchmarkPayload<N> >) const {
+            return "";
+        }
+};
+
+template<int N>
+struct SerializerRegistration {
+    static void add(std::vector<std::shared_ptr<PayloadSerializer> >& serializers, std::vector<std::shared_ptr<Payload> >& payloads) {
+        SerializerRegistration<N - 1>::add(serializers, payloads);
+        serializers.push_back(std::make_shared<BenchmarkSerializer<N - 1> >());
+        payloads.push_back(std::make_shared<BenchmarkPayload<N - 1> >());
+    }
+};
+
+template<>
+struct SerializerRegistration<0> {
+    static void add(std::vector<std::shared_ptr<PayloadSerializer> >&, std::vector<std::shared_ptr<Payload> >&) {
+    }
+};
+
+struct Key {
+    Key(const std::string& element, const std::string& ns) : element(element), ns(ns) {}
+    std::string element;
+    std::string ns;
+};
+
+template<typename F>
+static double measure(F f) {
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for (int i = 0; i < NUMBER_OF_STANZAS; ++i) {
+        checksum += f();
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    if (checksum == 0) {
+        std::cerr << "No dispatch result" << std::endl;
+    }
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / NUMBER_OF_STANZAS;
+}
+
+int main(int, char**) {
+    // Parser factories. Mimic the full collection: a few factories only match
+    // on the element name, the rest on the element name and namespace.
+    std::vector<std::shared_ptr<PayloadParserFactory> > factories;
+    const char* elementOnly[] = {"body", "subject", "thread", "priority", "show", "status"};
+    for (auto element : elementOnly) {
+        factories.push_back(std::make_shared<GenericPayloadParserFactory<BenchmarkParser> >(element));
+    }
+    while (static_cast<int>(factories.size()) < NUMBER_OF_FACTORIES) {
+        std::string n = boost::lexical_cast<std::string>(factories.size());
+        factories.push_back(std::make_shared<GenericPayloadParserFactory<BenchmarkParser> >("element" + n, "urn:benchmark:" + n));
+    }
+
+    std::vector<PayloadParserFactory*> linearFactories;
+    PayloadParserFactoryCollection indexedFactories;
+    for (const auto& factory : factories) {
+        linearFactories.push_back(factory.get());
+        indexedFactories.addFactory(factory.get());
+    }
+
+    // A message with a body, a thread, a chat state, a delay and a receipt request.
+    std::vector<Key> stanza;
+    stanza.push_back(Key("body", "jabber:client"));
+    stanza.push_back(Key("thread", "jabber:client"));
+    stanza.push_back(Key("element10", "urn:benchmark:10"));
+    stanza.push_back(Key("element50", "urn:benchmark:50"));
+    stanza.push_back(Key("element90", "urn:benchmark:90"));
+    AttributeMap attributes;
+
+    double linearParse = measure([&]() {
+        size_t found = 0;
+        for (const auto& key : stanza) {
+            std::vector<PayloadParserFactory*>::reverse_iterator i = std::find_if(
+                    linearFactories.rbegin(), linearFactories.rend(),
+                    boost::bind(&PayloadParserFactory::canParse, _1, key.element, key.ns, attributes));
+            found += (i != linearFactories.rend());
+        }
+        return found;
+    });
+    double indexedParse = measure([&]() {
+        size_t found = 0;
+        for (const auto& key : stanza) {
+            found += (indexedFactories.getPayloadParserFactory(key.element, key.ns, attributes) != nullptr);
+        }
+        return found;
+    });
+
+    // Serializers
+    std::vector<std::shared_ptr<PayloadSerializer> > serializers;
+    std::vector<std::shared_ptr<Payload> > payloads;
+    SerializerRegistration<NUMBER_OF_FACTORIES>::add(serializers, payloads);
+
+    std::vector<PayloadSerializer*> linearSerializers;
+    PayloadSerializerCollection indexedSerializers;
+    for (const auto& serializer : serializers) {
+        linearSerializers.push_back(serializer.get());
+        indexedSerializers.addSerializer(serializer.get());
+    }
+
+    std::vector<std::shared_ptr<Payload> > stanzaPayloads;
+    stanzaPayloads.push_back(payloads[5]);
+    stanzaPayloads.push_back(payloads[10]);
+    stanzaPayloads.push_back(payloads[30]);
+    stanzaPayloads.push_back(payloads[60]);
+    stanzaPayloads.push_back(payloads[90]);
+
+    double linearSerialize = measure([&]() {
+        size_t found = 0;
+        for (const auto& payload : stanzaPayloads) {
+            std::vector<PayloadSerializer*>::const_iterator i = std::find_if(
+                    linearSerializers.begin(), linearSerializers.end(),
+                    boost::bind(&PayloadSerializer::canSerialize, _1, payload));
+            found += (i != linearSerializers.end());
+        }
+        return found;
+    });
+    double indexedSerialize = measure([&]() {
+        size_t found = 0;
+        for (const auto& payload : stanzaPayloads) {
+            found += (indexedSerializers.getPayloadSerializer(payload) != nullptr);
+        }
+        return found;
+    });
+
+    std::cout << "Per-stanza dispatch cost (" << stanza.size() << " payloads, " << NUMBER_OF_FACTORIES << " factories/serializers)" << std::endl;
+    std::cout << "  Parser factory lookup, linear:  " << linearParse << " ns" << std::endl;
+    std::cout << "  Parser factory lookup, indexed: " << indexedParse << " ns" << std::endl;
+    std::cout << "  Serializer lookup, linear:      " << linearSerialize << " ns" << std::endl;
+    std::cout << "  Serializer lookup, indexed:     " << indexedSerialize << " ns" << std::endl;
+    return 0;
+}
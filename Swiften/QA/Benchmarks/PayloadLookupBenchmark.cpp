@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures the cost of looking up the payloads of a typical MUC presence, as
+ * the presence oracle, the entity caps manager and the MUC code do for every
+ * presence they receive. The dynamic_pointer_cast scan replicates what
+ * Stanza::getPayload() used to do.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+#include <Swiften/Elements/CapsInfo.h>
+#include <Swiften/Elements/Delay.h>
+#include <Swiften/Elements/ErrorPayload.h>
+#include <Swiften/Elements/Idle.h>
+#include <Swiften/Elements/MUCUserPayload.h>
+#include <Swiften/Elements/Presence.h>
+#include <Swiften/Elements/Priority.h>
+#include <Swiften/Elements/Status.h>
+#include <Swiften/Elements/StatusShow.h>
+#include <Swiften/Elements/VCardUpdate.h>
+
+using namespace Swift;
+
+static const int NUMBER_OF_STANZAS = 1000000;
+
+template<typename T>
+static std::shared_ptr<T> getPayloadWithDynamicCast(const Stanza& stanza) {
+    for (const auto& payload : stanza.getPayloads()) {
+        std::shared_ptr<T> result(std::dynamic_pointer_cast<T>(payload));
+        if (result) {
+            return result;
+        }
+    }
+    return std::shared_ptr<T>();
+}
+
+template<typename F>
+static double measure(F f) {
+    auto start = std::chrono::steady_clock::now();
+    size_t checksum = 0;
+    for (int i = 0; i < NUMBER_OF_STANZAS; ++i) {
+        checksum += f();
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    if (checksum == 0) {
+        std::cerr << "No payloads found" << std::endl;
+    }
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / NUMBER_OF_STANZAS;
+}
+
+int main(int, char**) {
+    Presence presence;
+    presence.setFrom(JID("room@conference.example.com/alice"));
+    presence.setTo(JID("bob@example.com/home"));
+    presence.addPayload(std::make_shared<StatusShow>(StatusShow::Away));
+    presence.addPayload(std::make_shared<Status>("Out to lunch"));
+    presence.addPayload(std::make_shared<Priority>(5));
+    presence.addPayload(std::make_shared<CapsInfo>("http://swift.im", "QgayPKawpkPSDYmwT/WM94uAlu0=", "sha-1"));
+    presence.addPayload(std::make_shared<VCardUpdate>("a3f549fa9705e7ead2905de0b6a804227ecdd404"));
+    std::shared_ptr<MUCUserPayload> mucUser = std::make_shared<MUCUserPayload>();
+    mucUser->addItem(MUCItem(MUCOccupant::Member, MUCOccupant::Participant));
+    presence.addPayload(mucUser);
+
+    // The payloads looked up for every presence, three of which are absent.
+    double dynamicCast = measure([&]() {
+        size_t found = 0;
+        found += !!getPayloadWithDynamicCast<StatusShow>(presence);
+        found += !!getPayloadWithDynamicCast<Status>(presence);
+        found += !!getPayloadWithDynamicCast<Priority>(presence);
+        found += !!getPayloadWithDynamicCast<CapsInfo>(presence);
+        found += !!getPayloadWithDynamicCast<ErrorPayload>(presence);
+        found += !!getPayloadWithDynamicCast<VCardUpdate>(presence);
+        found += !!getPayloadWithDynamicCast<MUCUserPayload>(presence);
+        found += !!getPayloadWithDynamicCast<Idle>(presence);
+        found += !!getPayloadWithDynamicCast<Delay>(presence);
+        return found;
+    });
+    double getPayload = measure([&]() {
+        size_t found = 0;
+        found += !!presence.getPayload<StatusShow>();
+        found += !!presence.getPayload<Status>();
+        found += !!presence.getPayload<Priority>();
+        found += !!presence.getPayload<CapsInfo>();
+        found += !!presence.getPayload<ErrorPayload>();
+        found += !!presence.getPayload<VCardUpdate>();
+        found += !!presence.getPayload<MUCUserPayload>();
+        found += !!presence.getPayload<Idle>();
+        found += !!presence.getPayload<Delay>();
+        return found;
+    });
+    double getPayloadPtr = measure([&]() {
+        size_t found = 0;
+        found += !!presence.getPayloadPtr<StatusShow>();
+        found += !!presence.getPayloadPtr<Status>();
+        found += !!presence.getPayloadPtr<Priority>();
+        found += !!presence.getPayloadPtr<CapsInfo>();
+        found += !!presence.getPayloadPtr<ErrorPayload>();
+        found += !!presence.getPayloadPtr<VCardUpdate>();
+        found += !!presence.getPayloadPtr<MUCUserPayload>();
+        found += !!presence.getPayloadPtr<Idle>();
+        found += !!presence.getPayloadPtr<Delay>();
+        return found;
+    });
+
+    std::cout << "Per-presence lookup cost (" << presence.getPayloads().size() << " payloads, 9 lookups)" << std::endl;
+    std::cout << "  dynamic_pointer_cast scan: " << dynamicCast << " ns" << std::endl;
+    std::cout << "  getPayload:                " << getPayload << " ns" << std::endl;
+    std::cout << "  getPayloadPtr:             " << getPayloadPtr << " ns" << std::endl;
+    return 0;
+}
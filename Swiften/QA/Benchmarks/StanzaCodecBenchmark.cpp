@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Replays a corpus of typical stanzas through XMPPParser (with each XML
+ * parser that is built in, or the one chosen with --parser), and through
+ * XMPPSerializer with the full payload serializer collection.
+ *
+ * For every stanza, it reports the time and the number of heap allocations
+ * per stanza, and the throughput in bytes of XML per second. With --json,
+ * the results are printed as a JSON array instead of a table, so that they
+ * can be compared across builds.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Elements/ProtocolHeader.h>
+#include <Swiften/Elements/ToplevelElement.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/XMLParserFactory.h>
+#include <Swiften/Parser/XMPPParser.h>
+#include <Swiften/Parser/XMPPParserClient.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/Serializer/XMPPSerializer.h>
+#include <Swiften/StringCodecs/Base64.h>
+
+#ifdef HAVE_EXPAT
+#include <Swiften/Parser/ExpatParser.h>
+#endif
+#ifdef HAVE_LIBXML
+#include <Swiften/Parser/LibXMLParser.h>
+#endif
+
+using namespace Swift;
+
+// Count every heap allocation of the process. Only the benchmark thread
+// allocates while measuring.
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* result = std::malloc(size ? size : 1)) {
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+static const char* STREAM_HEADER = "<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' from='example.com' id='bench' version='1.0'>";
+
+struct Stanza {
+    std::string name;
+    std::string xml;
+};
+
+static std::vector<Stanza> createCorpus() {
+    std::vector<Stanza> corpus;
+    corpus.push_back({"chat-message",
+        "<message from='juliet@example.com/balcony' to='romeo@example.net/orchard' type='chat' id='ktx72v49'>"
+            "<body>Art thou not Romeo, and a Montague?</body>"
+            "<thread>e0ffe42b28561960c6b12b944a092794b9683a38</thread>"
+            "<active xmlns='http://jabber.org/protocol/chatstates'/>"
+            "<request xmlns='urn:xmpp:receipts'/>"
+        "</message>"});
+    corpus.push_back({"muc-presence",
+        "<presence from='coven@chat.shakespeare.lit/thirdwitch' to='hag66@shakespeare.lit/pda' id='n13mt3l'>"
+            "<show>away</show>"
+            "<status>Stirring the cauldron</status>"
+            "<priority>5</priority>"
+            "<c xmlns='http://jabber.org/protocol/caps' hash='sha-1' node='https://swift.im' ver='QgayPKawpkPSDYmwT/WM94uAlu0='/>"
+            "<x xmlns='vcard-temp:x:update'><photo>01b87fcd030b72895ff8e88db57ec525450f000d</photo></x>"
+            "<x xmlns='http://jabber.org/protocol/muc#user'>"
+                "<item affiliation='member' jid='hag66@shakespeare.lit/pda' role='participant'/>"
+                "<status code='110'/>"
+            "</x>"
+        "</presence>"});
+    corpus.push_back({"roster-push",
+        "<iq to='juliet@example.com/balcony' type='set' id='a78b4q6ha463'>"
+            "<query xmlns='jabber:iq:roster' ver='ver14'>"
+                "<item jid='nurse@example.com' name='Nurse' subscription='both'><group>Servants</group></item>"
+                "<item jid='romeo@example.net' name='Romeo' subscription='to' ask='subscribe'><group>Friends</group><group>Montagues</group></item>"
+                "<item jid='mercutio@example.org' name='Mercutio' subscription='from'><group>Friends</group></item>"
+                "<item jid='benvolio@example.org' subscription='none'/>"
+                "<item jid='tybalt@example.com' name='Tybalt' subscription='remove'/>"
+            "</query>"
+        "</iq>"});
+
+    ByteArray photo;
+    for (size_t i = 0; i < 8192; ++i) {
+        photo.push_back(static_cast<unsigned char>((i * 7919) % 251));
+    }
+    corpus.push_back({"vcard-photo",
+        "<iq from='juliet@example.com' to='juliet@example.com/balcony' type='result' id='v1'>"
+            "<vCard xmlns='vcard-temp'>"
+                "<FN>Juliet Capulet</FN>"
+                "<N><FAMILY>Capulet</FAMILY><GIVEN>Juliet</GIVEN></N>"
+                "<NICKNAME>Jule</NICKNAME>"
+                "<EMAIL><INTERNET/><PREF/><USERID>juliet@example.com</USERID></EMAIL>"
+                "<BDAY>1583-07-31</BDAY>"
+                "<PHOTO><TYPE>image/png</TYPE><BINVAL>" + Base64::encode(photo) + "</BINVAL></PHOTO>"
+            "</vCard>"
+        "</iq>"});
+    corpus.push_back({"pubsub-item",
+        "<message from='romeo@example.net' to='juliet@example.com/balcony' type='headline' id='tunefoo'>"
+            "<event xmlns='http://jabber.org/protocol/pubsub#event'>"
+                "<items node='http://jabber.org/protocol/tune'>"
+                    "<item id='bffe6584-0f9c-11dc-84ba-001143d5d5db'>"
+                        "<tune xmlns='http://jabber.org/protocol/tune'>"
+                            "<artist>Yes</artist><length>686</length><rating>8</rating>"
+                            "<source>Yessongs</source><title>Heart of the Sunrise</title><track>3</track>"
+                            "<uri>http://www.yesworld.com/lyrics/Fragile.html#9</uri>"
+                        "</tune>"
+                    "</item>"
+                "</items>"
+            "</event>"
+            "<delay xmlns='urn:xmpp:delay' from='example.net' stamp='2017-06-12T10:24:47Z'/>"
+        "</message>"});
+    corpus.push_back({"command-form",
+        "<iq from='responder@example.com' to='requester@example.com/balcony' type='result' id='config1'>"
+            "<command xmlns='http://jabber.org/protocol/commands' node='config' sessionid='config:20170612T102444Z' status='executing'>"
+                "<actions execute='next'><next/></actions>"
+                "<x xmlns='jabber:x:data' type='form'>"
+                    "<title>Configure Service</title>"
+                    "<instructions>Please select the service to configure.</instructions>"
+                    "<field var='FORM_TYPE' type='hidden'><value>http://jabber.org/protocol/admin</value></field>"
+                    "<field var='service' label='Service' type='list-single'>"
+                        "<option label='Web'><value>httpd</value></option>"
+                        "<option label='Mail'><value>smtpd</value></option>"
+                        "<option label='Chat'><value>xmppd</value></option>"
+                    "</field>"
+                    "<field var='enabled' label='Enabled' type='boolean'><value>1</value></field>"
+                    "<field var='admins' label='Administrators' type='jid-multi'>"
+                        "<value>juliet@example.com</value><value>romeo@example.net</value>"
+                    "</field>"
+                    "<field var='motd' label='Message of the day' type='text-multi'>"
+                        "<value>Welcome to Verona.</value><value>Mind the Montagues.</value>"
+                    "</field>"
+                "</x>"
+            "</command>"
+        "</iq>"});
+    return corpus;
+}
+
+struct Result {
+    std::string operation;
+    std::string parser;
+    std::string stanza;
+    double nanosecondsPerStanza;
+    double allocationsPerStanza;
+    double bytesPerSecond;
+};
+
+class BenchmarkClient : public XMPPParserClient {
+    public:
+        BenchmarkClient() : elements(0) {}
+
+        virtual void handleStreamStart(const ProtocolHeader&) {}
+        virtual void handleElement(std::shared_ptr<ToplevelElement> element) {
+            lastElement = element;
+            elements++;
+        }
+        virtual void handleStreamEnd() {}
+
+        size_t elements;
+        std::shared_ptr<ToplevelElement> lastElement;
+};
+
+template<typename XMLParserType>
+class BenchmarkXMLParserFactory : public XMLParserFactory {
+    public:
+        virtual std::unique_ptr<XMLParser> createXMLParser(XMLParserClient* client) {
+            return std::make_unique<XMLParserType>(client);
+        }
+};
+
+template<typename F>
+static Result measure(const std::string& operation, const std::string& parser, const Stanza& stanza, int iterations, size_t bytesPerIteration, F f) {
+    // Warm up caches and buffers first
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        f();
+    }
+    size_t allocationsBefore = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        f();
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+
+    Result result;
+    result.operation = operation;
+    result.parser = parser;
+    result.stanza = stanza.name;
+    result.nanosecondsPerStanza = nanoseconds / iterations;
+    result.allocationsPerStanza = static_cast<double>(allocations - allocationsBefore) / iterations;
+    result.bytesPerSecond = nanoseconds > 0 ? static_cast<double>(bytesPerIteration) * iterations * 1e9 / nanoseconds : 0;
+    return result;
+}
+
+static std::vector<std::string> getParserNames() {
+    std::vector<std::string> names;
+#ifdef HAVE_EXPAT
+    names.push_back("expat");
+#endif
+#ifdef HAVE_LIBXML
+    names.push_back("libxml");
+#endif
+    return names;
+}
+
+static std::unique_ptr<XMLParserFactory> createXMLParserFactory(const std::string& parserName) {
+#ifdef HAVE_EXPAT
+    if (parserName == "expat") {
+        return std::make_unique<BenchmarkXMLParserFactory<ExpatParser> >();
+    }
+#endif
+#ifdef HAVE_LIBXML
+    if (parserName == "libxml") {
+        return std::make_unique<BenchmarkXMLParserFactory<LibXMLParser> >();
+    }
+#endif
+    return std::unique_ptr<XMLParserFactory>();
+}
+
+static void benchmarkParser(const std::string& parserName, const std::vector<Stanza>& corpus, int iterations, std::vector<Result>& results) {
+    FullPayloadParserFactoryCollection payloadParserFactories;
+    std::unique_ptr<XMLParserFactory> xmlParserFactory = createXMLParserFactory(parserName);
+    for (const auto& stanza : corpus) {
+        // Parse the stanzas as part of one long stream, as a session does
+        BenchmarkClient client;
+        XMPPParser parser(&client, &payloadParserFactories, xmlParserFactory.get());
+        parser.parse(STREAM_HEADER);
+        bool ok = true;
+        results.push_back(measure("parse", parserName, stanza, iterations, stanza.xml.size(), [&]() {
+            ok &= parser.parse(stanza.xml);
+        }));
+        if (!ok || client.elements != static_cast<size_t>(iterations + iterations / 10 + 1)) {
+            std::cerr << "Error parsing " << stanza.name << " with " << parserName << std::endl;
+            std::exit(1);
+        }
+    }
+}
+
+static void benchmarkSerializer(const std::string& parserName, const std::vector<Stanza>& corpus, int iterations, std::vector<Result>& results) {
+    FullPayloadParserFactoryCollection payloadParserFactories;
+    std::unique_ptr<XMLParserFactory> xmlParserFactory = createXMLParserFactory(parserName);
+    FullPayloadSerializerCollection payloadSerializers;
+    XMPPSerializer serializer(&payloadSerializers, ClientStreamType, false);
+    for (const auto& stanza : corpus) {
+        BenchmarkClient client;
+        XMPPParser parser(&client, &payloadParserFactories, xmlParserFactory.get());
+        parser.parse(STREAM_HEADER);
+        parser.parse(stanza.xml);
+        std::shared_ptr<ToplevelElement> element = client.lastElement;
+
+        SafeByteArray buffer;
+        serializer.serializeElement(element, buffer);
+        size_t size = buffer.size();
+        results.push_back(measure("serialize", "", stanza, iterations, size, [&]() {
+            buffer.clear();
+            serializer.serializeElement(element, buffer);
+        }));
+    }
+}
+
+static void printTable(const std::vector<Result>& results) {
+    std::cout << std::left << std::setw(10) << "Operation" << std::setw(8) << "Parser" << std::setw(14) << "Stanza"
+              << std::right << std::setw(12) << "ns/stanza" << std::setw(14) << "allocs/stanza" << std::setw(10) << "MB/s" << std::endl;
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(10) << result.operation << std::setw(8) << result.parser << std::setw(14) << result.stanza
+                  << std::right << std::fixed << std::setprecision(0) << std::setw(12) << result.nanosecondsPerStanza
+                  << std::setprecision(1) << std::setw(14) << result.allocationsPerStanza
+                  << std::setw(10) << result.bytesPerSecond / (1024 * 1024) << std::endl;
+    }
+}
+
+static void printJSON(const std::vector<Result>& results) {
+    std::cout << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::cout << "  {\"operation\": \"" << result.operation << "\", \"parser\": \"" << result.parser << "\", \"stanza\": \"" << result.stanza << "\", "
+                  << std::fixed << std::setprecision(1)
+                  << "\"ns_per_stanza\": " << result.nanosecondsPerStanza << ", "
+                  << "\"allocations_per_stanza\": " << result.allocationsPerStanza << ", "
+                  << std::setprecision(0)
+                  << "\"bytes_per_second\": " << result.bytesPerSecond << "}"
+                  << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    std::cout << "]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = 20000;
+    bool json = false;
+    std::vector<std::string> parserNames = getParserNames();
+    for (int i = 1; i < argc; ++i) {
+        std::string argument(argv[i]);
+        if (argument == "--json") {
+            json = true;
+        }
+        else if (argument == "--iterations" && i + 1 < argc) {
+            iterations = boost::lexical_cast<int>(argv[++i]);
+        }
+        else if (argument == "--parser" && i + 1 < argc && createXMLParserFactory(argv[i + 1])) {
+            parserNames = std::vector<std::string>(1, argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--json] [--iterations N] [--parser " << boost::algorithm::join(getParserNames(), "|") << "]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Stanza> corpus = createCorpus();
+    std::vector<Result> results;
+    for (const auto& parserName : parserNames) {
+        benchmarkParser(parserName, corpus, iterations, results);
+    }
+    // The serializer only needs a parser to build the elements
+    benchmarkSerializer(parserNames.back(), corpus, iterations, results);
+
+    if (json) {
+        printJSON(results);
+    }
+    else {
+        printTable(results);
+    }
+    return 0;
+}
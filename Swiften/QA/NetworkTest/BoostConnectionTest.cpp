@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -16,6 +16,7 @@
 #include <Swiften/Base/sleep.h>
 #include <Swiften/EventLoop/DummyEventLoop.h>
 #include <Swiften/Network/BoostConnection.h>
+#include <Swiften/Network/BoostConnectionServer.h>
 #include <Swiften/Network/BoostIOServiceThread.h>
 #include <Swiften/Network/HostAddress.h>
 #include <Swiften/Network/HostAddressPort.h>
@@ -28,6 +29,7 @@ class BoostConnectionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testDestructor_PendingEvents);
         CPPUNIT_TEST(testWrite);
         CPPUNIT_TEST(testWriteMultipleSimultaniouslyQueuesWrites);
+        CPPUNIT_TEST(testWrite_HighWatermark);
 #ifdef TEST_IPV6
         CPPUNIT_TEST(testWrite_IPv6);
 #endif
@@ -40,6 +42,8 @@ class BoostConnectionTest : public CppUnit::TestFixture {
             boostIOService_ = std::make_shared<boost::asio::io_service>();
             disconnected_ = false;
             connectFinished_ = false;
+            writeQueueFull_ = 0;
+            writeQueueDrained_ = 0;
         }
 
         void tearDown() {
@@ -150,6 +154,41 @@ class BoostConnectionTest : public CppUnit::TestFixture {
             }
         }
 
+        void testWrite_HighWatermark() {
+            BoostConnectionServer::ref server(BoostConnectionServer::create(HostAddress::fromString("127.0.0.1").get(), 9998, boostIOServiceThread_->getIOService(), eventLoop_));
+            server->onNewConnection.connect(boost::bind(&BoostConnectionTest::handleNewConnection, this, _1));
+            server->start();
+
+            BoostConnection::ref testling(BoostConnection::create(boostIOServiceThread_->getIOService(), eventLoop_));
+            testling->onConnectFinished.connect(boost::bind(&BoostConnectionTest::handleConnectFinished, this));
+            testling->onWriteQueueFull.connect(boost::bind(&BoostConnectionTest::handleWriteQueueFull, this));
+            testling->onWriteQueueDrained.connect(boost::bind(&BoostConnectionTest::handleWriteQueueDrained, this));
+            testling->setWriteHighWatermark(1024);
+            testling->connect(HostAddressPort(HostAddress::fromString("127.0.0.1").get(), 9998));
+            while (!connectFinished_) {
+                Swift::sleep(10);
+                eventLoop_->processEvents();
+            }
+
+            testling->write(SafeByteArray(2000, 'a'));
+            testling->write(SafeByteArray(100, 'b'));
+            testling->write(SafeByteArray(100, 'c'));
+            while (receivedData_.size() < 2200 || writeQueueDrained_ == 0) {
+                Swift::sleep(10);
+                eventLoop_->processEvents();
+            }
+
+            CPPUNIT_ASSERT_EQUAL(1, writeQueueFull_);
+            CPPUNIT_ASSERT_EQUAL(1, writeQueueDrained_);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2200), receivedData_.size());
+            CPPUNIT_ASSERT_EQUAL('a', static_cast<char>(receivedData_[1999]));
+            CPPUNIT_ASSERT_EQUAL('b', static_cast<char>(receivedData_[2000]));
+            CPPUNIT_ASSERT_EQUAL('c', static_cast<char>(receivedData_[2199]));
+
+            testling->disconnect();
+            server->stop();
+        }
+
         void doWrite(BoostConnection* connection) {
             connection->write(createSafeByteArray("<stream:stream>"));
             connection->write(createSafeByteArray("\r\n\r\n")); // Temporarily, while we don't have an xmpp server running on ipv6
@@ -167,6 +206,19 @@ class BoostConnectionTest : public CppUnit::TestFixture {
             connectFinished_ = true;
         }
 
+        void handleNewConnection(std::shared_ptr<Connection> connection) {
+            serverConnection_ = connection;
+            serverConnection_->onDataRead.connect(boost::bind(&BoostConnectionTest::handleDataRead, this, _1));
+        }
+
+        void handleWriteQueueFull() {
+            writeQueueFull_++;
+        }
+
+        void handleWriteQueueDrained() {
+            writeQueueDrained_++;
+        }
+
     private:
         BoostIOServiceThread* boostIOServiceThread_;
         std::shared_ptr<boost::asio::io_service> boostIOService_;
@@ -174,6 +226,9 @@ class BoostConnectionTest : public CppUnit::TestFixture {
         ByteArray receivedData_;
         bool disconnected_;
         bool connectFinished_;
+        std::shared_ptr<Connection> serverConnection_;
+        int writeQueueFull_;
+        int writeQueueDrained_;
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(BoostConnectionTest);
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <boost/bind.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLContextFactory.h>
+#include <Swiften/TLS/PEMCertificate.h>
+#include <Swiften/TLS/PKCS12Certificate.h>
+#include <Swiften/TLS/TLSContext.h>
+
+#include <SwifTools/Application/PlatformApplicationPathProvider.h>
+
+using namespace Swift;
+
+class ServerModeTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ServerModeTest);
+        CPPUNIT_TEST(testHandshake_PEMCertificate);
+        CPPUNIT_TEST(testHandshake_PKCS12Certificate);
+        CPPUNIT_TEST(testHandshake_WithoutCertificate);
+        CPPUNIT_TEST(testSetServerCertificate_InvalidPassword);
+        CPPUNIT_TEST(testExchangeData);
+        CPPUNIT_TEST(testExchangeData_RecordsFromOneReadDeliveredTogether);
+        CPPUNIT_TEST(testSessionResumption);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            pathProvider = std::make_unique<PlatformApplicationPathProvider>("ServerModeTest");
+            certificateFile = pathProvider->getExecutableDir() / "server.crt";
+            privateKeyFile = pathProvider->getExecutableDir() / "server.key";
+            pkcs12File = pathProvider->getExecutableDir() / "server.p12";
+            clientFactory = std::unique_ptr<OpenSSLContextFactory>(new OpenSSLContextFactory());
+            serverFactory = std::unique_ptr<OpenSSLContextFactory>(new OpenSSLContextFactory());
+        }
+
+        void testHandshake_PEMCertificate() {
+            CPPUNIT_ASSERT(serverFactory->setServerCertificate(std::make_shared<PEMCertificate>(certificateFile, privateKeyFile)));
+
+            Connection connection(clientFactory.get(), serverFactory.get());
+            connection.handshake();
+
+            CPPUNIT_ASSERT(connection.client.connected);
+            CPPUNIT_ASSERT(connection.server.connected);
+            CPPUNIT_ASSERT(connection.clientContext->getPeerCertificate());
+            CPPUNIT_ASSERT_EQUAL(std::string("localhost"), connection.clientContext->getPeerCertificate()->getCommonNames()[0]);
+        }
+
+        void testHandshake_PKCS12Certificate() {
+            CPPUNIT_ASSERT(serverFactory->setServerCertificate(std::make_shared<PKCS12Certificate>(pkcs12File, createSafeByteArray("secret"))));
+
+            Connection connection(clientFactory.get(), serverFactory.get());
+            connection.handshake();
+
+            CPPUNIT_ASSERT(connection.client.connected);
+            CPPUNIT_ASSERT(connection.server.connected);
+        }
+
+        void testHandshake_WithoutCertificate() {
+            Connection connection(clientFactory.get(), serverFactory.get());
+            connection.handshake();
+
+            CPPUNIT_ASSERT(!connection.client.connected);
+            CPPUNIT_ASSERT(!connection.server.connected);
+            CPPUNIT_ASSERT(connection.server.error);
+        }
+
+        void testSetServerCertificate_InvalidPassword() {
+            CPPUNIT_ASSERT(!serverFactory->setServerCertificate(std::make_shared<PKCS12Certificate>(pkcs12File, createSafeByteArray("wrong"))));
+        }
+
+        void testExchangeData() {
+            CPPUNIT_ASSERT(serverFactory->setServerCertificate(std::make_shared<PEMCertificate>(certificateFile, privateKeyFile)));
+            Connection connection(clientFactory.get(), serverFactory.get());
+            connection.handshake();
+
+            connection.clientContext->handleDataFromApplication(createSafeByteArray("<stream:stream>"));
+            connection.transfer();
+            connection.serverContext->handleDataFromApplication(createSafeByteArray("<stream:stream id='1'>"));
+            connection.transfer();
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<stream:stream>"), connection.server.receivedData);
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<stream:stream id='1'>"), connection.client.receivedData);
+        }
+
+        void testExchangeData_RecordsFromOneReadDeliveredTogether() {
+            CPPUNIT_ASSERT(serverFactory->setServerCertificate(std::make_shared<PEMCertificate>(certificateFile, privateKeyFile)));
+            Connection connection(clientFactory.get(), serverFactory.get());
+            connection.handshake();
+            connection.client.receivedData.clear();
+            connection.client.deliveries = 0;
+
+            // Each write becomes at least one record
+            SafeByteArray largeData(40000, 'x');
+            connection.serverContext->handleDataFromApplication(createSafeByteArray("<message>"));
+            connection.serverContext->handleDataFromApplication(largeData);
+            connection.serverContext->handleDataFromApplication(createSafeByteArray("</message>"));
+            connection.transfer();
+
+            CPPUNIT_ASSERT_EQUAL(1, connection.client.deliveries);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(9 + 40000 + 10), connection.client.receivedData.size());
+        }
+
+        void testSessionResumption() {
+            CPPUNIT_ASSERT(serverFactory->setServerCertificate(std::make_shared<PEMCertificate>(certificateFile, privateKeyFile)));
+
+            for (int i = 0; i < 3; ++i) {
+                Connection connection(clientFactory.get(), serverFactory.get());
+                connection.handshake();
+                CPPUNIT_ASSERT(connection.client.connected);
+
+                // Let the client receive the session tickets sent after the
+                // handshake in TLS 1.3
+                connection.serverContext->handleDataFromApplication(createSafeByteArray("<stream:stream id='1'>"));
+                connection.transfer();
+            }
+
+            CPPUNIT_ASSERT_EQUAL(1ULL, clientFactory->getHandshakeStatistics().fullHandshakes);
+            CPPUNIT_ASSERT_EQUAL(2ULL, clientFactory->getHandshakeStatistics().resumedHandshakes);
+            CPPUNIT_ASSERT_EQUAL(1ULL, serverFactory->getHandshakeStatistics().fullHandshakes);
+            CPPUNIT_ASSERT_EQUAL(2ULL, serverFactory->getHandshakeStatistics().resumedHandshakes);
+        }
+
+    private:
+        struct Endpoint {
+            Endpoint() : connected(false), error(false), deliveries(0) {}
+
+            void handleConnected() {
+                connected = true;
+            }
+
+            void handleError() {
+                error = true;
+            }
+
+            void handleDataForNetwork(const SafeByteArray& data) {
+                append(pendingData, data);
+            }
+
+            void handleDataForApplication(const SafeByteArray& data) {
+                append(receivedData, data);
+                ++deliveries;
+            }
+
+            bool connected;
+            bool error;
+            int deliveries;
+            SafeByteArray pendingData;
+            SafeByteArray receivedData;
+        };
+
+        // Connects a client and a server context in memory
+        struct Connection {
+            Connection(OpenSSLContextFactory* clientFactory, OpenSSLContextFactory* serverFactory) :
+                    clientContext(clientFactory->createTLSContext(TLSOptions(), TLSContext::Mode::Client)),
+                    serverContext(serverFactory->createTLSContext(TLSOptions(), TLSContext::Mode::Server)) {
+                connect(clientContext.get(), &client);
+                connect(serverContext.get(), &server);
+                clientContext->setServerIdentity("localhost");
+            }
+
+            void handshake() {
+                serverContext->accept();
+                clientContext->connect();
+                transfer();
+            }
+
+            // Passes data between both sides until there is nothing left to
+            // pass, so the contexts never get called recursively
+            void transfer() {
+                while (!client.pendingData.empty() || !server.pendingData.empty()) {
+                    SafeByteArray data;
+                    data.swap(client.pendingData);
+                    if (!data.empty() && !server.error) {
+                        serverContext->handleDataFromNetwork(data);
+                    }
+                    data.clear();
+                    data.swap(server.pendingData);
+                    if (!data.empty() && !client.error) {
+                        clientContext->handleDataFromNetwork(data);
+                    }
+                }
+            }
+
+            static void connect(TLSContext* context, Endpoint* endpoint) {
+                context->onConnected.connect(boost::bind(&Endpoint::handleConnected, endpoint));
+                context->onError.connect(boost::bind(&Endpoint::handleError, endpoint));
+                context->onDataForNetwork.connect(boost::bind(&Endpoint::handleDataForNetwork, endpoint, _1));
+                context->onDataForApplication.connect(boost::bind(&Endpoint::handleDataForApplication, endpoint, _1));
+            }
+
+            Endpoint client;
+            Endpoint server;
+            std::unique_ptr<TLSContext> clientContext;
+            std::unique_ptr<TLSContext> serverContext;
+        };
+
+    private:
+        std::unique_ptr<PlatformApplicationPathProvider> pathProvider;
+        boost::filesystem::path certificateFile;
+        boost::filesystem::path privateKeyFile;
+        boost::filesystem::path pkcs12File;
+        std::unique_ptr<OpenSSLContextFactory> clientFactory;
+        std::unique_ptr<OpenSSLContextFactory> serverFactory;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ServerModeTest);
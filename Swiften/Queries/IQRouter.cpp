@@ -1,17 +1,20 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Queries/IQRouter.h>
 
+#include <cassert>
+
 #include <boost/bind.hpp>
 
 #include <Swiften/Base/Algorithm.h>
 #include <Swiften/Elements/ErrorPayload.h>
 #include <Swiften/Queries/IQChannel.h>
 #include <Swiften/Queries/IQHandler.h>
+#include <Swiften/Queries/Request.h>
 
 namespace Swift {
 
@@ -33,10 +36,14 @@ void IQRouter::handleIQ(std::shared_ptr<IQ> iq) {
     queueRemoves_ = true;
 
     bool handled = false;
+    if (iq->getType() == IQ::Result || iq->getType() == IQ::Error) {
+        handled = handleResponse(iq);
+    }
+
     // Go through the handlers in reverse order, to give precedence to the last added handler
     std::vector<std::shared_ptr<IQHandler> >::const_reverse_iterator i = handlers_.rbegin();
     std::vector<std::shared_ptr<IQHandler> >::const_reverse_iterator rend = handlers_.rend();
-    for (; i != rend; ++i) {
+    for (; !handled && i != rend; ++i) {
         handled |= (*i)->handleIQ(iq);
         if (handled) {
             break;
@@ -51,6 +58,33 @@ void IQRouter::handleIQ(std::shared_ptr<IQ> iq) {
     queueRemoves_ = false;
 }
 
+bool IQRouter::handleResponse(std::shared_ptr<IQ> iq) {
+    auto i = requests_.find(iq->getID());
+    if (i == requests_.end()) {
+        return false;
+    }
+
+    // Requests remove themselves when they handle the response, so work on a
+    // copy. Give precedence to the last sent request, as the handler chain does.
+    std::vector<std::shared_ptr<IQHandler> > candidates;
+    for (auto j = i->second.rbegin(); j != i->second.rend(); ++j) {
+        candidates.push_back(j->request);
+    }
+    for (auto&& candidate : candidates) {
+        if (candidate->handleIQ(iq)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void IQRouter::handleRequestTimeout(std::shared_ptr<Request> request) {
+    std::shared_ptr<IQ> error = IQ::createError(jid_, request->getReceiver(), request->getID(), ErrorPayload::RemoteServerTimeout, ErrorPayload::Wait);
+    if (!std::static_pointer_cast<IQHandler>(request)->handleIQ(error)) {
+        removeRequest(request.get());
+    }
+}
+
 void IQRouter::processPendingRemoves() {
     for (auto&& handler : queuedRemoves_) {
         erase(handlers_, handler);
@@ -79,6 +113,39 @@ void IQRouter::removeHandler(std::shared_ptr<IQHandler> handler) {
     }
 }
 
+void IQRouter::addRequest(std::shared_ptr<Request> request) {
+    PendingRequest pending = { request, 0 };
+    if (timerWheel_ && request->getTimeout() > 0) {
+        pending.timeout = timerWheel_->schedule(request->getTimeout(), boost::bind(&IQRouter::handleRequestTimeout, this, request));
+    }
+    requests_[request->getID()].push_back(pending);
+}
+
+void IQRouter::removeRequest(Request* request) {
+    auto i = requests_.find(request->getID());
+    if (i == requests_.end()) {
+        return;
+    }
+    std::vector<PendingRequest>& pending = i->second;
+    for (auto j = pending.begin(); j != pending.end(); ++j) {
+        if (j->request.get() == request) {
+            if (j->timeout) {
+                timerWheel_->cancel(j->timeout);
+            }
+            pending.erase(j);
+            break;
+        }
+    }
+    if (pending.empty()) {
+        requests_.erase(i);
+    }
+}
+
+void IQRouter::setTimerFactory(TimerFactory* timerFactory) {
+    assert(requests_.empty());
+    timerWheel_ = std::unique_ptr<TimerWheel>(new TimerWheel(timerFactory));
+}
+
 void IQRouter::sendIQ(std::shared_ptr<IQ> iq) {
     if (from_.isValid() && !iq->getFrom().isValid()) {
         iq->setFrom(from_);
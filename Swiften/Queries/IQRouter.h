@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,14 +8,18 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/IQ.h>
+#include <Swiften/Network/TimerWheel.h>
 
 namespace Swift {
     class IQChannel;
     class IQHandler;
+    class Request;
+    class TimerFactory;
 
     class SWIFTEN_API IQRouter {
         public:
@@ -52,6 +56,26 @@ namespace Swift {
             void addHandler(std::shared_ptr<IQHandler> handler);
             void removeHandler(std::shared_ptr<IQHandler> handler);
 
+            /**
+             * Registers a sent request, so that its response is dispatched to
+             * it directly through a table keyed by the IQ ID, instead of through
+             * the handler chain.
+             *
+             * If the request has a timeout and a timer factory was set, the
+             * request receives a remote-server-timeout error when no response
+             * arrives in time.
+             *
+             * This is called by Request::send().
+             */
+            void addRequest(std::shared_ptr<Request> request);
+            void removeRequest(Request* request);
+
+            /**
+             * Sets the timer factory used for request timeouts. Without a
+             * timer factory, requests never time out.
+             */
+            void setTimerFactory(TimerFactory* timerFactory);
+
             /**
              * Sends an IQ stanza.
              *
@@ -77,6 +101,14 @@ namespace Swift {
         private:
             void handleIQ(std::shared_ptr<IQ> iq);
             void processPendingRemoves();
+            bool handleResponse(std::shared_ptr<IQ> iq);
+            void handleRequestTimeout(std::shared_ptr<Request> request);
+
+        private:
+            struct PendingRequest {
+                std::shared_ptr<Request> request;
+                TimerWheel::ID timeout;
+            };
 
         private:
             IQChannel* channel_;
@@ -85,5 +117,8 @@ namespace Swift {
             std::vector< std::shared_ptr<IQHandler> > handlers_;
             std::vector< std::shared_ptr<IQHandler> > queuedRemoves_;
             bool queueRemoves_;
+            // Requests sharing an ID are kept in the order they were sent
+            std::unordered_map<std::string, std::vector<PendingRequest> > requests_;
+            std::unique_ptr<TimerWheel> timerWheel_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,16 +12,18 @@
 
 namespace Swift {
 
-Request::Request(IQ::Type type, const JID& receiver, std::shared_ptr<Payload> payload, IQRouter* router) : router_(router), type_(type), receiver_(receiver), payload_(payload), sent_(false) {
+static void noop(Request*) {}
+
+Request::Request(IQ::Type type, const JID& receiver, std::shared_ptr<Payload> payload, IQRouter* router) : router_(router), type_(type), receiver_(receiver), payload_(payload), sent_(false), timeout_(0) {
 }
 
-Request::Request(IQ::Type type, const JID& receiver, IQRouter* router) : router_(router), type_(type), receiver_(receiver), sent_(false) {
+Request::Request(IQ::Type type, const JID& receiver, IQRouter* router) : router_(router), type_(type), receiver_(receiver), sent_(false), timeout_(0) {
 }
 
-Request::Request(IQ::Type type, const JID& sender, const JID& receiver, std::shared_ptr<Payload> payload, IQRouter* router) : router_(router), type_(type), sender_(sender), receiver_(receiver), payload_(payload), sent_(false) {
+Request::Request(IQ::Type type, const JID& sender, const JID& receiver, std::shared_ptr<Payload> payload, IQRouter* router) : router_(router), type_(type), sender_(sender), receiver_(receiver), payload_(payload), sent_(false), timeout_(0) {
 }
 
-Request::Request(IQ::Type type, const JID& sender, const JID& receiver, IQRouter* router) : router_(router), type_(type), sender_(sender), receiver_(receiver), sent_(false) {
+Request::Request(IQ::Type type, const JID& sender, const JID& receiver, IQRouter* router) : router_(router), type_(type), sender_(sender), receiver_(receiver), sent_(false), timeout_(0) {
 }
 
 std::string Request::send() {
@@ -37,10 +39,10 @@ std::string Request::send() {
     iq->setID(id_);
 
     try {
-        router_->addHandler(shared_from_this());
+        router_->addRequest(shared_from_this());
     }
     catch (const std::exception&) {
-        router_->addHandler(this);
+        router_->addRequest(std::shared_ptr<Request>(this, noop));
     }
 
     router_->sendIQ(iq);
@@ -68,7 +70,7 @@ bool Request::handleIQ(std::shared_ptr<IQ> iq) {
                         handleResponse(std::shared_ptr<Payload>(), ErrorPayload::ref(new ErrorPayload(ErrorPayload::UndefinedCondition)));
                     }
                 }
-                router_->removeHandler(this);
+                router_->removeRequest(this);
                 handled = true;
             }
         }
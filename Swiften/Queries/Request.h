@@ -40,6 +40,20 @@ namespace Swift {
                 return id_;
             }
 
+            /**
+             * Sets the number of milliseconds to wait for a response, after
+             * which the request fails with a remote-server-timeout error.
+             * Needs to be called before send(), and only has an effect if
+             * the IQRouter has a timer factory. By default, requests do not
+             * time out.
+             */
+            void setTimeout(int milliseconds) {
+                timeout_ = milliseconds;
+            }
+
+            int getTimeout() const {
+                return timeout_;
+            }
 
         protected:
             /**
@@ -104,5 +118,6 @@ namespace Swift {
             std::shared_ptr<Payload> payload_;
             std::string id_;
             bool sent_;
+            int timeout_;
     };
 }
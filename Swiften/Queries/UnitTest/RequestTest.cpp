@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,6 +13,7 @@
 
 #include <Swiften/Elements/Payload.h>
 #include <Swiften/Elements/RawXMLPayload.h>
+#include <Swiften/Network/DummyTimerFactory.h>
 #include <Swiften/Queries/DummyIQChannel.h>
 #include <Swiften/Queries/GenericRequest.h>
 #include <Swiften/Queries/IQRouter.h>
@@ -39,6 +40,10 @@ class RequestTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testHandleIQ_ServerRespondsWithBareJID);
         CPPUNIT_TEST(testHandleIQ_ServerRespondsWithoutFrom);
         CPPUNIT_TEST(testHandleIQ_ServerRespondsWithFullJID);
+        CPPUNIT_TEST(testHandleIQ_SameIDDifferentReceivers);
+        CPPUNIT_TEST(testTimeout);
+        CPPUNIT_TEST(testTimeout_CancelledByResponse);
+        CPPUNIT_TEST(testTimeout_WithoutTimerFactory);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -72,14 +77,17 @@ class RequestTest : public CppUnit::TestFixture {
     public:
         void setUp() {
             channel_ = new DummyIQChannel();
+            timerFactory_ = new DummyTimerFactory();
             router_ = new IQRouter(channel_);
             payload_ = std::make_shared<MyPayload>("foo");
             responsePayload_ = std::make_shared<MyPayload>("bar");
             responsesReceived_ = 0;
+            currentTime_ = 0;
         }
 
         void tearDown() {
             delete router_;
+            delete timerFactory_;
             delete channel_;
         }
 
@@ -312,9 +320,79 @@ class RequestTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(channel_->iqs_.size()));
         }
 
+        void testHandleIQ_SameIDDifferentReceivers() {
+            MyRequest testling1(IQ::Get, JID("foo@bar.com/baz"), payload_, router_);
+            testling1.onResponse.connect(boost::bind(&RequestTest::handleResponse, this, _1, _2));
+            testling1.send();
+            MyRequest testling2(IQ::Get, JID("foo@bar.com/qux"), payload_, router_);
+            testling2.onResponse.connect(boost::bind(&RequestTest::handleDifferentResponse, this, _1, _2));
+            testling2.send();
+
+            channel_->onIQReceived(createResponse(JID("foo@bar.com/baz"),"test-id"));
+            channel_->onIQReceived(createResponse(JID("foo@bar.com/baz"),"test-id"));
+
+            CPPUNIT_ASSERT_EQUAL(1, responsesReceived_);
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(receivedErrors.size()));
+        }
+
+        void testTimeout() {
+            router_->setTimerFactory(timerFactory_);
+            MyRequest testling(IQ::Get, JID("foo@bar.com/baz"), payload_, router_);
+            testling.onResponse.connect(boost::bind(&RequestTest::handleResponse, this, _1, _2));
+            testling.setTimeout(1000);
+            testling.send();
+
+            advanceTime(900);
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(receivedErrors.size()));
+
+            advanceTime(1000);
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(receivedErrors.size()));
+            CPPUNIT_ASSERT_EQUAL(ErrorPayload::RemoteServerTimeout, receivedErrors[0].getCondition());
+
+            // A late response is no longer handled
+            channel_->onIQReceived(createResponse(JID("foo@bar.com/baz"),"test-id"));
+            CPPUNIT_ASSERT_EQUAL(0, responsesReceived_);
+        }
+
+        void testTimeout_CancelledByResponse() {
+            router_->setTimerFactory(timerFactory_);
+            MyRequest testling(IQ::Get, JID("foo@bar.com/baz"), payload_, router_);
+            testling.onResponse.connect(boost::bind(&RequestTest::handleResponse, this, _1, _2));
+            testling.setTimeout(1000);
+            testling.send();
+
+            advanceTime(500);
+            channel_->onIQReceived(createResponse(JID("foo@bar.com/baz"),"test-id"));
+            advanceTime(2000);
+
+            CPPUNIT_ASSERT_EQUAL(1, responsesReceived_);
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(receivedErrors.size()));
+        }
+
+        void testTimeout_WithoutTimerFactory() {
+            MyRequest testling(IQ::Get, JID("foo@bar.com/baz"), payload_, router_);
+            testling.onResponse.connect(boost::bind(&RequestTest::handleResponse, this, _1, _2));
+            testling.setTimeout(1000);
+            testling.send();
+
+            advanceTime(2000);
+            channel_->onIQReceived(createResponse(JID("foo@bar.com/baz"),"test-id"));
+
+            CPPUNIT_ASSERT_EQUAL(1, responsesReceived_);
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(receivedErrors.size()));
+        }
+
 
 
     private:
+        // Moves the clock forward one timer wheel tick at a time
+        void advanceTime(int time) {
+            for (int t = currentTime_ + 100; t <= time; t += 100) {
+                timerFactory_->setTime(t);
+            }
+            currentTime_ = time;
+        }
+
         void handleResponse(std::shared_ptr<Payload> p, ErrorPayload::ref e) {
             if (e) {
                 receivedErrors.push_back(*e);
@@ -358,6 +436,8 @@ class RequestTest : public CppUnit::TestFixture {
     private:
         IQRouter* router_;
         DummyIQChannel* channel_;
+        DummyTimerFactory* timerFactory_;
+        int currentTime_;
         std::shared_ptr<Payload> payload_;
         std::shared_ptr<Payload> responsePayload_;
         int responsesReceived_;
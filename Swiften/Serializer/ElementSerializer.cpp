@@ -1,14 +1,21 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/ElementSerializer.h>
 
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
 namespace Swift {
 
 ElementSerializer::~ElementSerializer() {
 }
 
+void ElementSerializer::write(std::shared_ptr<ToplevelElement> element, XMLWriter& writer) const {
+    SafeByteArray serialized = serialize(element);
+    writer.getBuffer().insert(writer.getBuffer().end(), serialized.begin(), serialized.end());
+}
+
 }
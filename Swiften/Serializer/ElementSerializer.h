@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,11 +12,19 @@
 #include <Swiften/Elements/ToplevelElement.h>
 
 namespace Swift {
+    class XMLWriter;
+
     class ElementSerializer {
         public:
             virtual ~ElementSerializer();
 
             virtual SafeByteArray serialize(std::shared_ptr<ToplevelElement> element) const = 0;
             virtual bool canSerialize(std::shared_ptr<ToplevelElement> element) const = 0;
+
+            /**
+             * Writes the serialized element directly into the writer's buffer.
+             * The default implementation appends the result of serialize().
+             */
+            virtual void write(std::shared_ptr<ToplevelElement> element, XMLWriter& writer) const;
     };
 }
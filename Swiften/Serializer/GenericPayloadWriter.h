@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+namespace Swift {
+    /**
+     * A GenericPayloadSerializer for payloads that are written directly into
+     * an XMLWriter. The string based serializePayload() is derived from
+     * writePayload().
+     */
+    template<typename PAYLOAD_TYPE>
+    class GenericPayloadWriter : public GenericPayloadSerializer<PAYLOAD_TYPE> {
+        public:
+            virtual std::string serializePayload(std::shared_ptr<PAYLOAD_TYPE> payload) const {
+                SafeByteArray result;
+                XMLWriter writer(result);
+                writePayload(payload, writer);
+                return std::string(result.begin(), result.end());
+            }
+
+            virtual void writePayload(std::shared_ptr<PAYLOAD_TYPE>, XMLWriter&) const = 0;
+    };
+}
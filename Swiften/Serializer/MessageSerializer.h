@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,7 +13,7 @@
 #include <Swiften/Serializer/GenericStanzaSerializer.h>
 
 namespace Swift {
-    class XMLElement;
+    class XMLWriter;
 
     class SWIFTEN_API MessageSerializer : public GenericStanzaSerializer<Message> {
         public:
@@ -22,6 +22,6 @@ namespace Swift {
         private:
             void setStanzaSpecificAttributesGeneric(
                     std::shared_ptr<Message> message,
-                    XMLElement& element) const;
+                    XMLWriter& writer) const;
     };
 }
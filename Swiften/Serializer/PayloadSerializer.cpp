@@ -1,14 +1,20 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Serializer/PayloadSerializer.h>
 
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
 namespace Swift {
 
 PayloadSerializer::~PayloadSerializer() {
 }
 
+void PayloadSerializer::write(std::shared_ptr<Payload> payload, XMLWriter& writer) const {
+    writer.addRaw(serialize(payload));
+}
+
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,6 +13,7 @@
 
 namespace Swift {
     class Payload;
+    class XMLWriter;
 
     class SWIFTEN_API PayloadSerializer {
         public:
@@ -20,5 +21,11 @@ namespace Swift {
 
             virtual bool canSerialize(std::shared_ptr<Payload>) const = 0;
             virtual std::string serialize(std::shared_ptr<Payload>) const = 0;
+
+            /**
+             * Writes the serialized payload directly into the writer's buffer.
+             * The default implementation appends the result of serialize().
+             */
+            virtual void write(std::shared_ptr<Payload>, XMLWriter&) const;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,31 +8,62 @@
 
 #include <algorithm>
 
-#include <boost/bind.hpp>
-
 #include <Swiften/Serializer/PayloadSerializer.h>
 
 namespace Swift {
 
-PayloadSerializerCollection::PayloadSerializerCollection() {
+PayloadSerializerCollection::PayloadSerializerCollection() : serializersByType_(nullptr) {
+    publishSerializersByType(std::unique_ptr<SerializerMap>(new SerializerMap()));
 }
 
 PayloadSerializerCollection::~PayloadSerializerCollection() {
 }
 
 void PayloadSerializerCollection::addSerializer(PayloadSerializer* serializer) {
+    std::lock_guard<std::mutex> lock(serializersByTypeMutex_);
     serializers_.push_back(serializer);
+    publishSerializersByType(std::unique_ptr<SerializerMap>(new SerializerMap()));
 }
 
 void PayloadSerializerCollection::removeSerializer(PayloadSerializer* serializer) {
+    std::lock_guard<std::mutex> lock(serializersByTypeMutex_);
     serializers_.erase(std::remove(serializers_.begin(), serializers_.end(), serializer), serializers_.end());
+    publishSerializersByType(std::unique_ptr<SerializerMap>(new SerializerMap()));
 }
 
 PayloadSerializer* PayloadSerializerCollection::getPayloadSerializer(std::shared_ptr<Payload> payload) const {
-    std::vector<PayloadSerializer*>::const_iterator i = std::find_if(
-            serializers_.begin(), serializers_.end(),
-            boost::bind(&PayloadSerializer::canSerialize, _1, payload));
-    return (i != serializers_.end() ? *i : nullptr);
+    if (!payload) {
+        return nullptr;
+    }
+    const Payload& payloadRef = *payload;
+    std::type_index type(typeid(payloadRef));
+    const SerializerMap* serializersByType = serializersByType_.load(std::memory_order_acquire);
+    auto i = serializersByType->find(type);
+    if (i != serializersByType->end()) {
+        return i->second;
+    }
+
+    std::lock_guard<std::mutex> lock(serializersByTypeMutex_);
+    // Another lookup may have added the type in the meantime
+    serializersByType = serializersByType_.load(std::memory_order_relaxed);
+    i = serializersByType->find(type);
+    if (i != serializersByType->end()) {
+        return i->second;
+    }
+    auto j = std::find_if(serializers_.begin(), serializers_.end(), [&](PayloadSerializer* serializer) { return serializer->canSerialize(payload); });
+    PayloadSerializer* result = (j != serializers_.end() ? *j : nullptr);
+    std::unique_ptr<SerializerMap> updatedSerializersByType(new SerializerMap(*serializersByType));
+    (*updatedSerializersByType)[type] = result;
+    publishSerializersByType(std::move(updatedSerializersByType));
+    return result;
+}
+
+/**
+ * Needs to be called with serializersByTypeMutex_ held.
+ */
+void PayloadSerializerCollection::publishSerializersByType(std::unique_ptr<SerializerMap> serializersByType) const {
+    serializersByType_.store(serializersByType.get(), std::memory_order_release);
+    serializersByTypeVersions_.push_back(std::move(serializersByType));
 }
 
 }
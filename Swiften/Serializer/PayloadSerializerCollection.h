@@ -1,12 +1,16 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include <Swiften/Base/API.h>
@@ -15,6 +19,18 @@
 namespace Swift {
     class PayloadSerializer;
 
+    /**
+     * A collection of payload serializers.
+     *
+     * The serializer found for a payload is cached per payload type, so
+     * PayloadSerializer::canSerialize() should only depend on the type
+     * of the payload.
+     *
+     * Lookups of cached types do not lock. The cache is replaced by an
+     * updated copy when a new type is seen, and earlier copies are kept
+     * until the collection is destroyed, as a lookup may still be using
+     * them. The number of payload types is small, so this stays cheap.
+     */
     class SWIFTEN_API PayloadSerializerCollection {
         public:
             PayloadSerializerCollection();
@@ -24,7 +40,15 @@ namespace Swift {
             void removeSerializer(PayloadSerializer* factory);
             PayloadSerializer* getPayloadSerializer(std::shared_ptr<Payload>) const;
 
+        private:
+            typedef std::unordered_map<std::type_index, PayloadSerializer*> SerializerMap;
+
+            void publishSerializersByType(std::unique_ptr<SerializerMap> serializersByType) const;
+
         private:
             std::vector<PayloadSerializer*> serializers_;
+            mutable std::mutex serializersByTypeMutex_;
+            mutable std::atomic<const SerializerMap*> serializersByType_;
+            mutable std::vector<std::unique_ptr<SerializerMap> > serializersByTypeVersions_;
     };
 }
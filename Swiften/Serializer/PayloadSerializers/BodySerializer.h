@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,17 +8,17 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Body.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API BodySerializer : public GenericPayloadSerializer<Body> {
+    class SWIFTEN_API BodySerializer : public GenericPayloadWriter<Body> {
         public:
-            BodySerializer() : GenericPayloadSerializer<Body>() {}
+            BodySerializer() : GenericPayloadWriter<Body>() {}
 
-            virtual std::string serializePayload(std::shared_ptr<Body> body)  const {
-                XMLTextNode textNode(body->getText());
-                return "<body>" + textNode.serialize() + "</body>";
+            virtual void writePayload(std::shared_ptr<Body> body, XMLWriter& writer) const {
+                writer.startElement("body");
+                writer.addText(body->getText());
+                writer.endElement();
             }
     };
 }
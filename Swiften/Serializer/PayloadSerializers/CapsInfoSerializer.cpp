@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,19 +8,20 @@
 
 #include <memory>
 
-#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
-CapsInfoSerializer::CapsInfoSerializer() : GenericPayloadSerializer<CapsInfo>() {
+CapsInfoSerializer::CapsInfoSerializer() : GenericPayloadWriter<CapsInfo>() {
 }
 
-std::string CapsInfoSerializer::serializePayload(std::shared_ptr<CapsInfo> capsInfo)  const {
-    XMLElement capsElement("c", "http://jabber.org/protocol/caps");
-    capsElement.setAttribute("node", capsInfo->getNode());
-    capsElement.setAttribute("hash", capsInfo->getHash());
-    capsElement.setAttribute("ver", capsInfo->getVersion());
-    return capsElement.serialize();
+void CapsInfoSerializer::writePayload(std::shared_ptr<CapsInfo> capsInfo, XMLWriter& writer) const {
+    writer.startElement("c");
+    writer.addAttribute("hash", capsInfo->getHash());
+    writer.addAttribute("node", capsInfo->getNode());
+    writer.addAttribute("ver", capsInfo->getVersion());
+    writer.addAttribute("xmlns", "http://jabber.org/protocol/caps");
+    writer.endElement();
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,13 +8,13 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/ChatState.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API ChatStateSerializer : public GenericPayloadSerializer<ChatState> {
+    class SWIFTEN_API ChatStateSerializer : public GenericPayloadWriter<ChatState> {
         public:
             ChatStateSerializer();
 
-            virtual std::string serializePayload(std::shared_ptr<ChatState> error)  const;
+            virtual void writePayload(std::shared_ptr<ChatState>, XMLWriter&) const;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,20 +12,21 @@
 
 #include <Swiften/Base/DateTime.h>
 #include <Swiften/Base/String.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
-DelaySerializer::DelaySerializer() : GenericPayloadSerializer<Delay>() {
+DelaySerializer::DelaySerializer() : GenericPayloadWriter<Delay>() {
 }
 
-std::string DelaySerializer::serializePayload(std::shared_ptr<Delay> delay)  const {
-    XMLElement delayElement("delay", "urn:xmpp:delay");
+void DelaySerializer::writePayload(std::shared_ptr<Delay> delay, XMLWriter& writer) const {
+    writer.startElement("delay");
     if (delay->getFrom() && delay->getFrom()->isValid()) {
-        delayElement.setAttribute("from", delay->getFrom()->toString());
+        writer.addAttribute("from", delay->getFrom()->toString());
     }
-    delayElement.setAttribute("stamp", dateTimeToString(delay->getStamp()));
-    return delayElement.serialize();
+    writer.addAttribute("stamp", dateTimeToString(delay->getStamp()));
+    writer.addAttribute("xmlns", "urn:xmpp:delay");
+    writer.endElement();
 }
 
 }
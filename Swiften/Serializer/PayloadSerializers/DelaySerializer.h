@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,14 +8,14 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Delay.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API DelaySerializer : public GenericPayloadSerializer<Delay> {
+    class SWIFTEN_API DelaySerializer : public GenericPayloadWriter<Delay> {
         public:
             DelaySerializer();
 
-            virtual std::string serializePayload(std::shared_ptr<Delay>)  const;
+            virtual void writePayload(std::shared_ptr<Delay>, XMLWriter&) const;
     };
 }
 
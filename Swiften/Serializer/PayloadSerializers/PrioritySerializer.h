@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,15 +10,17 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Priority.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API PrioritySerializer : public GenericPayloadSerializer<Priority> {
+    class SWIFTEN_API PrioritySerializer : public GenericPayloadWriter<Priority> {
         public:
-            PrioritySerializer() : GenericPayloadSerializer<Priority>() {}
+            PrioritySerializer() : GenericPayloadWriter<Priority>() {}
 
-            virtual std::string serializePayload(std::shared_ptr<Priority> priority)  const {
-                return "<priority>" + boost::lexical_cast<std::string>(priority->getPriority()) + "</priority>";
+            virtual void writePayload(std::shared_ptr<Priority> priority, XMLWriter& writer) const {
+                writer.startElement("priority");
+                writer.addText(boost::lexical_cast<std::string>(priority->getPriority()));
+                writer.endElement();
             }
     };
 }
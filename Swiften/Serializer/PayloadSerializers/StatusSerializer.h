@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,19 +10,17 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Status.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API StatusSerializer : public GenericPayloadSerializer<Status> {
+    class SWIFTEN_API StatusSerializer : public GenericPayloadWriter<Status> {
         public:
-            StatusSerializer() : GenericPayloadSerializer<Status>() {}
+            StatusSerializer() : GenericPayloadWriter<Status>() {}
 
-            virtual std::string serializePayload(std::shared_ptr<Status> status)  const {
-                XMLElement element("status");
-                element.addNode(std::make_shared<XMLTextNode>(status->getText()));
-                return element.serialize();
+            virtual void writePayload(std::shared_ptr<Status> status, XMLWriter& writer) const {
+                writer.startElement("status");
+                writer.addText(status->getText());
+                writer.endElement();
             }
     };
 }
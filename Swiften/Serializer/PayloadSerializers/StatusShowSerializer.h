@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,30 +8,27 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/StatusShow.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API StatusShowSerializer : public GenericPayloadSerializer<StatusShow> {
+    class SWIFTEN_API StatusShowSerializer : public GenericPayloadWriter<StatusShow> {
         public:
-            StatusShowSerializer() : GenericPayloadSerializer<StatusShow>() {}
+            StatusShowSerializer() : GenericPayloadWriter<StatusShow>() {}
 
-            virtual std::string serializePayload(std::shared_ptr<StatusShow> statusShow)  const {
+            virtual void writePayload(std::shared_ptr<StatusShow> statusShow, XMLWriter& writer) const {
                 if (statusShow->getType () == StatusShow::Online || statusShow->getType() == StatusShow::None) {
-                    return "";
+                    return;
                 }
-                else {
-                    std::string result("<show>");
-                    switch (statusShow->getType()) {
-                        case StatusShow::Away: result += "away"; break;
-                        case StatusShow::XA: result += "xa"; break;
-                        case StatusShow::FFC: result += "chat"; break;
-                        case StatusShow::DND: result += "dnd"; break;
-                        case StatusShow::Online: assert(false); break;
-                        case StatusShow::None: assert(false); break;
-                    }
-                    result += "</show>";
-                    return result;
+                writer.startElement("show");
+                switch (statusShow->getType()) {
+                    case StatusShow::Away: writer.addText("away"); break;
+                    case StatusShow::XA: writer.addText("xa"); break;
+                    case StatusShow::FFC: writer.addText("chat"); break;
+                    case StatusShow::DND: writer.addText("dnd"); break;
+                    case StatusShow::Online: assert(false); break;
+                    case StatusShow::None: assert(false); break;
                 }
+                writer.endElement();
             }
     };
 }
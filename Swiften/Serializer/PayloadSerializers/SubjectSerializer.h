@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,17 +8,17 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/Subject.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API SubjectSerializer : public GenericPayloadSerializer<Subject> {
+    class SWIFTEN_API SubjectSerializer : public GenericPayloadWriter<Subject> {
         public:
-            SubjectSerializer() : GenericPayloadSerializer<Subject>() {}
+            SubjectSerializer() : GenericPayloadWriter<Subject>() {}
 
-            virtual std::string serializePayload(std::shared_ptr<Subject> subject)  const {
-                XMLTextNode textNode(subject->getText());
-                return "<subject>" + textNode.serialize() + "</subject>";
+            virtual void writePayload(std::shared_ptr<Subject> subject, XMLWriter& writer) const {
+                writer.startElement("subject");
+                writer.addText(subject->getText());
+                writer.endElement();
             }
     };
 }
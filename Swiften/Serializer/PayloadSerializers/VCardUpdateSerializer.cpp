@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,20 +8,20 @@
 
 #include <memory>
 
-#include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
-VCardUpdateSerializer::VCardUpdateSerializer() : GenericPayloadSerializer<VCardUpdate>() {
+VCardUpdateSerializer::VCardUpdateSerializer() : GenericPayloadWriter<VCardUpdate>() {
 }
 
-std::string VCardUpdateSerializer::serializePayload(std::shared_ptr<VCardUpdate> vcardUpdate)    const {
-    XMLElement updateElement("x", "vcard-temp:x:update");
-    std::shared_ptr<XMLElement> photoElement(new XMLElement("photo"));
-    photoElement->addNode(std::make_shared<XMLTextNode>(vcardUpdate->getPhotoHash()));
-    updateElement.addNode(photoElement);
-    return updateElement.serialize();
+void VCardUpdateSerializer::writePayload(std::shared_ptr<VCardUpdate> vcardUpdate, XMLWriter& writer) const {
+    writer.startElement("x");
+    writer.addAttribute("xmlns", "vcard-temp:x:update");
+    writer.startElement("photo");
+    writer.addText(vcardUpdate->getPhotoHash());
+    writer.endElement();
+    writer.endElement();
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,13 +8,13 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/VCardUpdate.h>
-#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/GenericPayloadWriter.h>
 
 namespace Swift {
-    class SWIFTEN_API VCardUpdateSerializer : public GenericPayloadSerializer<VCardUpdate> {
+    class SWIFTEN_API VCardUpdateSerializer : public GenericPayloadWriter<VCardUpdate> {
         public:
             VCardUpdateSerializer();
 
-            virtual std::string serializePayload(std::shared_ptr<VCardUpdate>)  const;
+            virtual void writePayload(std::shared_ptr<VCardUpdate>, XMLWriter&) const;
     };
 }
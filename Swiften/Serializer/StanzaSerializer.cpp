@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -15,7 +15,7 @@
 #include <Swiften/Serializer/PayloadSerializer.h>
 #include <Swiften/Serializer/PayloadSerializerCollection.h>
 #include <Swiften/Serializer/XML/XMLElement.h>
-#include <Swiften/Serializer/XML/XMLRawTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
@@ -32,36 +32,63 @@ SafeByteArray StanzaSerializer::serialize(std::shared_ptr<ToplevelElement> eleme
 }
 
 SafeByteArray StanzaSerializer::serialize(std::shared_ptr<ToplevelElement> element, const std::string& xmlns) const {
+    SafeByteArray result;
+    XMLWriter writer(result);
+    write(element, xmlns, writer);
+    return result;
+}
+
+void StanzaSerializer::setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement> element, XMLWriter& writer) const {
+    XMLElement stanzaElement(tag_);
+    setStanzaSpecificAttributes(element, stanzaElement);
+    for (const auto& attribute : stanzaElement.getAttributes()) {
+        writer.addAttribute(attribute.first, attribute.second);
+    }
+}
+
+void StanzaSerializer::setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement>, XMLElement&) const {
+}
+
+void StanzaSerializer::write(std::shared_ptr<ToplevelElement> element, XMLWriter& writer) const {
+    write(element, std::string(), writer);
+}
+
+void StanzaSerializer::write(std::shared_ptr<ToplevelElement> element, const std::string& xmlns, XMLWriter& writer) const {
     std::shared_ptr<Stanza> stanza(std::dynamic_pointer_cast<Stanza>(element));
 
-    XMLElement stanzaElement(tag_, explicitDefaultNS_ ? explicitDefaultNS_.get() : xmlns);
+    // Attributes are written in lexicographical order, as XMLElement does.
+    writer.startElement(tag_);
     if (stanza->getFrom().isValid()) {
-        stanzaElement.setAttribute("from", stanza->getFrom());
+        writer.addAttribute("from", stanza->getFrom().toString());
+    }
+    if (!stanza->getID().empty()) {
+        writer.addAttribute("id", stanza->getID());
     }
     if (stanza->getTo().isValid()) {
-        stanzaElement.setAttribute("to", stanza->getTo());
+        writer.addAttribute("to", stanza->getTo().toString());
     }
-    if (!stanza->getID().empty()) {
-        stanzaElement.setAttribute("id", stanza->getID());
+    setStanzaSpecificAttributes(stanza, writer);
+    const std::string& ns = explicitDefaultNS_ ? explicitDefaultNS_.get() : xmlns;
+    if (!ns.empty()) {
+        writer.addAttribute("xmlns", ns);
     }
-    setStanzaSpecificAttributes(stanza, stanzaElement);
 
-    std::string serializedPayloads;
+    SafeByteArray& buffer = writer.getBuffer();
+    size_t payloadsStart = buffer.size();
     for (const auto& payload : stanza->getPayloads()) {
         PayloadSerializer* serializer = payloadSerializers_->getPayloadSerializer(payload);
         if (serializer) {
-            serializedPayloads += serializer->serialize(payload);
+            serializer->write(payload, writer);
         }
         else {
             SWIFT_LOG(warning) << "Could not find serializer for " << typeid(*(payload.get())).name() << std::endl;
         }
     }
-    serializedPayloads = String::sanitizeXMPPString(serializedPayloads);
-    if (!serializedPayloads.empty()) {
-        stanzaElement.addNode(std::make_shared<XMLRawTextNode>(serializedPayloads));
+    if (buffer.size() > payloadsStart) {
+        size_t payloadsSize = String::sanitizeXMPPString(reinterpret_cast<char*>(&buffer[payloadsStart]), buffer.size() - payloadsStart);
+        buffer.resize(payloadsStart + payloadsSize);
     }
-
-    return createSafeByteArray(stanzaElement.serialize());
+    writer.endElement();
 }
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Isode Limited.
+ * Copyright (c) 2013-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -17,6 +17,7 @@
 namespace Swift {
     class PayloadSerializerCollection;
     class XMLElement;
+    class XMLWriter;
 
     class SWIFTEN_API StanzaSerializer : public ElementSerializer {
         public:
@@ -24,7 +25,24 @@ namespace Swift {
 
             virtual SafeByteArray serialize(std::shared_ptr<ToplevelElement> element) const;
             virtual SafeByteArray serialize(std::shared_ptr<ToplevelElement> element, const std::string& xmlns) const;
-            virtual void setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement>, XMLElement&) const = 0;
+            virtual void write(std::shared_ptr<ToplevelElement> element, XMLWriter& writer) const;
+            virtual void write(std::shared_ptr<ToplevelElement> element, const std::string& xmlns, XMLWriter& writer) const;
+
+            /**
+             * Adds the attributes specific to the stanza type to the stanza's
+             * start tag. This is called after the 'from', 'id' and 'to'
+             * attributes have been written, and before 'xmlns'.
+             *
+             * The default implementation collects the attributes set by
+             * the XMLElement based variant, for serializers that still
+             * implement that one.
+             */
+            virtual void setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement>, XMLWriter&) const;
+
+            /**
+             * Deprecated: implement the XMLWriter based variant instead.
+             */
+            virtual void setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement>, XMLElement&) const;
 
         private:
             std::string tag_;
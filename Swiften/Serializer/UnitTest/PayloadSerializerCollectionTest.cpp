@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Elements/Payload.h>
+#include <Swiften/Serializer/GenericPayloadSerializer.h>
+#include <Swiften/Serializer/PayloadSerializerCollection.h>
+
+using namespace Swift;
+
+class PayloadSerializerCollectionTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(PayloadSerializerCollectionTest);
+        CPPUNIT_TEST(testGetPayloadSerializer);
+        CPPUNIT_TEST(testGetPayloadSerializer_NoMatchingSerializer);
+        CPPUNIT_TEST(testGetPayloadSerializer_FirstMatchingSerializer);
+        CPPUNIT_TEST(testGetPayloadSerializer_CachesPerType);
+        CPPUNIT_TEST(testRemoveSerializer);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testGetPayloadSerializer() {
+            PayloadSerializerCollection testling;
+            DummySerializer<FooPayload> serializer1;
+            testling.addSerializer(&serializer1);
+            DummySerializer<BarPayload> serializer2;
+            testling.addSerializer(&serializer2);
+
+            CPPUNIT_ASSERT(&serializer1 == testling.getPayloadSerializer(std::make_shared<FooPayload>()));
+            CPPUNIT_ASSERT(&serializer2 == testling.getPayloadSerializer(std::make_shared<BarPayload>()));
+        }
+
+        void testGetPayloadSerializer_NoMatchingSerializer() {
+            PayloadSerializerCollection testling;
+            DummySerializer<FooPayload> serializer;
+            testling.addSerializer(&serializer);
+
+            CPPUNIT_ASSERT(!testling.getPayloadSerializer(std::make_shared<BarPayload>()));
+            CPPUNIT_ASSERT(!testling.getPayloadSerializer(std::shared_ptr<Payload>()));
+        }
+
+        void testGetPayloadSerializer_FirstMatchingSerializer() {
+            PayloadSerializerCollection testling;
+            DummySerializer<FooPayload> serializer1;
+            testling.addSerializer(&serializer1);
+            DummySerializer<DerivedFooPayload> serializer2;
+            testling.addSerializer(&serializer2);
+
+            CPPUNIT_ASSERT(&serializer1 == testling.getPayloadSerializer(std::make_shared<DerivedFooPayload>()));
+        }
+
+        void testGetPayloadSerializer_CachesPerType() {
+            PayloadSerializerCollection testling;
+            DummySerializer<FooPayload> serializer1;
+            testling.addSerializer(&serializer1);
+            DummySerializer<BarPayload> serializer2;
+            testling.addSerializer(&serializer2);
+
+            testling.getPayloadSerializer(std::make_shared<BarPayload>());
+            testling.getPayloadSerializer(std::make_shared<BarPayload>());
+
+            CPPUNIT_ASSERT_EQUAL(1, serializer1.canSerializeCalls);
+            CPPUNIT_ASSERT_EQUAL(1, serializer2.canSerializeCalls);
+        }
+
+        void testRemoveSerializer() {
+            PayloadSerializerCollection testling;
+            DummySerializer<FooPayload> serializer1;
+            testling.addSerializer(&serializer1);
+            DummySerializer<DerivedFooPayload> serializer2;
+            testling.addSerializer(&serializer2);
+            testling.getPayloadSerializer(std::make_shared<DerivedFooPayload>());
+
+            testling.removeSerializer(&serializer1);
+
+            CPPUNIT_ASSERT(&serializer2 == testling.getPayloadSerializer(std::make_shared<DerivedFooPayload>()));
+            CPPUNIT_ASSERT(!testling.getPayloadSerializer(std::make_shared<FooPayload>()));
+        }
+
+    private:
+        struct FooPayload : public Payload {
+        };
+
+        struct DerivedFooPayload : public FooPayload {
+        };
+
+        struct BarPayload : public Payload {
+        };
+
+        template<typename T>
+        struct DummySerializer : public GenericPayloadSerializer<T> {
+            DummySerializer() : canSerializeCalls(0) {}
+            virtual bool canSerialize(std::shared_ptr<Payload> payload) const {
+                canSerializeCalls++;
+                return GenericPayloadSerializer<T>::canSerialize(payload);
+            }
+            virtual std::string serializePayload(std::shared_ptr<T>) const { return ""; }
+            mutable int canSerializeCalls;
+        };
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PayloadSerializerCollectionTest);
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Elements/Message.h>
+#include <Swiften/Serializer/PayloadSerializerCollection.h>
+#include <Swiften/Serializer/StanzaSerializer.h>
+#include <Swiften/Serializer/XML/XMLElement.h>
+
+using namespace Swift;
+
+class StanzaSerializerTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(StanzaSerializerTest);
+        CPPUNIT_TEST(testSerialize_XMLElementAttributes);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testSerialize_XMLElementAttributes() {
+            PayloadSerializerCollection payloadSerializers;
+            XMLElementAttributesSerializer testling(&payloadSerializers);
+            std::shared_ptr<Message> message(new Message());
+            message->setFrom(JID("alice@wonderland.lit/rabbithole"));
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<message from=\"alice@wonderland.lit/rabbithole\" type=\"chat\" xmlns=\"jabber:client\"/>"), safeByteArrayToString(testling.serialize(message, "jabber:client")));
+        }
+
+    private:
+        /**
+         * A serializer that only implements the deprecated XMLElement
+         * variant of setStanzaSpecificAttributes.
+         */
+        class XMLElementAttributesSerializer : public StanzaSerializer {
+            public:
+                XMLElementAttributesSerializer(PayloadSerializerCollection* payloadSerializers) : StanzaSerializer("message", payloadSerializers) {
+                }
+
+                virtual bool canSerialize(std::shared_ptr<ToplevelElement> element) const {
+                    return dynamic_cast<Message*>(element.get()) != nullptr;
+                }
+
+                using StanzaSerializer::setStanzaSpecificAttributes;
+
+                virtual void setStanzaSpecificAttributes(std::shared_ptr<ToplevelElement>, XMLElement& element) const {
+                    element.setAttribute("type", "chat");
+                }
+        };
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StanzaSerializerTest);
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Serializer/XML/XMLElement.h>
+#include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+using namespace Swift;
+
+class XMLWriterTest : public CppUnit::TestFixture
+{
+        CPPUNIT_TEST_SUITE(XMLWriterTest);
+        CPPUNIT_TEST(testWrite);
+        CPPUNIT_TEST(testWrite_SameAsXMLElement);
+        CPPUNIT_TEST(testWrite_EmptyRaw);
+        CPPUNIT_TEST(testWrite_EmptyText);
+        CPPUNIT_TEST(testWrite_Appends);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testWrite() {
+            SafeByteArray buffer;
+            XMLWriter testling(buffer);
+
+            testling.startElement("foo");
+            testling.addAttribute("myatt", "<\"'&>");
+            testling.startElement("bar");
+            testling.addText("Bli&</stream>");
+            testling.endElement();
+            testling.startElement("baz");
+            testling.endElement();
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string(
+                "<foo myatt=\"&lt;&quot;&apos;&amp;&gt;\">"
+                    "<bar>Bli&amp;&lt;/stream&gt;</bar>"
+                    "<baz/>"
+                "</foo>"), safeByteArrayToString(buffer));
+        }
+
+        void testWrite_SameAsXMLElement() {
+            XMLElement element("foo", "http://example.com");
+            element.setAttribute("myatt", "a\"b");
+            std::shared_ptr<XMLElement> barElement(new XMLElement("bar"));
+            barElement->addNode(std::make_shared<XMLTextNode>("Blo<"));
+            element.addNode(barElement);
+
+            SafeByteArray buffer;
+            XMLWriter testling(buffer);
+            testling.startElement("foo");
+            testling.addAttribute("myatt", "a\"b");
+            testling.addAttribute("xmlns", "http://example.com");
+            testling.startElement("bar");
+            testling.addText("Blo<");
+            testling.endElement();
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(element.serialize(), safeByteArrayToString(buffer));
+        }
+
+        void testWrite_EmptyRaw() {
+            SafeByteArray buffer;
+            XMLWriter testling(buffer);
+
+            testling.startElement("foo");
+            testling.addRaw("");
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<foo/>"), safeByteArrayToString(buffer));
+        }
+
+        void testWrite_EmptyText() {
+            SafeByteArray buffer;
+            XMLWriter testling(buffer);
+
+            testling.startElement("foo");
+            testling.addText("");
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<foo></foo>"), safeByteArrayToString(buffer));
+        }
+
+        void testWrite_Appends() {
+            SafeByteArray buffer = createSafeByteArray("<a/>");
+            XMLWriter testling(buffer);
+
+            testling.startElement("b");
+            testling.addRaw("<c/>");
+            testling.endElement();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("<a/><b><c/></b>"), safeByteArrayToString(buffer));
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(XMLWriterTest);
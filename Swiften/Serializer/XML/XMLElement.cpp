@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #include <Swiften/Serializer/XML/XMLElement.h>
 
 #include <Swiften/Serializer/XML/XMLTextNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
@@ -21,32 +22,26 @@ XMLElement::XMLElement(const std::string& tag, const std::string& xmlns, const s
 
 std::string XMLElement::serialize() {
     std::string result;
-    result += "<" + tag_;
+    result.append("<").append(tag_);
     for (const auto& p : attributes_) {
-        result += " " + p.first + "=\"" + p.second + "\"";
+        result.append(" ").append(p.first).append("=\"").append(p.second).append("\"");
     }
 
     if (!childNodes_.empty()) {
-        result += ">";
+        result.append(">");
         for (auto& node : childNodes_) {
-            result += node->serialize();
+            result.append(node->serialize());
         }
-        result += "</" + tag_ + ">";
+        result.append("</").append(tag_).append(">");
     }
     else {
-        result += "/>";
+        result.append("/>");
     }
     return result;
 }
 
 void XMLElement::setAttribute(const std::string& attribute, const std::string& value) {
-    std::string escapedValue(value);
-    String::replaceAll(escapedValue, '&', "&amp;");
-    String::replaceAll(escapedValue, '<', "&lt;");
-    String::replaceAll(escapedValue, '>', "&gt;");
-    String::replaceAll(escapedValue, '\'', "&apos;");
-    String::replaceAll(escapedValue, '"', "&quot;");
-    attributes_[attribute] = escapedValue;
+    attributes_[attribute] = XMLWriter::escapeAttributeValue(value);
 }
 
 void XMLElement::addNode(std::shared_ptr<XMLNode> node) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -24,6 +24,10 @@ namespace Swift {
             void setAttribute(const std::string& attribute, const std::string& value);
             void addNode(std::shared_ptr<XMLNode> node);
 
+            const std::map<std::string, std::string>& getAttributes() const {
+                return attributes_;
+            }
+
             virtual std::string serialize();
 
         private:
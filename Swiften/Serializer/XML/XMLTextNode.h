@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,18 +9,15 @@
 #include <memory>
 
 #include <Swiften/Base/API.h>
-#include <Swiften/Base/String.h>
 #include <Swiften/Serializer/XML/XMLNode.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
     class SWIFTEN_API XMLTextNode : public XMLNode {
         public:
             typedef std::shared_ptr<XMLTextNode> ref;
 
-            XMLTextNode(const std::string& text) : text_(text) {
-                String::replaceAll(text_, '&', "&amp;"); // Should come first
-                String::replaceAll(text_, '<', "&lt;");
-                String::replaceAll(text_, '>', "&gt;");
+            XMLTextNode(const std::string& text) : text_(XMLWriter::escapeText(text)) {
             }
 
             std::string serialize() {
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Serializer/XML/XMLWriter.h>
+
+#include <cassert>
+#include <cstring>
+
+namespace Swift {
+
+template<typename Container>
+static void appendEscaped(Container& result, const std::string& s, bool escapeQuotes) {
+    const char* runStart = s.data();
+    const char* end = s.data() + s.size();
+    for (const char* i = runStart; i != end; ++i) {
+        const char* replacement = nullptr;
+        switch (*i) {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            case '\'': replacement = escapeQuotes ? "&apos;" : nullptr; break;
+            case '"': replacement = escapeQuotes ? "&quot;" : nullptr; break;
+            default: break;
+        }
+        if (replacement) {
+            result.insert(result.end(), runStart, i);
+            result.insert(result.end(), replacement, replacement + std::strlen(replacement));
+            runStart = i + 1;
+        }
+    }
+    result.insert(result.end(), runStart, end);
+}
+
+XMLWriter::XMLWriter(SafeByteArray& buffer) : buffer_(buffer), startTagOpen_(false) {
+}
+
+void XMLWriter::startElement(const std::string& tag) {
+    closeStartTag();
+    append("<", 1);
+    append(tag);
+    openElements_.push_back(tag);
+    startTagOpen_ = true;
+}
+
+void XMLWriter::addAttribute(const std::string& name, const std::string& value) {
+    assert(startTagOpen_);
+    append(" ", 1);
+    append(name);
+    append("=\"", 2);
+    appendEscaped(buffer_, value, true);
+    append("\"", 1);
+}
+
+void XMLWriter::addText(const std::string& text) {
+    closeStartTag();
+    appendEscaped(buffer_, text, false);
+}
+
+void XMLWriter::addRaw(const std::string& xml) {
+    if (!xml.empty()) {
+        closeStartTag();
+        append(xml);
+    }
+}
+
+void XMLWriter::endElement() {
+    assert(!openElements_.empty());
+    if (startTagOpen_) {
+        append("/>", 2);
+        startTagOpen_ = false;
+    }
+    else {
+        append("</", 2);
+        append(openElements_.back());
+        append(">", 1);
+    }
+    openElements_.pop_back();
+}
+
+void XMLWriter::closeStartTag() {
+    if (startTagOpen_) {
+        append(">", 1);
+        startTagOpen_ = false;
+    }
+}
+
+void XMLWriter::append(const char* data, size_t size) {
+    buffer_.insert(buffer_.end(), data, data + size);
+}
+
+std::string XMLWriter::escapeAttributeValue(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    appendEscaped(result, value, true);
+    return result;
+}
+
+std::string XMLWriter::escapeText(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+    appendEscaped(result, text, false);
+    return result;
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/SafeByteArray.h>
+
+namespace Swift {
+    /**
+     * Writes XML directly into an output buffer, escaping attribute values
+     * and text in a single pass.
+     *
+     * The output is the same as that of the equivalent XMLElement tree, as
+     * long as attributes are added in lexicographical order.
+     */
+    class SWIFTEN_API XMLWriter : public boost::noncopyable {
+        public:
+            XMLWriter(SafeByteArray& buffer);
+
+            void startElement(const std::string& tag);
+
+            /**
+             * Adds an attribute to the last started element. Needs to be called
+             * before any content is added to the element.
+             */
+            void addAttribute(const std::string& name, const std::string& value);
+
+            void addText(const std::string& text);
+
+            /**
+             * Appends already serialized XML. An empty string does not count as
+             * content, i.e. the element is still written as an empty-element tag.
+             */
+            void addRaw(const std::string& xml);
+
+            void endElement();
+
+            SafeByteArray& getBuffer() {
+                return buffer_;
+            }
+
+            static std::string escapeAttributeValue(const std::string& value);
+            static std::string escapeText(const std::string& text);
+
+        private:
+            void closeStartTag();
+            void append(const char* data, size_t size);
+            void append(const std::string& data) {
+                append(data.data(), data.size());
+            }
+
+        private:
+            SafeByteArray& buffer_;
+            std::vector<std::string> openElements_;
+            bool startTagOpen_;
+    };
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -36,6 +36,7 @@
 #include <Swiften/Serializer/StreamResumeSerializer.h>
 #include <Swiften/Serializer/StreamResumedSerializer.h>
 #include <Swiften/Serializer/TLSProceedSerializer.h>
+#include <Swiften/Serializer/XML/XMLWriter.h>
 
 namespace Swift {
 
@@ -84,13 +85,19 @@ std::string XMPPSerializer::serializeHeader(const ProtocolHeader& header) const
 }
 
 SafeByteArray XMPPSerializer::serializeElement(std::shared_ptr<ToplevelElement> element) const {
+    SafeByteArray result;
+    serializeElement(element, result);
+    return result;
+}
+
+void XMPPSerializer::serializeElement(std::shared_ptr<ToplevelElement> element, SafeByteArray& buffer) const {
     std::vector< std::shared_ptr<ElementSerializer> >::const_iterator i = std::find_if(serializers_.begin(), serializers_.end(), boost::bind(&ElementSerializer::canSerialize, _1, element));
     if (i != serializers_.end()) {
-        return (*i)->serialize(element);
+        XMLWriter writer(buffer);
+        (*i)->write(element, writer);
     }
     else {
         SWIFT_LOG(warning) << "Could not find serializer for " << typeid(*(element.get())).name() << std::endl;
-        return createSafeByteArray("");
     }
 }
 
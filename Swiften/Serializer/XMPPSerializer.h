@@ -25,6 +25,11 @@ namespace Swift {
 
             std::string serializeHeader(const ProtocolHeader&) const;
             SafeByteArray serializeElement(std::shared_ptr<ToplevelElement> stanza) const;
+
+            /**
+             * Appends the serialized element to the given buffer.
+             */
+            void serializeElement(std::shared_ptr<ToplevelElement> stanza, SafeByteArray& buffer) const;
             std::string serializeFooter() const;
 
         private:
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2016 Isode Limited.
+ * Copyright (c) 2011-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -158,6 +158,11 @@ void BOSHSessionStream::resetXMPPParser() {
     xmppLayer->resetParser();
 }
 
+void BOSHSessionStream::setMetrics(std::shared_ptr<StreamMetrics> metrics) {
+    SessionStream::setMetrics(metrics);
+    xmppLayer->setMetrics(metrics.get());
+}
+
 void BOSHSessionStream::handleStreamStartReceived(const ProtocolHeader& header) {
     onStreamStartReceived(header);
 }
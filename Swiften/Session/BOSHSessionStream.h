@@ -72,6 +72,12 @@ namespace Swift {
 
             virtual void resetXMPPParser();
 
+            /**
+             * Only the elements, parse time and serialization time are
+             * collected for BOSH streams.
+             */
+            virtual void setMetrics(std::shared_ptr<StreamMetrics> metrics);
+
         private:
             void handleXMPPError();
             void handleStreamStartReceived(const ProtocolHeader&);
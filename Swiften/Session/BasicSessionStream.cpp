@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -112,6 +112,7 @@ bool BasicSessionStream::supportsTLSEncryption() {
 void BasicSessionStream::addTLSEncryption() {
     assert(available);
     tlsLayer = new TLSLayer(tlsContextFactory, tlsOptions_);
+    tlsLayer->getContext()->setServerIdentity(getTLSServerIdentity());
     if (hasTLSCertificate() && !tlsLayer->setClientCertificate(getTLSCertificate())) {
         onClosed(std::make_shared<SessionStreamError>(SessionStreamError::InvalidTLSCertificateError));
     }
@@ -148,7 +149,7 @@ bool BasicSessionStream::supportsZLibCompression() {
 }
 
 void BasicSessionStream::addZLibCompression() {
-    compressionLayer = new CompressionLayer();
+    compressionLayer = new CompressionLayer(compressionOptions_);
     streamStack->addLayer(compressionLayer);
 }
 
@@ -169,6 +170,11 @@ void BasicSessionStream::resetXMPPParser() {
     xmppLayer->resetParser();
 }
 
+void BasicSessionStream::setMetrics(std::shared_ptr<StreamMetrics> metrics) {
+    SessionStream::setMetrics(metrics);
+    streamStack->setMetrics(metrics.get());
+}
+
 void BasicSessionStream::handleStreamStartReceived(const ProtocolHeader& header) {
     onStreamStartReceived(header);
 }
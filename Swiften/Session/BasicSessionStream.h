@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,6 +10,7 @@
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Compress/ZLibCompressor.h>
 #include <Swiften/Elements/StreamType.h>
 #include <Swiften/Network/Connection.h>
 #include <Swiften/Session/SessionStream.h>
@@ -54,6 +55,13 @@ namespace Swift {
             virtual bool supportsZLibCompression();
             virtual void addZLibCompression();
 
+            /**
+             * Sets the zlib parameters used by addZLibCompression().
+             */
+            void setCompressionOptions(const ZLibCompressor::Options& options) {
+                compressionOptions_ = options;
+            }
+
             virtual bool supportsTLSEncryption();
             virtual void addTLSEncryption();
             virtual bool isTLSEncrypted();
@@ -67,6 +75,8 @@ namespace Swift {
 
             virtual void resetXMPPParser();
 
+            virtual void setMetrics(std::shared_ptr<StreamMetrics> metrics);
+
         private:
             void handleConnectionFinished(const boost::optional<Connection::Error>& error);
             void handleXMPPError();
@@ -90,6 +100,7 @@ namespace Swift {
             WhitespacePingLayer* whitespacePingLayer;
             StreamStack* streamStack;
             TLSOptions tlsOptions_;
+            ZLibCompressor::Options compressionOptions_;
     };
 
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -25,10 +25,15 @@ Session::Session(
             xmppLayer(nullptr),
             connectionLayer(nullptr),
             streamStack(nullptr),
-            finishing(false) {
+            finishing(false),
+            writeQueueFull(false) {
+    connection->onWriteQueueFull.connect(boost::bind(&Session::handleWriteQueueFull, this));
+    connection->onWriteQueueDrained.connect(boost::bind(&Session::handleWriteQueueDrained, this));
 }
 
 Session::~Session() {
+    connection->onWriteQueueDrained.disconnect(boost::bind(&Session::handleWriteQueueDrained, this));
+    connection->onWriteQueueFull.disconnect(boost::bind(&Session::handleWriteQueueFull, this));
     delete streamStack;
     delete connectionLayer;
     delete xmppLayer;
@@ -66,6 +71,7 @@ void Session::initializeStreamStack() {
     xmppLayer->onStreamStart.connect(
             boost::bind(&Session::handleStreamStart, this, _1));
     xmppLayer->onElement.connect(boost::bind(&Session::handleElement, this, _1));
+    xmppLayer->onStreamEnd.connect(boost::bind(&Session::handleStreamEnd, this));
     xmppLayer->onError.connect(
             boost::bind(&Session::finishSession, this, XMLError));
     xmppLayer->onDataRead.connect(boost::bind(boost::ref(onDataRead), _1));
@@ -74,12 +80,29 @@ void Session::initializeStreamStack() {
             boost::bind(&Session::handleDisconnected, this, _1));
     connectionLayer = new ConnectionLayer(connection);
     streamStack = new StreamStack(xmppLayer, connectionLayer);
+    streamStack->setMetrics(streamMetrics.get());
+}
+
+void Session::setStreamMetrics(std::shared_ptr<StreamMetrics> metrics) {
+    streamMetrics = metrics;
+    if (streamStack) {
+        streamStack->setMetrics(metrics.get());
+    }
+}
+
+void Session::setWriteHighWatermark(size_t bytes) {
+    connection->setWriteHighWatermark(bytes);
 }
 
 void Session::sendElement(std::shared_ptr<ToplevelElement> stanza) {
     xmppLayer->writeElement(stanza);
 }
 
+void Session::handleStreamEnd() {
+    // Close our side of the stream too
+    finishSession();
+}
+
 void Session::handleDisconnected(const boost::optional<Connection::Error>& connectionError) {
     connection->onDisconnected.disconnect(
             boost::bind(&Session::handleDisconnected, this, _1));
@@ -102,4 +125,14 @@ void Session::handleDisconnected(const boost::optional<Connection::Error>& conne
     }
 }
 
+void Session::handleWriteQueueFull() {
+    writeQueueFull = true;
+    onWriteQueueFull();
+}
+
+void Session::handleWriteQueueDrained() {
+    writeQueueFull = false;
+    onWriteQueueDrained();
+}
+
 }
@@ -20,6 +20,7 @@
 
 namespace Swift {
     class ProtocolHeader;
+    class StreamMetrics;
     class StreamStack;
     class PayloadParserFactoryCollection;
     class PayloadSerializerCollection;
@@ -54,6 +55,24 @@ namespace Swift {
 
             void sendElement(std::shared_ptr<ToplevelElement>);
 
+            /**
+             * Sets the metrics to collect for this session's stream, or
+             * nullptr to stop collecting them.
+             */
+            void setStreamMetrics(std::shared_ptr<StreamMetrics> metrics);
+
+            /**
+             * Sets the number of written bytes that may be waiting to be sent
+             * on the connection before onWriteQueueFull is emitted, so that
+             * senders can hold back until onWriteQueueDrained. A value of 0
+             * (the default) disables this.
+             */
+            void setWriteHighWatermark(size_t bytes);
+
+            bool isWriteQueueFull() const {
+                return writeQueueFull;
+            }
+
             const JID& getLocalJID() const {
                 return localJID;
             }
@@ -66,6 +85,8 @@ namespace Swift {
             boost::signals2::signal<void (const boost::optional<SessionError>&)> onSessionFinished;
             boost::signals2::signal<void (const SafeByteArray&)> onDataWritten;
             boost::signals2::signal<void (const SafeByteArray&)> onDataRead;
+            boost::signals2::signal<void ()> onWriteQueueFull;
+            boost::signals2::signal<void ()> onWriteQueueDrained;
 
         protected:
             void setRemoteJID(const JID& j) {
@@ -96,7 +117,10 @@ namespace Swift {
             void setFinished();
 
         private:
+            void handleStreamEnd();
             void handleDisconnected(const boost::optional<Connection::Error>& error);
+            void handleWriteQueueFull();
+            void handleWriteQueueDrained();
 
         private:
             JID localJID;
@@ -108,6 +132,8 @@ namespace Swift {
             XMPPLayer* xmppLayer;
             ConnectionLayer* connectionLayer;
             StreamStack* streamStack;
+            std::shared_ptr<StreamMetrics> streamMetrics;
             bool finishing;
+            bool writeQueueFull;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include <boost/optional.hpp>
 #include <boost/signals2.hpp>
@@ -21,6 +22,8 @@
 #include <Swiften/TLS/CertificateWithKey.h>
 
 namespace Swift {
+    class StreamMetrics;
+
     class SWIFTEN_API SessionStream {
         public:
             class SWIFTEN_API SessionStreamError : public Swift::Error {
@@ -68,12 +71,32 @@ namespace Swift {
                 return certificate && !certificate->isNull();
             }
 
+            /**
+             * Sets the identity of the server, used to resume previous TLS
+             * sessions with it.
+             */
+            void setTLSServerIdentity(const std::string& identity) {
+                tlsServerIdentity = identity;
+            }
+
             virtual Certificate::ref getPeerCertificate() const = 0;
             virtual std::vector<Certificate::ref> getPeerCertificateChain() const = 0;
             virtual std::shared_ptr<CertificateVerificationError> getPeerCertificateVerificationError() const = 0;
 
             virtual ByteArray getTLSFinishMessage() const = 0;
 
+            /**
+             * Sets the metrics to collect for this stream, or nullptr to stop
+             * collecting them.
+             */
+            virtual void setMetrics(std::shared_ptr<StreamMetrics> metrics) {
+                this->metrics = metrics;
+            }
+
+            std::shared_ptr<StreamMetrics> getMetrics() const {
+                return metrics;
+            }
+
             boost::signals2::signal<void (const ProtocolHeader&)> onStreamStartReceived;
             boost::signals2::signal<void ()> onStreamEndReceived;
             boost::signals2::signal<void (std::shared_ptr<ToplevelElement>)> onElementReceived;
@@ -87,7 +110,13 @@ namespace Swift {
                 return certificate;
             }
 
+            const std::string& getTLSServerIdentity() const {
+                return tlsServerIdentity;
+            }
+
         private:
             CertificateWithKey::ref certificate;
+            std::string tlsServerIdentity;
+            std::shared_ptr<StreamMetrics> metrics;
     };
 }
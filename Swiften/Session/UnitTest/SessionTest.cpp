@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <boost/bind.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/Network/DummyConnection.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/Session/Session.h>
+
+using namespace Swift;
+
+class SessionTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SessionTest);
+        CPPUNIT_TEST(testStreamEnd);
+        CPPUNIT_TEST(testStreamEnd_AfterFinish);
+        CPPUNIT_TEST(testElement_KeepsStreamOpen);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            eventLoop = new DummyEventLoop();
+            connection = std::make_shared<DummyConnection>(eventLoop);
+            connection->onDataSent.connect(boost::bind(&SessionTest::handleDataSent, this, _1));
+            session = std::make_shared<TestSession>(connection, &payloadParserFactories, &payloadSerializers, &xmlParserFactory);
+            session->startSession();
+            receive("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' to='example.com' version='1.0'>");
+        }
+
+        void tearDown() {
+            session.reset();
+            connection.reset();
+            delete eventLoop;
+        }
+
+        void testStreamEnd() {
+            receive("</stream:stream>");
+
+            CPPUNIT_ASSERT_EQUAL(std::string("</stream:stream>"), written);
+        }
+
+        void testStreamEnd_AfterFinish() {
+            session->finishSession();
+            receive("</stream:stream>");
+
+            CPPUNIT_ASSERT_EQUAL(std::string("</stream:stream>"), written);
+        }
+
+        void testElement_KeepsStreamOpen() {
+            receive("<presence/>");
+
+            CPPUNIT_ASSERT_EQUAL(1, session->elementsReceived);
+            CPPUNIT_ASSERT_EQUAL(std::string(), written);
+        }
+
+    private:
+        class TestSession : public Session {
+            public:
+                TestSession(std::shared_ptr<Connection> connection, PayloadParserFactoryCollection* payloadParserFactories, PayloadSerializerCollection* payloadSerializers, XMLParserFactory* xmlParserFactory) : Session(connection, payloadParserFactories, payloadSerializers, xmlParserFactory), elementsReceived(0) {
+                }
+
+                virtual void handleElement(std::shared_ptr<ToplevelElement>) {
+                    ++elementsReceived;
+                }
+
+                virtual void handleStreamStart(const ProtocolHeader&) {
+                }
+
+                int elementsReceived;
+        };
+
+        void receive(const std::string& data) {
+            connection->receive(createSafeByteArray(data));
+            eventLoop->processEvents();
+        }
+
+        void handleDataSent(const SafeByteArray& data) {
+            written += byteArrayToString(ByteArray(data.begin(), data.end()));
+        }
+
+    private:
+        DummyEventLoop* eventLoop;
+        FullPayloadParserFactoryCollection payloadParserFactories;
+        FullPayloadSerializerCollection payloadSerializers;
+        PlatformXMLParserFactory xmlParserFactory;
+        std::shared_ptr<DummyConnection> connection;
+        std::shared_ptr<TestSession> session;
+        std::string written;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SessionTest);
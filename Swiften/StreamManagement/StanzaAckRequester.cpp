@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,7 +21,7 @@ StanzaAckRequester::StanzaAckRequester() : lastHandledStanzasCount(0) {
 
 void StanzaAckRequester::handleStanzaSent(std::shared_ptr<Stanza> stanza) {
     unackedStanzas.push_back(stanza);
-    if (std::dynamic_pointer_cast<Message>(stanza)) {
+    if (dynamic_cast<Message*>(stanza.get())) {
         onRequestAck();
     }
 }
@@ -1,11 +1,13 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <chrono>
+
 #include <boost/noncopyable.hpp>
 #include <boost/signals2.hpp>
 
@@ -15,6 +17,7 @@
 #include <Swiften/Compress/ZLibDecompressor.h>
 #include <Swiften/Compress/ZLibException.h>
 #include <Swiften/StreamStack/StreamLayer.h>
+#include <Swiften/StreamStack/StreamMetrics.h>
 
 namespace Swift {
     class ZLibCompressor;
@@ -22,31 +25,59 @@ namespace Swift {
 
     class SWIFTEN_API CompressionLayer : public StreamLayer, boost::noncopyable {
         public:
-            CompressionLayer() {}
+            CompressionLayer(const ZLibCompressor::Options& options = ZLibCompressor::Options()) : compressor_(options) {}
 
             virtual void writeData(const SafeByteArray& data) {
+                // The buffers are reused between calls, and taken out of the
+                // layer while in use, in case the next layer calls back.
+                SafeByteArray output;
+                output.swap(compressBuffer_);
                 try {
-                    writeDataToChildLayer(compressor_.process(data));
+                    process(compressor_, data, output);
                 }
                 catch (const ZLibException&) {
                     onError();
+                    return;
                 }
+                writeDataToChildLayer(output);
+                scrubSafeByteArray(output);
+                compressBuffer_.swap(output);
             }
 
             virtual void handleDataRead(const SafeByteArray& data) {
+                SafeByteArray output;
+                output.swap(decompressBuffer_);
                 try {
-                    writeDataToParentLayer(decompressor_.process(data));
+                    process(decompressor_, data, output);
                 }
                 catch (const ZLibException&) {
                     onError();
+                    return;
                 }
+                writeDataToParentLayer(output);
+                scrubSafeByteArray(output);
+                decompressBuffer_.swap(output);
             }
 
         public:
             boost::signals2::signal<void ()> onError;
 
+        private:
+            void process(ZLibCodecompressor& codecompressor, const SafeByteArray& data, SafeByteArray& output) {
+                StreamMetrics* metrics = getMetrics();
+                if (!metrics) {
+                    codecompressor.process(data, output);
+                    return;
+                }
+                auto start = std::chrono::steady_clock::now();
+                codecompressor.process(data, output);
+                metrics->getCompressionTime().add(StreamMetrics::getNanoseconds(std::chrono::steady_clock::now() - start));
+            }
+
         private:
             ZLibCompressor compressor_;
             ZLibDecompressor decompressor_;
+            SafeByteArray compressBuffer_;
+            SafeByteArray decompressBuffer_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,19 +8,39 @@
 
 #include <boost/bind.hpp>
 
+#include <Swiften/StreamStack/StreamMetrics.h>
+
 namespace Swift {
 
 ConnectionLayer::ConnectionLayer(std::shared_ptr<Connection> connection) : connection(connection) {
     connection->onDataRead.connect(boost::bind(&ConnectionLayer::handleDataRead, this, _1));
+    connection->onDataWritten.connect(boost::bind(&ConnectionLayer::handleDataWritten, this));
 }
 
 ConnectionLayer::~ConnectionLayer() {
     connection->onDataRead.disconnect(boost::bind(&ConnectionLayer::handleDataRead, this, _1));
+    connection->onDataWritten.disconnect(boost::bind(&ConnectionLayer::handleDataWritten, this));
+}
+
+void ConnectionLayer::writeData(const SafeByteArray& data) {
+    connection->write(data);
+    if (StreamMetrics* metrics = getMetrics()) {
+        metrics->addBytesWritten(data.size());
+        metrics->setWriteQueueBytes(connection->getQueuedWriteBytes());
+    }
 }
 
 void ConnectionLayer::handleDataRead(std::shared_ptr<SafeByteArray> data) {
+    if (StreamMetrics* metrics = getMetrics()) {
+        metrics->addBytesRead(data->size());
+    }
     writeDataToParentLayer(*data);
 }
 
+void ConnectionLayer::handleDataWritten() {
+    if (StreamMetrics* metrics = getMetrics()) {
+        metrics->setWriteQueueBytes(connection->getQueuedWriteBytes());
+    }
+}
 
 }
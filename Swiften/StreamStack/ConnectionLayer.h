@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -18,12 +18,11 @@ namespace Swift {
             ConnectionLayer(std::shared_ptr<Connection> connection);
             virtual ~ConnectionLayer();
 
-            void writeData(const SafeByteArray& data) {
-                connection->write(data);
-            }
+            void writeData(const SafeByteArray& data);
 
         private:
             void handleDataRead(std::shared_ptr<SafeByteArray>);
+            void handleDataWritten();
 
         private:
             std::shared_ptr<Connection> connection;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,7 +12,7 @@
 
 namespace Swift {
 
-LowLayer::LowLayer() : parentLayer(nullptr) {
+LowLayer::LowLayer() : parentLayer(nullptr), metrics(nullptr) {
 }
 
 LowLayer::~LowLayer() {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,6 +11,7 @@
 
 namespace Swift {
     class HighLayer;
+    class StreamMetrics;
 
     class SWIFTEN_API LowLayer {
             friend class StreamStack;
@@ -33,7 +34,20 @@ namespace Swift {
 
             void writeDataToParentLayer(const SafeByteArray& data);
 
+            /**
+             * Returns the metrics to update, or nullptr if the stream has
+             * none.
+             */
+            StreamMetrics* getMetrics() const {
+                return metrics;
+            }
+
+            void setMetrics(StreamMetrics* metrics) {
+                this->metrics = metrics;
+            }
+
         private:
             HighLayer* parentLayer;
+            StreamMetrics* metrics;
     };
 }
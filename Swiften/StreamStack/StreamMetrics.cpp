@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/StreamStack/StreamMetrics.h>
+
+#include <Swiften/Elements/IQ.h>
+#include <Swiften/Elements/Message.h>
+#include <Swiften/Elements/Presence.h>
+
+namespace Swift {
+
+StreamMetrics::StreamMetrics() {
+    reset();
+}
+
+StreamMetrics::ElementType StreamMetrics::getElementType(const ToplevelElement& element) {
+    if (dynamic_cast<const Message*>(&element)) {
+        return MessageElement;
+    }
+    if (dynamic_cast<const Presence*>(&element)) {
+        return PresenceElement;
+    }
+    if (dynamic_cast<const IQ*>(&element)) {
+        return IQElement;
+    }
+    return OtherElement;
+}
+
+void StreamMetrics::addElementReceived(const ToplevelElement& element) {
+    elementsReceived_[getElementType(element)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void StreamMetrics::addElementSent(const ToplevelElement& element) {
+    elementsSent_[getElementType(element)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void StreamMetrics::setWriteQueueBytes(size_t bytes) {
+    writeQueueBytes_.store(bytes, std::memory_order_relaxed);
+    if (bytes > maxWriteQueueBytes_.load(std::memory_order_relaxed)) {
+        // Only updated from the stream's thread, so no need for a CAS loop
+        maxWriteQueueBytes_.store(bytes, std::memory_order_relaxed);
+    }
+}
+
+StreamMetrics::Snapshot StreamMetrics::getSnapshot() const {
+    Snapshot snapshot;
+    snapshot.bytesRead = bytesRead_.load(std::memory_order_relaxed);
+    snapshot.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < ELEMENT_TYPES; ++i) {
+        snapshot.elementsReceived[i] = elementsReceived_[i].load(std::memory_order_relaxed);
+        snapshot.elementsSent[i] = elementsSent_[i].load(std::memory_order_relaxed);
+    }
+    snapshot.writeQueueBytes = writeQueueBytes_.load(std::memory_order_relaxed);
+    snapshot.maxWriteQueueBytes = maxWriteQueueBytes_.load(std::memory_order_relaxed);
+    snapshot.parseTime = parseTime_.getSnapshot();
+    snapshot.serializeTime = serializeTime_.getSnapshot();
+    snapshot.tlsTime = tlsTime_.getSnapshot();
+    snapshot.compressionTime = compressionTime_.getSnapshot();
+    return snapshot;
+}
+
+void StreamMetrics::reset() {
+    bytesRead_.store(0, std::memory_order_relaxed);
+    bytesWritten_.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < ELEMENT_TYPES; ++i) {
+        elementsReceived_[i].store(0, std::memory_order_relaxed);
+        elementsSent_[i].store(0, std::memory_order_relaxed);
+    }
+    writeQueueBytes_.store(0, std::memory_order_relaxed);
+    maxWriteQueueBytes_.store(0, std::memory_order_relaxed);
+    parseTime_.reset();
+    serializeTime_.reset();
+    tlsTime_.reset();
+    compressionTime_.reset();
+}
+
+}
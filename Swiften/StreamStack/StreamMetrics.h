@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/Histogram.h>
+
+namespace Swift {
+    class ToplevelElement;
+
+    /**
+     * Counters and timings of a single stream, filled in by the layers of
+     * the StreamStack it is set on.
+     *
+     * The layers update the metrics from the thread the stream runs on,
+     * but snapshots can be taken from any thread. Streams without metrics
+     * only pay for a null pointer check.
+     *
+     * All times are in nanoseconds, and only count the time spent in the
+     * layer itself, not in the layers above or below it.
+     */
+    class SWIFTEN_API StreamMetrics : boost::noncopyable {
+        public:
+            enum ElementType {
+                MessageElement,
+                PresenceElement,
+                IQElement,
+                OtherElement ///< Stream features, SASL, stream management, ...
+            };
+            static const size_t ELEMENT_TYPES = OtherElement + 1;
+
+            struct SWIFTEN_API Snapshot {
+                Snapshot() : bytesRead(0), bytesWritten(0), writeQueueBytes(0), maxWriteQueueBytes(0) {
+                    elementsReceived.fill(0);
+                    elementsSent.fill(0);
+                }
+
+                /// Bytes read from and written to the connection
+                std::uint64_t bytesRead;
+                std::uint64_t bytesWritten;
+
+                /// Indexed by ElementType
+                std::array<std::uint64_t, ELEMENT_TYPES> elementsReceived;
+                std::array<std::uint64_t, ELEMENT_TYPES> elementsSent;
+
+                /// Bytes written to the connection but not sent yet
+                std::uint64_t writeQueueBytes;
+                std::uint64_t maxWriteQueueBytes;
+
+                /// Time per parsed read, and per serialized element
+                Histogram::Snapshot parseTime;
+                Histogram::Snapshot serializeTime;
+
+                /// Time per TLS record read or written
+                Histogram::Snapshot tlsTime;
+
+                /// Time per compressed or decompressed chunk
+                Histogram::Snapshot compressionTime;
+            };
+
+        public:
+            StreamMetrics();
+
+            void addBytesRead(size_t bytes) {
+                bytesRead_.fetch_add(bytes, std::memory_order_relaxed);
+            }
+
+            void addBytesWritten(size_t bytes) {
+                bytesWritten_.fetch_add(bytes, std::memory_order_relaxed);
+            }
+
+            void addElementReceived(const ToplevelElement& element);
+            void addElementSent(const ToplevelElement& element);
+
+            void setWriteQueueBytes(size_t bytes);
+
+            Histogram& getParseTime() {
+                return parseTime_;
+            }
+
+            Histogram& getSerializeTime() {
+                return serializeTime_;
+            }
+
+            Histogram& getTLSTime() {
+                return tlsTime_;
+            }
+
+            Histogram& getCompressionTime() {
+                return compressionTime_;
+            }
+
+            Snapshot getSnapshot() const;
+
+            void reset();
+
+            static ElementType getElementType(const ToplevelElement& element);
+
+            static std::uint64_t getNanoseconds(std::chrono::steady_clock::duration duration) {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+            }
+
+        private:
+            std::atomic<std::uint64_t> bytesRead_;
+            std::atomic<std::uint64_t> bytesWritten_;
+            std::array<std::atomic<std::uint64_t>, ELEMENT_TYPES> elementsReceived_;
+            std::array<std::atomic<std::uint64_t>, ELEMENT_TYPES> elementsSent_;
+            std::atomic<std::uint64_t> writeQueueBytes_;
+            std::atomic<std::uint64_t> maxWriteQueueBytes_;
+            Histogram parseTime_;
+            Histogram serializeTime_;
+            Histogram tlsTime_;
+            Histogram compressionTime_;
+    };
+}
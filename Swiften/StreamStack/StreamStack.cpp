@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -14,7 +14,7 @@
 
 namespace Swift {
 
-StreamStack::StreamStack(XMPPLayer* xmppLayer, LowLayer* physicalLayer) : xmppLayer_(xmppLayer), physicalLayer_(physicalLayer) {
+StreamStack::StreamStack(XMPPLayer* xmppLayer, LowLayer* physicalLayer) : xmppLayer_(xmppLayer), physicalLayer_(physicalLayer), metrics_(nullptr) {
     physicalLayer_->setParentLayer(xmppLayer_);
     xmppLayer_->setChildLayer(physicalLayer_);
 }
@@ -32,6 +32,16 @@ void StreamStack::addLayer(StreamLayer* newLayer) {
     newLayer->setChildLayer(lowLayer);
 
     layers_.push_back(newLayer);
+    newLayer->setMetrics(metrics_);
+}
+
+void StreamStack::setMetrics(StreamMetrics* metrics) {
+    metrics_ = metrics;
+    xmppLayer_->setMetrics(metrics);
+    physicalLayer_->setMetrics(metrics);
+    for (auto layer : layers_) {
+        layer->setMetrics(metrics);
+    }
 }
 
 }
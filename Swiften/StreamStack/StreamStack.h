@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -18,6 +18,7 @@ namespace Swift {
     class XMPPLayer;
     class LowLayer;
     class StreamLayer;
+    class StreamMetrics;
 
     class SWIFTEN_API StreamStack {
         public:
@@ -26,6 +27,14 @@ namespace Swift {
 
             void addLayer(StreamLayer*);
 
+            /**
+             * Sets the metrics the layers of this stack update, including
+             * the layers added later. Passing nullptr disables them.
+             *
+             * The metrics need to outlive the stack, or be unset first.
+             */
+            void setMetrics(StreamMetrics* metrics);
+
             XMPPLayer* getXMPPLayer() const {
                 return xmppLayer_;
             }
@@ -44,5 +53,6 @@ namespace Swift {
             XMPPLayer* xmppLayer_;
             LowLayer* physicalLayer_;
             std::vector<StreamLayer*> layers_;
+            StreamMetrics* metrics_;
     };
 }
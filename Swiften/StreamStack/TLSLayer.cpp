@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,16 +8,20 @@
 
 #include <boost/bind.hpp>
 
+#include <Swiften/StreamStack/StreamMetrics.h>
+
 #include <Swiften/TLS/TLSContext.h>
 #include <Swiften/TLS/TLSContextFactory.h>
 
 namespace Swift {
 
-TLSLayer::TLSLayer(TLSContextFactory* factory, const TLSOptions& tlsOptions) {
-    context = factory->createTLSContext(tlsOptions);
-    context->onDataForNetwork.connect(boost::bind(&TLSLayer::writeDataToChildLayer, this, _1));
-    context->onDataForApplication.connect(boost::bind(&TLSLayer::writeDataToParentLayer, this, _1));
-    context->onConnected.connect(onConnected);
+TLSLayer::TLSLayer(TLSContextFactory* factory, const TLSOptions& tlsOptions, TLSContext::Mode mode) : TLSLayer(std::unique_ptr<TLSContext>(factory->createTLSContext(tlsOptions, mode))) {
+}
+
+TLSLayer::TLSLayer(std::unique_ptr<TLSContext> context) : context(context.release()), callbackTime_(std::chrono::steady_clock::duration::zero()) {
+    context->onDataForNetwork.connect(boost::bind(&TLSLayer::handleDataForNetwork, this, _1));
+    context->onDataForApplication.connect(boost::bind(&TLSLayer::handleDataForApplication, this, _1));
+    context->onConnected.connect(boost::bind(&TLSLayer::handleConnected, this));
     context->onError.connect(onError);
 }
 
@@ -29,12 +33,68 @@ void TLSLayer::connect() {
     context->connect();
 }
 
+void TLSLayer::accept() {
+    context->accept();
+}
+
 void TLSLayer::writeData(const SafeByteArray& data) {
+    StreamMetrics* metrics = getMetrics();
+    if (!metrics) {
+        context->handleDataFromApplication(data);
+        return;
+    }
+    // Writes can happen from within a callback of a read, so keep the
+    // callback time of the read separate.
+    auto outerCallbackTime = callbackTime_;
+    callbackTime_ = std::chrono::steady_clock::duration::zero();
+    auto start = std::chrono::steady_clock::now();
     context->handleDataFromApplication(data);
+    metrics->getTLSTime().add(StreamMetrics::getNanoseconds(std::chrono::steady_clock::now() - start - callbackTime_));
+    callbackTime_ = outerCallbackTime;
 }
 
 void TLSLayer::handleDataRead(const SafeByteArray& data) {
+    StreamMetrics* metrics = getMetrics();
+    if (!metrics) {
+        context->handleDataFromNetwork(data);
+        return;
+    }
+    auto outerCallbackTime = callbackTime_;
+    callbackTime_ = std::chrono::steady_clock::duration::zero();
+    auto start = std::chrono::steady_clock::now();
     context->handleDataFromNetwork(data);
+    metrics->getTLSTime().add(StreamMetrics::getNanoseconds(std::chrono::steady_clock::now() - start - callbackTime_));
+    callbackTime_ = outerCallbackTime;
+}
+
+void TLSLayer::handleDataForNetwork(const SafeByteArray& data) {
+    if (!getMetrics()) {
+        writeDataToChildLayer(data);
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    writeDataToChildLayer(data);
+    callbackTime_ += std::chrono::steady_clock::now() - start;
+}
+
+void TLSLayer::handleDataForApplication(const SafeByteArray& data) {
+    if (!getMetrics()) {
+        writeDataToParentLayer(data);
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    writeDataToParentLayer(data);
+    callbackTime_ += std::chrono::steady_clock::now() - start;
+}
+
+void TLSLayer::handleConnected() {
+    if (!getMetrics()) {
+        onConnected();
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    onConnected();
+    callbackTime_ += std::chrono::steady_clock::now() - start;
 }
 
 bool TLSLayer::setClientCertificate(CertificateWithKey::ref certificate) {
@@ -1,11 +1,14 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <chrono>
+#include <memory>
+
 #include <boost/signals2.hpp>
 
 #include <Swiften/Base/API.h>
@@ -14,19 +17,25 @@
 #include <Swiften/TLS/Certificate.h>
 #include <Swiften/TLS/CertificateVerificationError.h>
 #include <Swiften/TLS/CertificateWithKey.h>
+#include <Swiften/TLS/TLSContext.h>
 #include <Swiften/TLS/TLSError.h>
 #include <Swiften/TLS/TLSOptions.h>
 
 namespace Swift {
-    class TLSContext;
     class TLSContextFactory;
 
     class SWIFTEN_API TLSLayer : public StreamLayer {
         public:
-            TLSLayer(TLSContextFactory*, const TLSOptions&);
+            /**
+             * The factory needs to support the mode; use the constructor
+             * taking a context otherwise.
+             */
+            TLSLayer(TLSContextFactory*, const TLSOptions&, TLSContext::Mode mode = TLSContext::Mode::Client);
+            TLSLayer(std::unique_ptr<TLSContext> context);
             virtual ~TLSLayer();
 
             void connect();
+            void accept();
             bool setClientCertificate(CertificateWithKey::ref cert);
 
             Certificate::ref getPeerCertificate() const;
@@ -44,7 +53,15 @@ namespace Swift {
             boost::signals2::signal<void (std::shared_ptr<TLSError>)> onError;
             boost::signals2::signal<void ()> onConnected;
 
+        private:
+            void handleDataForNetwork(const SafeByteArray& data);
+            void handleDataForApplication(const SafeByteArray& data);
+            void handleConnected();
+
         private:
             TLSContext* context;
+            // Time spent in the layers above and below while the context
+            // processes data, which does not count as TLS time
+            std::chrono::steady_clock::duration callbackTime_;
     };
 }
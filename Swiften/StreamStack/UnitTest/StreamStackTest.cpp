@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,6 +21,7 @@
 #include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
 #include <Swiften/StreamStack/LowLayer.h>
 #include <Swiften/StreamStack/StreamLayer.h>
+#include <Swiften/StreamStack/StreamMetrics.h>
 #include <Swiften/StreamStack/StreamStack.h>
 #include <Swiften/StreamStack/XMPPLayer.h>
 
@@ -35,6 +36,8 @@ class StreamStackTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testReadData_OneIntermediateStream);
         CPPUNIT_TEST(testReadData_TwoIntermediateStreamStack);
         CPPUNIT_TEST(testAddLayer_ExistingOnWriteDataSlot);
+        CPPUNIT_TEST(testSetMetrics);
+        CPPUNIT_TEST(testSetMetrics_LayerAddedLater);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -127,6 +130,32 @@ class StreamStackTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(1, dataWriteReceived_);
         }
 
+        void testSetMetrics() {
+            StreamStack testling(xmppStream_, physicalStream_);
+            std::shared_ptr<MyStreamLayer> xStream(new MyStreamLayer("X"));
+            testling.addLayer(xStream.get());
+            StreamMetrics metrics;
+
+            testling.setMetrics(&metrics);
+            CPPUNIT_ASSERT_EQUAL(&metrics, physicalStream_->getMetrics());
+            CPPUNIT_ASSERT_EQUAL(&metrics, xStream->getMetrics());
+
+            testling.setMetrics(nullptr);
+            CPPUNIT_ASSERT(!physicalStream_->getMetrics());
+            CPPUNIT_ASSERT(!xStream->getMetrics());
+        }
+
+        void testSetMetrics_LayerAddedLater() {
+            StreamStack testling(xmppStream_, physicalStream_);
+            StreamMetrics metrics;
+            testling.setMetrics(&metrics);
+
+            std::shared_ptr<MyStreamLayer> xStream(new MyStreamLayer("X"));
+            testling.addLayer(xStream.get());
+
+            CPPUNIT_ASSERT_EQUAL(&metrics, xStream->getMetrics());
+        }
+
         void handleElement(std::shared_ptr<ToplevelElement>) {
             ++elementsReceived_;
         }
@@ -149,6 +178,8 @@ class StreamStackTest : public CppUnit::TestFixture {
                     writeDataToParentLayer(concat(createSafeByteArray(prepend_), data));
                 }
 
+                using LowLayer::getMetrics;
+
             private:
                 std::string prepend_;
         };
@@ -166,6 +197,8 @@ class StreamStackTest : public CppUnit::TestFixture {
                     writeDataToParentLayer(data);
                 }
 
+                using LowLayer::getMetrics;
+
                 std::vector<SafeByteArray> data_;
         };
 
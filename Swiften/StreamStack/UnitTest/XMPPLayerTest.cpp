@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -12,12 +12,16 @@
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
 #include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/sleep.h>
+#include <Swiften/Elements/IQ.h>
+#include <Swiften/Elements/Message.h>
 #include <Swiften/Elements/Presence.h>
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
 #include <Swiften/Parser/PlatformXMLParserFactory.h>
 #include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
 #include <Swiften/StreamStack/LowLayer.h>
+#include <Swiften/StreamStack/StreamMetrics.h>
 #include <Swiften/StreamStack/XMPPLayer.h>
 
 using namespace Swift;
@@ -30,6 +34,10 @@ class XMPPLayerTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testWriteHeader);
         CPPUNIT_TEST(testWriteElement);
         CPPUNIT_TEST(testWriteFooter);
+        CPPUNIT_TEST(testMetrics_ElementsReceived);
+        CPPUNIT_TEST(testMetrics_ElementsSent);
+        CPPUNIT_TEST(testMetrics_ParseTimeExcludesHandlers);
+        CPPUNIT_TEST(testMetrics_Disabled);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -96,10 +104,69 @@ class XMPPLayerTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("</stream:stream>"), lowLayer_->writtenData);
         }
 
+        void testMetrics_ElementsReceived() {
+            StreamMetrics metrics;
+            testling_->setMetrics(&metrics);
+
+            testling_->handleDataRead(createSafeByteArray("<stream:stream to=\"example.com\" xmlns=\"jabber:client\" xmlns:stream=\"http://etherx.jabber.org/streams\" ><presence/><message/>"));
+            testling_->handleDataRead(createSafeByteArray("<message/><iq type=\"get\" id=\"1\"/><stream:features/>"));
+
+            StreamMetrics::Snapshot snapshot = metrics.getSnapshot();
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), snapshot.elementsReceived[StreamMetrics::MessageElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1), snapshot.elementsReceived[StreamMetrics::PresenceElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1), snapshot.elementsReceived[StreamMetrics::IQElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1), snapshot.elementsReceived[StreamMetrics::OtherElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), snapshot.parseTime.count);
+        }
+
+        void testMetrics_ElementsSent() {
+            StreamMetrics metrics;
+            testling_->setMetrics(&metrics);
+
+            testling_->writeElement(std::make_shared<Presence>());
+            testling_->writeElement(std::make_shared<Message>());
+
+            StreamMetrics::Snapshot snapshot = metrics.getSnapshot();
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1), snapshot.elementsSent[StreamMetrics::PresenceElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(1), snapshot.elementsSent[StreamMetrics::MessageElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), snapshot.elementsSent[StreamMetrics::IQElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(2), snapshot.serializeTime.count);
+        }
+
+        void testMetrics_ParseTimeExcludesHandlers() {
+            StreamMetrics metrics;
+            testling_->setMetrics(&metrics);
+            testling_->onElement.connect(boost::bind(&XMPPLayerTest::handleElementSlowly, this, _1));
+
+            testling_->handleDataRead(createSafeByteArray("<stream:stream to=\"example.com\" xmlns=\"jabber:client\" xmlns:stream=\"http://etherx.jabber.org/streams\" ><presence/>"));
+
+            CPPUNIT_ASSERT_EQUAL(1, elementsReceived_);
+            CPPUNIT_ASSERT(metrics.getSnapshot().parseTime.max < 50 * 1000 * 1000);
+        }
+
+        void testMetrics_Disabled() {
+            StreamMetrics metrics;
+            testling_->setMetrics(&metrics);
+            testling_->setMetrics(nullptr);
+
+            testling_->handleDataRead(createSafeByteArray("<stream:stream to=\"example.com\" xmlns=\"jabber:client\" xmlns:stream=\"http://etherx.jabber.org/streams\" ><presence/>"));
+            testling_->writeElement(std::make_shared<Presence>());
+
+            StreamMetrics::Snapshot snapshot = metrics.getSnapshot();
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), snapshot.elementsReceived[StreamMetrics::PresenceElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), snapshot.elementsSent[StreamMetrics::PresenceElement]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<std::uint64_t>(0), snapshot.parseTime.count);
+        }
+
         void handleElement(std::shared_ptr<ToplevelElement>) {
             ++elementsReceived_;
         }
 
+        void handleElementSlowly(std::shared_ptr<ToplevelElement>) {
+            ++elementsReceived_;
+            Swift::sleep(50);
+        }
+
         void handleElementAndReset(std::shared_ptr<ToplevelElement>) {
             ++elementsReceived_;
             testling_->resetParser();
@@ -1,14 +1,17 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/StreamStack/XMPPLayer.h>
 
+#include <algorithm>
+
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Parser/XMPPParser.h>
 #include <Swiften/Serializer/XMPPSerializer.h>
+#include <Swiften/StreamStack/StreamMetrics.h>
 
 namespace Swift {
 
@@ -23,7 +26,9 @@ XMPPLayer::XMPPLayer(
             xmlParserFactory_(xmlParserFactory),
             setExplictNSonTopLevelElements_(setExplictNSonTopLevelElements),
             resetParserAfterParse_(false),
-            inParser_(false) {
+            inParser_(false),
+            writeBufferInUse_(false),
+            metrics_(nullptr) {
     xmppParser_ = new XMPPParser(this, payloadParserFactories_, xmlParserFactory);
     xmppSerializer_ = new XMPPSerializer(payloadSerializers_, streamType, setExplictNSonTopLevelElements);
 }
@@ -42,7 +47,28 @@ void XMPPLayer::writeFooter() {
 }
 
 void XMPPLayer::writeElement(std::shared_ptr<ToplevelElement> element) {
-    writeDataInternal(xmppSerializer_->serializeElement(element));
+    if (metrics_) {
+        metrics_->addElementSent(*element);
+    }
+    if (writeBufferInUse_) {
+        // Written from within a write handler; don't clobber the buffer being written.
+        writeDataInternal(xmppSerializer_->serializeElement(element));
+        return;
+    }
+    writeBufferInUse_ = true;
+    if (metrics_) {
+        auto start = std::chrono::steady_clock::now();
+        xmppSerializer_->serializeElement(element, writeBuffer_);
+        metrics_->getSerializeTime().add(StreamMetrics::getNanoseconds(std::chrono::steady_clock::now() - start));
+    }
+    else {
+        xmppSerializer_->serializeElement(element, writeBuffer_);
+    }
+    writeDataInternal(writeBuffer_);
+    // Keep the capacity for the next element, but not the (possibly sensitive) data
+    std::fill(writeBuffer_.begin(), writeBuffer_.end(), 0);
+    writeBuffer_.clear();
+    writeBufferInUse_ = false;
 }
 
 void XMPPLayer::writeData(const std::string& data) {
@@ -56,16 +82,22 @@ void XMPPLayer::writeDataInternal(const SafeByteArray& data) {
 
 void XMPPLayer::handleDataRead(const SafeByteArray& data) {
     onDataRead(data);
+    StreamMetrics* metrics = metrics_;
+    std::chrono::steady_clock::time_point start;
+    if (metrics) {
+        handlerTime_ = std::chrono::steady_clock::duration::zero();
+        start = std::chrono::steady_clock::now();
+    }
     inParser_ = true;
-    // FIXME: Converting to unsafe string. Should be ok, since we don't take passwords
-    // from the stream in clients. If servers start using this, and require safe storage,
-    // we need to fix this.
-    if (!xmppParser_->parse(byteArrayToString(ByteArray(data.begin(), data.end())))) {
-        inParser_ = false;
+    bool parsed = xmppParser_->parse(reinterpret_cast<const char*>(vecptr(data)), data.size());
+    inParser_ = false;
+    if (metrics) {
+        metrics->getParseTime().add(StreamMetrics::getNanoseconds(std::chrono::steady_clock::now() - start - handlerTime_));
+    }
+    if (!parsed) {
         onError();
         return;
     }
-    inParser_ = false;
     if (resetParserAfterParse_) {
         doResetParser();
     }
@@ -78,11 +110,26 @@ void XMPPLayer::doResetParser() {
 }
 
 void XMPPLayer::handleStreamStart(const ProtocolHeader& header) {
-    onStreamStart(header);
+    if (metrics_) {
+        auto start = std::chrono::steady_clock::now();
+        onStreamStart(header);
+        handlerTime_ += std::chrono::steady_clock::now() - start;
+    }
+    else {
+        onStreamStart(header);
+    }
 }
 
 void XMPPLayer::handleElement(std::shared_ptr<ToplevelElement> stanza) {
-    onElement(stanza);
+    if (metrics_) {
+        metrics_->addElementReceived(*stanza);
+        auto start = std::chrono::steady_clock::now();
+        onElement(stanza);
+        handlerTime_ += std::chrono::steady_clock::now() - start;
+    }
+    else {
+        onElement(stanza);
+    }
 }
 
 void XMPPLayer::handleStreamEnd() {
@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include <boost/noncopyable.hpp>
@@ -26,6 +27,7 @@ namespace Swift {
     class PayloadSerializerCollection;
     class XMLParserFactory;
     class BOSHSessionStream;
+    class StreamMetrics;
 
     class SWIFTEN_API XMPPLayer : public XMPPParserClient, public HighLayer, boost::noncopyable {
         friend class BOSHSessionStream;
@@ -45,6 +47,14 @@ namespace Swift {
 
             void resetParser();
 
+            /**
+             * Sets the metrics to count elements and parse and serialization
+             * time in, or nullptr to disable them.
+             */
+            void setMetrics(StreamMetrics* metrics) {
+                metrics_ = metrics;
+            }
+
         protected:
             void handleDataRead(const SafeByteArray& data);
             void writeDataInternal(const SafeByteArray& data);
@@ -73,5 +83,11 @@ namespace Swift {
             bool setExplictNSonTopLevelElements_;
             bool resetParserAfterParse_;
             bool inParser_;
+            SafeByteArray writeBuffer_;
+            bool writeBufferInUse_;
+            StreamMetrics* metrics_;
+            // Time spent in the handlers of parsed elements, which does not
+            // count as parse time
+            std::chrono::steady_clock::duration handlerTime_;
     };
 }
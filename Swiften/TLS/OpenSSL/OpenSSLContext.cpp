@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -10,8 +10,10 @@
 #include <wincrypt.h>
 #endif
 
+#include <algorithm>
 #include <vector>
 #include <openssl/err.h>
+#include <openssl/pem.h>
 #include <openssl/pkcs12.h>
 #include <memory>
 
@@ -21,7 +23,9 @@
 
 #include <Swiften/TLS/OpenSSL/OpenSSLContext.h>
 #include <Swiften/TLS/OpenSSL/OpenSSLCertificate.h>
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
 #include <Swiften/TLS/CertificateWithKey.h>
+#include <Swiften/TLS/PEMCertificate.h>
 #include <Swiften/TLS/PKCS12Certificate.h>
 
 #pragma GCC diagnostic ignored "-Wold-style-cast"
@@ -33,16 +37,27 @@
 namespace Swift {
 
 static const int MAX_FINISHED_SIZE = 4096;
-static const int SSL_READ_BUFFERSIZE = 8192;
+// The maximum amount of plaintext in one TLS record
+static const int SSL_READ_BUFFERSIZE = 16384;
 
 static void freeX509Stack(STACK_OF(X509)* stack) {
     sk_X509_free(stack);
 }
 
-OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readBIO_(0), writeBIO_(0) {
+OpenSSLContext::OpenSSLContext() : OpenSSLContext(createSSLContext(), std::shared_ptr<OpenSSLSessionCache>()) {
+}
+
+OpenSSLContext::OpenSSLContext(std::shared_ptr<SSL_CTX> context, std::shared_ptr<OpenSSLSessionCache> sessionCache) : state_(Start), context_(context), sessionCache_(sessionCache), handle_(0), readBIO_(0), writeBIO_(0) {
+}
+
+std::shared_ptr<SSL_CTX> OpenSSLContext::createSSLContext() {
     ensureLibraryInitialized();
-    context_ = SSL_CTX_new(SSLv23_client_method());
-    SSL_CTX_set_options(context_, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+    std::shared_ptr<SSL_CTX> context(SSL_CTX_new(SSLv23_client_method()), SSL_CTX_free);
+    SSL_CTX_set_options(context.get(), SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+
+    // Sessions are kept per server identity by OpenSSLSessionCache
+    SSL_CTX_set_session_cache_mode(context.get(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context.get(), &OpenSSLContext::handleNewSession);
 
     // TODO: implement CRL checking
     // TODO: download CRL (HTTP transport)
@@ -52,7 +67,7 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
     // TODO: handle OCSP stapling see https://www.rfc-editor.org/rfc/rfc4366.txt
     // Load system certs
 #if defined(SWIFTEN_PLATFORM_WINDOWS)
-    X509_STORE* store = SSL_CTX_get_cert_store(context_);
+    X509_STORE* store = SSL_CTX_get_cert_store(context.get());
     HCERTSTORE systemStore = CertOpenSystemStore(0, "ROOT");
     if (systemStore) {
         PCCERT_CONTEXT certContext = NULL;
@@ -68,7 +83,7 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
         }
     }
 #elif !defined(SWIFTEN_PLATFORM_MACOSX)
-    SSL_CTX_set_default_verify_paths(context_);
+    SSL_CTX_set_default_verify_paths(context.get());
 #elif defined(SWIFTEN_PLATFORM_MACOSX) && !defined(SWIFTEN_PLATFORM_IPHONE)
     // On Mac OS X 10.5 (OpenSSL < 0.9.8), OpenSSL does not automatically look in the system store.
     // On Mac OS X 10.6 (OpenSSL >= 0.9.8), OpenSSL *does* look in the system store to determine trust.
@@ -76,7 +91,7 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
     // the certificates first. See
     //        http://opensource.apple.com/source/OpenSSL098/OpenSSL098-27/src/crypto/x509/x509_vfy_apple.c
     // to understand why. We therefore add all certs from the system store ourselves.
-    X509_STORE* store = SSL_CTX_get_cert_store(context_);
+    X509_STORE* store = SSL_CTX_get_cert_store(context.get());
     CFArrayRef anchorCertificates;
     if (SecTrustCopyAnchorCertificates(&anchorCertificates) == 0) {
         for (int i = 0; i < CFArrayGetCount(anchorCertificates); ++i) {
@@ -96,11 +111,48 @@ OpenSSLContext::OpenSSLContext() : state_(Start), context_(0), handle_(0), readB
         CFRelease(anchorCertificates);
     }
 #endif
+    return context;
+}
+
+std::shared_ptr<SSL_CTX> OpenSSLContext::createServerSSLContext() {
+    ensureLibraryInitialized();
+    std::shared_ptr<SSL_CTX> context(SSL_CTX_new(SSLv23_server_method()), SSL_CTX_free);
+    SSL_CTX_set_options(context.get(), SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+
+    // Session tickets are enabled by default, and encrypted with keys
+    // belonging to the SSL_CTX, so they are valid for all contexts sharing it.
+    static const unsigned char sessionIDContext[] = "Swiften";
+    SSL_CTX_set_session_id_context(context.get(), sessionIDContext, sizeof(sessionIDContext) - 1);
+    SSL_CTX_set_session_cache_mode(context.get(), SSL_SESS_CACHE_SERVER);
+    return context;
+}
+
+bool OpenSSLContext::setCertificate(SSL_CTX* context, CertificateWithKey::ref certificate) {
+    std::shared_ptr<X509> x509;
+    std::shared_ptr<EVP_PKEY> privateKey;
+    std::vector<std::shared_ptr<X509> > chain;
+    if (!loadCertificate(certificate, x509, privateKey, chain)) {
+        return false;
+    }
+    if (SSL_CTX_use_certificate(context, x509.get()) != 1 || SSL_CTX_use_PrivateKey(context, privateKey.get()) != 1) {
+        return false;
+    }
+    for (const auto& chainCertificate : chain) {
+        if (SSL_CTX_add1_chain_cert(context, chainCertificate.get()) != 1) {
+            return false;
+        }
+    }
+    return true;
 }
 
 OpenSSLContext::~OpenSSLContext() {
+    if (handle_ && state_ == Connected) {
+        // The XMPP stream is closed without a TLS close_notify, which OpenSSL
+        // would take as a truncated connection, and refuse to resume its
+        // session afterwards.
+        SSL_set_shutdown(handle_, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
     SSL_free(handle_);
-    SSL_CTX_free(context_);
 }
 
 void OpenSSLContext::ensureLibraryInitialized() {
@@ -119,33 +171,84 @@ void OpenSSLContext::ensureLibraryInitialized() {
     }
 }
 
-void OpenSSLContext::connect() {
-    handle_ = SSL_new(context_);
+bool OpenSSLContext::createHandle() {
+    handle_ = SSL_new(context_.get());
     if (handle_ == nullptr) {
         state_ = Error;
         onError(std::make_shared<TLSError>());
-        return;
+        return false;
     }
+    SSL_set_app_data(handle_, this);
 
-    // Ownership of BIOs is ransferred
+    // Ownership of BIOs is transferred
     readBIO_ = BIO_new(BIO_s_mem());
     writeBIO_ = BIO_new(BIO_s_mem());
     SSL_set_bio(handle_, readBIO_, writeBIO_);
+    return true;
+}
+
+void OpenSSLContext::connect() {
+    if (!createHandle()) {
+        return;
+    }
+    SSL_set_connect_state(handle_);
+
+    if (clientCertificate_) {
+        bool certificateUsed = SSL_use_certificate(handle_, clientCertificate_.get()) == 1 && SSL_use_PrivateKey(handle_, clientPrivateKey_.get()) == 1;
+        for (const auto& certificate : clientCertificateChain_) {
+            certificateUsed = certificateUsed && SSL_add1_chain_cert(handle_, certificate.get()) == 1;
+        }
+        if (!certificateUsed) {
+            state_ = Error;
+            onError(std::make_shared<TLSError>());
+            return;
+        }
+    }
+
+    if (canResumeSessions()) {
+        std::shared_ptr<SSL_SESSION> session = sessionCache_->getSession(serverIdentity_);
+        if (session) {
+            SSL_set_session(handle_, session.get());
+        }
+    }
+
+    state_ = Connecting;
+    doHandshake();
+}
+
+void OpenSSLContext::accept() {
+    if (!createHandle()) {
+        return;
+    }
+    SSL_set_accept_state(handle_);
 
+    // Wait for the client to start the handshake
     state_ = Connecting;
-    doConnect();
 }
 
-void OpenSSLContext::doConnect() {
-    int connectResult = SSL_connect(handle_);
-    int error = SSL_get_error(handle_, connectResult);
+void OpenSSLContext::doHandshake() {
+    int handshakeResult = SSL_do_handshake(handle_);
+    int error = SSL_get_error(handle_, handshakeResult);
     switch (error) {
         case SSL_ERROR_NONE: {
             state_ = Connected;
+            if (sessionCache_) {
+                sessionCache_->addHandshake(SSL_session_reused(handle_) == 1);
+            }
             //std::cout << x->name << std::endl;
             //const char* comp = SSL_get_current_compression(handle_);
             //std::cout << "Compression: " << SSL_COMP_get_name(comp) << std::endl;
+
+            // Send the last handshake message (e.g. the server's Finished in
+            // TLS 1.2, or the session tickets in TLS 1.3)
+            sendPendingDataToNetwork();
             onConnected();
+
+            // The peer can send application data right after its last
+            // handshake message
+            if (state_ == Connected) {
+                sendPendingDataToApplication();
+            }
             break;
         }
         case SSL_ERROR_WANT_READ:
@@ -153,17 +256,46 @@ void OpenSSLContext::doConnect() {
             break;
         default:
             state_ = Error;
+            if (canResumeSessions()) {
+                sessionCache_->removeSession(serverIdentity_);
+            }
             onError(std::make_shared<TLSError>());
     }
 }
 
+int OpenSSLContext::handleNewSession(SSL* handle, SSL_SESSION* session) {
+    OpenSSLContext* context = static_cast<OpenSSLContext*>(SSL_get_app_data(handle));
+    if (context && context->canResumeSessions()) {
+        // Returning 1 passes our reference to the session on to the cache
+        context->sessionCache_->setSession(context->serverIdentity_, std::shared_ptr<SSL_SESSION>(session, SSL_SESSION_free));
+        return 1;
+    }
+    return 0;
+}
+
+bool OpenSSLContext::canResumeSessions() const {
+    // Sessions are shared per server, so never resume one that was
+    // authenticated with a client certificate.
+    return sessionCache_ && !serverIdentity_.empty() && !clientCertificate_;
+}
+
+void OpenSSLContext::setServerIdentity(const std::string& identity) {
+    serverIdentity_ = identity;
+}
+
 void OpenSSLContext::sendPendingDataToNetwork() {
     int size = BIO_pending(writeBIO_);
     if (size > 0) {
+        // Reuse the buffer of the previous flush. It is taken out of the
+        // context while in use, in case the signal calls back into us.
         SafeByteArray data;
+        data.swap(networkBuffer_);
         data.resize(size);
         BIO_read(writeBIO_, vecptr(data), size);
         onDataForNetwork(data);
+        scrubSafeByteArray(data);
+        data.clear();
+        networkBuffer_.swap(data);
     }
 }
 
@@ -171,7 +303,7 @@ void OpenSSLContext::handleDataFromNetwork(const SafeByteArray& data) {
     BIO_write(readBIO_, vecptr(data), data.size());
     switch (state_) {
         case Connecting:
-            doConnect();
+            doHandshake();
             break;
         case Connected:
             sendPendingDataToApplication();
@@ -192,60 +324,124 @@ void OpenSSLContext::handleDataFromApplication(const SafeByteArray& data) {
 }
 
 void OpenSSLContext::sendPendingDataToApplication() {
+    // Decrypt all complete records into one buffer, and pass them on in one
+    // go. The buffer is reused (and scrubbed) across calls, like the
+    // network buffer.
     SafeByteArray data;
-    data.resize(SSL_READ_BUFFERSIZE);
-    int ret = SSL_read(handle_, vecptr(data), data.size());
-    while (ret > 0) {
-        data.resize(ret);
+    data.swap(applicationBuffer_);
+    size_t size = 0;
+    int ret;
+    do {
+        if (data.size() < size + SSL_READ_BUFFERSIZE) {
+            data.resize(size + SSL_READ_BUFFERSIZE);
+        }
+        ret = SSL_read(handle_, vecptr(data) + size, SSL_READ_BUFFERSIZE);
+        if (ret > 0) {
+            size += static_cast<size_t>(ret);
+        }
+    } while (ret > 0);
+
+    // Passing on the data can touch the OpenSSL error queue, so check the
+    // result first.
+    bool failed = ret < 0 && SSL_get_error(handle_, ret) != SSL_ERROR_WANT_READ;
+    if (size > 0) {
+        data.resize(size);
         onDataForApplication(data);
-        data.resize(SSL_READ_BUFFERSIZE);
-        ret = SSL_read(handle_, vecptr(data), data.size());
     }
-    if (ret < 0 && SSL_get_error(handle_, ret) != SSL_ERROR_WANT_READ) {
+    // Only the first size bytes were written; growing the buffer
+    // zero-initializes the rest.
+    std::fill(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(std::min(size, data.size())), 0);
+    data.clear();
+    applicationBuffer_.swap(data);
+
+    if (failed) {
         state_ = Error;
         onError(std::make_shared<TLSError>());
     }
 }
 
 bool OpenSSLContext::setClientCertificate(CertificateWithKey::ref certificate) {
-    std::shared_ptr<PKCS12Certificate> pkcs12Certificate = std::dynamic_pointer_cast<PKCS12Certificate>(certificate);
-    if (!pkcs12Certificate || pkcs12Certificate->isNull()) {
-        return false;
-    }
+    // Use the key & certificates once the connection is set up, since the
+    // SSL_CTX can be shared with other contexts.
+    return loadCertificate(certificate, clientCertificate_, clientPrivateKey_, clientCertificateChain_);
+}
 
-    // Create a PKCS12 structure
-    BIO* bio = BIO_new(BIO_s_mem());
-    BIO_write(bio, vecptr(pkcs12Certificate->getData()), pkcs12Certificate->getData().size());
-    std::shared_ptr<PKCS12> pkcs12(d2i_PKCS12_bio(bio, NULL), PKCS12_free);
-    BIO_free(bio);
-    if (!pkcs12) {
-        return false;
-    }
+bool OpenSSLContext::loadCertificate(CertificateWithKey::ref certificate, std::shared_ptr<X509>& x509, std::shared_ptr<EVP_PKEY>& privateKey, std::vector<std::shared_ptr<X509> >& chain) {
+    std::shared_ptr<X509> loadedX509;
+    std::shared_ptr<EVP_PKEY> loadedPrivateKey;
+    std::vector<std::shared_ptr<X509> > loadedChain;
 
-    // Parse PKCS12
-    X509 *certPtr = 0;
-    EVP_PKEY* privateKeyPtr = 0;
-    STACK_OF(X509)* caCertsPtr = 0;
-    SafeByteArray password(pkcs12Certificate->getPassword());
-    password.push_back(0);
-    int result = PKCS12_parse(pkcs12.get(), reinterpret_cast<const char*>(vecptr(password)), &privateKeyPtr, &certPtr, &caCertsPtr);
-    if (result != 1) {
-        return false;
+    if (std::shared_ptr<PKCS12Certificate> pkcs12Certificate = std::dynamic_pointer_cast<PKCS12Certificate>(certificate)) {
+        if (pkcs12Certificate->isNull()) {
+            return false;
+        }
+
+        // Create a PKCS12 structure
+        BIO* bio = BIO_new(BIO_s_mem());
+        BIO_write(bio, vecptr(pkcs12Certificate->getData()), pkcs12Certificate->getData().size());
+        std::shared_ptr<PKCS12> pkcs12(d2i_PKCS12_bio(bio, NULL), PKCS12_free);
+        BIO_free(bio);
+        if (!pkcs12) {
+            return false;
+        }
+
+        // Parse PKCS12
+        X509 *certPtr = 0;
+        EVP_PKEY* privateKeyPtr = 0;
+        STACK_OF(X509)* caCertsPtr = 0;
+        SafeByteArray password(pkcs12Certificate->getPassword());
+        password.push_back(0);
+        int result = PKCS12_parse(pkcs12.get(), reinterpret_cast<const char*>(vecptr(password)), &privateKeyPtr, &certPtr, &caCertsPtr);
+        if (result != 1) {
+            return false;
+        }
+        loadedX509 = std::shared_ptr<X509>(certPtr, X509_free);
+        loadedPrivateKey = std::shared_ptr<EVP_PKEY>(privateKeyPtr, EVP_PKEY_free);
+        std::shared_ptr<STACK_OF(X509)> caCerts(caCertsPtr, freeX509Stack);
+        for (int i = 0;  i < sk_X509_num(caCerts.get()); ++i) {
+            loadedChain.push_back(std::shared_ptr<X509>(sk_X509_value(caCerts.get(), i), X509_free));
+        }
     }
-    std::shared_ptr<X509> cert(certPtr, X509_free);
-    std::shared_ptr<EVP_PKEY> privateKey(privateKeyPtr, EVP_PKEY_free);
-    std::shared_ptr<STACK_OF(X509)> caCerts(caCertsPtr, freeX509Stack);
+    else if (std::shared_ptr<PEMCertificate> pemCertificate = std::dynamic_pointer_cast<PEMCertificate>(certificate)) {
+        if (pemCertificate->isNull()) {
+            return false;
+        }
 
-    // Use the key & certificates
-    if (SSL_CTX_use_certificate(context_, cert.get()) != 1) {
-        return false;
+        // The certificate comes first, followed by its chain
+        BIO* bio = BIO_new(BIO_s_mem());
+        BIO_write(bio, vecptr(pemCertificate->getCertificateData()), pemCertificate->getCertificateData().size());
+        loadedX509 = std::shared_ptr<X509>(PEM_read_bio_X509(bio, NULL, NULL, NULL), X509_free);
+        while (X509* chainCertificate = PEM_read_bio_X509(bio, NULL, NULL, NULL)) {
+            loadedChain.push_back(std::shared_ptr<X509>(chainCertificate, X509_free));
+        }
+        BIO_free(bio);
+        // Reading past the last certificate leaves an error behind
+        ERR_clear_error();
+        if (!loadedX509) {
+            return false;
+        }
+
+        // Always pass the password, so OpenSSL never prompts for one
+        bio = BIO_new(BIO_s_mem());
+        BIO_write(bio, vecptr(pemCertificate->getPrivateKeyData()), pemCertificate->getPrivateKeyData().size());
+        SafeByteArray password(pemCertificate->getPassword());
+        password.push_back(0);
+        loadedPrivateKey = std::shared_ptr<EVP_PKEY>(PEM_read_bio_PrivateKey(bio, NULL, NULL, vecptr(password)), EVP_PKEY_free);
+        BIO_free(bio);
+        if (!loadedPrivateKey) {
+            return false;
+        }
     }
-    if (SSL_CTX_use_PrivateKey(context_, privateKey.get()) != 1) {
+    else {
         return false;
     }
-    for (int i = 0;  i < sk_X509_num(caCerts.get()); ++i) {
-        SSL_CTX_add_extra_chain_cert(context_, sk_X509_value(caCerts.get(), i));
+
+    if (X509_check_private_key(loadedX509.get(), loadedPrivateKey.get()) != 1) {
+        return false;
     }
+    x509 = loadedX509;
+    privateKey = loadedPrivateKey;
+    chain = loadedChain;
     return true;
 }
 
@@ -1,29 +1,50 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <boost/noncopyable.hpp>
 #include <boost/signals2.hpp>
 
 #include <openssl/ssl.h>
 
 #include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/TLS/CertificateWithKey.h>
 #include <Swiften/TLS/TLSContext.h>
 
 namespace Swift {
+    class OpenSSLSessionCache;
 
     class OpenSSLContext : public TLSContext, boost::noncopyable {
         public:
+            /**
+             * Creates a context with its own SSL_CTX, and without session
+             * resumption.
+             */
             OpenSSLContext();
+
+            /**
+             * Creates a context using a shared SSL_CTX, created with
+             * createSSLContext(), or with createServerSSLContext() for
+             * contexts that accept() connections. If a session cache is
+             * given, client sessions are resumed from it, and handshakes are
+             * counted in it.
+             */
+            OpenSSLContext(std::shared_ptr<SSL_CTX> context, std::shared_ptr<OpenSSLSessionCache> sessionCache);
             virtual ~OpenSSLContext();
 
             void connect();
+            void accept();
             bool setClientCertificate(CertificateWithKey::ref cert);
+            void setServerIdentity(const std::string& identity);
 
             void handleDataFromNetwork(const SafeByteArray&);
             void handleDataFromApplication(const SafeByteArray&);
@@ -33,12 +54,38 @@ namespace Swift {
 
             virtual ByteArray getFinishMessage() const;
 
+            /**
+             * Creates an SSL_CTX for client contexts, with the system trust
+             * store loaded.
+             */
+            static std::shared_ptr<SSL_CTX> createSSLContext();
+
+            /**
+             * Creates an SSL_CTX for server contexts. Server contexts sharing
+             * it can resume each other's sessions, from both session IDs and
+             * session tickets.
+             *
+             * The certificate to present to clients still needs to be set
+             * with setCertificate().
+             */
+            static std::shared_ptr<SSL_CTX> createServerSSLContext();
+
+            /**
+             * Sets the certificate, private key and certificate chain of
+             * a PKCS12Certificate or PEMCertificate on an SSL_CTX.
+             */
+            static bool setCertificate(SSL_CTX* context, CertificateWithKey::ref certificate);
+
         private:
             static void ensureLibraryInitialized();
+            static bool loadCertificate(CertificateWithKey::ref certificate, std::shared_ptr<X509>& x509, std::shared_ptr<EVP_PKEY>& privateKey, std::vector<std::shared_ptr<X509> >& chain);
+            static int handleNewSession(SSL* handle, SSL_SESSION* session);
 
             static CertificateVerificationError::Type getVerificationErrorTypeForResult(int);
 
-            void doConnect();
+            bool canResumeSessions() const;
+            bool createHandle();
+            void doHandshake();
             void sendPendingDataToNetwork();
             void sendPendingDataToApplication();
 
@@ -46,9 +93,16 @@ namespace Swift {
             enum State { Start, Connecting, Connected, Error };
 
             State state_;
-            SSL_CTX* context_;
+            std::shared_ptr<SSL_CTX> context_;
+            std::shared_ptr<OpenSSLSessionCache> sessionCache_;
+            std::string serverIdentity_;
+            std::shared_ptr<X509> clientCertificate_;
+            std::shared_ptr<EVP_PKEY> clientPrivateKey_;
+            std::vector<std::shared_ptr<X509> > clientCertificateChain_;
             SSL* handle_;
             BIO* readBIO_;
             BIO* writeBIO_;
+            SafeByteArray networkBuffer_;
+            SafeByteArray applicationBuffer_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,12 +11,37 @@
 
 namespace Swift {
 
+OpenSSLContextFactory::OpenSSLContextFactory() : sessionCache_(std::make_shared<OpenSSLSessionCache>()) {
+}
+
 bool OpenSSLContextFactory::canCreate() const {
     return true;
 }
 
-TLSContext* OpenSSLContextFactory::createTLSContext(const TLSOptions&) {
-    return new OpenSSLContext();
+TLSContext* OpenSSLContextFactory::createTLSContext(const TLSOptions&, TLSContext::Mode mode) {
+    if (mode == TLSContext::Mode::Server) {
+        // Without a certificate, handshakes will fail
+        if (!serverContext_) {
+            serverContext_ = OpenSSLContext::createServerSSLContext();
+        }
+        return new OpenSSLContext(serverContext_, sessionCache_);
+    }
+
+    // Loading the trust store is expensive, so only do it once
+    if (!context_) {
+        context_ = OpenSSLContext::createSSLContext();
+    }
+    return new OpenSSLContext(context_, sessionCache_);
+}
+
+bool OpenSSLContextFactory::setServerCertificate(CertificateWithKey::ref certificate) {
+    // Contexts created before keep using the previous certificate
+    std::shared_ptr<SSL_CTX> serverContext = OpenSSLContext::createServerSSLContext();
+    if (!OpenSSLContext::setCertificate(serverContext.get(), certificate)) {
+        return false;
+    }
+    serverContext_ = serverContext;
+    return true;
 }
 
 void OpenSSLContextFactory::setCheckCertificateRevocation(bool check) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,17 +7,44 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 
+#include <openssl/ssl.h>
+
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
 #include <Swiften/TLS/TLSContextFactory.h>
 
 namespace Swift {
+    /**
+     * Creates OpenSSL contexts that share one SSL_CTX (and thus one trust
+     * store), and resume sessions with servers they connected to before.
+     *
+     * Server mode contexts share another SSL_CTX, holding the server
+     * certificate and the session ticket keys.
+     */
     class OpenSSLContextFactory : public TLSContextFactory {
         public:
+            OpenSSLContextFactory();
+
             bool canCreate() const;
-            virtual TLSContext* createTLSContext(const TLSOptions& tlsOptions);
+            virtual TLSContext* createTLSContext(const TLSOptions& tlsOptions, TLSContext::Mode mode);
+            virtual bool setServerCertificate(CertificateWithKey::ref certificate);
 
             // Not supported
             virtual void setCheckCertificateRevocation(bool b);
             virtual void setDisconnectOnCardRemoval(bool b);
+
+            /**
+             * Returns the number of full and resumed handshakes done by the
+             * contexts of this factory.
+             */
+            OpenSSLSessionCache::Statistics getHandshakeStatistics() const {
+                return sessionCache_->getStatistics();
+            }
+
+        private:
+            std::shared_ptr<SSL_CTX> context_;
+            std::shared_ptr<SSL_CTX> serverContext_;
+            std::shared_ptr<OpenSSLSessionCache> sessionCache_;
     };
 }
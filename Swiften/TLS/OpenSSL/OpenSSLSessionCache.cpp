@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
+
+#include <ctime>
+
+namespace Swift {
+
+std::shared_ptr<SSL_SESSION> OpenSSLSessionCache::getSession(const std::string& serverIdentity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto i = sessionIndex_.find(serverIdentity);
+    if (i == sessionIndex_.end()) {
+        return std::shared_ptr<SSL_SESSION>();
+    }
+    // Expired sessions can't be resumed anymore, so don't offer them to the server
+    SSL_SESSION* session = i->second->second.get();
+    if (std::time(nullptr) - SSL_SESSION_get_time(session) > SSL_SESSION_get_timeout(session)) {
+        sessions_.erase(i->second);
+        sessionIndex_.erase(i);
+        return std::shared_ptr<SSL_SESSION>();
+    }
+    sessions_.splice(sessions_.begin(), sessions_, i->second);
+    return i->second->second;
+}
+
+void OpenSSLSessionCache::setSession(const std::string& serverIdentity, std::shared_ptr<SSL_SESSION> session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto i = sessionIndex_.find(serverIdentity);
+    if (i != sessionIndex_.end()) {
+        // A newer session (e.g. from a renewed ticket) replaces the old one
+        i->second->second = session;
+        sessions_.splice(sessions_.begin(), sessions_, i->second);
+        return;
+    }
+    sessions_.push_front(std::make_pair(serverIdentity, session));
+    sessionIndex_[serverIdentity] = sessions_.begin();
+    if (sessions_.size() > MAX_SESSIONS) {
+        sessionIndex_.erase(sessions_.back().first);
+        sessions_.pop_back();
+    }
+}
+
+void OpenSSLSessionCache::removeSession(const std::string& serverIdentity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto i = sessionIndex_.find(serverIdentity);
+    if (i != sessionIndex_.end()) {
+        sessions_.erase(i->second);
+        sessionIndex_.erase(i);
+    }
+}
+
+void OpenSSLSessionCache::addHandshake(bool resumed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (resumed) {
+        statistics_.resumedHandshakes++;
+    }
+    else {
+        statistics_.fullHandshakes++;
+    }
+}
+
+OpenSSLSessionCache::Statistics OpenSSLSessionCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+}
+
+}
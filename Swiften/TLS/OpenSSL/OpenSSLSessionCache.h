@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/noncopyable.hpp>
+
+#include <openssl/ssl.h>
+
+namespace Swift {
+    /**
+     * Keeps the last TLS session per server, so that new connections to a
+     * server can resume the session instead of doing a full handshake.
+     * Only the sessions of the most recently used servers are kept, and
+     * expired sessions are dropped when they are looked up.
+     *
+     * Also counts the full and resumed handshakes of the contexts using it.
+     */
+    class OpenSSLSessionCache : public boost::noncopyable {
+        public:
+            struct Statistics {
+                Statistics() : fullHandshakes(0), resumedHandshakes(0) {}
+
+                unsigned long long fullHandshakes;
+                unsigned long long resumedHandshakes;
+            };
+
+            static const size_t MAX_SESSIONS = 256;
+
+            std::shared_ptr<SSL_SESSION> getSession(const std::string& serverIdentity);
+            void setSession(const std::string& serverIdentity, std::shared_ptr<SSL_SESSION> session);
+            void removeSession(const std::string& serverIdentity);
+
+            void addHandshake(bool resumed);
+            Statistics getStatistics() const;
+
+        private:
+            typedef std::list<std::pair<std::string, std::shared_ptr<SSL_SESSION> > > SessionList;
+
+            mutable std::mutex mutex_;
+            SessionList sessions_;
+            std::unordered_map<std::string, SessionList::iterator> sessionIndex_;
+            Statistics statistics_;
+    };
+}
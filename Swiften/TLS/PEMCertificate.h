@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <boost/filesystem/path.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/TLS/CertificateWithKey.h>
+
+namespace Swift {
+    /**
+     * A certificate chain and private key in PEM format.
+     *
+     * The chain starts with the certificate itself, followed by the
+     * certificates of its issuers. The certificates and the key can be read
+     * from the same file.
+     */
+    class SWIFTEN_API PEMCertificate : public Swift::CertificateWithKey {
+        public:
+            PEMCertificate() {}
+
+            PEMCertificate(const boost::filesystem::path& certificateFile, const boost::filesystem::path& privateKeyFile, const SafeByteArray& password = SafeByteArray()) : password_(password) {
+                readByteArrayFromFile(certificateData_, certificateFile);
+                ByteArray privateKeyData;
+                readByteArrayFromFile(privateKeyData, privateKeyFile);
+                privateKeyData_ = createSafeByteArray(privateKeyData);
+                std::fill(privateKeyData.begin(), privateKeyData.end(), 0);
+            }
+
+            virtual ~PEMCertificate() {}
+
+            virtual bool isNull() const {
+                return certificateData_.empty() || privateKeyData_.empty();
+            }
+
+            const ByteArray& getCertificateData() const {
+                return certificateData_;
+            }
+
+            void setCertificateData(const ByteArray& data) {
+                certificateData_ = data;
+            }
+
+            const SafeByteArray& getPrivateKeyData() const {
+                return privateKeyData_;
+            }
+
+            void setPrivateKeyData(const SafeByteArray& data) {
+                privateKeyData_ = data;
+            }
+
+            /**
+             * Returns the password of the private key, or an empty password
+             * if the key is not encrypted.
+             */
+            const SafeByteArray& getPassword() const {
+                return password_;
+            }
+
+        private:
+            ByteArray certificateData_;
+            SafeByteArray privateKeyData_;
+            SafeByteArray password_;
+    };
+}
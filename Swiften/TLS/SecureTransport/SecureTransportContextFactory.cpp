@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -26,7 +26,11 @@ bool SecureTransportContextFactory::canCreate() const {
     return true;
 }
 
-TLSContext* SecureTransportContextFactory::createTLSContext(const TLSOptions& /* tlsOptions */) {
+TLSContext* SecureTransportContextFactory::createTLSContext(const TLSOptions& /* tlsOptions */, TLSContext::Mode mode) {
+    // Server mode is not supported
+    if (mode != TLSContext::Mode::Client) {
+        return nullptr;
+    }
     return new SecureTransportContext(checkCertificateRevocation_);
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015 Isode Limited.
+ * Copyright (c) 2015-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -17,7 +17,7 @@ class SecureTransportContextFactory : public TLSContextFactory {
 
         virtual bool canCreate() const;
 
-        virtual TLSContext* createTLSContext(const TLSOptions& tlsOptions);
+        virtual TLSContext* createTLSContext(const TLSOptions& tlsOptions, TLSContext::Mode mode);
         virtual void setCheckCertificateRevocation(bool b);
         virtual void setDisconnectOnCardRemoval(bool b);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2016 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include <boost/signals2.hpp>
 
@@ -20,13 +21,33 @@
 namespace Swift {
 
     class SWIFTEN_API TLSContext {
+        public:
+            enum class Mode {
+                Client,
+                Server
+            };
+
         public:
             virtual ~TLSContext();
 
             virtual void connect() = 0;
 
+            /**
+             * Starts the server side of a handshake. Only contexts created
+             * in Mode::Server support this; others emit onError.
+             */
+            virtual void accept();
+
             virtual bool setClientCertificate(CertificateWithKey::ref cert) = 0;
 
+            /**
+             * Sets the identity of the server to connect to (e.g. its domain).
+             * Contexts that support session resumption use it to find a
+             * previous session with the same server. Needs to be called
+             * before connect().
+             */
+            virtual void setServerIdentity(const std::string& /* identity */) {}
+
             virtual void handleDataFromNetwork(const SafeByteArray&) = 0;
             virtual void handleDataFromApplication(const SafeByteArray&) = 0;
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2017 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,18 +7,31 @@
 #pragma once
 
 #include <Swiften/Base/API.h>
+#include <Swiften/TLS/CertificateWithKey.h>
+#include <Swiften/TLS/TLSContext.h>
 #include <Swiften/TLS/TLSOptions.h>
 
 namespace Swift {
-    class TLSContext;
-
     class SWIFTEN_API TLSContextFactory {
         public:
             virtual ~TLSContextFactory();
 
             virtual bool canCreate() const = 0;
 
-            virtual TLSContext* createTLSContext(const TLSOptions& tlsOptions) = 0;
+            /**
+             * Returns nullptr if this factory does not support the mode.
+             */
+            virtual TLSContext* createTLSContext(const TLSOptions& tlsOptions, TLSContext::Mode mode = TLSContext::Mode::Client) = 0;
+
+            /**
+             * Sets the certificate and private key that the Mode::Server
+             * contexts of this factory present to clients.
+             *
+             * Returns false if the certificate could not be loaded, or if
+             * this factory does not support server mode.
+             */
+            virtual bool setServerCertificate(CertificateWithKey::ref certificate);
+
             virtual void setCheckCertificateRevocation(bool b) = 0;
             virtual void setDisconnectOnCardRemoval(bool b) = 0;
     };
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2017 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include <boost/lexical_cast.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/TLS/OpenSSL/OpenSSLSessionCache.h>
+
+using namespace Swift;
+
+class OpenSSLSessionCacheTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(OpenSSLSessionCacheTest);
+        CPPUNIT_TEST(testGetSession);
+        CPPUNIT_TEST(testGetSession_UnknownServer);
+        CPPUNIT_TEST(testSetSession_ReplacesSession);
+        CPPUNIT_TEST(testRemoveSession);
+        CPPUNIT_TEST(testGetSession_Expired);
+        CPPUNIT_TEST(testSetSession_EvictsLeastRecentlyUsed);
+        CPPUNIT_TEST(testAddHandshake);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testGetSession() {
+            OpenSSLSessionCache testling;
+            std::shared_ptr<SSL_SESSION> session = createSession();
+
+            testling.setSession("example.com", session);
+
+            CPPUNIT_ASSERT(session == testling.getSession("example.com"));
+        }
+
+        void testGetSession_UnknownServer() {
+            OpenSSLSessionCache testling;
+            testling.setSession("example.com", createSession());
+
+            CPPUNIT_ASSERT(!testling.getSession("example.org"));
+        }
+
+        void testSetSession_ReplacesSession() {
+            OpenSSLSessionCache testling;
+            std::shared_ptr<SSL_SESSION> session = createSession();
+
+            testling.setSession("example.com", createSession());
+            testling.setSession("example.com", session);
+
+            CPPUNIT_ASSERT(session == testling.getSession("example.com"));
+        }
+
+        void testRemoveSession() {
+            OpenSSLSessionCache testling;
+            testling.setSession("example.com", createSession());
+
+            testling.removeSession("example.com");
+
+            CPPUNIT_ASSERT(!testling.getSession("example.com"));
+        }
+
+        void testGetSession_Expired() {
+            OpenSSLSessionCache testling;
+            std::shared_ptr<SSL_SESSION> session = createSession();
+            CPPUNIT_ASSERT(SSL_SESSION_set_timeout(session.get(), 60));
+            CPPUNIT_ASSERT(SSL_SESSION_set_time(session.get(), static_cast<long>(std::time(nullptr)) - 120));
+
+            testling.setSession("example.com", session);
+
+            CPPUNIT_ASSERT(!testling.getSession("example.com"));
+        }
+
+        void testSetSession_EvictsLeastRecentlyUsed() {
+            OpenSSLSessionCache testling;
+            for (size_t i = 0; i < OpenSSLSessionCache::MAX_SESSIONS; ++i) {
+                testling.setSession("server" + boost::lexical_cast<std::string>(i), createSession());
+            }
+            // Using the oldest session makes server1 the least recently used one
+            CPPUNIT_ASSERT(testling.getSession("server0"));
+
+            testling.setSession("example.com", createSession());
+
+            CPPUNIT_ASSERT(testling.getSession("server0"));
+            CPPUNIT_ASSERT(!testling.getSession("server1"));
+            CPPUNIT_ASSERT(testling.getSession("server2"));
+            CPPUNIT_ASSERT(testling.getSession("example.com"));
+        }
+
+        void testAddHandshake() {
+            OpenSSLSessionCache testling;
+
+            testling.addHandshake(false);
+            testling.addHandshake(true);
+            testling.addHandshake(true);
+
+            CPPUNIT_ASSERT_EQUAL(1ULL, testling.getStatistics().fullHandshakes);
+            CPPUNIT_ASSERT_EQUAL(2ULL, testling.getStatistics().resumedHandshakes);
+        }
+
+    private:
+        std::shared_ptr<SSL_SESSION> createSession() {
+            std::shared_ptr<SSL_SESSION> session(SSL_SESSION_new(), SSL_SESSION_free);
+            CPPUNIT_ASSERT(session);
+            return session;
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OpenSSLSessionCacheTest);